@@ -0,0 +1,110 @@
+#ifndef CHIMERA_CLUSTERS_GLSL
+#define CHIMERA_CLUSTERS_GLSL
+
+#include "common.glsl"
+
+// Clustered point and spot lights for the forward path. cluster_cull.comp
+// lists the lights that reach each froxel of the view; forward.frag shades
+// the list of the froxel a fragment lies in. The grid and its math mirror
+// ClusterGrid in ClusteredLights.h: cluster space is view space with depth
+// measured forward, and clusterData.yz holds the near and far planes.
+
+#ifdef CLUSTER_LIGHTS_WRITABLE
+#define CLUSTER_LIST_ACCESS writeonly
+#else
+#define CLUSTER_LIST_ACCESS readonly
+#endif
+
+layout(set = 1, binding = BINDING_PUNCTUAL_LIGHTS, scalar) readonly buffer PunctualLightBuffer
+{
+    GpuPunctualLight punctualLights[];
+};
+
+// Every cluster's count, then CLUSTER_MAX_LIGHTS light indices per cluster
+layout(set = 1, binding = BINDING_CLUSTERS, scalar) CLUSTER_LIST_ACCESS buffer ClusterBuffer
+{
+    uint clusterCounts[CLUSTER_COUNT];
+    uint clusterLights[];
+};
+
+uint ClusterIndex(uint i, uint j, uint k)
+{
+    return (k * CLUSTER_GRID_Y + j) * CLUSTER_GRID_X + i;
+}
+
+vec2 ClusterProjectionScale()
+{
+    return abs(vec2(camera.proj[0][0], camera.proj[1][1]));
+}
+
+vec3 ToClusterSpace(vec3 worldPos)
+{
+    vec3 viewPos = (camera.view * vec4(worldPos, 1.0)).xyz;
+    return vec3(viewPos.xy, -viewPos.z);
+}
+
+uint ClusterSlice(float depth)
+{
+    float nearPlane = clusterData.y;
+    if (!(depth > nearPlane)) return 0u;
+    float slice = log(depth / nearPlane) / log(clusterData.z / nearPlane) * float(CLUSTER_GRID_Z);
+    return min(uint(slice), uint(CLUSTER_GRID_Z - 1));
+}
+
+float ClusterSliceDepth(uint k)
+{
+    return clusterData.y * pow(clusterData.z / clusterData.y, float(k) / float(CLUSTER_GRID_Z));
+}
+
+// Froxel holding a cluster space point. Taken from the point rather than
+// gl_FragCoord so the TAA jitter cannot move it out of its froxel's box.
+uint ClusterOfPoint(vec3 p)
+{
+    vec2 slope = p.xy / max(p.z, clusterData.y);
+    vec2 scale = ClusterProjectionScale();
+    vec2 t = vec2(slope.x * scale.x + 1.0, 1.0 - slope.y * scale.y) * 0.5;
+    vec2 grid = vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y);
+    uvec2 tile = uvec2(clamp(floor(t * grid), vec2(0.0), grid - 1.0));
+    return ClusterIndex(tile.x, tile.y, ClusterSlice(p.z));
+}
+
+// Cluster space box around froxel (i, j, k)
+void ClusterBounds(uint i, uint j, uint k, out vec3 boxMin, out vec3 boxMax)
+{
+    vec2 scale = ClusterProjectionScale();
+    float slopeX0 = (2.0 * float(i) / float(CLUSTER_GRID_X) - 1.0) / scale.x;
+    float slopeX1 = (2.0 * float(i + 1) / float(CLUSTER_GRID_X) - 1.0) / scale.x;
+    float slopeY0 = (1.0 - 2.0 * float(j + 1) / float(CLUSTER_GRID_Y)) / scale.y;
+    float slopeY1 = (1.0 - 2.0 * float(j) / float(CLUSTER_GRID_Y)) / scale.y;
+    float nearDepth = ClusterSliceDepth(k);
+    float farDepth = ClusterSliceDepth(k + 1);
+
+    boxMin = vec3(min(slopeX0 * nearDepth, slopeX0 * farDepth),
+                  min(slopeY0 * nearDepth, slopeY0 * farDepth), nearDepth);
+    boxMax = vec3(max(slopeX1 * nearDepth, slopeX1 * farDepth),
+                  max(slopeY1 * nearDepth, slopeY1 * farDepth), farDepth);
+}
+
+bool SphereIntersectsCluster(vec3 boxMin, vec3 boxMax, vec3 center, float radius)
+{
+    vec3 outside = max(max(boxMin - center, center - boxMax), vec3(0.0));
+    return radius > 0.0 && dot(outside, outside) <= radius * radius;
+}
+
+// Radiance a punctual light sends to worldPos along L: inverse square
+// falloff windowed to reach zero at the light's range (Karis, "Real Shading
+// in Unreal Engine 4"), times the spot cone, which admits every direction
+// for point lights.
+vec3 EvalPunctualLight(GpuPunctualLight light, vec3 worldPos, out vec3 L)
+{
+    vec3 toLight = light.positionRange.xyz - worldPos;
+    float distanceSquared = max(dot(toLight, toLight), 1e-4);
+    L = toLight * inversesqrt(distanceSquared);
+
+    float ratio = distanceSquared / (light.positionRange.w * light.positionRange.w);
+    float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+    float cone = smoothstep(light.spotCos.x, light.spotCos.y, dot(-L, light.directionType.xyz));
+    return light.colorIntensity.rgb * light.colorIntensity.a * cone * window * window / distanceSquared;
+}
+
+#endif
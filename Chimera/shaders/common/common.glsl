@@ -151,7 +151,7 @@ float CalculateRayQueryShadow(vec3 origin, vec3 L, float maxDist)
     {
         if (rayQueryGetIntersectionTypeEXT(rq, false) == gl_RayQueryCandidateIntersectionTriangleEXT) 
         {
-            uint objId = rayQueryGetIntersectionInstanceCustomIndexEXT(rq, false);
+            uint objId = rayQueryGetIntersectionInstanceCustomIndexEXT(rq, false) + rayQueryGetIntersectionGeometryIndexEXT(rq, false);
             uint primIdx = rayQueryGetIntersectionPrimitiveIndexEXT(rq, false);
             vec2 bary = rayQueryGetIntersectionBarycentricsEXT(rq, false);
             GpuInstance inst = instances[objId];
@@ -169,6 +169,8 @@ float CalculateRayQueryShadow(vec3 origin, vec3 L, float maxDist)
             return 0.0;
         }
     }
+    // Opaque geometry is committed without appearing as a candidate
+    if (rayQueryGetIntersectionTypeEXT(rq, true) != gl_RayQueryCommittedIntersectionNoneEXT) return 0.0;
     return 1.0;
 }
 
@@ -245,12 +247,8 @@ vec2 SampleTriangle(vec2 u) {
     return vec2(1.0 - r, u.y * r);
 }
 
-int SampleDiscrete(int lightID, float randVal) {
-    int start = lights[lightID].cdfStart;
-    int count = lights[lightID].cdfCount;
-    float maxVal = lightsCDF[start + count - 1];
-    float x = randVal * maxVal;
-    
+// First entry of lightsCDF[start, start + count) whose running sum exceeds x.
+int FindCDFInterval(int start, int count, float x) {
     int low = start;
     int high = start + count;
     while (low < high) {
@@ -261,17 +259,261 @@ int SampleDiscrete(int lightID, float randVal) {
     return clamp(low - start, 0, count - 1);
 }
 
-vec3 SampleLights(vec3 position, float randL, float randEl, vec2 randUV, inout int sampledLightInstance) {
+// The light CDF buffer starts with a header (LightCDFHeaderFloats in
+// LightManager.h): the light tree's offset and node count as uint bits.
+const int LIGHT_CDF_HEADER_FLOATS = 4;
+const int LIGHT_TREE_NODE_FLOATS = 16;
+
+// Alias table of count entries at lightsCDF[start], as written by
+// AliasTable::AppendTo: three floats per entry, the probability of keeping
+// it, its alias (uint bits) and its own probability, returned in pmf.
+// The light table (power weighted, one entry per light) follows the
+// header; each emissive mesh's table over its triangles is at its cdfStart.
+int SampleAlias(int start, int count, float u, out float pmf) {
+    float scaled = u * float(count);
+    int index = clamp(int(scaled), 0, count - 1);
+    int entry = start + index * 3;
+    if (scaled - float(index) >= lightsCDF[entry])
+        index = int(floatBitsToUint(lightsCDF[entry + 1]));
+    pmf = lightsCDF[start + index * 3 + 2];
+    return index;
+}
+
+// Light tree node as written by LightTree::AppendTo.
+struct LightTreeNode {
+    vec3 boundsMin;
+    float power;
+    vec3 boundsMax;
+    float cosThetaO;
+    vec3 axis;
+    float cosThetaE;
+    int child;      // Second child, or the leaf's instance
+    int triangle;   // The leaf's triangle within its instance
+    bool leaf;
+};
+
+LightTreeNode LoadLightTreeNode(int index) {
+    int base = int(floatBitsToUint(lightsCDF[0])) + index * LIGHT_TREE_NODE_FLOATS;
+    LightTreeNode node;
+    node.boundsMin = vec3(lightsCDF[base], lightsCDF[base + 1], lightsCDF[base + 2]);
+    node.power = lightsCDF[base + 3];
+    node.boundsMax = vec3(lightsCDF[base + 4], lightsCDF[base + 5], lightsCDF[base + 6]);
+    node.cosThetaO = lightsCDF[base + 7];
+    node.axis = vec3(lightsCDF[base + 8], lightsCDF[base + 9], lightsCDF[base + 10]);
+    node.cosThetaE = lightsCDF[base + 11];
+    node.child = int(floatBitsToUint(lightsCDF[base + 12]));
+    node.triangle = int(floatBitsToUint(lightsCDF[base + 13]));
+    node.leaf = floatBitsToUint(lightsCDF[base + 14]) != 0u;
+    return node;
+}
+
+// cos(max(0, a - b)) and sin(max(0, a - b)).
+float CosSubClamped(float sinA, float cosA, float sinB, float cosB) {
+    return cosA > cosB ? 1.0 : cosA * cosB + sinA * sinB;
+}
+
+float SinSubClamped(float sinA, float cosA, float sinB, float cosB) {
+    return cosA > cosB ? 0.0 : sinA * cosB - cosA * sinB;
+}
+
+// How much light a node may send to p with surface normal n, up to a
+// constant; n may be zero. Mirrors LightImportance in LightTree.cpp.
+float LightImportance(LightTreeNode node, vec3 p, vec3 n) {
+    if (node.power <= 0.0) return 0.0;
+    vec3 centre = 0.5 * (node.boundsMin + node.boundsMax);
+    vec3 toPoint = p - centre;
+    float distanceSquared = dot(toPoint, toPoint);
+    float d2 = max(distanceSquared, 0.5 * length(node.boundsMax - node.boundsMin));
+
+    vec3 wi = distanceSquared > 0.0 ? toPoint * inversesqrt(distanceSquared) : node.axis;
+    float cosThetaW = abs(dot(node.axis, wi));
+    float sinThetaW = sqrt(max(1.0 - cosThetaW * cosThetaW, 0.0));
+
+    vec3 halfDiagonal = node.boundsMax - centre;
+    float radiusSquared = dot(halfDiagonal, halfDiagonal);
+    float cosThetaB = distanceSquared < radiusSquared ? -1.0 : sqrt(max(1.0 - radiusSquared / distanceSquared, 0.0));
+    float sinThetaB = sqrt(max(1.0 - cosThetaB * cosThetaB, 0.0));
+
+    float sinThetaO = sqrt(max(1.0 - node.cosThetaO * node.cosThetaO, 0.0));
+    float cosThetaX = CosSubClamped(sinThetaW, cosThetaW, sinThetaO, node.cosThetaO);
+    float sinThetaX = SinSubClamped(sinThetaW, cosThetaW, sinThetaO, node.cosThetaO);
+    float cosThetaP = CosSubClamped(sinThetaX, cosThetaX, sinThetaB, cosThetaB);
+    if (cosThetaP <= node.cosThetaE) return 0.0;
+
+    float importance = node.power * cosThetaP / d2;
+    if (dot(n, n) > 0.0) {
+        float cosThetaI = abs(dot(wi, n));
+        float sinThetaI = sqrt(max(1.0 - cosThetaI * cosThetaI, 0.0));
+        importance *= CosSubClamped(sinThetaI, cosThetaI, sinThetaB, cosThetaB);
+    }
+    return max(importance, 0.0);
+}
+
+// Descends the light tree choosing children by importance to (p, n).
+// Returns the chosen leaf, or -1 when nothing lights p; pmf is the
+// probability of the leaf. Mirrors LightTree::Sample.
+int SampleLightTree(vec3 p, vec3 n, float u, out float pmf) {
+    pmf = 1.0;
+    if (floatBitsToUint(lightsCDF[1]) == 0u) return -1;
+    int current = 0;
+    LightTreeNode node = LoadLightTreeNode(0);
+    while (!node.leaf) {
+        LightTreeNode first = LoadLightTreeNode(current + 1);
+        LightTreeNode second = LoadLightTreeNode(node.child);
+        float importance0 = LightImportance(first, p, n);
+        float importance1 = LightImportance(second, p, n);
+        if (importance0 <= 0.0 && importance1 <= 0.0) return -1;
+        float p0 = importance0 / (importance0 + importance1);
+        if (u < p0) {
+            current = current + 1;
+            node = first;
+            u = min(u / p0, 0.99999994);
+            pmf *= p0;
+        } else {
+            current = node.child;
+            node = second;
+            u = min((u - p0) / (1.0 - p0), 0.99999994);
+            pmf *= 1.0 - p0;
+        }
+    }
+    // A lone leaf was never weighed against a sibling
+    if (current == 0 && LightImportance(node, p, n) <= 0.0) return -1;
+    return current;
+}
+
+// Environment importance sampling. The environment light's CDF range holds
+// width, height, the marginal row CDF and then one CDF per row, as written
+// by EnvironmentDistribution::AppendTo; texels are weighted by luminance
+// times solid angle.
+
+// Inverse of SampleEquirectangular.
+vec3 EnvUVToDirection(vec2 uv) {
+    float phi = (uv.x - 0.5) * 2.0 * PI;
+    float lat = (0.5 - uv.y) * PI;
+    return vec3(cos(lat) * cos(phi), sin(lat), cos(lat) * sin(phi));
+}
+
+// The environment light is always last; INVALID_ID unless it has a
+// distribution to sample.
+int GetEnvironmentLight() {
+    int lightID = int(envData.y) - 1;
+    if (lightID < 0 || lights[lightID].environment == INVALID_ID ||
+        lights[lightID].cdfCount == 0)
+        return INVALID_ID;
+    return lightID;
+}
+
+// Solid angle pdf of SampleEnvironment returning dir.
+float EnvironmentPdf(int lightID, vec3 dir) {
+    int start = lights[lightID].cdfStart;
+    int width = int(lightsCDF[start]);
+    int height = int(lightsCDF[start + 1]);
+    int marginal = start + 2;
+    int row = marginal + height;
+
+    vec2 uv = SampleEquirectangular(dir);
+    int x = clamp(int(uv.x * float(width)), 0, width - 1);
+    int y = clamp(int(uv.y * float(height)), 0, height - 1);
+    row += y * width;
+    float weight = lightsCDF[row + x] - (x > 0 ? lightsCDF[row + x - 1] : 0.0);
+    float pdfUV = weight / lightsCDF[marginal + height - 1] *
+                  float(width) * float(height);
+
+    // dw = 2 pi^2 cos(latitude) du dv
+    float cosLat = sqrt(max(1.0 - dir.y * dir.y, 0.0));
+    return cosLat > 1e-6 ? pdfUV / (2.0 * PI * PI * cosLat) : 0.0;
+}
+
+vec3 SampleEnvironment(int lightID, vec2 u, out float pdf) {
+    int start = lights[lightID].cdfStart;
+    int width = int(lightsCDF[start]);
+    int height = int(lightsCDF[start + 1]);
+    int marginal = start + 2;
+
+    float total = lightsCDF[marginal + height - 1];
+    float rowTarget = u.x * total;
+    int y = FindCDFInterval(marginal, height, rowTarget);
+    float rowStart = y > 0 ? lightsCDF[marginal + y - 1] : 0.0;
+    float rowWeight = lightsCDF[marginal + y] - rowStart;
+    float rowOffset = rowWeight > 0.0
+        ? clamp((rowTarget - rowStart) / rowWeight, 0.0, 1.0) : 0.5;
+
+    int row = marginal + height + y * width;
+    float texelTarget = u.y * lightsCDF[row + width - 1];
+    int x = FindCDFInterval(row, width, texelTarget);
+    float texelStart = x > 0 ? lightsCDF[row + x - 1] : 0.0;
+    float texelWeight = lightsCDF[row + x] - texelStart;
+    float texelOffset = texelWeight > 0.0
+        ? clamp((texelTarget - texelStart) / texelWeight, 0.0, 1.0) : 0.5;
+
+    vec2 uv = min(vec2(float(x) + texelOffset, float(y) + rowOffset) /
+                  vec2(width, height), vec2(1.0));
+    vec3 dir = EnvUVToDirection(uv);
+    float cosLat = cos((0.5 - uv.y) * PI);
+    float pdfUV = texelWeight / total * float(width) * float(height);
+    pdf = cosLat > 1e-6 ? pdfUV / (2.0 * PI * PI * cosLat) : 0.0;
+    return dir;
+}
+
+// Diffuse IBL: radiance a white Lambertian surface facing n reflects, from
+// the skybox irradiance SH (ProjectIrradianceSH in EnvironmentLighting.cpp).
+vec3 EvaluateIrradianceSH(vec3 n) {
+    vec3 result = envIrradianceSH[0].rgb * 0.282095;
+    result += envIrradianceSH[1].rgb * (0.488603 * n.y);
+    result += envIrradianceSH[2].rgb * (0.488603 * n.z);
+    result += envIrradianceSH[3].rgb * (0.488603 * n.x);
+    result += envIrradianceSH[4].rgb * (1.092548 * n.x * n.y);
+    result += envIrradianceSH[5].rgb * (1.092548 * n.y * n.z);
+    result += envIrradianceSH[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0));
+    result += envIrradianceSH[7].rgb * (1.092548 * n.x * n.z);
+    result += envIrradianceSH[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+    return max(result, vec3(0.0));
+}
+
+// Specular IBL along R from the prefiltered GGX chain, whose level i holds
+// roughness i / envData.w. Below the first rough level it blends from the
+// full resolution skybox so mirrors stay sharp; without a chain it reads
+// the skybox alone.
+vec3 SampleEnvironmentSpecular(vec3 R, float roughness) {
+    vec2 uv = SampleEquirectangular(R);
+    vec3 mirror = texture(textureArray[nonuniformEXT(int(envData.x))], uv).rgb;
+    int prefilteredIdx = int(envData.z);
+    if (prefilteredIdx < 0) return mirror;
+    float lod = clamp(roughness, 0.0, 1.0) * envData.w;
+    vec3 rough = textureLod(textureArray[nonuniformEXT(prefilteredIdx)], uv,
+                            max(lod, 1.0)).rgb;
+    return lod >= 1.0 ? rough : mix(mirror, rough, lod);
+}
+
+// Power heuristic (beta = 2) weight of a sample from the strategy with pdfA.
+float PowerHeuristic(float pdfA, float pdfB) {
+    float a = pdfA * pdfA;
+    float b = pdfB * pdfB;
+    return a + b > 0.0 ? a / (a + b) : 0.0;
+}
+
+// Picks the sky with its share of the light table, or else an emissive
+// triangle from the light tree by its importance to (position, normal),
+// and returns a direction towards it. pdf is the solid angle density of
+// that direction, zero when nothing was sampled.
+vec3 SampleLights(vec3 position, vec3 normal, float randL, float randEl, vec2 randUV, inout int sampledLightInstance, out float pdf) {
+    pdf = 0.0;
     uint lightCount = uint(envData.y);
     if (lightCount == 0) return vec3(0.0);
 
-    int lightID = int(randL * float(lightCount));
-    lightID = clamp(lightID, 0, int(lightCount) - 1);
-
-    if (lights[lightID].instance != INVALID_ID) {
-        sampledLightInstance = lights[lightID].instance;
+    int skyID = int(lightCount) - 1;
+    float skyPmf = 0.0;
+    if (lights[skyID].environment != INVALID_ID)
+        skyPmf = lightsCDF[LIGHT_CDF_HEADER_FLOATS + skyID * 3 + 2];
+
+    if (randL >= skyPmf) {
+        float treePmf;
+        int leaf = SampleLightTree(position, normal, randEl, treePmf);
+        if (leaf < 0) return vec3(0.0);
+        LightTreeNode node = LoadLightTreeNode(leaf);
+        sampledLightInstance = node.child;
         GpuInstance inst = instances[sampledLightInstance];
-        int element = SampleDiscrete(lightID, randEl);
+        int element = node.triangle;
         vec2 triUV = SampleTriangle(randUV);
 
         VertexBufferRef vBuf = VertexBufferRef(inst.vertexAddress);
@@ -285,16 +527,33 @@ vec3 SampleLights(vec3 position, float randL, float randEl, vec2 randUV, inout i
         vec3 p2 = (inst.transform * vec4(vBuf.v[i2].pos, 1.0)).xyz;
 
         vec3 lightPos = p1 * triUV.x + p2 * triUV.y + p0 * (1.0 - triUV.x - triUV.y);
-        return normalize(lightPos - position);
-    } else if (lights[lightID].environment != INVALID_ID) {
-        float r1 = randUV.x;
-        float r2 = randUV.y;
-        float z = 2.0 * r1 - 1.0;
-        float r = sqrt(max(0.0, 1.0 - z * z));
-        float phi = 2.0 * PI * r2;
-        return vec3(r * cos(phi), r * sin(phi), z);
+        vec3 toLight = lightPos - position;
+        float distanceSquared = dot(toLight, toLight);
+        vec3 crossEdges = cross(p1 - p0, p2 - p0);
+        float doubleArea = length(crossEdges);
+        if (distanceSquared <= 0.0 || doubleArea <= 0.0) return vec3(0.0);
+        vec3 direction = toLight * inversesqrt(distanceSquared);
+        // Emitters are two sided
+        float cosLight = abs(dot(crossEdges, direction)) / doubleArea;
+        if (cosLight <= 0.0) return vec3(0.0);
+        // Uniform over the triangle's area, converted to solid angle
+        pdf = (1.0 - skyPmf) * treePmf * 2.0 * distanceSquared / (doubleArea * cosLight);
+        return direction;
     }
-    return vec3(0.0);
+
+    if (lights[skyID].cdfCount > 0) {
+        float skyPdf;
+        vec3 direction = SampleEnvironment(skyID, randUV, skyPdf);
+        pdf = skyPmf * skyPdf;
+        return direction;
+    }
+    float r1 = randUV.x;
+    float r2 = randUV.y;
+    float z = 2.0 * r1 - 1.0;
+    float r = sqrt(max(0.0, 1.0 - z * z));
+    float phi = 2.0 * PI * r2;
+    pdf = skyPmf / (4.0 * PI);
+    return vec3(r * cos(phi), r * sin(phi), z);
 }
 
 // 4.4 Material & Texture Utilities
@@ -321,7 +580,10 @@ vec3 CalculateNormal(GpuMaterial mat, vec3 N, vec4 tangent, vec2 uv)
     float handedness = abs(tangent.w) < 0.001 ? 1.0 : tangent.w;
     vec3 B = cross(surfaceNormal, T) * handedness;
     mat3 TBN = mat3(T, B, surfaceNormal);
-    vec3 nm = texture(textureArray[nonuniformEXT(mat.normalTexture)], uv).xyz * 2.0 - 1.0;
+    // Only XY is read: BC5-compressed normal maps store no Z, so it is
+    // rebuilt from the unit length of the tangent-space normal.
+    vec2 nxy = texture(textureArray[nonuniformEXT(mat.normalTexture)], uv).xy * 2.0 - 1.0;
+    vec3 nm = vec3(nxy, sqrt(max(1.0 - dot(nxy, nxy), 0.0)));
     return normalize(TBN * nm);
 }
 
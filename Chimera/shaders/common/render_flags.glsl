@@ -0,0 +1,24 @@
+#ifndef CHIMERA_RENDER_FLAGS_GLSL
+#define CHIMERA_RENDER_FLAGS_GLSL
+
+// RenderFlags with compile-time specialization (see RenderFlagPermutation.h).
+// Flags in RENDER_FLAGS_STATIC_MASK take their value from
+// RENDER_FLAGS_STATIC_VALUE, so branches on them fold away when the pipeline
+// is created; all other flags are read from frameData.w. Without
+// specialization the mask is 0 and every flag stays dynamic.
+// Include after common.glsl.
+
+#ifndef RENDER_FLAGS_CONSTANT_ID
+#define RENDER_FLAGS_CONSTANT_ID 0
+#endif
+
+layout(constant_id = RENDER_FLAGS_CONSTANT_ID) const uint RENDER_FLAGS_STATIC_MASK = 0u;
+layout(constant_id = RENDER_FLAGS_CONSTANT_ID + 1) const uint RENDER_FLAGS_STATIC_VALUE = 0u;
+
+uint GetRenderFlags()
+{
+    return (frameData.w & ~RENDER_FLAGS_STATIC_MASK) |
+           (RENDER_FLAGS_STATIC_VALUE & RENDER_FLAGS_STATIC_MASK);
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef CHIMERA_RESTIR_GLSL
+#define CHIMERA_RESTIR_GLSL
+
+#include "common.glsl"
+
+// ReSTIR direct lighting from emissive triangles, shared by restir_di.rgen
+// (initial candidates and temporal reuse) and restir_di_spatial.rgen.
+
+// Candidates drawn per pixel, and how many frames of them history may
+// stand for.
+const int RESTIR_CANDIDATES = 8;
+const float RESTIR_HISTORY_LIMIT = 20.0 * float(RESTIR_CANDIDATES);
+
+// A reservoir's sample is a point on one triangle of one light; the light
+// table index is checked against the instance on reuse, since lights are
+// renumbered when the scene changes. Mirrors Reservoir in Reservoir.h.
+struct Reservoir {
+    uint light;
+    uint instance;
+    uint triangle;
+    vec2 bary;
+    float weightSum;
+    float M;
+    float W;
+};
+
+Reservoir EmptyReservoir() {
+    Reservoir r;
+    r.light = uint(INVALID_ID);
+    r.instance = uint(INVALID_ID);
+    r.triangle = 0u;
+    r.bary = vec2(0.0);
+    r.weightSum = 0.0;
+    r.M = 0.0;
+    r.W = 0.0;
+    return r;
+}
+
+// Reservoirs live in two images: the sample (light, instance, triangle and
+// barycentrics as unorm16x2) in rgba32ui and (W, M) in rg32f.
+uvec4 PackReservoirSample(Reservoir r) {
+    return uvec4(r.light, r.instance, r.triangle, packUnorm2x16(r.bary));
+}
+
+Reservoir UnpackReservoir(uvec4 s, vec2 weights) {
+    Reservoir r = EmptyReservoir();
+    r.light = s.x;
+    r.instance = s.y;
+    r.triangle = s.z;
+    r.bary = unpackUnorm2x16(s.w);
+    r.W = weights.x;
+    r.M = weights.y;
+    return r;
+}
+
+// Streams in a candidate standing for count candidates.
+bool UpdateReservoir(inout Reservoir r, Reservoir candidate, float weight, float count, float u) {
+    r.M += count;
+    if (!(weight > 0.0) || isinf(weight)) return false;
+    r.weightSum += weight;
+    if (u * r.weightSum >= weight) return false;
+    r.light = candidate.light;
+    r.instance = candidate.instance;
+    r.triangle = candidate.triangle;
+    r.bary = candidate.bary;
+    return true;
+}
+
+// Streams in another pixel's or frame's reservoir whose sample has target
+// density targetPdf here.
+bool MergeReservoir(inout Reservoir r, Reservoir other, float targetPdf, float u) {
+    return UpdateReservoir(r, other, targetPdf * other.W * other.M, other.M, u);
+}
+
+void FinalizeReservoir(inout Reservoir r, float targetPdf) {
+    r.W = targetPdf > 0.0 && r.M > 0.0 ? r.weightSum / (r.M * targetPdf) : 0.0;
+    if (isnan(r.W) || isinf(r.W)) r.W = 0.0;
+}
+
+// The shading point a sample is evaluated at, from the G-buffer.
+struct RestirSurface {
+    vec3 position;
+    vec3 normal;
+    vec3 view;
+    vec3 albedo;
+    float roughness;
+    float metallic;
+};
+
+// Unshadowed radiance a sample sends to the surface, with the direction and
+// distance to it. Zero when the sample no longer names the emissive
+// triangle it did.
+vec3 RestirContribution(RestirSurface s, Reservoir r, out vec3 L, out float lightDistance) {
+    L = vec3(0.0);
+    lightDistance = 0.0;
+    int lightCount = int(envData.y);
+    if (r.light >= uint(lightCount) || r.instance >= uint(instances.length())) return vec3(0.0);
+    GpuLight light = lights[r.light];
+    if (light.environment != INVALID_ID || uint(light.instance) != r.instance ||
+        r.triangle >= uint(light.cdfCount))
+        return vec3(0.0);
+
+    GpuInstance inst = instances[r.instance];
+    VertexBufferRef vBuf = VertexBufferRef(inst.vertexAddress);
+    IndexBufferRef iBuf = IndexBufferRef(inst.indexAddress);
+    uint i0 = iBuf.i[r.triangle * 3 + 0];
+    uint i1 = iBuf.i[r.triangle * 3 + 1];
+    uint i2 = iBuf.i[r.triangle * 3 + 2];
+    vec3 p0 = (inst.transform * vec4(vBuf.v[i0].pos, 1.0)).xyz;
+    vec3 p1 = (inst.transform * vec4(vBuf.v[i1].pos, 1.0)).xyz;
+    vec3 p2 = (inst.transform * vec4(vBuf.v[i2].pos, 1.0)).xyz;
+
+    vec3 lightPos = p1 * r.bary.x + p2 * r.bary.y + p0 * (1.0 - r.bary.x - r.bary.y);
+    vec3 toLight = lightPos - s.position;
+    float distanceSquared = dot(toLight, toLight);
+    vec3 crossEdges = cross(p1 - p0, p2 - p0);
+    float doubleArea = length(crossEdges);
+    if (distanceSquared <= 0.0 || doubleArea <= 0.0) return vec3(0.0);
+    lightDistance = sqrt(distanceSquared);
+    L = toLight / lightDistance;
+    // Emitters are two sided; the geometry term converts area to solid angle
+    float cosLight = abs(dot(crossEdges, L)) / doubleArea;
+    vec3 emission = materials[inst.material].emission;
+    vec3 brdf = EvalPbr(s.albedo, 1.5, s.roughness, s.metallic, s.normal, s.view, L);
+    return brdf * emission * cosLight / distanceSquared;
+}
+
+float RestirLuminance(vec3 c) {
+    return dot(c, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Target density p-hat: the luminance of the unshadowed contribution.
+float RestirTargetPdf(RestirSurface s, Reservoir r) {
+    vec3 L;
+    float lightDistance;
+    return RestirLuminance(RestirContribution(s, r, L, lightDistance));
+}
+
+// Draws a candidate from the light CDF buffer: a light from the power
+// weighted light table, a triangle from its alias table, then a uniform
+// point on it. pdf is the area density of the point, zero when the light
+// table picked the sky, which ReSTIR leaves to the IBL and GI passes.
+Reservoir SampleRestirCandidate(inout uint seed, out float pdf) {
+    Reservoir candidate = EmptyReservoir();
+    pdf = 0.0;
+    int lightCount = int(envData.y);
+    if (lightCount == 0) return candidate;
+
+    float lightPmf;
+    int light = SampleAlias(LIGHT_CDF_HEADER_FLOATS, lightCount, RandomFloat(seed), lightPmf);
+    GpuLight gpuLight = lights[light];
+    if (gpuLight.environment != INVALID_ID || gpuLight.cdfCount == 0) {
+        RandomFloat(seed);
+        RandomFloat(seed);
+        RandomFloat(seed);
+        return candidate;
+    }
+    float trianglePmf;
+    int triangle = SampleAlias(gpuLight.cdfStart, gpuLight.cdfCount, RandomFloat(seed), trianglePmf);
+    candidate.light = uint(light);
+    candidate.instance = uint(gpuLight.instance);
+    candidate.triangle = uint(triangle);
+    candidate.bary = SampleTriangle(vec2(RandomFloat(seed), RandomFloat(seed)));
+
+    GpuInstance inst = instances[gpuLight.instance];
+    VertexBufferRef vBuf = VertexBufferRef(inst.vertexAddress);
+    IndexBufferRef iBuf = IndexBufferRef(inst.indexAddress);
+    vec3 p0 = (inst.transform * vec4(vBuf.v[iBuf.i[triangle * 3 + 0]].pos, 1.0)).xyz;
+    vec3 p1 = (inst.transform * vec4(vBuf.v[iBuf.i[triangle * 3 + 1]].pos, 1.0)).xyz;
+    vec3 p2 = (inst.transform * vec4(vBuf.v[iBuf.i[triangle * 3 + 2]].pos, 1.0)).xyz;
+    float area = 0.5 * length(cross(p1 - p0, p2 - p0));
+    pdf = area > 0.0 ? lightPmf * trianglePmf / area : 0.0;
+    return candidate;
+}
+
+#endif // CHIMERA_RESTIR_GLSL
@@ -1,6 +1,8 @@
 #version 460
 #extension GL_GOOGLE_include_directive : require
 #include "../common/common.glsl"
+#include "../common/clusters.glsl"
+#include "../common/render_flags.glsl"
 
 layout(location = 0) in vec3 inNormal;
 layout(location = 1) in vec2 inUV;
@@ -23,7 +25,7 @@ void main()
     vec3 worldNormal = CalculateNormal(rawMat, inNormal, inTangent, inUV);
     vec3 viewDirection = normalize(camera.position.xyz - inWorldPos);
     
-    uint renderFlags = frameData.w;
+    uint renderFlags = GetRenderFlags();
     bool lightEnabled = (renderFlags & RENDER_FLAG_LIGHT_BIT) != 0;
     bool shadowsEnabled = (renderFlags & RENDER_FLAG_SHADOW_BIT) != 0;
     vec3 lightDirection = normalize(-sunLight.direction.xyz);
@@ -42,6 +44,20 @@ void main()
 
     // --- [PLAGIARISM] SVGF PBR Evaluation ---
     vec3 directLighting = EvalPbr(mat.Colour, 1.5, mat.Roughness, mat.Metallic, worldNormal, viewDirection, lightDirection) * shadow * lightIntensity;
+
+    // Point and spot lights listed for this fragment's cluster, unshadowed
+    if (lightEnabled)
+    {
+        uint cluster = ClusterOfPoint(ToClusterSpace(inWorldPos));
+        uint count = min(clusterCounts[cluster], uint(CLUSTER_MAX_LIGHTS));
+        for (uint n = 0; n < count; ++n)
+        {
+            GpuPunctualLight light = punctualLights[clusterLights[cluster * CLUSTER_MAX_LIGHTS + n]];
+            vec3 L;
+            vec3 radiance = EvalPunctualLight(light, inWorldPos, L);
+            directLighting += EvalPbr(mat.Colour, 1.5, mat.Roughness, mat.Metallic, worldNormal, viewDirection, L) * radiance;
+        }
+    }
     
     float ambStr = postData.y;
     int skyIdx = int(envData.x);
@@ -49,8 +65,8 @@ void main()
     if (skyIdx >= 0 && (renderFlags & RENDER_FLAG_IBL_BIT) != 0)
     {
         vec3 reflectDirection = reflect(-viewDirection, worldNormal);
-        vec3 envSpecular = texture(textureArray[nonuniformEXT(skyIdx)], SampleEquirectangular(reflectDirection)).rgb;
-        vec3 envDiffuse = texture(textureArray[nonuniformEXT(skyIdx)], SampleEquirectangular(worldNormal)).rgb;
+        vec3 envSpecular = SampleEnvironmentSpecular(reflectDirection, mat.Roughness);
+        vec3 envDiffuse = EvaluateIrradianceSH(worldNormal);
         
         vec3 F0 = mix(vec3(0.04), mat.Colour, mat.Metallic);
         vec3 F = FresnelSchlick(F0, worldNormal, viewDirection);
@@ -1,6 +1,7 @@
 #version 460
 #extension GL_GOOGLE_include_directive : require
 #include "../common/common.glsl"
+#include "../common/render_flags.glsl"
 
 /**
  * @file composition.frag
@@ -28,13 +29,14 @@ layout(set = 2, binding = 6) uniform sampler2D gGI;
 layout(set = 2, binding = 7) uniform sampler2D gReflection;
 layout(set = 2, binding = 8) uniform sampler2D gShadow; 
 layout(set = 2, binding = 9) uniform sampler2D gAO;     
+layout(set = 2, binding = 10) uniform sampler2D gDirectLights; // ReSTIR DI 自发光几何直接光
 
 void main() 
 {
     // --- 1. 获取全局参数与深度控制 ---
     float depth = texture(gDepth, inUV).r;
     uint displayMode = frameData.z;
-    uint renderFlags = frameData.w;
+    uint renderFlags = GetRenderFlags();
     float ambStr     = postData.y;
     int skyIdx       = int(envData.x);
 
@@ -101,6 +103,7 @@ void main()
 
     // A. 直接光部分 (Cook-Torrance BRDF)
     vec3 directRadiance = EvalPbr(baseColor, 1.5, roughness, metallic, worldNormal, viewDir, lightDir) * shadowFactor * lightIntensity;
+    directRadiance += texture(gDirectLights, inUV).rgb;
 
     // B. 间接漫反射 (GI + Albedo)
     vec3 F0 = mix(vec3(0.04), baseColor, metallic);
@@ -111,9 +114,12 @@ void main()
     // C. 间接镜面反射 (RT Reflections * Fresnel)
     vec3 indirectSpecular = reflRadiance * F;
 
-    // D. 降级逻辑：若 GI 禁用则回退至简单的环境光
+    // D. 降级逻辑：若 GI 禁用则回退至环境图辐照度球谐 (一次 SH 求值)，无环境图时使用简单的环境光
     if ((renderFlags & RENDER_FLAG_GI_BIT) == 0) {
-        indirectDiffuse = ambStr * baseColor * 0.1;
+        if (skyIdx >= 0 && (renderFlags & RENDER_FLAG_IBL_BIT) != 0)
+            indirectDiffuse = EvaluateIrradianceSH(worldNormal) * baseColor * kD * ambStr;
+        else
+            indirectDiffuse = ambStr * baseColor * 0.1;
     }
     indirectDiffuse *= clamp(gBufferAO * rtAO, 0.0, 1.0);
 
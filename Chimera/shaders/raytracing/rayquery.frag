@@ -1,6 +1,7 @@
 #version 460
 #extension GL_GOOGLE_include_directive : require
 #include "../common/common.glsl"
+#include "../common/render_flags.glsl"
 
 layout(location = 0) in vec3 inNormal;
 layout(location = 1) in vec2 inUV;
@@ -22,7 +23,7 @@ void main()
     MaterialPoint mat = GetMaterialPoint(rawMat, inUV);
     vec3 worldNormal = CalculateNormal(rawMat, inNormal, inTangent, inUV);
     vec3 viewDirection = normalize(camera.position.xyz - inWorldPos);
-    uint renderFlags = frameData.w;
+    uint renderFlags = GetRenderFlags();
     bool lightEnabled = (renderFlags & RENDER_FLAG_LIGHT_BIT) != 0;
     bool shadowsEnabled = (renderFlags & RENDER_FLAG_SHADOW_BIT) != 0;
 
@@ -52,8 +53,8 @@ void main()
     if (skyboxIdx >= 0 && (renderFlags & RENDER_FLAG_IBL_BIT) != 0)
     {
         vec3 reflectDirection = reflect(-viewDirection, worldNormal);
-        vec3 envSpecular = texture(textureArray[nonuniformEXT(skyboxIdx)], SampleEquirectangular(reflectDirection)).rgb;
-        vec3 envDiffuse = texture(textureArray[nonuniformEXT(skyboxIdx)], SampleEquirectangular(worldNormal)).rgb;
+        vec3 envSpecular = SampleEnvironmentSpecular(reflectDirection, mat.Roughness);
+        vec3 envDiffuse = EvaluateIrradianceSH(worldNormal);
         vec3 F0 = mix(vec3(0.04), mat.Colour, mat.Metallic);
         vec3 F = FresnelSchlick(F0, worldNormal, viewDirection);
         vec3 kD = (vec3(1.0) - F) * (1.0 - mat.Metallic);
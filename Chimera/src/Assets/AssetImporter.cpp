@@ -67,6 +67,9 @@ static void TraverseNodes(aiNode* node, const aiScene* scene,
         Mesh mesh{};
         mesh.name = aMesh->mName.C_Str();
         mesh.materialIndex = aMesh->mMaterialIndex;
+        if (aMesh->mMaterialIndex < outScene.MaterialAlphaModes.size())
+            mesh.alphaMode =
+                outScene.MaterialAlphaModes[aMesh->mMaterialIndex];
         mesh.transform = worldTransform;
 
         mesh.vertexOffset = (uint32_t)outScene.Vertices.size();
@@ -179,7 +182,8 @@ std::shared_ptr<ImportedScene> AssetImporter::ImportScene(
     std::vector<std::future<void>> textureFutures;
     std::set<std::string> uniquePaths;
 
-    auto QueueTexture = [&](const aiString& texPath, bool srgb)
+    auto QueueTexture =
+        [&](const aiString& texPath, bool srgb, bool normalMap = false)
     {
         if (texPath.length == 0) return;
         const aiTexture* embedded =
@@ -203,8 +207,11 @@ std::shared_ptr<ImportedScene> AssetImporter::ImportScene(
             {
                 textureFutures.push_back(
                     Application::Get().GetTaskSystem()->Enqueue(
-                        [identity, srgb]()
-                        { ResourceManager::Get().LoadTexture(identity, srgb); }));
+                        [identity, srgb, normalMap]()
+                        {
+                            ResourceManager::Get().LoadTexture(identity, srgb,
+                                                               normalMap);
+                        }));
             }
             else if (embedded->mHeight == 0)
             {
@@ -214,10 +221,12 @@ std::shared_ptr<ImportedScene> AssetImporter::ImportScene(
                                                    begin + embedded->mWidth);
                 textureFutures.push_back(
                     Application::Get().GetTaskSystem()->Enqueue(
-                        [identity, srgb, encoded = std::move(encoded)]()
+                        [identity, srgb, normalMap,
+                         encoded = std::move(encoded)]()
                         {
                             ResourceManager::Get().LoadTextureFromMemory(
-                                identity, encoded.data(), encoded.size(), srgb);
+                                identity, encoded.data(), encoded.size(), srgb,
+                                normalMap);
                         }));
             }
             else
@@ -238,11 +247,12 @@ std::shared_ptr<ImportedScene> AssetImporter::ImportScene(
                 const uint32_t height = embedded->mHeight;
                 textureFutures.push_back(
                     Application::Get().GetTaskSystem()->Enqueue(
-                        [identity, srgb, width, height,
+                        [identity, srgb, normalMap, width, height,
                          rgba = std::move(rgba)]()
                         {
                             ResourceManager::Get().LoadTextureFromPixels(
-                                identity, rgba.data(), width, height, srgb);
+                                identity, rgba.data(), width, height, srgb,
+                                normalMap);
                         }));
             }
         }
@@ -254,10 +264,11 @@ std::shared_ptr<ImportedScene> AssetImporter::ImportScene(
         aiString texPath;
         if (mat->GetTexture(aiTextureType_DIFFUSE, 0, &texPath) == AI_SUCCESS)
             QueueTexture(texPath, true);
+        // HEIGHT is the normal map fallback below, so it is filtered as one.
         if (mat->GetTexture(aiTextureType_NORMALS, 0, &texPath) == AI_SUCCESS)
-            QueueTexture(texPath, false);
+            QueueTexture(texPath, false, true);
         if (mat->GetTexture(aiTextureType_HEIGHT, 0, &texPath) == AI_SUCCESS)
-            QueueTexture(texPath, false);
+            QueueTexture(texPath, false, true);
         if (mat->GetTexture(aiTextureType_METALNESS, 0, &texPath) == AI_SUCCESS)
             QueueTexture(texPath, false);
         if (mat->GetTexture(aiTextureType_DIFFUSE_ROUGHNESS, 0, &texPath) ==
@@ -296,6 +307,7 @@ std::shared_ptr<ImportedScene> AssetImporter::ImportScene(
         return TextureHandle();
     };
 
+    uint32_t alphaModeCounts[3] = {};
     for (unsigned int i = 0; i < scene->mNumMaterials; i++)
     {
         aiMaterial* aMat = scene->mMaterials[i];
@@ -335,6 +347,12 @@ std::shared_ptr<ImportedScene> AssetImporter::ImportScene(
 
         auto hAlbedo = GetTexHandle(aMat, aiTextureType_DIFFUSE, true);
         mat.colourTexture = hAlbedo.IsValid() ? (int)hAlbedo.id : -1;
+        const AlphaMode alphaMode =
+            hAlbedo.IsValid()
+                ? ResourceManager::Get().GetTextureAlphaMode(hAlbedo)
+                : AlphaMode::Opaque;
+        outScene->MaterialAlphaModes.push_back(alphaMode);
+        alphaModeCounts[(uint32_t)alphaMode]++;
 
         auto hNormal = GetTexHandle(aMat, aiTextureType_NORMALS, false);
         if (!hNormal.IsValid())
@@ -363,7 +381,14 @@ std::shared_ptr<ImportedScene> AssetImporter::ImportScene(
     }
 
     if (outScene->Materials.empty())
+    {
         outScene->Materials.push_back(GpuMaterial{});
+        outScene->MaterialAlphaModes.push_back(AlphaMode::Opaque);
+    }
+    CH_CORE_INFO("AssetImporter: {} materials, {} opaque, {} alpha masked, "
+                 "{} alpha blended",
+                 outScene->Materials.size(), alphaModeCounts[0],
+                 alphaModeCounts[1], alphaModeCounts[2]);
 
     TraverseNodes(scene->mRootNode, scene, glm::mat4(1.0f), *outScene,
                   0xFFFFFFFF);
@@ -0,0 +1,130 @@
+#include "pch.h"
+#include "PipelineCacheFile.h"
+
+#include <cstring>
+
+namespace Chimera
+{
+namespace
+{
+constexpr uint32_t PipelineCacheMagic = 0x43504843; // "CHPC"
+constexpr uint32_t PipelineCacheFormatVersion = 1;
+
+struct PipelineCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t pipelineCacheUUID[16];
+    uint32_t reserved; // Keeps the 64-bit fields aligned without padding
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+static_assert(sizeof(PipelineCacheFileHeader) == 56,
+              "pipeline cache header must not contain implicit padding");
+
+uint64_t HashPayload(const uint8_t* data, size_t size)
+{
+    // FNV-1a: only guards against truncation and bit rot, not tampering.
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+} // namespace
+
+const char* PipelineCacheLoadStatusToString(PipelineCacheLoadStatus status)
+{
+    switch (status)
+    {
+        case PipelineCacheLoadStatus::Loaded:
+            return "loaded";
+        case PipelineCacheLoadStatus::Missing:
+            return "missing";
+        case PipelineCacheLoadStatus::Corrupt:
+            return "corrupt";
+        case PipelineCacheLoadStatus::DeviceMismatch:
+            return "device mismatch";
+        case PipelineCacheLoadStatus::DriverMismatch:
+            return "driver mismatch";
+    }
+    return "unknown";
+}
+
+std::vector<uint8_t> SerializePipelineCache(
+    const PipelineCacheDeviceInfo& device, const std::vector<uint8_t>& payload)
+{
+    PipelineCacheFileHeader header{};
+    header.magic = PipelineCacheMagic;
+    header.formatVersion = PipelineCacheFormatVersion;
+    header.vendorID = device.vendorID;
+    header.deviceID = device.deviceID;
+    header.driverVersion = device.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, device.pipelineCacheUUID.data(),
+                sizeof(header.pipelineCacheUUID));
+    header.payloadSize = payload.size();
+    header.payloadHash = HashPayload(payload.data(), payload.size());
+
+    std::vector<uint8_t> fileData(sizeof(header) + payload.size());
+    std::memcpy(fileData.data(), &header, sizeof(header));
+    if (!payload.empty())
+    {
+        std::memcpy(fileData.data() + sizeof(header), payload.data(),
+                    payload.size());
+    }
+    return fileData;
+}
+
+PipelineCacheLoadStatus DeserializePipelineCache(
+    const std::vector<uint8_t>& fileData,
+    const PipelineCacheDeviceInfo& device, std::vector<uint8_t>& outPayload)
+{
+    outPayload.clear();
+
+    if (fileData.empty())
+    {
+        return PipelineCacheLoadStatus::Missing;
+    }
+
+    PipelineCacheFileHeader header{};
+    if (fileData.size() < sizeof(header))
+    {
+        return PipelineCacheLoadStatus::Corrupt;
+    }
+    std::memcpy(&header, fileData.data(), sizeof(header));
+
+    if (header.magic != PipelineCacheMagic ||
+        header.formatVersion != PipelineCacheFormatVersion ||
+        header.payloadSize != fileData.size() - sizeof(header))
+    {
+        return PipelineCacheLoadStatus::Corrupt;
+    }
+
+    if (header.vendorID != device.vendorID ||
+        header.deviceID != device.deviceID ||
+        std::memcmp(header.pipelineCacheUUID, device.pipelineCacheUUID.data(),
+                    sizeof(header.pipelineCacheUUID)) != 0)
+    {
+        return PipelineCacheLoadStatus::DeviceMismatch;
+    }
+
+    if (header.driverVersion != device.driverVersion)
+    {
+        return PipelineCacheLoadStatus::DriverMismatch;
+    }
+
+    const uint8_t* payload = fileData.data() + sizeof(header);
+    if (HashPayload(payload, header.payloadSize) != header.payloadHash)
+    {
+        return PipelineCacheLoadStatus::Corrupt;
+    }
+
+    outPayload.assign(payload, payload + header.payloadSize);
+    return PipelineCacheLoadStatus::Loaded;
+}
+} // namespace Chimera
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // Identity of the device/driver that produced a VkPipelineCache blob.
+    // Mirrors the relevant VkPhysicalDeviceProperties fields so the file
+    // format stays testable without a Vulkan device.
+struct PipelineCacheDeviceInfo
+{
+    uint32_t vendorID = 0;
+    uint32_t deviceID = 0;
+    uint32_t driverVersion = 0;
+    std::array<uint8_t, 16> pipelineCacheUUID{};
+};
+
+enum class PipelineCacheLoadStatus
+{
+    Loaded,
+    Missing,
+    Corrupt,
+    DeviceMismatch,
+    DriverMismatch
+};
+
+const char* PipelineCacheLoadStatusToString(PipelineCacheLoadStatus status);
+
+    // Wraps driver cache data in a header carrying the device identity and a
+    // payload checksum. Drivers validate their own header too, but a stale or
+    // truncated blob is cheaper to reject here than to hand to the driver.
+std::vector<uint8_t> SerializePipelineCache(
+    const PipelineCacheDeviceInfo& device, const std::vector<uint8_t>& payload);
+
+PipelineCacheLoadStatus DeserializePipelineCache(
+    const std::vector<uint8_t>& fileData,
+    const PipelineCacheDeviceInfo& device, std::vector<uint8_t>& outPayload);
+} // namespace Chimera
@@ -0,0 +1,164 @@
+#include "pch.h"
+#include "PipelineKey.h"
+
+namespace Chimera
+{
+namespace
+{
+void AddShader(PipelineKey& key, ShaderIDTable& shaderIDs,
+               const std::string& name)
+{
+    if (key.shaderCount >= PipelineKey::MaxShaders)
+    {
+        throw std::runtime_error("PipelineKey: too many shader stages");
+    }
+    key.shaderIDs[key.shaderCount++] =
+        name.empty() ? 0u : shaderIDs.GetID(name);
+}
+
+void SetSpecializationConstants(PipelineKey& key,
+                                const std::vector<uint32_t>& constants)
+{
+    if (constants.size() > PipelineKey::MaxSpecializationConstants)
+    {
+        throw std::runtime_error(
+            "PipelineKey: too many specialization constants");
+    }
+    key.specializationConstantCount = static_cast<uint32_t>(constants.size());
+    for (size_t i = 0; i < constants.size(); ++i)
+    {
+        key.specializationConstants[i] = constants[i];
+    }
+}
+
+uint64_t Mix(uint64_t hash, uint64_t value)
+{
+    hash ^= value;
+    hash *= 0x9E3779B97F4A7C15ull;
+    return hash ^ (hash >> 32);
+}
+} // namespace
+
+uint64_t HashPipelineKey(const PipelineKey& key)
+{
+    // The key has no padding, so hashing it as 64-bit words covers every
+    // field. Each word is folded independently and the results are summed,
+    // which keeps the multiplies off a single dependency chain.
+    constexpr size_t WordCount = sizeof(PipelineKey) / sizeof(uint64_t);
+    static_assert(sizeof(PipelineKey) % sizeof(uint64_t) == 0,
+                  "PipelineKey is hashed in 64-bit words");
+
+    uint64_t words[WordCount];
+    std::memcpy(words, &key, sizeof(PipelineKey));
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < WordCount; ++i)
+    {
+        hash += Mix(0x9E3779B97F4A7C15ull * (i + 1), words[i]);
+    }
+
+    // Final avalanche (MurmurHash3 fmix64) so low bits are usable as a
+    // table index.
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+uint32_t ShaderIDTable::GetID(const std::string& name)
+{
+    auto it = m_IDs.find(name);
+    if (it != m_IDs.end()) return it->second;
+
+    const uint32_t id = static_cast<uint32_t>(m_IDs.size()) + 1;
+    m_IDs.emplace(name, id);
+    return id;
+}
+
+uint32_t ShaderIDTable::FindID(const std::string& name) const
+{
+    auto it = m_IDs.find(name);
+    return it != m_IDs.end() ? it->second : 0u;
+}
+
+bool IsFullscreenGraphicsPipeline(const GraphicsPipelineDescription& desc)
+{
+    return desc.name == "Composition" || desc.name == "FinalBlit" ||
+           desc.name == "LinearizeDepth" ||
+           desc.vertex_shader.find("fullscreen") != std::string::npos ||
+           desc.vertex_shader.find("Fullscreen") != std::string::npos;
+}
+
+PipelineKey MakeGraphicsPipelineKey(ShaderIDTable& shaderIDs,
+                                    const std::vector<VkFormat>& colorFormats,
+                                    VkFormat depthFormat,
+                                    const GraphicsPipelineDescription& desc)
+{
+    if (colorFormats.size() > PipelineKey::MaxColorFormats)
+    {
+        throw std::runtime_error("PipelineKey: too many color attachments");
+    }
+
+    PipelineKey key{};
+    key.kind = static_cast<uint32_t>(PipelineKind::Graphics);
+    key.depthFormat = static_cast<uint32_t>(depthFormat);
+    key.colorFormatCount = static_cast<uint32_t>(colorFormats.size());
+    for (size_t i = 0; i < colorFormats.size(); ++i)
+    {
+        key.colorFormats[i] = static_cast<uint32_t>(colorFormats[i]);
+    }
+
+    AddShader(key, shaderIDs, desc.vertex_shader);
+    AddShader(key, shaderIDs, desc.fragment_shader);
+
+    key.stateBits = (desc.depth_test ? 1u : 0u) |
+                    (desc.depth_write ? 1u << 1 : 0u) |
+                    ((static_cast<uint32_t>(desc.depth_compare_op) & 0xFu)
+                     << 2) |
+                    ((static_cast<uint32_t>(desc.cull_mode) & 0x3u) << 6) |
+                    (IsFullscreenGraphicsPipeline(desc) ? 1u << 8 : 0u);
+
+    SetSpecializationConstants(key, desc.specializationConstants);
+    return key;
+}
+
+PipelineKey MakeRaytracingPipelineKey(ShaderIDTable& shaderIDs,
+                                      const RaytracingPipelineDescription& desc)
+{
+    PipelineKey key{};
+    key.kind = static_cast<uint32_t>(PipelineKind::Raytracing);
+
+    // Group counts decide where each shader lands in the SBT, so a shader
+    // moving between miss and hit groups must change the key.
+    key.stateBits = (static_cast<uint32_t>(desc.miss_shaders.size()) & 0xFFu) |
+                    ((static_cast<uint32_t>(desc.hit_shaders.size()) & 0xFFu)
+                     << 8);
+
+    AddShader(key, shaderIDs, desc.raygen_shader);
+    for (const auto& miss : desc.miss_shaders)
+    {
+        AddShader(key, shaderIDs, miss);
+    }
+    for (const auto& hit : desc.hit_shaders)
+    {
+        AddShader(key, shaderIDs, hit.closest_hit);
+        AddShader(key, shaderIDs, hit.any_hit);
+        AddShader(key, shaderIDs, hit.intersection);
+    }
+
+    SetSpecializationConstants(key, desc.specializationConstants);
+    return key;
+}
+
+PipelineKey MakeComputePipelineKey(
+    ShaderIDTable& shaderIDs, const ComputePipelineDescription::Kernel& kernel)
+{
+    PipelineKey key{};
+    key.kind = static_cast<uint32_t>(PipelineKind::Compute);
+    AddShader(key, shaderIDs, kernel.shader);
+    SetSpecializationConstants(key, kernel.specializationConstants);
+    return key;
+}
+} // namespace Chimera
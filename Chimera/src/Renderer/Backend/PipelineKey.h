@@ -0,0 +1,254 @@
+#pragma once
+
+#include "Renderer/Graph/RenderGraphCommon.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Chimera
+{
+enum class PipelineKind : uint32_t
+{
+    Graphics = 1,
+    Raytracing = 2,
+    Compute = 3
+};
+
+    // Structural identity of a pipeline: attachment formats, shader IDs,
+    // fixed-function state and specialization constants. Every field is a
+    // 32-bit word and unused slots stay zero, so keys are hashed and compared
+    // as raw memory.
+struct PipelineKey
+{
+    static constexpr uint32_t MaxColorFormats = 8;
+    static constexpr uint32_t MaxShaders = 16;
+    static constexpr uint32_t MaxSpecializationConstants = 16;
+
+    uint32_t kind = 0;
+    uint32_t stateBits = 0;
+    uint32_t depthFormat = 0;
+    uint32_t colorFormatCount = 0;
+    uint32_t shaderCount = 0;
+    uint32_t specializationConstantCount = 0;
+    uint32_t colorFormats[MaxColorFormats] = {};
+    uint32_t shaderIDs[MaxShaders] = {};
+    uint32_t specializationConstants[MaxSpecializationConstants] = {};
+
+    bool operator==(const PipelineKey& other) const
+    {
+        return std::memcmp(this, &other, sizeof(PipelineKey)) == 0;
+    }
+    bool operator!=(const PipelineKey& other) const
+    {
+        return !(*this == other);
+    }
+};
+static_assert(std::is_trivially_copyable_v<PipelineKey>,
+              "PipelineKey is hashed as raw memory");
+static_assert(sizeof(PipelineKey) ==
+                  sizeof(uint32_t) * (6 + PipelineKey::MaxColorFormats +
+                                      PipelineKey::MaxShaders +
+                                      PipelineKey::MaxSpecializationConstants),
+              "PipelineKey must not contain padding");
+
+uint64_t HashPipelineKey(const PipelineKey& key);
+
+struct PipelineKeyHasher
+{
+    size_t operator()(const PipelineKey& key) const
+    {
+        return static_cast<size_t>(HashPipelineKey(key));
+    }
+};
+
+    // Assigns dense IDs to shader names. ID 0 means "no shader". Looking up
+    // a name that is already known does not allocate.
+class ShaderIDTable
+{
+public:
+    uint32_t GetID(const std::string& name);
+        // Returns 0 for names that never got an ID. Does not insert.
+    uint32_t FindID(const std::string& name) const;
+    size_t GetCount() const
+    {
+        return m_IDs.size();
+    }
+
+private:
+    std::unordered_map<std::string, uint32_t> m_IDs;
+};
+
+    // Fullscreen pipelines are created without vertex input, so this is part
+    // of the key as well as the create info.
+bool IsFullscreenGraphicsPipeline(const GraphicsPipelineDescription& desc);
+
+    // Key builders throw std::runtime_error if a description exceeds the
+    // fixed key capacity.
+PipelineKey MakeGraphicsPipelineKey(ShaderIDTable& shaderIDs,
+                                    const std::vector<VkFormat>& colorFormats,
+                                    VkFormat depthFormat,
+                                    const GraphicsPipelineDescription& desc);
+PipelineKey MakeRaytracingPipelineKey(
+    ShaderIDTable& shaderIDs, const RaytracingPipelineDescription& desc);
+PipelineKey MakeComputePipelineKey(
+    ShaderIDTable& shaderIDs, const ComputePipelineDescription::Kernel& kernel);
+
+    // Open-addressing (linear probing) map from PipelineKey to an owned
+    // pipeline. Find() never allocates.
+template <typename T>
+class PipelineKeyTable
+{
+public:
+    T* Find(const PipelineKey& key) const
+    {
+        if (m_Slots.empty()) return nullptr;
+
+        const uint64_t hash = HashPipelineKey(key);
+        const size_t mask = m_Slots.size() - 1;
+        for (size_t i = static_cast<size_t>(hash) & mask;; i = (i + 1) & mask)
+        {
+            const Slot& slot = m_Slots[i];
+            if (!slot.value) return nullptr;
+            if (slot.hash == hash && slot.key == key) return slot.value.get();
+        }
+    }
+
+    T& Insert(const PipelineKey& key, std::unique_ptr<T> value)
+    {
+        if (!value)
+        {
+            throw std::invalid_argument(
+                "PipelineKeyTable cannot store a null pipeline");
+        }
+
+        // Keep the load factor at or below 1/2 so probe runs stay short.
+        if ((m_Count + 1) * 2 > m_Slots.size())
+        {
+            Rehash(m_Slots.empty() ? 64 : m_Slots.size() * 2);
+        }
+
+        const uint64_t hash = HashPipelineKey(key);
+        Slot& slot = FindSlot(key, hash);
+        if (!slot.value) ++m_Count;
+        slot.hash = hash;
+        slot.key = key;
+        slot.value = std::move(value);
+        return *slot.value;
+    }
+
+        // Removes and returns the value for key, or nullptr if absent.
+    std::unique_ptr<T> Take(const PipelineKey& key)
+    {
+        if (m_Slots.empty()) return nullptr;
+
+        const uint64_t hash = HashPipelineKey(key);
+        const size_t mask = m_Slots.size() - 1;
+        size_t hole = static_cast<size_t>(hash) & mask;
+        while (m_Slots[hole].value &&
+               !(m_Slots[hole].hash == hash && m_Slots[hole].key == key))
+        {
+            hole = (hole + 1) & mask;
+        }
+        if (!m_Slots[hole].value) return nullptr;
+
+        std::unique_ptr<T> value = std::move(m_Slots[hole].value);
+        --m_Count;
+
+        // Backward-shift deletion: pull later members of the probe run into
+        // the hole so Find() never stops early at it.
+        for (size_t i = (hole + 1) & mask; m_Slots[i].value; i = (i + 1) & mask)
+        {
+            const size_t home = static_cast<size_t>(m_Slots[i].hash) & mask;
+            if (((i - home) & mask) >= ((i - hole) & mask))
+            {
+                m_Slots[hole] = std::move(m_Slots[i]);
+                hole = i;
+            }
+        }
+        return value;
+    }
+
+        // Removes every entry whose key matches the predicate.
+    template <typename F>
+    std::vector<std::pair<PipelineKey, std::unique_ptr<T>>> TakeIf(F&& pred)
+    {
+        std::vector<PipelineKey> keys;
+        for (const auto& slot : m_Slots)
+        {
+            if (slot.value && pred(slot.key)) keys.push_back(slot.key);
+        }
+
+        std::vector<std::pair<PipelineKey, std::unique_ptr<T>>> taken;
+        for (const auto& key : keys)
+        {
+            taken.emplace_back(key, Take(key));
+        }
+        return taken;
+    }
+
+    template <typename F>
+    void ForEach(F&& func)
+    {
+        for (auto& slot : m_Slots)
+        {
+            if (slot.value) func(slot.key, *slot.value);
+        }
+    }
+
+    size_t Size() const
+    {
+        return m_Count;
+    }
+
+    size_t Capacity() const
+    {
+        return m_Slots.size();
+    }
+
+    void Clear()
+    {
+        m_Slots.clear();
+        m_Count = 0;
+    }
+
+private:
+    struct Slot
+    {
+        uint64_t hash = 0;
+        PipelineKey key;
+        std::unique_ptr<T> value; // Null marks an empty slot
+    };
+
+    Slot& FindSlot(const PipelineKey& key, uint64_t hash)
+    {
+        const size_t mask = m_Slots.size() - 1;
+        for (size_t i = static_cast<size_t>(hash) & mask;; i = (i + 1) & mask)
+        {
+            Slot& slot = m_Slots[i];
+            if (!slot.value || (slot.hash == hash && slot.key == key))
+                return slot;
+        }
+    }
+
+    void Rehash(size_t capacity)
+    {
+        std::vector<Slot> old = std::move(m_Slots);
+        m_Slots = std::vector<Slot>(capacity);
+        for (auto& slot : old)
+        {
+            if (!slot.value) continue;
+            Slot& target = FindSlot(slot.key, slot.hash);
+            target = std::move(slot);
+        }
+    }
+
+    std::vector<Slot> m_Slots; // Power-of-two size
+    size_t m_Count = 0;
+};
+} // namespace Chimera
@@ -1,28 +1,187 @@
 #include "pch.h"
 #include "PipelineManager.h"
 #include "Renderer/Backend/VulkanContext.h"
+#include "Renderer/Backend/Renderer.h"
 #include "Renderer/Backend/ShaderManager.h"
 #include "Renderer/Resources/ResourceManager.h"
 #include "Utils/VulkanBarrier.h"
 #include "Core/Application.h"
+#include "Core/TaskSystem.h"
 #include "Renderer/RenderState.h"
 
 namespace Chimera
 {
 PipelineManager* PipelineManager::s_Instance = nullptr;
 
+namespace
+{
+    // Destroys a replaced pipeline once the GPU has finished the frame being
+    // recorded; earlier frames that may have bound it complete before that.
+template <typename T>
+void RetirePipeline(std::unique_ptr<T> pipeline)
+{
+    if (!pipeline) return;
+
+    std::shared_ptr<T> retired = std::move(pipeline);
+    VulkanContext::Get().GetDeletionQueue().PushFunction(
+        Renderer::Get().GetCurrentFrameIndex(),
+        [retired]()
+        {
+            if (retired->handle != VK_NULL_HANDLE)
+            {
+                vkDestroyPipeline(VulkanContext::Get().GetDevice(),
+                                  retired->handle, nullptr);
+            }
+        });
+}
+
+    // Moves a finished background compile into the cache and retires the
+    // pipeline it replaces after a shader reload. Returns the cached
+    // pipeline, or nullptr if it is still compiling (and wait is false),
+    // was never requested, or failed.
+template <typename T>
+T* CollectPipeline(
+    PipelineKeyTable<T>& cache, PipelineKeyTable<T>& stale,
+    std::unordered_map<PipelineKey, PendingPipelineCompile<T>,
+                       PipelineKeyHasher>& pending,
+    std::unordered_set<PipelineKey, PipelineKeyHasher>& failed,
+    const PipelineKey& key, bool wait)
+{
+    if (T* cached = cache.Find(key))
+    {
+        return cached;
+    }
+    if (pending.empty())
+    {
+        return nullptr;
+    }
+
+    auto it = pending.find(key);
+    if (it == pending.end())
+    {
+        return nullptr;
+    }
+    if (!wait && it->second.future.wait_for(std::chrono::seconds(0)) !=
+                     std::future_status::ready)
+    {
+        return nullptr;
+    }
+
+    PendingPipelineCompile<T> compile = std::move(it->second);
+    pending.erase(it);
+
+    try
+    {
+        T* pipeline = &cache.Insert(key, compile.future.get());
+        RetirePipeline(stale.Take(key));
+        return pipeline;
+    }
+    catch (const std::exception& e)
+    {
+        CH_CORE_ERROR("PipelineManager: Background compile of '{}' failed: {}",
+                      compile.name, e.what());
+        failed.insert(key);
+        return nullptr;
+    }
+}
+
+    // Collects every pending compile that has finished, leaving the rest.
+template <typename T>
+void CollectFinishedPipelines(
+    PipelineKeyTable<T>& cache, PipelineKeyTable<T>& stale,
+    std::unordered_map<PipelineKey, PendingPipelineCompile<T>,
+                       PipelineKeyHasher>& pending,
+    std::unordered_set<PipelineKey, PipelineKeyHasher>& failed)
+{
+    // Copy the keys: collecting erases the pending entries that own them.
+    std::vector<PipelineKey> finished;
+    for (const auto& [key, compile] : pending)
+    {
+        if (compile.future.wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready)
+            finished.push_back(key);
+    }
+    for (const auto& key : finished)
+    {
+        CollectPipeline(cache, stale, pending, failed, key, false);
+    }
+}
+
+    // Moves every cached pipeline built from a reloaded shader into the
+    // stale table, which keeps serving it until its rebuild lands.
+template <typename T, typename F>
+size_t InvalidatePipelines(
+    PipelineKeyTable<T>& cache, PipelineKeyTable<T>& stale,
+    std::unordered_map<PipelineKey, PendingPipelineCompile<T>,
+                       PipelineKeyHasher>& pending,
+    std::unordered_set<PipelineKey, PipelineKeyHasher>& failed,
+    const F& usesShader)
+{
+    // A compile still in flight read the old bytecode. Let it land so it
+    // is invalidated below like any cached pipeline.
+    std::vector<PipelineKey> inFlight;
+    for (const auto& [key, compile] : pending)
+    {
+        if (usesShader(key)) inFlight.push_back(key);
+    }
+    for (const auto& key : inFlight)
+    {
+        CollectPipeline(cache, stale, pending, failed, key, true);
+    }
+
+    auto invalidated = cache.TakeIf(usesShader);
+    for (auto& [key, pipeline] : invalidated)
+    {
+        RetirePipeline(stale.Take(key));
+        stale.Insert(key, std::move(pipeline));
+    }
+    return invalidated.size();
+}
+
+template <typename T>
+void DestroyPipelines(VkDevice device, PipelineKeyTable<T>& cache)
+{
+    cache.ForEach(
+        [device](const PipelineKey&, T& pipeline)
+        {
+            if (pipeline.handle != VK_NULL_HANDLE)
+            {
+                vkDestroyPipeline(device, pipeline.handle, nullptr);
+            }
+        });
+    cache.Clear();
+}
+} // namespace
+
 PipelineManager::PipelineManager()
 {
     s_Instance = this;
+    m_OwnerThread = std::this_thread::get_id();
+    m_PipelineCachePath =
+        std::filesystem::current_path() / "cache" / "pipeline_cache.bin";
+    CreatePipelineCache();
 }
 
 PipelineManager::~PipelineManager()
 {
     CH_CORE_INFO("PipelineManager: Destructor CALLED.");
     ClearCache();
+    SavePipelineCache();
 
     VkDevice device = VulkanContext::Get().GetDevice();
 
+    for (auto& [threadId, cache] : m_ThreadPipelineCaches)
+    {
+        vkDestroyPipelineCache(device, cache, nullptr);
+    }
+    m_ThreadPipelineCaches.clear();
+
+    if (m_PipelineCache != VK_NULL_HANDLE)
+    {
+        vkDestroyPipelineCache(device, m_PipelineCache, nullptr);
+        m_PipelineCache = VK_NULL_HANDLE;
+    }
+
     CH_CORE_INFO("PipelineManager: Destroying Layout Cache ({} layouts)...",
                  m_LayoutCache.size());
     for (auto& [hash, layout] : m_LayoutCache)
@@ -45,72 +204,344 @@ PipelineManager::~PipelineManager()
 
 void PipelineManager::ClearCache()
 {
+    WaitForPendingCompiles();
+    m_FailedCompiles.clear();
+
     VkDevice device = VulkanContext::Get().GetDevice();
     vkDeviceWaitIdle(device);
 
     CH_CORE_INFO("PipelineManager: Clearing Pipeline Caches...");
 
     CH_CORE_INFO("PipelineManager: Destroying Graphics Pipelines ({})...",
-                 m_GraphicsCache.size());
-    for (auto& [name, p] : m_GraphicsCache)
+                 m_GraphicsCache.Size());
+    DestroyPipelines(device, m_GraphicsCache);
+
+    CH_CORE_INFO("PipelineManager: Destroying Raytracing Pipelines ({})...",
+                 m_RaytracingCache.Size());
+    DestroyPipelines(device, m_RaytracingCache);
+
+    CH_CORE_INFO("PipelineManager: Destroying Compute Pipelines ({})...",
+                 m_ComputeCache.Size());
+    DestroyPipelines(device, m_ComputeCache);
+
+    DestroyPipelines(device, m_StaleGraphics);
+    DestroyPipelines(device, m_StaleRaytracing);
+    DestroyPipelines(device, m_StaleCompute);
+
+    CH_CORE_INFO("PipelineManager: Pipeline Caches cleared.");
+}
+
+void PipelineManager::WaitForPendingCompiles()
+{
+    if (GetPendingCompileCount() == 0) return;
+
+    CH_CORE_INFO("PipelineManager: Waiting for {} background compiles...",
+                 GetPendingCompileCount());
+
+    // Copy the key: collecting erases the pending entry that owns it.
+    while (!m_PendingGraphics.empty())
     {
-        if (p->handle != VK_NULL_HANDLE)
+        const PipelineKey key = m_PendingGraphics.begin()->first;
+        CollectPipeline(m_GraphicsCache, m_StaleGraphics, m_PendingGraphics,
+                        m_FailedCompiles, key, true);
+    }
+    while (!m_PendingRaytracing.empty())
+    {
+        const PipelineKey key = m_PendingRaytracing.begin()->first;
+        CollectPipeline(m_RaytracingCache, m_StaleRaytracing, m_PendingRaytracing,
+                        m_FailedCompiles, key, true);
+    }
+    while (!m_PendingCompute.empty())
+    {
+        const PipelineKey key = m_PendingCompute.begin()->first;
+        CollectPipeline(m_ComputeCache, m_StaleCompute, m_PendingCompute,
+                        m_FailedCompiles, key, true);
+    }
+}
+
+void PipelineManager::CollectFinishedCompiles()
+{
+    if (GetPendingCompileCount() == 0) return;
+
+    CollectFinishedPipelines(m_GraphicsCache, m_StaleGraphics,
+                             m_PendingGraphics, m_FailedCompiles);
+    CollectFinishedPipelines(m_RaytracingCache, m_StaleRaytracing,
+                             m_PendingRaytracing, m_FailedCompiles);
+    CollectFinishedPipelines(m_ComputeCache, m_StaleCompute, m_PendingCompute,
+                             m_FailedCompiles);
+}
+
+void PipelineManager::InvalidateShaders(
+    const std::unordered_set<std::string>& shaderNames)
+{
+    std::unordered_set<uint32_t> ids;
+    for (const auto& name : shaderNames)
+    {
+        if (uint32_t id = m_ShaderIDs.FindID(name)) ids.insert(id);
+    }
+    if (ids.empty()) return;
+
+    auto usesShader = [&ids](const PipelineKey& key)
+    {
+        for (uint32_t i = 0; i < key.shaderCount; ++i)
         {
-            vkDestroyPipeline(device, p->handle, nullptr);
+            if (ids.count(key.shaderIDs[i])) return true;
         }
+        return false;
+    };
+
+    // A pipeline that failed against the old source gets another try.
+    for (auto it = m_FailedCompiles.begin(); it != m_FailedCompiles.end();)
+    {
+        it = usesShader(*it) ? m_FailedCompiles.erase(it) : std::next(it);
     }
-    m_GraphicsCache.clear();
 
-    CH_CORE_INFO("PipelineManager: Destroying Raytracing Pipelines ({})...",
-                 m_RaytracingCache.size());
-    for (auto& [name, p] : m_RaytracingCache)
+    const size_t count =
+        InvalidatePipelines(m_GraphicsCache, m_StaleGraphics,
+                            m_PendingGraphics, m_FailedCompiles, usesShader) +
+        InvalidatePipelines(m_RaytracingCache, m_StaleRaytracing,
+                            m_PendingRaytracing, m_FailedCompiles,
+                            usesShader) +
+        InvalidatePipelines(m_ComputeCache, m_StaleCompute, m_PendingCompute,
+                            m_FailedCompiles, usesShader);
+    CH_CORE_INFO("PipelineManager: Invalidated {} pipelines after shader "
+                 "reload",
+                 count);
+}
+
+TaskSystem* PipelineManager::GetCompileTaskSystem() const
+{
+    return m_AsyncCompilation ? Application::Get().GetTaskSystem() : nullptr;
+}
+
+void PipelineManager::CreatePipelineCache()
+{
+    const VkPhysicalDeviceProperties& properties =
+        VulkanContext::Get().GetDeviceProperties();
+    m_PipelineCacheDevice.vendorID = properties.vendorID;
+    m_PipelineCacheDevice.deviceID = properties.deviceID;
+    m_PipelineCacheDevice.driverVersion = properties.driverVersion;
+    std::copy(std::begin(properties.pipelineCacheUUID),
+              std::end(properties.pipelineCacheUUID),
+              m_PipelineCacheDevice.pipelineCacheUUID.begin());
+
+    std::vector<uint8_t> fileData;
+    std::ifstream file(m_PipelineCachePath, std::ios::binary | std::ios::ate);
+    if (file.is_open())
     {
-        if (p->handle != VK_NULL_HANDLE)
+        fileData.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(fileData.data()),
+                  static_cast<std::streamsize>(fileData.size()));
+        if (!file) fileData.clear();
+    }
+
+    std::vector<uint8_t> payload;
+    m_PipelineCacheLoadStatus =
+        DeserializePipelineCache(fileData, m_PipelineCacheDevice, payload);
+
+    VkPipelineCacheCreateInfo info{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+    info.initialDataSize = payload.size();
+    info.pInitialData = payload.empty() ? nullptr : payload.data();
+
+    VkResult result = vkCreatePipelineCache(VulkanContext::Get().GetDevice(),
+                                            &info, nullptr, &m_PipelineCache);
+    if (result != VK_SUCCESS && !payload.empty())
+    {
+        // The driver rejected data that passed our header checks; start cold.
+        m_PipelineCacheLoadStatus = PipelineCacheLoadStatus::Corrupt;
+        info.initialDataSize = 0;
+        info.pInitialData = nullptr;
+        VK_CHECK(vkCreatePipelineCache(VulkanContext::Get().GetDevice(), &info,
+                                       nullptr, &m_PipelineCache));
+    }
+    else
+    {
+        VK_CHECK(result);
+    }
+
+    CH_CORE_INFO("PipelineManager: Pipeline cache {} ({} bytes) from {}",
+                 PipelineCacheLoadStatusToString(m_PipelineCacheLoadStatus),
+                 payload.size(), m_PipelineCachePath.string());
+}
+
+VkPipelineCache PipelineManager::GetThreadPipelineCache()
+{
+    if (std::this_thread::get_id() == m_OwnerThread)
+    {
+        return m_PipelineCache;
+    }
+
+    std::scoped_lock lock(m_PipelineCacheMutex);
+    auto& cache = m_ThreadPipelineCaches[std::this_thread::get_id()];
+    if (cache == VK_NULL_HANDLE)
+    {
+        VkPipelineCacheCreateInfo info{
+            VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+        VK_CHECK(vkCreatePipelineCache(VulkanContext::Get().GetDevice(), &info,
+                                       nullptr, &cache));
+    }
+    return cache;
+}
+
+void PipelineManager::RecordPipelineCreation(double durationMS)
+{
+    std::scoped_lock lock(m_PipelineCacheMutex);
+    ++m_CreationStats.pipelineCount;
+    m_CreationStats.totalMS += durationMS;
+    m_PipelineCacheDirty = true;
+}
+
+PipelineCreationStats PipelineManager::GetCreationStats()
+{
+    std::scoped_lock lock(m_PipelineCacheMutex);
+    return m_CreationStats;
+}
+
+void PipelineManager::ResetCreationStats()
+{
+    std::scoped_lock lock(m_PipelineCacheMutex);
+    m_CreationStats = {};
+}
+
+void PipelineManager::SavePipelineCache()
+{
+    if (m_PipelineCache == VK_NULL_HANDLE) return;
+
+    VkDevice device = VulkanContext::Get().GetDevice();
+    std::scoped_lock lock(m_PipelineCacheMutex);
+
+    if (!m_PipelineCacheDirty) return;
+
+    if (!m_ThreadPipelineCaches.empty())
+    {
+        std::vector<VkPipelineCache> sources;
+        sources.reserve(m_ThreadPipelineCaches.size());
+        for (auto& [threadId, cache] : m_ThreadPipelineCaches)
         {
-            vkDestroyPipeline(device, p->handle, nullptr);
+            sources.push_back(cache);
         }
+        VK_CHECK(vkMergePipelineCaches(device, m_PipelineCache,
+                                       (uint32_t)sources.size(),
+                                       sources.data()));
     }
-    m_RaytracingCache.clear();
 
-    CH_CORE_INFO("PipelineManager: Destroying Compute Pipelines ({})...",
-                 m_ComputeCache.size());
-    for (auto& [name, p] : m_ComputeCache)
+    size_t dataSize = 0;
+    VK_CHECK(vkGetPipelineCacheData(device, m_PipelineCache, &dataSize,
+                                    nullptr));
+    std::vector<uint8_t> payload(dataSize);
+    VK_CHECK(vkGetPipelineCacheData(device, m_PipelineCache, &dataSize,
+                                    payload.data()));
+    payload.resize(dataSize);
+
+    const std::vector<uint8_t> fileData =
+        SerializePipelineCache(m_PipelineCacheDevice, payload);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_PipelineCachePath.parent_path(),
+                                        error);
+
+    // Write next to the target and rename so a crash never leaves a
+    // half-written cache behind.
+    std::filesystem::path tempPath = m_PipelineCachePath;
+    tempPath += ".tmp";
     {
-        if (p->handle != VK_NULL_HANDLE)
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(fileData.data()),
+                   static_cast<std::streamsize>(fileData.size()));
+        if (!file.good())
         {
-            vkDestroyPipeline(device, p->handle, nullptr);
+            CH_CORE_WARN("PipelineManager: Failed to write pipeline cache {}",
+                         tempPath.string());
+            return;
         }
     }
-    m_ComputeCache.clear();
 
-    CH_CORE_INFO("PipelineManager: Pipeline Caches cleared.");
+    std::filesystem::rename(tempPath, m_PipelineCachePath, error);
+    if (error)
+    {
+        CH_CORE_WARN("PipelineManager: Failed to replace pipeline cache: {}",
+                     error.message());
+        return;
+    }
+
+    m_PipelineCacheDirty = false;
+    CH_CORE_INFO("PipelineManager: Saved pipeline cache ({} bytes) to {}",
+                 payload.size(), m_PipelineCachePath.string());
 }
 
 GraphicsPipeline& PipelineManager::GetGraphicsPipeline(
     const std::vector<VkFormat>& colorFormats, VkFormat depthFormat,
     const GraphicsPipelineDescription& desc)
 {
-    std::string cacheKey = desc.name;
-    for (uint32_t val : desc.specializationConstants)
+    const PipelineKey key =
+        MakeGraphicsPipelineKey(m_ShaderIDs, colorFormats, depthFormat, desc);
+
+    if (GraphicsPipeline* pipe =
+            CollectPipeline(m_GraphicsCache, m_StaleGraphics,
+                            m_PendingGraphics, m_FailedCompiles, key,
+                            true))
+    {
+        return *pipe;
+    }
+
+    GraphicsPipeline& pipe = m_GraphicsCache.Insert(
+        key, CreateGraphicsPipeline(colorFormats, depthFormat, desc));
+    RetirePipeline(m_StaleGraphics.Take(key));
+    return pipe;
+}
+
+GraphicsPipeline* PipelineManager::RequestGraphicsPipeline(
+    const std::vector<VkFormat>& colorFormats, VkFormat depthFormat,
+    const GraphicsPipelineDescription& desc)
+{
+    TaskSystem* taskSystem = GetCompileTaskSystem();
+    if (!taskSystem)
+    {
+        return &GetGraphicsPipeline(colorFormats, depthFormat, desc);
+    }
+
+    const PipelineKey key =
+        MakeGraphicsPipelineKey(m_ShaderIDs, colorFormats, depthFormat, desc);
+
+    if (GraphicsPipeline* pipe =
+            CollectPipeline(m_GraphicsCache, m_StaleGraphics,
+                            m_PendingGraphics, m_FailedCompiles, key,
+                            false))
     {
-        cacheKey += "_" + std::to_string(val);
+        return pipe;
     }
 
-    if (m_GraphicsCache.count(cacheKey))
+    if (!m_PendingGraphics.count(key) && !m_FailedCompiles.count(key))
     {
-        return *m_GraphicsCache[cacheKey];
+        m_PendingGraphics.emplace(
+            key, PendingPipelineCompile<GraphicsPipeline>{
+                     desc.name,
+                     taskSystem->Enqueue(
+                         [this, colorFormats, depthFormat, desc]()
+                         {
+                             return CreateGraphicsPipeline(colorFormats,
+                                                           depthFormat, desc);
+                         })});
     }
+    // Keep drawing with the pre-reload pipeline while its rebuild compiles.
+    return m_StaleGraphics.Find(key);
+}
 
+std::unique_ptr<GraphicsPipeline> PipelineManager::CreateGraphicsPipeline(
+    const std::vector<VkFormat>& colorFormats, VkFormat depthFormat,
+    const GraphicsPipelineDescription& desc)
+{
     auto p = std::make_unique<GraphicsPipeline>();
     auto vSh = ShaderManager::GetShader(desc.vertex_shader);
-    p->shaders.push_back(vSh.get());
+    AttachShader(*p, vSh);
 
     std::shared_ptr<Shader> fSh = nullptr;
     bool hasFragmentShader = !desc.fragment_shader.empty();
     if (hasFragmentShader)
     {
         fSh = ShaderManager::GetShader(desc.fragment_shader);
-        p->shaders.push_back(fSh.get());
+        AttachShader(*p, fSh);
     }
 
     p->layout = GetReflectionLayout(p->shaders);
@@ -161,11 +592,7 @@ GraphicsPipeline& PipelineManager::GetGraphicsPipeline(
         shaderStages.push_back(fStage);
     }
 
-    bool isFullscreen =
-        (desc.name == "Composition" || desc.name == "FinalBlit" ||
-         desc.name == "LinearizeDepth" ||
-         desc.vertex_shader.find("fullscreen") != std::string::npos ||
-         desc.vertex_shader.find("Fullscreen") != std::string::npos);
+    bool isFullscreen = IsFullscreenGraphicsPipeline(desc);
 
     auto bD = VertexInfo::getBindingDescription();
     auto aD = VertexInfo::getAttributeDescriptions();
@@ -260,46 +687,91 @@ GraphicsPipeline& PipelineManager::GetGraphicsPipeline(
         &dY,
         p->layout};
 
-    vkCreateGraphicsPipelines(VulkanContext::Get().GetDevice(), VK_NULL_HANDLE,
-                              1, &info, nullptr, &p->handle);
+    const auto createStart = std::chrono::high_resolution_clock::now();
+    vkCreateGraphicsPipelines(VulkanContext::Get().GetDevice(),
+                              GetThreadPipelineCache(), 1, &info, nullptr,
+                              &p->handle);
+    RecordPipelineCreation(std::chrono::duration<double, std::milli>(
+                               std::chrono::high_resolution_clock::now() -
+                               createStart)
+                               .count());
 
     vkDestroyShaderModule(VulkanContext::Get().GetDevice(), vMod, nullptr);
     if (fMod != VK_NULL_HANDLE)
         vkDestroyShaderModule(VulkanContext::Get().GetDevice(), fMod, nullptr);
 
-    m_GraphicsCache[cacheKey] = std::move(p);
-    return *m_GraphicsCache[cacheKey];
+    return p;
 }
 
 RaytracingPipeline& PipelineManager::GetRaytracingPipeline(
     const RaytracingPipelineDescription& desc)
 {
-    std::string cacheKey = desc.raygen_shader;
-    for (uint32_t val : desc.specializationConstants)
+    const PipelineKey key = MakeRaytracingPipelineKey(m_ShaderIDs, desc);
+
+    if (RaytracingPipeline* pipe =
+            CollectPipeline(m_RaytracingCache, m_StaleRaytracing,
+                            m_PendingRaytracing, m_FailedCompiles, key,
+                            true))
     {
-        cacheKey += "_" + std::to_string(val);
+        return *pipe;
     }
 
-    if (m_RaytracingCache.count(cacheKey))
+    RaytracingPipeline& pipe =
+        m_RaytracingCache.Insert(key, CreateRaytracingPipeline(desc));
+    RetirePipeline(m_StaleRaytracing.Take(key));
+    return pipe;
+}
+
+RaytracingPipeline* PipelineManager::RequestRaytracingPipeline(
+    const RaytracingPipelineDescription& desc)
+{
+    TaskSystem* taskSystem = GetCompileTaskSystem();
+    if (!taskSystem)
     {
-        return *m_RaytracingCache[cacheKey];
+        return &GetRaytracingPipeline(desc);
     }
 
+    const PipelineKey key = MakeRaytracingPipelineKey(m_ShaderIDs, desc);
+
+    if (RaytracingPipeline* pipe =
+            CollectPipeline(m_RaytracingCache, m_StaleRaytracing,
+                            m_PendingRaytracing, m_FailedCompiles, key,
+                            false))
+    {
+        return pipe;
+    }
+
+    if (!m_PendingRaytracing.count(key) && !m_FailedCompiles.count(key))
+    {
+        m_PendingRaytracing.emplace(
+            key, PendingPipelineCompile<RaytracingPipeline>{
+                     desc.raygen_shader,
+                     taskSystem->Enqueue(
+                         [this, desc]()
+                         { return CreateRaytracingPipeline(desc); })});
+    }
+    // Keep drawing with the pre-reload pipeline while its rebuild compiles.
+    return m_StaleRaytracing.Find(key);
+}
+
+std::unique_ptr<RaytracingPipeline> PipelineManager::CreateRaytracingPipeline(
+    const RaytracingPipelineDescription& desc)
+{
     auto p = std::make_unique<RaytracingPipeline>();
-    p->shaders.push_back(ShaderManager::GetShader(desc.raygen_shader).get());
+    AttachShader(*p, ShaderManager::GetShader(desc.raygen_shader));
     for (const auto& m : desc.miss_shaders)
     {
-        p->shaders.push_back(ShaderManager::GetShader(m).get());
+        AttachShader(*p, ShaderManager::GetShader(m));
     }
     for (const auto& h : desc.hit_shaders)
     {
         if (!h.closest_hit.empty())
         {
-            p->shaders.push_back(ShaderManager::GetShader(h.closest_hit).get());
+            AttachShader(*p, ShaderManager::GetShader(h.closest_hit));
         }
         if (!h.any_hit.empty())
         {
-            p->shaders.push_back(ShaderManager::GetShader(h.any_hit).get());
+            AttachShader(*p, ShaderManager::GetShader(h.any_hit));
         }
     }
 
@@ -402,9 +874,14 @@ RaytracingPipeline& PipelineManager::GetRaytracingPipeline(
     pipeInfo.maxPipelineRayRecursionDepth = 2;
     pipeInfo.layout = p->layout;
 
+    const auto createStart = std::chrono::high_resolution_clock::now();
     vkCreateRayTracingPipelinesKHR(VulkanContext::Get().GetDevice(),
-                                   VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &pipeInfo,
-                                   nullptr, &p->handle);
+                                   VK_NULL_HANDLE, GetThreadPipelineCache(), 1,
+                                   &pipeInfo, nullptr, &p->handle);
+    RecordPipelineCreation(std::chrono::duration<double, std::milli>(
+                               std::chrono::high_resolution_clock::now() -
+                               createStart)
+                               .count());
 
     p->sbt_buffer =
         VulkanUtils::CreateSBT(p->handle, 1, (uint32_t)desc.miss_shaders.size(),
@@ -417,27 +894,66 @@ RaytracingPipeline& PipelineManager::GetRaytracingPipeline(
                               nullptr);
     }
 
-    m_RaytracingCache[cacheKey] = std::move(p);
-    return *m_RaytracingCache[cacheKey];
+    return p;
 }
 
 ComputePipeline& PipelineManager::GetComputePipeline(
     const ComputePipelineDescription::Kernel& kernel)
 {
-    std::string cacheKey = kernel.shader;
-    for (uint32_t val : kernel.specializationConstants)
+    const PipelineKey key = MakeComputePipelineKey(m_ShaderIDs, kernel);
+
+    if (ComputePipeline* pipe =
+            CollectPipeline(m_ComputeCache, m_StaleCompute,
+                            m_PendingCompute, m_FailedCompiles, key,
+                            true))
+    {
+        return *pipe;
+    }
+
+    ComputePipeline& pipe =
+        m_ComputeCache.Insert(key, CreateComputePipeline(kernel));
+    RetirePipeline(m_StaleCompute.Take(key));
+    return pipe;
+}
+
+ComputePipeline* PipelineManager::RequestComputePipeline(
+    const ComputePipelineDescription::Kernel& kernel)
+{
+    TaskSystem* taskSystem = GetCompileTaskSystem();
+    if (!taskSystem)
+    {
+        return &GetComputePipeline(kernel);
+    }
+
+    const PipelineKey key = MakeComputePipelineKey(m_ShaderIDs, kernel);
+
+    if (ComputePipeline* pipe =
+            CollectPipeline(m_ComputeCache, m_StaleCompute,
+                            m_PendingCompute, m_FailedCompiles, key,
+                            false))
     {
-        cacheKey += "_" + std::to_string(val);
+        return pipe;
     }
 
-    if (m_ComputeCache.count(cacheKey))
+    if (!m_PendingCompute.count(key) && !m_FailedCompiles.count(key))
     {
-        return *m_ComputeCache[cacheKey];
+        m_PendingCompute.emplace(
+            key, PendingPipelineCompile<ComputePipeline>{
+                     kernel.shader,
+                     taskSystem->Enqueue(
+                         [this, kernel]()
+                         { return CreateComputePipeline(kernel); })});
     }
+    // Keep drawing with the pre-reload pipeline while its rebuild compiles.
+    return m_StaleCompute.Find(key);
+}
 
+std::unique_ptr<ComputePipeline> PipelineManager::CreateComputePipeline(
+    const ComputePipelineDescription::Kernel& kernel)
+{
     auto p = std::make_unique<ComputePipeline>();
     auto sh = ShaderManager::GetShader(kernel.shader);
-    p->shaders = {sh.get()};
+    AttachShader(*p, sh);
     p->layout = GetReflectionLayout(p->shaders);
 
     VkShaderModule mod =
@@ -475,24 +991,38 @@ ComputePipeline& PipelineManager::GetComputePipeline(
     }
     info.layout = p->layout;
 
-    vkCreateComputePipelines(VulkanContext::Get().GetDevice(), VK_NULL_HANDLE,
-                             1, &info, nullptr, &p->handle);
+    const auto createStart = std::chrono::high_resolution_clock::now();
+    vkCreateComputePipelines(VulkanContext::Get().GetDevice(),
+                             GetThreadPipelineCache(), 1, &info, nullptr,
+                             &p->handle);
+    RecordPipelineCreation(std::chrono::duration<double, std::milli>(
+                               std::chrono::high_resolution_clock::now() -
+                               createStart)
+                               .count());
     vkDestroyShaderModule(VulkanContext::Get().GetDevice(), mod, nullptr);
 
-    m_ComputeCache[cacheKey] = std::move(p);
-    return *m_ComputeCache[cacheKey];
+    return p;
 }
 
 VkPipelineLayout PipelineManager::GetReflectionLayout(
     const std::vector<const Shader*>& shaders)
 {
-    size_t hash = 0;
+    std::scoped_lock lock(m_LayoutMutex);
+
+    // Set 2 and push constants are part of the hash, so a hot-reloaded
+    // shader whose interface changed gets a new layout.
+    VkDescriptorSetLayout set2 = GetSet2Layout(shaders);
+    size_t hash = std::hash<uint64_t>{}((uint64_t)set2);
     for (const auto* sh : shaders)
     {
         if (sh)
         {
+            const auto& pc = sh->GetPushConstantInfo();
             hash ^= std::hash<std::string>{}(sh->GetPath()) + 0x9e3779b9 +
                     (hash << 6) + (hash >> 2);
+            hash ^= std::hash<uint64_t>{}(((uint64_t)pc.offset << 32) |
+                                          pc.size) +
+                    0x9e3779b9 + (hash << 6) + (hash >> 2);
         }
     }
 
@@ -505,7 +1035,6 @@ VkPipelineLayout PipelineManager::GetReflectionLayout(
     layouts.push_back(Application::Get().GetRenderState()->GetLayout());
     layouts.push_back(ResourceManager::Get().GetSceneDescriptorSetLayout());
 
-    VkDescriptorSetLayout set2 = GetSet2Layout(shaders);
     if (set2 != VK_NULL_HANDLE)
     {
         layouts.push_back(set2);
@@ -595,6 +1124,8 @@ VkPipelineLayout PipelineManager::GetReflectionLayout(
 VkDescriptorSetLayout PipelineManager::GetSet2Layout(
     const std::vector<const Shader*>& shaders)
 {
+    std::scoped_lock lock(m_LayoutMutex);
+
     std::map<uint32_t, ShaderResource> uniqueBindings;
     for (const auto* sh : shaders)
     {
@@ -650,7 +1181,7 @@ VkDescriptorSetLayout PipelineManager::GetSet2Layout(
 }
 
 VkShaderModule PipelineManager::CreateShaderModule(
-    VkDevice device, const std::vector<uint32_t>& code)
+    VkDevice device, std::span<const uint32_t> code)
 {
     VkShaderModuleCreateInfo info{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
     info.codeSize = code.size() * sizeof(uint32_t);
@@ -1,20 +1,31 @@
 #pragma once
 
 #include "Renderer/Graph/RenderGraphCommon.h"
+#include "PipelineCacheFile.h"
+#include "PipelineKey.h"
 #include "Shader.h"
+#include <filesystem>
+#include <future>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
 #include <vector>
 
 namespace Chimera
 {
+class TaskSystem;
+
 struct GraphicsPipeline
 {
     VkPipeline handle = VK_NULL_HANDLE;
     VkPipelineLayout layout = VK_NULL_HANDLE;
     GraphicsPipelineDescription description;
     std::vector<const Shader*> shaders;
+    std::vector<std::shared_ptr<Shader>> shaderRefs; // Outlive hot reloads
 };
 
 struct RaytracingPipeline
@@ -23,6 +34,7 @@ struct RaytracingPipeline
     VkPipelineLayout layout = VK_NULL_HANDLE;
     RaytracingPipelineDescription description;
     std::vector<const Shader*> shaders;
+    std::vector<std::shared_ptr<Shader>> shaderRefs; // Outlive hot reloads
 
     struct SBT
     {
@@ -36,6 +48,20 @@ struct ComputePipeline
     VkPipeline handle = VK_NULL_HANDLE;
     VkPipelineLayout layout = VK_NULL_HANDLE;
     std::vector<const Shader*> shaders;
+    std::vector<std::shared_ptr<Shader>> shaderRefs; // Outlive hot reloads
+};
+
+template <typename T>
+struct PendingPipelineCompile
+{
+    std::string name; // For logging only
+    std::future<std::unique_ptr<T>> future;
+};
+
+struct PipelineCreationStats
+{
+    uint32_t pipelineCount = 0;
+    double totalMS = 0.0;
 };
 
 class PipelineManager
@@ -44,8 +70,25 @@ public:
     PipelineManager();
     ~PipelineManager();
 
+        // Destroys pipelines only. The VkPipelineCache lives for the whole
+        // process, so rebuilt pipelines are served from the driver cache.
     void ClearCache();
 
+        // Merges per-thread caches into the process cache and writes it to
+        // disk. Called on shutdown and after graph rebuilds that created new
+        // pipelines.
+    void SavePipelineCache();
+
+    PipelineCacheLoadStatus GetPipelineCacheLoadStatus() const
+    {
+        return m_PipelineCacheLoadStatus;
+    }
+
+    PipelineCreationStats GetCreationStats();
+    void ResetCreationStats();
+
+        // Blocking lookups: compile on the calling thread (or wait for an
+        // in-flight background compile) when the pipeline is not cached yet.
     GraphicsPipeline& GetGraphicsPipeline(
         const std::vector<VkFormat>& colorFormats, VkFormat depthFormat,
         const GraphicsPipelineDescription& desc);
@@ -54,6 +97,48 @@ public:
     ComputePipeline& GetComputePipeline(
         const ComputePipelineDescription::Kernel& kernel);
 
+        // Non-blocking lookups: return nullptr and queue a compile on the
+        // TaskSystem if the pipeline is not ready. Must be called from the
+        // render thread. Falls back to the blocking path when async
+        // compilation is disabled or no TaskSystem exists yet.
+    GraphicsPipeline* RequestGraphicsPipeline(
+        const std::vector<VkFormat>& colorFormats, VkFormat depthFormat,
+        const GraphicsPipelineDescription& desc);
+    RaytracingPipeline* RequestRaytracingPipeline(
+        const RaytracingPipelineDescription& desc);
+    ComputePipeline* RequestComputePipeline(
+        const ComputePipelineDescription::Kernel& kernel);
+
+    void SetAsyncCompilation(bool enabled)
+    {
+        m_AsyncCompilation = enabled;
+    }
+    bool IsAsyncCompilationEnabled() const
+    {
+        return m_AsyncCompilation;
+    }
+    uint32_t GetPendingCompileCount() const
+    {
+        return (uint32_t)(m_PendingGraphics.size() +
+                          m_PendingRaytracing.size() +
+                          m_PendingCompute.size());
+    }
+
+        // Blocks until every queued background compile has finished and its
+        // pipeline is in the cache.
+    void WaitForPendingCompiles();
+        // Moves every finished background compile into the cache without
+        // blocking, whether or not a pass has requested it again. Called
+        // once per frame so prewarmed pipelines nobody binds still land.
+    void CollectFinishedCompiles();
+
+        // Called after a shader hot reload swapped these shader names. Every
+        // pipeline built from them is rebuilt on its next request; until the
+        // rebuild is ready Request*Pipeline keeps returning the old one, and
+        // the old one is destroyed through the frame deletion queue instead
+        // of waiting for the device to idle.
+    void InvalidateShaders(const std::unordered_set<std::string>& shaderNames);
+
     VkPipelineLayout GetReflectionLayout(
         const std::vector<const Shader*>& shaders);
     VkDescriptorSetLayout GetSet2Layout(
@@ -65,20 +150,64 @@ public:
     }
 
 private:
+    void CreatePipelineCache();
+    VkPipelineCache GetThreadPipelineCache();
+    void RecordPipelineCreation(double durationMS);
+
+    std::unique_ptr<GraphicsPipeline> CreateGraphicsPipeline(
+        const std::vector<VkFormat>& colorFormats, VkFormat depthFormat,
+        const GraphicsPipelineDescription& desc);
+    std::unique_ptr<RaytracingPipeline> CreateRaytracingPipeline(
+        const RaytracingPipelineDescription& desc);
+    std::unique_ptr<ComputePipeline> CreateComputePipeline(
+        const ComputePipelineDescription::Kernel& kernel);
+    TaskSystem* GetCompileTaskSystem() const;
+
     size_t CalculateShaderHash(const std::vector<const Shader*>& shaders);
     static VkShaderModule CreateShaderModule(VkDevice device,
-                                             const std::vector<uint32_t>& code);
+                                             std::span<const uint32_t> code);
 
 private:
     static PipelineManager* s_Instance;
-    std::unordered_map<std::string, std::unique_ptr<GraphicsPipeline>>
-        m_GraphicsCache;
-    std::unordered_map<std::string, std::unique_ptr<RaytracingPipeline>>
-        m_RaytracingCache;
-    std::unordered_map<std::string, std::unique_ptr<ComputePipeline>>
-        m_ComputeCache;
+    // Looked up by every pass every frame, so keys are POD and the tables
+    // never allocate on a hit.
+    ShaderIDTable m_ShaderIDs;
+    PipelineKeyTable<GraphicsPipeline> m_GraphicsCache;
+    PipelineKeyTable<RaytracingPipeline> m_RaytracingCache;
+    PipelineKeyTable<ComputePipeline> m_ComputeCache;
+    // Pipelines invalidated by a shader reload, served until replaced.
+    PipelineKeyTable<GraphicsPipeline> m_StaleGraphics;
+    PipelineKeyTable<RaytracingPipeline> m_StaleRaytracing;
+    PipelineKeyTable<ComputePipeline> m_StaleCompute;
+
+    // In-flight background compiles, keyed like the caches above. Only the
+    // render thread touches these maps; workers just run Create*Pipeline.
+    std::unordered_map<PipelineKey, PendingPipelineCompile<GraphicsPipeline>,
+                       PipelineKeyHasher>
+        m_PendingGraphics;
+    std::unordered_map<PipelineKey, PendingPipelineCompile<RaytracingPipeline>,
+                       PipelineKeyHasher>
+        m_PendingRaytracing;
+    std::unordered_map<PipelineKey, PendingPipelineCompile<ComputePipeline>,
+                       PipelineKeyHasher>
+        m_PendingCompute;
+    std::unordered_set<PipelineKey, PipelineKeyHasher> m_FailedCompiles;
+    bool m_AsyncCompilation = true;
 
+    std::recursive_mutex m_LayoutMutex;
     std::unordered_map<size_t, VkPipelineLayout> m_LayoutCache;
     std::unordered_map<size_t, VkDescriptorSetLayout> m_Set2LayoutCache;
+
+    VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+    std::filesystem::path m_PipelineCachePath;
+    PipelineCacheDeviceInfo m_PipelineCacheDevice;
+    PipelineCacheLoadStatus m_PipelineCacheLoadStatus =
+        PipelineCacheLoadStatus::Missing;
+    std::thread::id m_OwnerThread;
+
+    std::mutex m_PipelineCacheMutex;
+    std::unordered_map<std::thread::id, VkPipelineCache> m_ThreadPipelineCaches;
+    bool m_PipelineCacheDirty = false;
+    PipelineCreationStats m_CreationStats;
 };
 } // namespace Chimera
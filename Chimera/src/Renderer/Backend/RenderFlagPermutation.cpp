@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "RenderFlagPermutation.h"
+
+#include <bit>
+#include <stdexcept>
+
+namespace Chimera
+{
+RenderFlagPermutation::RenderFlagPermutation(uint32_t staticFlags,
+                                             uint32_t firstConstantID)
+    : m_StaticFlags(staticFlags), m_FirstConstantID(firstConstantID),
+      m_FlagCount((uint32_t)std::popcount(staticFlags))
+{
+    if (m_FlagCount > MaxStaticFlags)
+    {
+        throw std::invalid_argument(
+            "RenderFlagPermutation: " + std::to_string(m_FlagCount) +
+            " static flags exceed the limit of " +
+            std::to_string(MaxStaticFlags));
+    }
+}
+
+uint32_t RenderFlagPermutation::GetVariantIndex(uint32_t renderFlags) const
+{
+        // Gathers the masked bits into the low bits, lowest flag first.
+    uint32_t index = 0;
+    uint32_t slot = 0;
+    for (uint32_t mask = m_StaticFlags; mask != 0; mask &= mask - 1, ++slot)
+    {
+        const uint32_t bit = mask & (~mask + 1);
+        if (renderFlags & bit) index |= 1u << slot;
+    }
+    return index;
+}
+
+uint32_t RenderFlagPermutation::GetVariantFlags(uint32_t variantIndex) const
+{
+    uint32_t flags = 0;
+    uint32_t slot = 0;
+    for (uint32_t mask = m_StaticFlags; mask != 0; mask &= mask - 1, ++slot)
+    {
+        const uint32_t bit = mask & (~mask + 1);
+        if (variantIndex & (1u << slot)) flags |= bit;
+    }
+    return flags;
+}
+
+void RenderFlagPermutation::Apply(uint32_t renderFlags,
+                                  std::vector<uint32_t>& constants) const
+{
+    if (constants.size() < m_FirstConstantID + ConstantCount)
+    {
+        constants.resize(m_FirstConstantID + ConstantCount, 0);
+    }
+    constants[m_FirstConstantID] = m_StaticFlags;
+    constants[m_FirstConstantID + 1] = renderFlags & m_StaticFlags;
+}
+
+void RenderFlagPermutation::ApplyDynamic(std::vector<uint32_t>& constants) const
+{
+    if (constants.size() < m_FirstConstantID + ConstantCount)
+    {
+        constants.resize(m_FirstConstantID + ConstantCount, 0);
+    }
+    constants[m_FirstConstantID] = 0;
+    constants[m_FirstConstantID + 1] = 0;
+}
+} // namespace Chimera
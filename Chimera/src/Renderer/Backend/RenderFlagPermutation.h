@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // Bakes a declared subset of RenderFlags into specialization constants
+    // so a pipeline variant has those branches resolved at creation time.
+    // Shaders opt in through shaders/common/render_flags.glsl, which reads
+    // two constants: the mask of baked flags and their values. Flags outside
+    // the mask still come from frameData.w at runtime.
+    //
+    // A permutation may bake at most MaxStaticFlags flags, which bounds a
+    // pipeline to 2^MaxStaticFlags variants plus the dynamic one.
+class RenderFlagPermutation
+{
+public:
+    static constexpr uint32_t MaxStaticFlags = 4;
+    static constexpr uint32_t ConstantCount = 2; // Mask, value
+
+        // Throws std::invalid_argument if staticFlags has more than
+        // MaxStaticFlags bits set.
+    explicit RenderFlagPermutation(uint32_t staticFlags,
+                                   uint32_t firstConstantID = 0);
+
+    uint32_t GetStaticFlags() const
+    {
+        return m_StaticFlags;
+    }
+    uint32_t GetFirstConstantID() const
+    {
+        return m_FirstConstantID;
+    }
+    uint32_t GetVariantCount() const
+    {
+        return 1u << m_FlagCount;
+    }
+
+        // Dense index of the variant renderFlags selects, in
+        // [0, GetVariantCount()). Flags outside the mask are ignored.
+    uint32_t GetVariantIndex(uint32_t renderFlags) const;
+        // Inverse of GetVariantIndex: the baked flag values of a variant.
+    uint32_t GetVariantFlags(uint32_t variantIndex) const;
+
+        // Writes the mask and baked values at firstConstantID, growing the
+        // constant list with zeros as needed. Other constants are untouched.
+    void Apply(uint32_t renderFlags, std::vector<uint32_t>& constants) const;
+        // Writes a zero mask, which keeps every flag dynamic. This variant
+        // serves any flag combination, so it is the one to fall back to
+        // while a specialized variant is still compiling.
+    void ApplyDynamic(std::vector<uint32_t>& constants) const;
+
+        // Copies a pipeline description (graphics, ray tracing or compute
+        // kernel) with the constants for renderFlags applied.
+    template <typename Description>
+    Description Select(Description desc, uint32_t renderFlags) const
+    {
+        Apply(renderFlags, desc.specializationConstants);
+        return desc;
+    }
+    template <typename Description>
+    Description SelectDynamic(Description desc) const
+    {
+        ApplyDynamic(desc.specializationConstants);
+        return desc;
+    }
+
+private:
+    uint32_t m_StaticFlags = 0;
+    uint32_t m_FirstConstantID = 0;
+    uint32_t m_FlagCount = 0;
+};
+} // namespace Chimera
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Shader.h"
-#include <spirv_reflect.h>
+#include "ShaderArchive.h"
+#include "ShaderReflection.h"
 #include <fstream>
 #include <stdexcept>
 #include <filesystem>
@@ -30,104 +31,103 @@ Shader::Shader(const std::filesystem::path& path)
         throw std::runtime_error("Empty or invalid shader file: " + m_Path);
     }
 
-    m_Bytecode.resize(fileSize / 4);
+    m_OwnedBytecode.resize(fileSize / 4);
     file.seekg(0);
-    file.read((char*)m_Bytecode.data(), fileSize);
+    file.read((char*)m_OwnedBytecode.data(), fileSize);
     file.close();
+    m_Bytecode = m_OwnedBytecode;
 
-    Reflect();
+    std::vector<uint8_t> sidecar;
+    std::filesystem::path sidecarPath = path;
+    sidecarPath += ".refl";
+    std::ifstream sidecarFile(sidecarPath, std::ios::ate | std::ios::binary);
+    if (sidecarFile.is_open())
+    {
+        sidecar.resize((size_t)sidecarFile.tellg());
+        sidecarFile.seekg(0);
+        sidecarFile.read((char*)sidecar.data(), sidecar.size());
+    }
+    LoadReflection(sidecar);
 }
 
-Shader::~Shader() {}
-
-void Shader::Reflect()
+Shader::Shader(const std::string& name, std::span<const uint32_t> bytecode,
+               std::span<const uint8_t> reflection,
+               std::shared_ptr<const ShaderArchive> archive)
+    : m_Bytecode(bytecode), m_Archive(std::move(archive))
 {
+    m_Path = name;
+    m_Name = std::filesystem::path(name).stem().string();
+
     if (m_Bytecode.empty())
     {
-        return;
+        throw std::runtime_error("Empty shader in archive: " + name);
     }
 
-    SpvReflectShaderModule module;
-    SpvReflectResult result = spvReflectCreateShaderModule(
-        m_Bytecode.size() * 4, m_Bytecode.data(), &module);
+    LoadReflection(reflection);
+}
+
+Shader::~Shader() {}
 
-    if (result != SPV_REFLECT_RESULT_SUCCESS)
+void Shader::LoadReflection(std::span<const uint8_t> sidecar)
+{
+    ShaderReflectionData reflection;
+    const auto status =
+        DeserializeShaderReflection(sidecar, m_Bytecode, reflection);
+    if (status == ShaderReflectionLoadStatus::Loaded)
     {
-        CH_CORE_ERROR("Shader: SPIR-V Reflection FAILED for {0}", m_Name);
+        ApplyReflection(reflection);
         return;
     }
 
-    uint32_t count = 0;
-    spvReflectEnumerateDescriptorBindings(&module, &count, nullptr);
-    std::vector<SpvReflectDescriptorBinding*> bindings(count);
-    spvReflectEnumerateDescriptorBindings(&module, &count, bindings.data());
-
-    for (auto* b : bindings)
+        // Hot-reloaded or hand-compiled shaders have no (or an outdated)
+        // sidecar; reflect them at runtime instead.
+    if (status == ShaderReflectionLoadStatus::Missing)
     {
-        ShaderResource res;
-        std::string rawName = b->name;
-
-        res.name = rawName;
-        res.set = b->set;
-        res.binding = b->binding;
-        res.type = (VkDescriptorType)b->descriptor_type;
-        res.count = b->count;
-        m_ReflectionData[res.name] = res;
+        CH_CORE_TRACE("Shader: No reflection sidecar for '{0}', reflecting "
+                      "at runtime",
+                      m_Name);
     }
-
-    uint32_t pushConstantCount = 0;
-    result = spvReflectEnumeratePushConstantBlocks(&module, &pushConstantCount,
-                                                   nullptr);
-
-    if (result != SPV_REFLECT_RESULT_SUCCESS)
+    else
     {
-        spvReflectDestroyShaderModule(&module);
-        throw std::runtime_error(
-            "Failed to enumerate push constant blocks for shader: " + m_Path);
+        CH_CORE_WARN("Shader: Reflection sidecar for '{0}' is {1}, "
+                     "reflecting at runtime",
+                     m_Name, ShaderReflectionLoadStatusToString(status));
     }
+    Reflect();
+}
 
-    std::vector<SpvReflectBlockVariable*> pushConstantBlocks(pushConstantCount);
-
-    result = spvReflectEnumeratePushConstantBlocks(&module, &pushConstantCount,
-                                                   pushConstantBlocks.data());
-
-    if (result != SPV_REFLECT_RESULT_SUCCESS)
+void Shader::Reflect()
+{
+    try
     {
-        spvReflectDestroyShaderModule(&module);
-        throw std::runtime_error(
-            "Failed to enumerate push constant blocks for shader: " + m_Path);
+        ApplyReflection(ReflectSpirv(m_Bytecode));
     }
-
-    // Process the push constant blocks
-    for (auto* block : pushConstantBlocks)
+    catch (const std::exception& e)
     {
-        if (!block) 
-            continue;
-
-        if (!m_PushConstantInfo.IsValid())
-        {
-            m_PushConstantInfo.offset = block->offset;
-            m_PushConstantInfo.size = block->size;
-        }
-        else
-        {
-            const uint32_t currentEnd =
-                m_PushConstantInfo.offset + m_PushConstantInfo.size;
-            const uint32_t blockEnd = block->offset + block->size;
-            const uint32_t mergedStart =
-                std::min(m_PushConstantInfo.offset, block->offset);
-            const uint32_t mergedEnd = std::max(currentEnd, blockEnd);
-
-            m_PushConstantInfo.offset = mergedStart;
-            m_PushConstantInfo.size = mergedEnd - mergedStart;
-        }
-
-        m_PushConstantInfo.stages |=
-            static_cast<VkShaderStageFlags>(module.shader_stage);
-
+        CH_CORE_ERROR("Shader: SPIR-V Reflection FAILED for {0}: {1}", m_Name,
+                      e.what());
+    }
+}
 
+void Shader::ApplyReflection(const ShaderReflectionData& reflection)
+{
+    m_ReflectionData.clear();
+    for (const auto& b : reflection.bindings)
+    {
+        ShaderResource res;
+        res.name = b.name;
+        res.set = b.set;
+        res.binding = b.binding;
+        res.type = (VkDescriptorType)b.descriptorType;
+        res.count = b.count;
+        m_ReflectionData[res.name] = res;
     }
 
+    m_PushConstantInfo.offset = reflection.pushConstantOffset;
+    m_PushConstantInfo.size = reflection.pushConstantSize;
+    m_PushConstantInfo.stages =
+        static_cast<VkShaderStageFlags>(reflection.pushConstantStages);
+
     if (m_PushConstantInfo.IsValid())
     {
         CH_CORE_INFO(
@@ -135,8 +135,6 @@ void Shader::Reflect()
             m_Name, m_PushConstantInfo.offset, m_PushConstantInfo.size,
             m_PushConstantInfo.stages);
     }
-
-    spvReflectDestroyShaderModule(&module);
 }
 
 std::vector<ShaderResource> Shader::GetSetBindings(uint32_t setIndex) const
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "pch.h"
+#include <span>
 #include <string>
 #include <vector>
 #include <unordered_map>
 
 namespace Chimera
 {
+struct ShaderReflectionData;
+class ShaderArchive;
+
 struct ShaderResource
 {
     std::string name;
@@ -32,8 +36,16 @@ class Shader
 {
 public:
     Shader(const std::filesystem::path& path);
+        // Bytecode and reflection point into the archive's mapping, which
+        // the shader keeps alive.
+    Shader(const std::string& name, std::span<const uint32_t> bytecode,
+           std::span<const uint8_t> reflection,
+           std::shared_ptr<const ShaderArchive> archive);
     ~Shader();
 
+    Shader(const Shader&) = delete;
+    Shader& operator=(const Shader&) = delete;
+
     const std::string& GetPath() const
     {
         return m_Path;
@@ -42,7 +54,7 @@ public:
     {
         return m_Name;
     }
-    const std::vector<uint32_t>& GetBytecode() const
+    std::span<const uint32_t> GetBytecode() const
     {
         return m_Bytecode;
     }
@@ -61,12 +73,18 @@ public:
     std::vector<ShaderResource> GetSetBindings(uint32_t setIndex) const;
 
 private:
+        // Uses the build-time reflection sidecar when it matches the
+        // bytecode, otherwise falls back to Reflect().
+    void LoadReflection(std::span<const uint8_t> sidecar);
     void Reflect();
+    void ApplyReflection(const ShaderReflectionData& reflection);
 
 private:
     std::string m_Path;
     std::string m_Name;
-    std::vector<uint32_t> m_Bytecode;
+    std::span<const uint32_t> m_Bytecode;
+    std::vector<uint32_t> m_OwnedBytecode; // Loose .spv files only
+    std::shared_ptr<const ShaderArchive> m_Archive;
     std::unordered_map<std::string, ShaderResource> m_ReflectionData;
     ShaderPushConstantInfo m_PushConstantInfo;
 };
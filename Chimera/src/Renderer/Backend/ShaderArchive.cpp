@@ -0,0 +1,200 @@
+#include "pch.h"
+#include "ShaderArchive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace Chimera
+{
+namespace
+{
+constexpr uint32_t ShaderArchiveMagic = 0x41534843; // "CHSA"
+constexpr uint32_t ShaderArchiveFormatVersion = 1;
+
+struct ShaderArchiveHeader
+{
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint32_t entryCount;
+    uint32_t fileSize;
+};
+static_assert(sizeof(ShaderArchiveHeader) == 16,
+              "archive header must not contain implicit padding");
+
+    // Offsets are from the start of the file; sizes are in bytes.
+struct ShaderArchiveIndexEntry
+{
+    uint32_t nameOffset;
+    uint32_t nameSize;
+    uint32_t spirvOffset;
+    uint32_t spirvSize;
+    uint32_t reflectionOffset;
+    uint32_t reflectionSize;
+};
+static_assert(sizeof(ShaderArchiveIndexEntry) == 24,
+              "archive index entry must not contain implicit padding");
+
+size_t AlignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint32_t Append(std::vector<uint8_t>& out, const void* data, size_t size,
+                size_t alignment)
+{
+    out.resize(AlignUp(out.size(), alignment));
+    const size_t offset = out.size();
+    if (offset + size > UINT32_MAX)
+    {
+        throw std::runtime_error("shader archive exceeds 4 GiB");
+    }
+    out.resize(offset + size);
+    if (size > 0) std::memcpy(out.data() + offset, data, size);
+    return (uint32_t)offset;
+}
+
+bool InBounds(std::span<const uint8_t> data, uint32_t offset, uint32_t size)
+{
+    return offset <= data.size() && size <= data.size() - offset;
+}
+} // namespace
+
+std::vector<uint8_t> BuildShaderArchive(std::vector<ShaderArchiveInput> inputs)
+{
+    std::sort(inputs.begin(), inputs.end(),
+              [](const auto& a, const auto& b) { return a.name < b.name; });
+    for (size_t i = 1; i < inputs.size(); ++i)
+    {
+        if (inputs[i].name == inputs[i - 1].name)
+        {
+            throw std::runtime_error("duplicate shader in archive: " +
+                                     inputs[i].name);
+        }
+    }
+
+    ShaderArchiveHeader header{};
+    header.magic = ShaderArchiveMagic;
+    header.formatVersion = ShaderArchiveFormatVersion;
+    header.entryCount = (uint32_t)inputs.size();
+
+    std::vector<ShaderArchiveIndexEntry> index(inputs.size());
+    std::vector<uint8_t> out(sizeof(header) +
+                             index.size() * sizeof(ShaderArchiveIndexEntry));
+
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        index[i].nameOffset =
+            Append(out, inputs[i].name.data(), inputs[i].name.size(), 1);
+        index[i].nameSize = (uint32_t)inputs[i].name.size();
+    }
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        const auto& spirv = inputs[i].spirv;
+        const auto& reflection = inputs[i].reflection;
+        index[i].spirvOffset = Append(out, spirv.data(),
+                                      spirv.size() * sizeof(uint32_t), 4);
+        index[i].spirvSize = (uint32_t)(spirv.size() * sizeof(uint32_t));
+        index[i].reflectionOffset =
+            Append(out, reflection.data(), reflection.size(), 4);
+        index[i].reflectionSize = (uint32_t)reflection.size();
+    }
+
+    header.fileSize = (uint32_t)out.size();
+    std::memcpy(out.data(), &header, sizeof(header));
+    if (!index.empty())
+    {
+        std::memcpy(out.data() + sizeof(header), index.data(),
+                    index.size() * sizeof(ShaderArchiveIndexEntry));
+    }
+    return out;
+}
+
+std::shared_ptr<ShaderArchive> ShaderArchive::Open(
+    const std::filesystem::path& path)
+{
+    std::shared_ptr<ShaderArchive> archive(new ShaderArchive());
+    archive->m_Path = path.string();
+    archive->m_File = MappedFile(path);
+    archive->Parse(archive->m_File.GetData());
+    return archive;
+}
+
+std::shared_ptr<ShaderArchive> ShaderArchive::FromMemory(
+    std::vector<uint8_t> data)
+{
+    std::shared_ptr<ShaderArchive> archive(new ShaderArchive());
+    archive->m_Memory = std::move(data);
+    archive->Parse(archive->m_Memory);
+    return archive;
+}
+
+void ShaderArchive::Parse(std::span<const uint8_t> data)
+{
+    const std::string label = m_Path.empty() ? "shader archive" : m_Path;
+
+    ShaderArchiveHeader header{};
+    if (data.size() < sizeof(header))
+    {
+        throw std::runtime_error(label + ": truncated header");
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != ShaderArchiveMagic ||
+        header.formatVersion != ShaderArchiveFormatVersion)
+    {
+        throw std::runtime_error(label + ": not a shader archive or wrong "
+                                         "format version");
+    }
+    if (header.fileSize != data.size())
+    {
+        throw std::runtime_error(label + ": size does not match header");
+    }
+    if (header.entryCount > (data.size() - sizeof(header)) /
+                                sizeof(ShaderArchiveIndexEntry))
+    {
+        throw std::runtime_error(label + ": index exceeds file");
+    }
+
+        // The mapping is page aligned, so 4-byte aligned offsets give
+        // properly aligned uint32_t views.
+    m_Entries.resize(header.entryCount);
+    for (uint32_t i = 0; i < header.entryCount; ++i)
+    {
+        ShaderArchiveIndexEntry record{};
+        std::memcpy(&record,
+                    data.data() + sizeof(header) +
+                        i * sizeof(ShaderArchiveIndexEntry),
+                    sizeof(record));
+
+        if (!InBounds(data, record.nameOffset, record.nameSize) ||
+            !InBounds(data, record.spirvOffset, record.spirvSize) ||
+            !InBounds(data, record.reflectionOffset, record.reflectionSize) ||
+            record.spirvOffset % 4 != 0 || record.spirvSize % 4 != 0)
+        {
+            throw std::runtime_error(label + ": corrupt index entry");
+        }
+
+        Entry& entry = m_Entries[i];
+        entry.name = {(const char*)data.data() + record.nameOffset,
+                      record.nameSize};
+        entry.spirv = {(const uint32_t*)(data.data() + record.spirvOffset),
+                       record.spirvSize / sizeof(uint32_t)};
+        entry.reflection = data.subspan(record.reflectionOffset,
+                                        record.reflectionSize);
+
+        if (i > 0 && !(m_Entries[i - 1].name < entry.name))
+        {
+            throw std::runtime_error(label + ": index is not sorted");
+        }
+    }
+}
+
+const ShaderArchive::Entry* ShaderArchive::Find(std::string_view name) const
+{
+    auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), name,
+                               [](const Entry& entry, std::string_view value)
+                               { return entry.name < value; });
+    if (it == m_Entries.end() || it->name != name) return nullptr;
+    return &*it;
+}
+} // namespace Chimera
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Core/MappedFile.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Chimera
+{
+    // Written next to the loose SPIR-V in the compiled shader directory.
+inline constexpr const char* ShaderArchiveFileName = "shaders.pak";
+
+    // One shader as packed by the build. The name is the shader path
+    // relative to the shader directory without ".spv", e.g.
+    // "postprocess/taa.comp", which is what ShaderManager looks up.
+struct ShaderArchiveInput
+{
+    std::string name;
+    std::vector<uint32_t> spirv;
+    std::vector<uint8_t> reflection; // ShaderReflection sidecar, may be empty
+};
+
+    // Packs shaders into one file: a header, an index sorted by name, the
+    // names, then 4-byte aligned SPIR-V and reflection blobs. Throws
+    // std::runtime_error on duplicate names.
+std::vector<uint8_t> BuildShaderArchive(std::vector<ShaderArchiveInput> inputs);
+
+    // Read-only view of a shader archive. Opened from disk the file is
+    // memory-mapped and entries point straight into the mapping, so shader
+    // bytecode reaches vkCreateShaderModule without a copy. Keep the archive
+    // alive (it is shared with every Shader created from it) while entries
+    // are in use.
+class ShaderArchive
+{
+public:
+    struct Entry
+    {
+        std::string_view name;
+        std::span<const uint32_t> spirv;
+        std::span<const uint8_t> reflection;
+    };
+
+        // Both throw std::runtime_error if the data is not a valid archive.
+    static std::shared_ptr<ShaderArchive> Open(
+        const std::filesystem::path& path);
+    static std::shared_ptr<ShaderArchive> FromMemory(std::vector<uint8_t> data);
+
+        // Binary search over the index; no allocation, no file access.
+    const Entry* Find(std::string_view name) const;
+
+    const std::vector<Entry>& GetEntries() const
+    {
+        return m_Entries;
+    }
+    const std::string& GetPath() const
+    {
+        return m_Path;
+    }
+
+private:
+    ShaderArchive() = default;
+    void Parse(std::span<const uint8_t> data);
+
+private:
+    std::string m_Path;
+    MappedFile m_File;
+    std::vector<uint8_t> m_Memory; // Backing store for FromMemory()
+    std::vector<Entry> m_Entries;  // Sorted by name
+};
+} // namespace Chimera
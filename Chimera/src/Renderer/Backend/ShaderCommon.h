@@ -29,12 +29,21 @@ using uint64 = uint64_t;
 #define BINDING_TEXTURES              3
 #define BINDING_LIGHTS                4
 #define BINDING_LIGHTS_CDF            5
+#define BINDING_PUNCTUAL_LIGHTS       6
+#define BINDING_CLUSTERS              7
 #define BINDING_RT_OUTPUT             0
 #define BINDING_RT_MOTION             1
 
 // --- 1. Shared Constants ---
 #define INVALID_ID                    -1
 
+// Froxel grid of the clustered forward lights, see ClusteredLights.h
+#define CLUSTER_GRID_X                16
+#define CLUSTER_GRID_Y                9
+#define CLUSTER_GRID_Z                24
+#define CLUSTER_COUNT                 (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+#define CLUSTER_MAX_LIGHTS            128
+
 #ifdef __cplusplus
 enum class MaterialType : int
 {
@@ -204,6 +213,15 @@ struct GpuLight
     int cdfStart;
 };
 
+// Point or spot light of the scene, lit through the cluster lists
+struct GpuPunctualLight
+{
+    vec4 positionRange; // xyz: world position, w: range
+    vec4 colorIntensity; // rgb: color, a: intensity
+    vec4 directionType; // xyz: spot direction, w: LightType
+    vec4 spotCos; // x: cos outer angle, y: cos inner angle, zw: padding
+};
+
 // --- 3. UBO & Ray Tracing Payload ---
 
 struct CameraData
@@ -236,10 +254,13 @@ struct UniformBufferObject
     uvec4 frameData; // x: frame-in-flight index, y: temporal/random sample index,
                      // z: displayMode, w: renderFlags
     vec4 postData; // x: exposure, y: ambientStrength, zw: blueNoiseTextureIndex
-    vec4 envData; // x: skyboxTextureIndex, y: lightCount, zw: padding
+    vec4 envData; // x: skyboxTextureIndex, y: lightCount,
+                  // z: prefilteredTextureIndex, w: prefilteredMaxLod
     vec4 svgfAlpha; // x: alphaColor, y: alphaMoments, zw: padding
     vec4 svgfPhi; // x: phiColor, y: phiNormal, z: phiDepth, w: padding
     vec4 gpuClearColor;
+    vec4 envIrradianceSH[9]; // rgb: skybox irradiance SH / pi, w: padding
+    vec4 clusterData; // x: punctual light count, y: near, z: far, w: padding
 };
 
 #ifndef __cplusplus
@@ -254,6 +275,8 @@ layout(set = 0, binding = BINDING_GLOBAL_UBO) uniform GlobalUBO
     vec4 svgfAlpha;
     vec4 svgfPhi;
     vec4 gpuClearColor;
+    vec4 envIrradianceSH[9];
+    vec4 clusterData;
 };
 #endif
 
@@ -261,6 +284,8 @@ struct HitPayload
 {
     vec4 color_dist;
     vec4 normal_rough;
+    // xy: motion, z: hit. w is an input: nonzero asks the closest hit to
+    // leave out its emission.
     vec4 motion_hit;
 };
 
@@ -274,6 +299,8 @@ struct ScenePushConstants
 static_assert(sizeof(GpuMaterial) == 80, "GpuMaterial size mismatch");
 static_assert(sizeof(GpuTriangle) == 160, "GpuTriangle size mismatch");
 static_assert(sizeof(GpuLight) == 16, "GpuLight size mismatch");
+static_assert(sizeof(GpuPunctualLight) == 64,
+              "GpuPunctualLight size mismatch");
 static_assert(sizeof(UniformBufferObject) % 16 == 0, "UBO alignment mismatch");
 } // namespace Chimera
 #endif
@@ -0,0 +1,286 @@
+#include "pch.h"
+#include "ShaderHotReload.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace Chimera
+{
+namespace
+{
+const std::vector<std::filesystem::path> NoIncludes;
+
+std::string StripComments(const std::string& source)
+{
+    std::string result;
+    result.reserve(source.size());
+    bool lineComment = false;
+    bool blockComment = false;
+    for (size_t i = 0; i < source.size(); ++i)
+    {
+        const char c = source[i];
+        const char next = i + 1 < source.size() ? source[i + 1] : '\0';
+        if (lineComment)
+        {
+            if (c == '\n')
+            {
+                lineComment = false;
+                result += c;
+            }
+        }
+        else if (blockComment)
+        {
+            if (c == '*' && next == '/')
+            {
+                blockComment = false;
+                ++i;
+            }
+            else if (c == '\n')
+            {
+                result += c; // Keep line structure for the directive parser
+            }
+        }
+        else if (c == '/' && next == '/')
+        {
+            lineComment = true;
+            ++i;
+        }
+        else if (c == '/' && next == '*')
+        {
+            blockComment = true;
+            ++i;
+        }
+        else
+        {
+            result += c;
+        }
+    }
+    return result;
+}
+} // namespace
+
+std::vector<std::string> ParseShaderIncludes(const std::string& source)
+{
+    std::vector<std::string> includes;
+    std::istringstream lines(StripComments(source));
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#') continue;
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos || line.compare(pos, 7, "include") != 0)
+            continue;
+        pos = line.find_first_not_of(" \t", pos + 7);
+        if (pos == std::string::npos) continue;
+
+        const char open = line[pos];
+        const char close = open == '"' ? '"' : (open == '<' ? '>' : '\0');
+        if (close == '\0') continue;
+        const size_t end = line.find(close, pos + 1);
+        if (end == std::string::npos || end == pos + 1) continue;
+        includes.push_back(line.substr(pos + 1, end - pos - 1));
+    }
+    return includes;
+}
+
+bool IsShaderStageFile(const std::filesystem::path& path)
+{
+    static const std::unordered_set<std::string> stageExtensions = {
+        ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese", ".rgen",
+        ".rchit", ".rmiss", ".rahit", ".rcall", ".rint", ".mesh", ".task"};
+    return stageExtensions.count(path.extension().string()) != 0;
+}
+
+void ShaderDependencyGraph::SetIncludeDirectories(
+    std::vector<std::filesystem::path> directories)
+{
+    m_IncludeDirectories.clear();
+    for (const auto& dir : directories)
+    {
+        m_IncludeDirectories.push_back(Normalize(dir));
+    }
+}
+
+void ShaderDependencyGraph::ScanDirectory(const std::filesystem::path& root)
+{
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, ec);
+         !ec && it != std::filesystem::recursive_directory_iterator();
+         it.increment(ec))
+    {
+        if (it->is_regular_file() && IsShaderStageFile(it->path()))
+        {
+            ScanFile(it->path());
+        }
+    }
+}
+
+void ShaderDependencyGraph::ScanFile(const std::filesystem::path& file)
+{
+    const std::filesystem::path path = Normalize(file);
+    const std::string key = path.string();
+
+    // Drop the old edges first so a removed #include stops propagating.
+    auto old = m_Includes.find(key);
+    if (old != m_Includes.end())
+    {
+        for (const auto& include : old->second)
+        {
+            m_Includers[include.string()].erase(key);
+        }
+    }
+
+    std::vector<std::filesystem::path>& includes = m_Includes[key];
+    includes.clear();
+
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) return;
+    std::stringstream source;
+    source << stream.rdbuf();
+
+    std::vector<std::filesystem::path> unscanned;
+    for (const auto& name : ParseShaderIncludes(source.str()))
+    {
+        const std::filesystem::path resolved = ResolveInclude(path, name);
+        if (resolved.empty()) continue;
+        if (std::find(includes.begin(), includes.end(), resolved) !=
+            includes.end())
+            continue;
+
+        includes.push_back(resolved);
+        m_Includers[resolved.string()].insert(key);
+        if (!m_Includes.count(resolved.string()))
+        {
+            unscanned.push_back(resolved);
+        }
+    }
+
+    for (const auto& include : unscanned)
+    {
+        if (!m_Includes.count(include.string())) ScanFile(include);
+    }
+}
+
+std::vector<std::filesystem::path> ShaderDependencyGraph::GetAffectedShaders(
+    const std::vector<std::filesystem::path>& changedFiles) const
+{
+    std::unordered_set<std::string> visited;
+    std::vector<std::string> stack;
+    for (const auto& file : changedFiles)
+    {
+        stack.push_back(Normalize(file).string());
+    }
+
+    std::vector<std::filesystem::path> affected;
+    while (!stack.empty())
+    {
+        const std::string current = std::move(stack.back());
+        stack.pop_back();
+        if (!visited.insert(current).second) continue;
+
+        if (IsShaderStageFile(current)) affected.emplace_back(current);
+
+        auto includers = m_Includers.find(current);
+        if (includers == m_Includers.end()) continue;
+        for (const auto& includer : includers->second)
+        {
+            stack.push_back(includer);
+        }
+    }
+
+    std::sort(affected.begin(), affected.end());
+    return affected;
+}
+
+std::vector<std::filesystem::path> ShaderDependencyGraph::GetFiles() const
+{
+    std::vector<std::filesystem::path> files;
+    files.reserve(m_Includes.size());
+    for (const auto& [file, includes] : m_Includes)
+    {
+        files.emplace_back(file);
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::vector<std::filesystem::path> ShaderDependencyGraph::GetShaderFiles()
+    const
+{
+    std::vector<std::filesystem::path> files = GetFiles();
+    files.erase(std::remove_if(files.begin(), files.end(),
+                               [](const std::filesystem::path& file)
+                               { return !IsShaderStageFile(file); }),
+                files.end());
+    return files;
+}
+
+const std::vector<std::filesystem::path>& ShaderDependencyGraph::GetIncludes(
+    const std::filesystem::path& file) const
+{
+    auto it = m_Includes.find(Normalize(file).string());
+    return it != m_Includes.end() ? it->second : NoIncludes;
+}
+
+std::filesystem::path ShaderDependencyGraph::Normalize(
+    const std::filesystem::path& path)
+{
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(path, ec);
+    if (ec) absolute = path;
+    return absolute.lexically_normal().make_preferred();
+}
+
+std::filesystem::path ShaderDependencyGraph::ResolveInclude(
+    const std::filesystem::path& from, const std::string& include) const
+{
+    std::error_code ec;
+    std::filesystem::path candidate = from.parent_path() / include;
+    if (std::filesystem::is_regular_file(candidate, ec))
+    {
+        return Normalize(candidate);
+    }
+    for (const auto& dir : m_IncludeDirectories)
+    {
+        candidate = dir / include;
+        if (std::filesystem::is_regular_file(candidate, ec))
+        {
+            return Normalize(candidate);
+        }
+    }
+    return {};
+}
+
+void ShaderFileWatcher::Watch(const std::filesystem::path& file)
+{
+    const std::filesystem::path path = ShaderDependencyGraph::Normalize(file);
+    auto [it, inserted] = m_Timestamps.try_emplace(path.string());
+    if (!inserted) return;
+
+    std::error_code ec;
+    it->second.path = path;
+    it->second.time = std::filesystem::last_write_time(path, ec);
+    it->second.exists = !ec;
+}
+
+std::vector<std::filesystem::path> ShaderFileWatcher::Poll()
+{
+    std::vector<std::filesystem::path> changed;
+    for (auto& [key, entry] : m_Timestamps)
+    {
+        std::error_code ec;
+        const auto time = std::filesystem::last_write_time(entry.path, ec);
+        const bool exists = !ec;
+        if (exists != entry.exists || (exists && time != entry.time))
+        {
+            entry.time = exists ? time : std::filesystem::file_time_type{};
+            entry.exists = exists;
+            changed.push_back(entry.path);
+        }
+    }
+    std::sort(changed.begin(), changed.end());
+    return changed;
+}
+} // namespace Chimera
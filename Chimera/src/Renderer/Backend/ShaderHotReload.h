@@ -0,0 +1,83 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Chimera
+{
+    // Returns the quoted and angle-bracket #include targets of a GLSL
+    // source, in order. Includes inside // and /* */ comments are ignored.
+std::vector<std::string> ParseShaderIncludes(const std::string& source);
+
+    // True for files glslc compiles on their own (.vert, .comp, .rgen, ...),
+    // as opposed to headers such as common.glsl or ShaderCommon.h.
+bool IsShaderStageFile(const std::filesystem::path& path);
+
+    // Include graph of the shader sources. Paths are stored normalized, so
+    // "../common/common.glsl" from two directories is one node. Does not
+    // touch the GPU; the hot reload service uses it to decide which stage
+    // files to recompile when any file changes.
+class ShaderDependencyGraph
+{
+public:
+        // Searched after the including file's own directory, like glslc -I.
+    void SetIncludeDirectories(std::vector<std::filesystem::path> directories);
+
+        // Scans every stage file under root and everything they include.
+    void ScanDirectory(const std::filesystem::path& root);
+
+        // Re-reads one file and replaces its include edges. Newly referenced
+        // includes are scanned too. A missing file keeps no edges.
+    void ScanFile(const std::filesystem::path& file);
+
+        // Stage files that are in changedFiles or include one of them,
+        // directly or transitively. Sorted, without duplicates.
+    std::vector<std::filesystem::path> GetAffectedShaders(
+        const std::vector<std::filesystem::path>& changedFiles) const;
+
+        // Every scanned file, headers included.
+    std::vector<std::filesystem::path> GetFiles() const;
+    std::vector<std::filesystem::path> GetShaderFiles() const;
+
+    const std::vector<std::filesystem::path>& GetIncludes(
+        const std::filesystem::path& file) const;
+
+    static std::filesystem::path Normalize(const std::filesystem::path& path);
+
+private:
+    std::filesystem::path ResolveInclude(const std::filesystem::path& from,
+                                         const std::string& include) const;
+
+    std::vector<std::filesystem::path> m_IncludeDirectories;
+    std::unordered_map<std::string, std::vector<std::filesystem::path>>
+        m_Includes; // file -> files it includes
+    std::unordered_map<std::string, std::unordered_set<std::string>>
+        m_Includers; // file -> files that include it
+};
+
+    // Polls last-write times. Watch() records the current time, so Poll()
+    // only reports files modified, created or deleted after that.
+class ShaderFileWatcher
+{
+public:
+    void Watch(const std::filesystem::path& file);
+    void Clear()
+    {
+        m_Timestamps.clear();
+    }
+
+    std::vector<std::filesystem::path> Poll();
+
+private:
+    struct Entry
+    {
+        std::filesystem::path path;
+        std::filesystem::file_time_type time{};
+        bool exists = false;
+    };
+    std::unordered_map<std::string, Entry> m_Timestamps;
+};
+} // namespace Chimera
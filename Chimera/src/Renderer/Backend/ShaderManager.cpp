@@ -2,21 +2,122 @@
 #include "ShaderManager.h"
 #include "Core/Log.h"
 #include "Core/Application.h"
+#include "Core/TaskSystem.h"
+#include "PipelineManager.h"
+#include "ShaderReflection.h"
+#include <cstdlib>
 #include <fstream>
 #include <filesystem>
 
 namespace Chimera
 {
+namespace
+{
+constexpr auto HotReloadPollInterval = std::chrono::milliseconds(250);
+
+    // Same -I order as the build's glslc command.
+std::vector<std::filesystem::path> GetIncludeDirectories(
+    const std::filesystem::path& sourceDir)
+{
+    return {sourceDir.parent_path() / "src" / "Renderer" / "Backend",
+            sourceDir / "common", sourceDir};
+}
+
+std::string GetShaderCompilerPath()
+{
+#ifdef CHIMERA_GLSLC_PATH
+    if (std::filesystem::exists(CHIMERA_GLSLC_PATH)) return CHIMERA_GLSLC_PATH;
+#endif
+    if (const char* sdk = std::getenv("VULKAN_SDK"))
+    {
+        for (const char* name : {"Bin/glslc.exe", "bin/glslc"})
+        {
+            const std::filesystem::path compiler =
+                std::filesystem::path(sdk) / name;
+            if (std::filesystem::exists(compiler)) return compiler.string();
+        }
+    }
+    return "glslc";
+}
+
+    // Mirrors the build's reflect step so the next startup finds a sidecar
+    // that matches the reloaded bytecode.
+void WriteReflectionSidecar(const std::filesystem::path& spirvPath)
+{
+    std::ifstream input(spirvPath, std::ios::ate | std::ios::binary);
+    if (!input.is_open()) return;
+
+    std::vector<uint32_t> spirv((size_t)input.tellg() / sizeof(uint32_t));
+    input.seekg(0);
+    input.read((char*)spirv.data(), spirv.size() * sizeof(uint32_t));
+
+    const auto fileData =
+        SerializeShaderReflection(ReflectSpirv(spirv), spirv);
+    std::filesystem::path sidecarPath = spirvPath;
+    sidecarPath += ".refl";
+    std::ofstream output(sidecarPath, std::ios::binary | std::ios::trunc);
+    output.write((const char*)fileData.data(), fileData.size());
+}
+} // namespace
+
 void ShaderManager::Init(const std::string& shaderDir,
                          const std::string& sourceDir)
 {
     s_ShaderDir = shaderDir;
     s_SourceDir = sourceDir;
+    s_Dependencies = ShaderDependencyGraph();
+    s_Watcher.Clear();
+
+    {
+        std::scoped_lock lock(s_Mutex);
+        s_Archive.reset();
+        s_ReloadedPaths.clear();
+        for (const std::filesystem::path dir :
+             {std::filesystem::path(shaderDir),
+              std::filesystem::path("shaders")})
+        {
+            const auto archivePath = dir / ShaderArchiveFileName;
+            if (!std::filesystem::exists(archivePath)) continue;
+            try
+            {
+                s_Archive = ShaderArchive::Open(archivePath);
+                CH_CORE_INFO("ShaderManager: Mapped {0} shaders from {1}",
+                             s_Archive->GetEntries().size(),
+                             archivePath.string());
+                LoadReloadedPaths();
+            }
+            catch (const std::exception& e)
+            {
+                CH_CORE_WARN("ShaderManager: Ignoring shader archive: {0}",
+                             e.what());
+            }
+            break;
+        }
+    }
+
+    if (sourceDir.empty() || !std::filesystem::is_directory(sourceDir))
+    {
+        CH_CORE_INFO("ShaderManager: No shader source directory, hot reload "
+                     "disabled.");
+        s_SourceDir.clear();
+        return;
+    }
+
+    s_Dependencies.SetIncludeDirectories(GetIncludeDirectories(sourceDir));
+    s_Dependencies.ScanDirectory(sourceDir);
+    const auto files = s_Dependencies.GetFiles();
+    for (const auto& file : files)
+    {
+        s_Watcher.Watch(file);
+    }
+    CH_CORE_INFO("ShaderManager: Watching {0} shader sources in {1}",
+                 files.size(), sourceDir);
 }
 
 void ShaderManager::RegisterAlias(const std::string& alias,
                                   const std::string& path)
 {
+    std::scoped_lock lock(s_Mutex);
     s_AliasMap[alias] = path;
     CH_CORE_TRACE("ShaderManager: Registered alias '{0}' -> '{1}'", alias,
                   path);
@@ -24,6 +125,7 @@ void ShaderManager::RegisterAlias(const std::string& alias,
 
 std::shared_ptr<Shader> ShaderManager::GetShader(const std::string& name)
 {
+    std::scoped_lock lock(s_Mutex);
     if (s_ShaderCache.count(name))
     {
         return s_ShaderCache[name];
@@ -35,10 +137,67 @@ std::shared_ptr<Shader> ShaderManager::GetShader(const std::string& name)
         actualPath = s_AliasMap[name];
     }
 
+    if (s_Archive && !s_ReloadedPaths.count(actualPath))
+    {
+        if (const auto* entry = s_Archive->Find(actualPath))
+        {
+            CH_CORE_INFO("ShaderManager: Loading shader '{0}' from archive",
+                         name);
+            auto shader = std::make_shared<Shader>(
+                actualPath, entry->spirv, entry->reflection, s_Archive);
+            s_ShaderCache[name] = shader;
+            return shader;
+        }
+    }
+
+    std::filesystem::path fullPath = ResolveBinaryPath(actualPath);
+
+    CH_CORE_INFO("ShaderManager: Loading shader '{0}' from [ {1} ]", name,
+                 fullPath.string());
+
+        // Pass the fully normalized absolute path
+    auto shader = std::make_shared<Shader>(fullPath);
+    s_ShaderCache[name] = shader;
+    return shader;
+}
+
+std::filesystem::path ShaderManager::GetReloadedListPath()
+{
+    return s_Archive->GetPath() + ".reloaded";
+}
+
+void ShaderManager::LoadReloadedPaths()
+{
+        // Hot reload writes loose .spv files but cannot touch the mapped
+        // archive, so the list of reloaded shaders outlives the session
+        // until a build packs a newer archive.
+    const std::filesystem::path listPath = GetReloadedListPath();
+    std::error_code ec;
+    const auto listTime = std::filesystem::last_write_time(listPath, ec);
+    if (ec) return;
+    if (listTime < std::filesystem::last_write_time(s_Archive->GetPath(), ec))
+    {
+        std::filesystem::remove(listPath, ec);
+        return;
+    }
+
+    std::ifstream list(listPath);
+    for (std::string path; std::getline(list, path);)
+    {
+        if (!path.empty()) s_ReloadedPaths.insert(path);
+    }
+    CH_CORE_INFO("ShaderManager: {0} hot-reloaded shaders override the "
+                 "archive",
+                 s_ReloadedPaths.size());
+}
+
+std::filesystem::path ShaderManager::ResolveBinaryPath(
+    const std::string& shaderPath)
+{
         // --- ULTRA ROBUST PATH RESOLUTION ---
     std::filesystem::path baseDir =
         Application::Get().GetSpecification().ShaderDir;
-    std::filesystem::path shaderFile = actualPath + ".spv";
+    std::filesystem::path shaderFile = shaderPath + ".spv";
 
         // Use operator / for proper path joining
     std::filesystem::path fullPath = baseDir / shaderFile;
@@ -51,24 +210,186 @@ std::shared_ptr<Shader> ShaderManager::GetShader(const std::string& name)
 
         // 1. Convert to absolute path to rule out working directory issues
         // 2. Normalize separators (\ vs /) for Windows stability
-    fullPath = std::filesystem::absolute(fullPath).make_preferred();
-
-    CH_CORE_INFO("ShaderManager: Loading shader '{0}' from [ {1} ]", name,
-                 fullPath.string());
-
-        // Pass the fully normalized absolute path
-    auto shader = std::make_shared<Shader>(fullPath);
-    s_ShaderCache[name] = shader;
-    return shader;
+    return std::filesystem::absolute(fullPath).make_preferred();
 }
 
 bool ShaderManager::CheckForUpdates()
 {
-    return false;
+    if (!s_HotReloadEnabled || s_SourceDir.empty() ||
+        !Application::Get().GetTaskSystem())
+    {
+        return false;
+    }
+
+        // 1. Swap in finished compiles. A failed compile keeps the old
+        // shader and pipelines, so a typo never takes a pass down.
+    std::unordered_set<std::string> reloadedNames;
+    std::vector<std::filesystem::path> requeue;
+    for (auto it = s_PendingReloads.begin(); it != s_PendingReloads.end();)
+    {
+        if (it->second.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        ReloadResult result = it->second.get();
+        if (s_QueuedReloads.erase(it->first))
+        {
+            requeue.emplace_back(it->first);
+        }
+        it = s_PendingReloads.erase(it);
+
+        if (!result.shader)
+        {
+            CH_CORE_ERROR("ShaderManager: Hot reload of '{0}' failed: {1}",
+                          result.path, result.error);
+            continue;
+        }
+
+        std::scoped_lock lock(s_Mutex);
+        if (s_Archive && s_ReloadedPaths.insert(result.path).second)
+        {
+            std::ofstream(GetReloadedListPath(), std::ios::app)
+                << result.path << '\n';
+        }
+        std::vector<std::string> names = {result.path};
+        for (const auto& [alias, path] : s_AliasMap)
+        {
+            if (path == result.path) names.push_back(alias);
+        }
+        for (const auto& name : names)
+        {
+            auto cached = s_ShaderCache.find(name);
+            if (cached != s_ShaderCache.end()) cached->second = result.shader;
+            reloadedNames.insert(name);
+        }
+        CH_CORE_INFO("ShaderManager: Reloaded '{0}'", result.path);
+    }
+
+    if (!reloadedNames.empty())
+    {
+        PipelineManager::Get().InvalidateShaders(reloadedNames);
+    }
+    for (const auto& source : requeue)
+    {
+        QueueRecompile(source);
+    }
+
+        // 2. Poll sources. Changed files are rescanned first so an edited
+        // #include list is honoured by this very rebuild.
+    const auto now = std::chrono::steady_clock::now();
+    if (now - s_LastPoll >= HotReloadPollInterval)
+    {
+        s_LastPoll = now;
+        const auto changed = s_Watcher.Poll();
+        if (!changed.empty())
+        {
+            for (const auto& file : changed)
+            {
+                s_Dependencies.ScanFile(file);
+            }
+            for (const auto& file : s_Dependencies.GetFiles())
+            {
+                s_Watcher.Watch(file);
+            }
+            for (const auto& shader : s_Dependencies.GetAffectedShaders(changed))
+            {
+                QueueRecompile(shader);
+            }
+        }
+    }
+
+    return !reloadedNames.empty();
 }
 
 void ShaderManager::RecompileAll()
 {
+    if (s_SourceDir.empty())
+    {
+        CH_CORE_WARN("ShaderManager: No shader source directory to recompile.");
+        return;
+    }
+
     CH_CORE_INFO("ShaderManager: Recompiling all shaders...");
+    for (const auto& shader : s_Dependencies.GetShaderFiles())
+    {
+        QueueRecompile(shader);
+    }
+}
+
+void ShaderManager::QueueRecompile(const std::filesystem::path& source)
+{
+    TaskSystem* taskSystem = Application::Get().GetTaskSystem();
+    if (!taskSystem) return;
+
+    const std::string key = source.string();
+    if (s_PendingReloads.count(key))
+    {
+            // glslc may already have read the old text; build again after.
+        s_QueuedReloads.insert(key);
+        return;
+    }
+
+    const std::string path =
+        std::filesystem::relative(source, s_SourceDir).generic_string();
+    const std::filesystem::path output = ResolveBinaryPath(path);
+    CH_CORE_INFO("ShaderManager: Recompiling '{0}'...", path);
+
+    s_PendingReloads.emplace(
+        key, taskSystem->Enqueue([source, path, output]()
+                                 { return CompileShader(source, path, output); }));
+}
+
+ShaderManager::ReloadResult ShaderManager::CompileShader(
+    const std::filesystem::path& source, const std::string& path,
+    const std::filesystem::path& output)
+{
+    ReloadResult result;
+    result.path = path;
+
+        // Compile next to the target and rename, so a failed build leaves
+        // the previous SPIR-V in place.
+    const std::filesystem::path temp = output.string() + ".tmp";
+    std::string command =
+        "\"" + GetShaderCompilerPath() + "\" --target-env=vulkan1.3";
+    for (const auto& dir : GetIncludeDirectories(s_SourceDir))
+    {
+        command += " -I \"" + dir.string() + "\"";
+    }
+    command += " \"" + source.string() + "\" -o \"" + temp.string() + "\"";
+#ifdef _WIN32
+        // cmd.exe strips the first and last quote of the whole line.
+    command = "\"" + command + "\"";
+#endif
+
+    std::error_code ec;
+    std::filesystem::create_directories(output.parent_path(), ec);
+    if (std::system(command.c_str()) != 0)
+    {
+        std::filesystem::remove(temp, ec);
+        result.error = "glslc reported errors (see console output)";
+        return result;
+    }
+
+    std::filesystem::rename(temp, output, ec);
+    if (ec)
+    {
+        result.error = "could not replace " + output.string() + ": " +
+                       ec.message();
+        return result;
+    }
+
+    try
+    {
+        WriteReflectionSidecar(output);
+        result.shader = std::make_shared<Shader>(output);
+    }
+    catch (const std::exception& e)
+    {
+        result.error = e.what();
+    }
+    return result;
 }
 } // namespace Chimera
@@ -1,14 +1,23 @@
 #pragma once
 #include "pch.h"
 #include "Shader.h"
+#include "ShaderArchive.h"
+#include "ShaderHotReload.h"
+#include <chrono>
 #include <filesystem>
+#include <future>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace Chimera
 {
 class ShaderManager
 {
 public:
+        // Maps the shader archive from shaderDir if the build produced one
+        // and starts watching sourceDir for hot reload. Without a source
+        // directory only precompiled SPIR-V from shaderDir is used.
     static void Init(const std::string& shaderDir,
                      const std::string& sourceDir);
 
@@ -16,19 +25,58 @@ public:
     static void RegisterAlias(const std::string& alias,
                               const std::string& path);
 
-        // Returns a shader object containing bytecode and reflection data
+        // Returns a shader object containing bytecode and reflection data.
+        // Shaders are taken from the archive when it has them, otherwise
+        // from loose .spv files.
     static std::shared_ptr<Shader> GetShader(const std::string& name);
 
+        // Hot reload, called once per frame on the render thread. Polls the
+        // watched sources, queues glslc for changed stage files and their
+        // #include dependents on the TaskSystem, and swaps finished shaders
+        // into the cache. Pipelines using a swapped shader are invalidated;
+        // the old ones stay in use until their replacements are compiled.
+        // Returns true if any shader was swapped this call.
     static bool CheckForUpdates();
     static void RecompileAll();
 
+    static void SetHotReloadEnabled(bool enabled)
+    {
+        s_HotReloadEnabled = enabled;
+    }
+    static bool IsHotReloadEnabled()
+    {
+        return s_HotReloadEnabled;
+    }
+    static uint32_t GetPendingReloadCount()
+    {
+        return (uint32_t)s_PendingReloads.size();
+    }
+
     static void ClearCache()
     {
+        std::scoped_lock lock(s_Mutex);
         s_ShaderCache.clear();
         s_Timestamps.clear();
         s_AliasMap.clear();
     }
 
+private:
+    struct ReloadResult
+    {
+        std::string path; // Relative to the source dir, e.g. "postprocess/taa.comp"
+        std::shared_ptr<Shader> shader;
+        std::string error;
+    };
+
+    static std::filesystem::path ResolveBinaryPath(
+        const std::string& shaderPath);
+    static std::filesystem::path GetReloadedListPath();
+    static void LoadReloadedPaths();
+    static void QueueRecompile(const std::filesystem::path& source);
+    static ReloadResult CompileShader(const std::filesystem::path& source,
+                                      const std::string& path,
+                                      const std::filesystem::path& output);
+
 private:
     inline static std::string s_ShaderDir;
     inline static std::string s_SourceDir;
@@ -39,5 +87,21 @@ private:
         s_Timestamps;
     inline static std::unordered_map<std::string, std::shared_ptr<Shader>>
         s_ShaderCache;
+        // Pipelines are compiled on TaskSystem workers, so shader lookups
+        // can race with the render thread.
+    inline static std::mutex s_Mutex;
+    inline static std::shared_ptr<const ShaderArchive> s_Archive;
+        // Hot-reloaded paths; the archive copy of these is outdated.
+    inline static std::unordered_set<std::string> s_ReloadedPaths;
+
+        // Hot reload state; render thread only.
+    inline static bool s_HotReloadEnabled = true;
+    inline static ShaderDependencyGraph s_Dependencies;
+    inline static ShaderFileWatcher s_Watcher;
+    inline static std::chrono::steady_clock::time_point s_LastPoll;
+    inline static std::unordered_map<std::string, std::future<ReloadResult>>
+        s_PendingReloads; // Source path -> glslc job
+    inline static std::unordered_set<std::string>
+        s_QueuedReloads; // Changed again while compiling
 };
 } // namespace Chimera
@@ -0,0 +1,281 @@
+#include "pch.h"
+#include "ShaderReflection.h"
+
+#include <spirv_reflect.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+namespace Chimera
+{
+namespace
+{
+constexpr uint32_t ShaderReflectionMagic = 0x46524843; // "CHRF"
+constexpr uint32_t ShaderReflectionFormatVersion = 1;
+
+struct ShaderReflectionFileHeader
+{
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint64_t spirvHash;
+    uint32_t bindingCount;
+    uint32_t pushConstantOffset;
+    uint32_t pushConstantSize;
+    uint32_t pushConstantStages;
+};
+static_assert(sizeof(ShaderReflectionFileHeader) == 32,
+              "reflection header must not contain implicit padding");
+
+    // Per binding: set, binding, descriptor type, count, name length, then
+    // the name bytes without a terminator.
+constexpr size_t BindingFieldCount = 5;
+
+uint64_t HashSpirv(std::span<const uint32_t> spirv)
+{
+    // FNV-1a: detects a sidecar paired with the wrong binary, not tampering.
+    const auto* bytes = reinterpret_cast<const uint8_t*>(spirv.data());
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < spirv.size() * sizeof(uint32_t); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+void AppendU32(std::vector<uint8_t>& out, uint32_t value)
+{
+    const size_t offset = out.size();
+    out.resize(offset + sizeof(value));
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+bool ReadU32(std::span<const uint8_t> data, size_t& offset, uint32_t& value)
+{
+    if (data.size() - offset < sizeof(value)) return false;
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    offset += sizeof(value);
+    return true;
+}
+
+void SortBindings(std::vector<ShaderReflectionBinding>& bindings)
+{
+    std::sort(bindings.begin(), bindings.end(),
+              [](const auto& a, const auto& b)
+              {
+                  return std::tie(a.set, a.binding, a.name) <
+                         std::tie(b.set, b.binding, b.name);
+              });
+}
+} // namespace
+
+const char* ShaderReflectionLoadStatusToString(
+    ShaderReflectionLoadStatus status)
+{
+    switch (status)
+    {
+        case ShaderReflectionLoadStatus::Loaded:
+            return "loaded";
+        case ShaderReflectionLoadStatus::Missing:
+            return "missing";
+        case ShaderReflectionLoadStatus::Corrupt:
+            return "corrupt";
+        case ShaderReflectionLoadStatus::Stale:
+            return "stale";
+    }
+    return "unknown";
+}
+
+ShaderReflectionData ReflectSpirv(std::span<const uint32_t> spirv)
+{
+    ShaderReflectionData reflection;
+    if (spirv.empty())
+    {
+        return reflection;
+    }
+
+    SpvReflectShaderModule module;
+    SpvReflectResult result = spvReflectCreateShaderModule(
+        spirv.size() * sizeof(uint32_t), spirv.data(), &module);
+    if (result != SPV_REFLECT_RESULT_SUCCESS)
+    {
+        throw std::runtime_error("spirv-reflect could not parse the module");
+    }
+
+    uint32_t count = 0;
+    spvReflectEnumerateDescriptorBindings(&module, &count, nullptr);
+    std::vector<SpvReflectDescriptorBinding*> bindings(count);
+    spvReflectEnumerateDescriptorBindings(&module, &count, bindings.data());
+
+    for (auto* b : bindings)
+    {
+        ShaderReflectionBinding binding;
+        binding.name = b->name ? b->name : "";
+        binding.set = b->set;
+        binding.binding = b->binding;
+        binding.descriptorType = static_cast<uint32_t>(b->descriptor_type);
+        binding.count = b->count;
+
+        // Resources are looked up by name, so a repeated name keeps the
+        // last binding reported, as the runtime map always did.
+        auto existing = std::find_if(reflection.bindings.begin(),
+                                     reflection.bindings.end(),
+                                     [&](const auto& other)
+                                     { return other.name == binding.name; });
+        if (existing != reflection.bindings.end())
+        {
+            *existing = binding;
+        }
+        else
+        {
+            reflection.bindings.push_back(binding);
+        }
+    }
+    SortBindings(reflection.bindings);
+
+    uint32_t pushConstantCount = 0;
+    result = spvReflectEnumeratePushConstantBlocks(&module, &pushConstantCount,
+                                                   nullptr);
+    std::vector<SpvReflectBlockVariable*> pushConstantBlocks(pushConstantCount);
+    if (result == SPV_REFLECT_RESULT_SUCCESS)
+    {
+        result = spvReflectEnumeratePushConstantBlocks(
+            &module, &pushConstantCount, pushConstantBlocks.data());
+    }
+    if (result != SPV_REFLECT_RESULT_SUCCESS)
+    {
+        spvReflectDestroyShaderModule(&module);
+        throw std::runtime_error("failed to enumerate push constant blocks");
+    }
+
+    // Merge every block into one range, as the pipeline layout uses a
+    // single push constant range.
+    for (auto* block : pushConstantBlocks)
+    {
+        if (!block) continue;
+
+        if (reflection.pushConstantSize == 0)
+        {
+            reflection.pushConstantOffset = block->offset;
+            reflection.pushConstantSize = block->size;
+        }
+        else
+        {
+            const uint32_t currentEnd =
+                reflection.pushConstantOffset + reflection.pushConstantSize;
+            const uint32_t blockEnd = block->offset + block->size;
+            const uint32_t mergedStart =
+                std::min(reflection.pushConstantOffset, block->offset);
+            reflection.pushConstantOffset = mergedStart;
+            reflection.pushConstantSize =
+                std::max(currentEnd, blockEnd) - mergedStart;
+        }
+        reflection.pushConstantStages |=
+            static_cast<uint32_t>(module.shader_stage);
+    }
+
+    spvReflectDestroyShaderModule(&module);
+    return reflection;
+}
+
+std::vector<uint8_t> SerializeShaderReflection(
+    const ShaderReflectionData& reflection, std::span<const uint32_t> spirv)
+{
+    ShaderReflectionFileHeader header{};
+    header.magic = ShaderReflectionMagic;
+    header.formatVersion = ShaderReflectionFormatVersion;
+    header.spirvHash = HashSpirv(spirv);
+    header.bindingCount = static_cast<uint32_t>(reflection.bindings.size());
+    header.pushConstantOffset = reflection.pushConstantOffset;
+    header.pushConstantSize = reflection.pushConstantSize;
+    header.pushConstantStages = reflection.pushConstantStages;
+
+    std::vector<uint8_t> fileData(sizeof(header));
+    std::memcpy(fileData.data(), &header, sizeof(header));
+
+    std::vector<ShaderReflectionBinding> bindings = reflection.bindings;
+    SortBindings(bindings);
+    for (const auto& binding : bindings)
+    {
+        AppendU32(fileData, binding.set);
+        AppendU32(fileData, binding.binding);
+        AppendU32(fileData, binding.descriptorType);
+        AppendU32(fileData, binding.count);
+        AppendU32(fileData, static_cast<uint32_t>(binding.name.size()));
+        fileData.insert(fileData.end(), binding.name.begin(),
+                        binding.name.end());
+    }
+    return fileData;
+}
+
+ShaderReflectionLoadStatus DeserializeShaderReflection(
+    std::span<const uint8_t> fileData, std::span<const uint32_t> spirv,
+    ShaderReflectionData& outReflection)
+{
+    outReflection = {};
+
+    if (fileData.empty())
+    {
+        return ShaderReflectionLoadStatus::Missing;
+    }
+
+    ShaderReflectionFileHeader header{};
+    if (fileData.size() < sizeof(header))
+    {
+        return ShaderReflectionLoadStatus::Corrupt;
+    }
+    std::memcpy(&header, fileData.data(), sizeof(header));
+
+    if (header.magic != ShaderReflectionMagic ||
+        header.formatVersion != ShaderReflectionFormatVersion)
+    {
+        return ShaderReflectionLoadStatus::Corrupt;
+    }
+    if (header.spirvHash != HashSpirv(spirv))
+    {
+        return ShaderReflectionLoadStatus::Stale;
+    }
+
+    // Every binding needs at least its fixed fields; reject counts the file
+    // cannot hold before reserving for them.
+    const size_t minBindingSize = BindingFieldCount * sizeof(uint32_t);
+    if (header.bindingCount > (fileData.size() - sizeof(header)) / minBindingSize)
+    {
+        return ShaderReflectionLoadStatus::Corrupt;
+    }
+
+    ShaderReflectionData reflection;
+    reflection.pushConstantOffset = header.pushConstantOffset;
+    reflection.pushConstantSize = header.pushConstantSize;
+    reflection.pushConstantStages = header.pushConstantStages;
+    reflection.bindings.resize(header.bindingCount);
+
+    size_t offset = sizeof(header);
+    for (auto& binding : reflection.bindings)
+    {
+        uint32_t nameLength = 0;
+        if (!ReadU32(fileData, offset, binding.set) ||
+            !ReadU32(fileData, offset, binding.binding) ||
+            !ReadU32(fileData, offset, binding.descriptorType) ||
+            !ReadU32(fileData, offset, binding.count) ||
+            !ReadU32(fileData, offset, nameLength) ||
+            fileData.size() - offset < nameLength)
+        {
+            return ShaderReflectionLoadStatus::Corrupt;
+        }
+        binding.name.assign(
+            reinterpret_cast<const char*>(fileData.data() + offset),
+            nameLength);
+        offset += nameLength;
+    }
+
+    if (offset != fileData.size())
+    {
+        return ShaderReflectionLoadStatus::Corrupt;
+    }
+
+    outReflection = std::move(reflection);
+    return ShaderReflectionLoadStatus::Loaded;
+}
+} // namespace Chimera
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Chimera
+{
+    // Reflection results for one SPIR-V module. Descriptor types and stage
+    // flags are stored as raw Vulkan enum values so this stays free of
+    // Vulkan headers and can be shared with the build-time reflect tool.
+struct ShaderReflectionBinding
+{
+    std::string name;
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    uint32_t descriptorType = 0; // VkDescriptorType
+    uint32_t count = 0;
+
+    bool operator==(const ShaderReflectionBinding& other) const = default;
+};
+
+struct ShaderReflectionData
+{
+    std::vector<ShaderReflectionBinding> bindings; // Sorted by set, binding
+    uint32_t pushConstantOffset = 0;
+    uint32_t pushConstantSize = 0;
+    uint32_t pushConstantStages = 0; // VkShaderStageFlags
+
+    bool operator==(const ShaderReflectionData& other) const = default;
+};
+
+enum class ShaderReflectionLoadStatus
+{
+    Loaded,
+    Missing,
+    Corrupt,
+    Stale // Sidecar was written for different bytecode
+};
+
+const char* ShaderReflectionLoadStatusToString(
+    ShaderReflectionLoadStatus status);
+
+    // Runs spirv-reflect over a module. Throws std::runtime_error if the
+    // module cannot be parsed.
+ShaderReflectionData ReflectSpirv(std::span<const uint32_t> spirv);
+
+    // Sidecar file (<shader>.spv.refl) written next to each SPIR-V binary by
+    // the build. It carries a hash of the bytecode it describes, so a
+    // sidecar left behind by an older build or a hot reload is rejected.
+std::vector<uint8_t> SerializeShaderReflection(
+    const ShaderReflectionData& reflection, std::span<const uint32_t> spirv);
+
+ShaderReflectionLoadStatus DeserializeShaderReflection(
+    std::span<const uint8_t> fileData, std::span<const uint32_t> spirv,
+    ShaderReflectionData& outReflection);
+} // namespace Chimera
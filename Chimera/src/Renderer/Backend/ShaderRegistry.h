@@ -11,6 +11,8 @@ public:
             // --- 1. Forward / Raster Passes ---
         ShaderManager::RegisterAlias("Forward_Vert", "forward/forward.vert");
         ShaderManager::RegisterAlias("Forward_Frag", "forward/forward.frag");
+        ShaderManager::RegisterAlias("Cluster_Cull",
+                                     "forward/cluster_cull.comp");
 
             // --- 2. Hybrid / G-Buffer Passes ---
         ShaderManager::RegisterAlias("GBuffer_Vert", "hybrid/gbuffer.vert");
@@ -35,6 +37,10 @@ public:
                                      "raytracing/diffuse_gi.rgen");
         ShaderManager::RegisterAlias("Reflection_Gen",
                                      "raytracing/reflection.rgen");
+        ShaderManager::RegisterAlias("ReSTIR_DI_Gen",
+                                     "raytracing/restir_di.rgen");
+        ShaderManager::RegisterAlias("ReSTIR_DI_Spatial_Gen",
+                                     "raytracing/restir_di_spatial.rgen");
 
             // --- 4. Post-Processing & SVGF ---
         ShaderManager::RegisterAlias("Composition_Frag",
@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "StagingRing.h"
+
+#include <stdexcept>
+
+namespace Chimera
+{
+StagingRing::StagingRing(uint64_t capacity) : m_Capacity(capacity)
+{
+    if (capacity == 0)
+    {
+        throw std::invalid_argument("StagingRing: capacity must not be zero");
+    }
+}
+
+std::optional<uint64_t> StagingRing::Allocate(uint64_t size,
+                                              uint64_t alignment)
+{
+    if (size == 0 || size > m_Capacity) return std::nullopt;
+    if (alignment == 0) alignment = 1;
+
+        // An empty ring restarts at offset 0, so any block up to the full
+        // capacity fits instead of only the larger side of the head.
+    if (m_Head == m_Tail && m_Head % m_Capacity != 0)
+    {
+        m_Head += m_Capacity - m_Head % m_Capacity;
+        m_Tail = m_Head;
+        m_ClosedHead = m_Head;
+    }
+
+    const uint64_t offset = m_Head % m_Capacity;
+    const uint64_t aligned = (offset + alignment - 1) & ~(alignment - 1);
+
+        // Offset 0 satisfies every alignment, so a block that would run
+        // past the end restarts there.
+    uint64_t start = m_Head + (aligned - offset);
+    if (aligned + size > m_Capacity) start = m_Head + (m_Capacity - offset);
+
+    const uint64_t end = start + size;
+    if (end - m_Tail > m_Capacity) return std::nullopt;
+
+    m_Head = end;
+    return start % m_Capacity;
+}
+
+void StagingRing::Close(uint64_t token)
+{
+    if (!HasOpenAllocations()) return;
+
+    if (!m_Closed.empty() && m_Closed.back().token > token)
+    {
+        throw std::invalid_argument(
+            "StagingRing: tokens must not decrease between Close() calls");
+    }
+    m_Closed.push_back({m_Head, token});
+    m_ClosedHead = m_Head;
+}
+
+void StagingRing::Retire(uint64_t completedToken)
+{
+    while (!m_Closed.empty() && m_Closed.front().token <= completedToken)
+    {
+        m_Tail = m_Closed.front().end;
+        m_Closed.pop_front();
+    }
+}
+
+std::optional<uint64_t> StagingRing::GetOldestToken() const
+{
+    if (m_Closed.empty()) return std::nullopt;
+    return m_Closed.front().token;
+}
+} // namespace Chimera
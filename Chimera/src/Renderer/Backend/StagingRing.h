@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+namespace Chimera
+{
+    // Allocator for a fixed-size staging buffer used as a ring. It hands out
+    // byte offsets only, so it holds no Vulkan objects and is tested on the
+    // CPU. Allocations are freed in the order they were made: Close() tags
+    // everything allocated since the previous Close() with a completion
+    // token, and Retire() frees every tagged range whose token the GPU has
+    // reached. Tokens passed to Close() must not decrease.
+    //
+    // An allocation never straddles the end of the buffer. If it does not
+    // fit in the bytes left before the end, those bytes are skipped and the
+    // allocation starts at offset 0. An empty ring also restarts at offset
+    // 0, so a block no larger than the capacity always fits once every
+    // older block is retired.
+class StagingRing
+{
+public:
+        // Throws std::invalid_argument if capacity is zero.
+    explicit StagingRing(uint64_t capacity);
+
+        // Returns the offset of a block of size bytes, or nullopt if the
+        // ring cannot hold it until older blocks are retired. alignment
+        // must be a power of two; zero counts as one. Blocks larger than
+        // the capacity never fit.
+    std::optional<uint64_t> Allocate(uint64_t size, uint64_t alignment = 1);
+
+        // Tags every block allocated since the last Close() with token.
+    void Close(uint64_t token);
+        // Frees the blocks of every closed token <= completedToken.
+    void Retire(uint64_t completedToken);
+
+        // Bytes in use, including padding and bytes skipped at wraparound.
+    uint64_t GetUsed() const
+    {
+        return m_Head - m_Tail;
+    }
+    uint64_t GetCapacity() const
+    {
+        return m_Capacity;
+    }
+        // True if blocks were allocated since the last Close().
+    bool HasOpenAllocations() const
+    {
+        return m_Head != m_ClosedHead;
+    }
+        // Oldest token still holding space, if any.
+    std::optional<uint64_t> GetOldestToken() const;
+
+private:
+    struct ClosedRange
+    {
+        uint64_t end; // Head position when the range was closed
+        uint64_t token;
+    };
+
+        // Positions grow without bound; the buffer offset is position %
+        // capacity. Used bytes are m_Head - m_Tail.
+    uint64_t m_Capacity;
+    uint64_t m_Head = 0;
+    uint64_t m_Tail = 0;
+    uint64_t m_ClosedHead = 0;
+    std::deque<ClosedRange> m_Closed;
+};
+} // namespace Chimera
@@ -0,0 +1,416 @@
+#include "pch.h"
+#include "UploadService.h"
+#include "VulkanContext.h"
+#include "Utils/VulkanBarrier.h"
+
+namespace Chimera
+{
+namespace
+{
+    // Covers the bufferOffset rules of vkCmdCopyBufferToImage on transfer
+    // queues (multiple of 4) and the texel size of every format up to 16
+    // bytes that is a power of two.
+constexpr VkDeviceSize ImageStagingAlignment = 16;
+
+VkCommandPool CreatePool(VkDevice device, uint32_t family)
+{
+    VkCommandPoolCreateInfo poolInfo{
+        VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = family;
+
+    VkCommandPool pool = VK_NULL_HANDLE;
+    VK_CHECK(vkCreateCommandPool(device, &poolInfo, nullptr, &pool));
+    return pool;
+}
+
+VkCommandBuffer BeginCommandBuffer(VkDevice device, VkCommandPool pool)
+{
+    VkCommandBufferAllocateInfo allocInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = pool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer cmd = VK_NULL_HANDLE;
+    VK_CHECK(vkAllocateCommandBuffers(device, &allocInfo, &cmd));
+
+    VkCommandBufferBeginInfo beginInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+    return cmd;
+}
+
+void RecordBarriers(VkCommandBuffer cmd,
+                    const std::vector<VkBufferMemoryBarrier2>& buffers,
+                    const std::vector<VkImageMemoryBarrier2>& images)
+{
+    if (buffers.empty() && images.empty()) return;
+
+    VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    dep.bufferMemoryBarrierCount = (uint32_t)buffers.size();
+    dep.pBufferMemoryBarriers = buffers.data();
+    dep.imageMemoryBarrierCount = (uint32_t)images.size();
+    dep.pImageMemoryBarriers = images.data();
+    vkCmdPipelineBarrier2(cmd, &dep);
+}
+} // namespace
+
+UploadService::UploadService(VulkanContext& context, VkDeviceSize ringSize)
+    : m_Device(context.GetDevice()),
+      m_TransferQueue(context.GetTransferQueue()),
+      m_GraphicsQueue(context.GetGraphicsQueue()),
+      m_TransferFamily(context.GetTransferQueueFamily()),
+      m_GraphicsFamily(context.GetGraphicsQueueFamily()),
+      m_Ring(ringSize)
+{
+    m_StagingBuffer = std::make_unique<Buffer>(
+        ringSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY,
+        "Upload_StagingRing");
+
+    m_TransferPool = CreatePool(m_Device, m_TransferFamily);
+    context.SetDebugName((uint64_t)m_TransferPool, VK_OBJECT_TYPE_COMMAND_POOL,
+                         "Upload_TransferPool");
+    if (UsesDedicatedTransferQueue())
+    {
+        m_AcquirePool = CreatePool(m_Device, m_GraphicsFamily);
+        context.SetDebugName((uint64_t)m_AcquirePool,
+                             VK_OBJECT_TYPE_COMMAND_POOL, "Upload_AcquirePool");
+    }
+
+    VkSemaphoreTypeCreateInfo typeInfo{
+        VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+    VkSemaphoreCreateInfo semaphoreInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
+    semaphoreInfo.pNext = &typeInfo;
+    VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_Timeline));
+    context.SetDebugName((uint64_t)m_Timeline, VK_OBJECT_TYPE_SEMAPHORE,
+                         "Upload_Timeline");
+
+    CH_CORE_INFO("UploadService: {} MB staging ring, {} transfer queue",
+                 ringSize / (1024 * 1024),
+                 UsesDedicatedTransferQueue() ? "dedicated" : "graphics");
+}
+
+UploadService::~UploadService()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        FlushLocked();
+    }
+    Wait(UploadToken{m_LastSubmittedValue});
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        RetireLocked();
+    }
+
+    vkDestroySemaphore(m_Device, m_Timeline, nullptr);
+    if (m_AcquirePool != VK_NULL_HANDLE)
+        vkDestroyCommandPool(m_Device, m_AcquirePool, nullptr);
+    vkDestroyCommandPool(m_Device, m_TransferPool, nullptr);
+}
+
+void UploadService::UploadBuffer(VkBuffer dst, const void* data,
+                                 VkDeviceSize size, VkDeviceSize dstOffset)
+{
+    if (dst == VK_NULL_HANDLE || !data || size == 0) return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto [staging, offset] = StageLocked(data, size, 4);
+    Batch& batch = GetOpenBatchLocked();
+
+    VkBufferCopy copy{offset, dstOffset, size};
+    vkCmdCopyBuffer(batch.transferCmd, staging, dst, 1, &copy);
+
+    VkBufferMemoryBarrier2 barrier{VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2};
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.srcQueueFamilyIndex = m_TransferFamily;
+    barrier.dstQueueFamilyIndex = m_GraphicsFamily;
+    barrier.buffer = dst;
+    barrier.offset = dstOffset;
+    barrier.size = size;
+    batch.bufferBarriers.push_back(barrier);
+}
+
+void UploadService::UploadImage(VkImage image, VkFormat format,
+                                VkExtent2D extent, const void* data,
+                                VkDeviceSize size, uint32_t mipLevels,
+                                VkImageLayout finalLayout)
+{
+    if (image == VK_NULL_HANDLE || !data || size == 0 || mipLevels == 0)
+        return;
+
+    const uint32_t texelSize = VulkanUtils::GetFormatTexelSize(format);
+        // Block-compressed levels are whole 4x4 blocks; imageExtent stays
+        // the level size, which the copy allows for partial edge blocks.
+    const uint32_t blockSize = VulkanUtils::GetCompressedBlockSize(format);
+    if (mipLevels > 1 && texelSize == 0 && blockSize == 0)
+        throw std::invalid_argument(
+            "UploadService: mip chains need a format with a known texel size");
+
+    std::vector<VkBufferImageCopy> regions(mipLevels);
+    VkDeviceSize chainSize = 0;
+    for (uint32_t level = 0; level < mipLevels; ++level)
+    {
+        const uint32_t w = std::max(extent.width >> level, 1u);
+        const uint32_t h = std::max(extent.height >> level, 1u);
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = chainSize;
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        region.imageExtent = {w, h, 1};
+        chainSize += blockSize != 0
+                         ? (VkDeviceSize)((w + 3) / 4) * ((h + 3) / 4) *
+                               blockSize
+                         : (VkDeviceSize)w * h * texelSize;
+    }
+    if (mipLevels > 1 && chainSize > size)
+        throw std::invalid_argument(
+            "UploadService: image data is smaller than its mip chain");
+
+    const VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0,
+                                        mipLevels, 0, 1};
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+        // Formats whose texel or block size does not divide the ring
+        // alignment (or is unknown) get a staging buffer of their own, which
+        // starts at offset 0.
+    const uint32_t copyUnit = blockSize != 0 ? blockSize : texelSize;
+    const bool ringAligned =
+        copyUnit != 0 && ImageStagingAlignment % copyUnit == 0;
+    auto [staging, offset] =
+        StageLocked(data, size, ringAligned ? ImageStagingAlignment : 0);
+    Batch& batch = GetOpenBatchLocked();
+
+    VkImageMemoryBarrier2 toTransfer{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+    toTransfer.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    toTransfer.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    toTransfer.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    toTransfer.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    toTransfer.image = image;
+    toTransfer.subresourceRange = range;
+    RecordBarriers(batch.transferCmd, {}, {toTransfer});
+
+    for (auto& region : regions) region.bufferOffset += offset;
+    vkCmdCopyBufferToImage(batch.transferCmd, staging, image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           (uint32_t)regions.size(), regions.data());
+
+    VkImageMemoryBarrier2 release{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+    release.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    release.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    release.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    release.newLayout = finalLayout;
+    release.srcQueueFamilyIndex = m_TransferFamily;
+    release.dstQueueFamilyIndex = m_GraphicsFamily;
+    release.image = image;
+    release.subresourceRange = range;
+    batch.imageBarriers.push_back(release);
+}
+
+UploadToken UploadService::Flush()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    RetireLocked();
+    return FlushLocked();
+}
+
+bool UploadService::IsComplete(UploadToken token) const
+{
+    return GetCompletedValue() >= token.value;
+}
+
+void UploadService::Wait(UploadToken token) const
+{
+    if (token.value == 0) return;
+
+    VkSemaphoreWaitInfo waitInfo{VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_Timeline;
+    waitInfo.pValues = &token.value;
+    VK_CHECK(vkWaitSemaphores(m_Device, &waitInfo, UINT64_MAX));
+}
+
+std::pair<VkBuffer, VkDeviceSize> UploadService::StageDedicatedLocked(
+    const void* data, VkDeviceSize size)
+{
+    auto staging = std::make_unique<Buffer>(
+        size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY,
+        "Upload_DedicatedStaging");
+    staging->Update(data, size);
+    VkBuffer handle = staging->GetBuffer();
+    GetOpenBatchLocked().ownedStaging.push_back(std::move(staging));
+    return {handle, 0};
+}
+
+std::pair<VkBuffer, VkDeviceSize> UploadService::StageLocked(
+    const void* data, VkDeviceSize size, VkDeviceSize alignment)
+{
+    if (alignment == 0 || size > m_Ring.GetCapacity())
+        return StageDedicatedLocked(data, size);
+
+    std::optional<uint64_t> offset = m_Ring.Allocate(size, alignment);
+    while (!offset)
+    {
+            // Nothing left to wait for, so the ring can never make room.
+        if (!m_Ring.HasOpenAllocations() && !m_Ring.GetOldestToken())
+            return StageDedicatedLocked(data, size);
+
+            // The ring is full of copies that have not landed yet. Submit
+            // what is open so its space can be reclaimed too, then wait for
+            // the oldest batch.
+        if (m_Ring.HasOpenAllocations()) FlushLocked();
+        Wait(UploadToken{m_Ring.GetOldestToken().value_or(0)});
+        RetireLocked();
+        offset = m_Ring.Allocate(size, alignment);
+    }
+
+    m_StagingBuffer->Update(data, size, *offset);
+    return {m_StagingBuffer->GetBuffer(), *offset};
+}
+
+UploadService::Batch& UploadService::GetOpenBatchLocked()
+{
+    if (!m_OpenBatch)
+    {
+        m_OpenBatch = std::make_unique<Batch>();
+        m_OpenBatch->transferCmd = BeginCommandBuffer(m_Device, m_TransferPool);
+    }
+    return *m_OpenBatch;
+}
+
+UploadToken UploadService::FlushLocked()
+{
+    if (!m_OpenBatch) return UploadToken{m_LastSubmittedValue};
+
+    std::unique_ptr<Batch> batch = std::move(m_OpenBatch);
+    const bool transferOwnership = UsesDedicatedTransferQueue();
+
+        // Without an ownership transfer the release barriers are plain
+        // barriers that make the copies visible to all later work on the
+        // queue.
+    if (!transferOwnership)
+    {
+        for (auto& barrier : batch->bufferBarriers)
+        {
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        }
+        for (auto& barrier : batch->imageBarriers)
+        {
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        }
+    }
+    RecordBarriers(batch->transferCmd, batch->bufferBarriers,
+                   batch->imageBarriers);
+    VK_CHECK(vkEndCommandBuffer(batch->transferCmd));
+
+    if (transferOwnership)
+    {
+            // The acquire half repeats each release barrier with the
+            // destination scope filled in instead of the source scope.
+        for (auto& barrier : batch->bufferBarriers)
+        {
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+            barrier.srcAccessMask = VK_ACCESS_2_NONE;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+        }
+        for (auto& barrier : batch->imageBarriers)
+        {
+            barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+            barrier.srcAccessMask = VK_ACCESS_2_NONE;
+            barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
+        }
+        batch->acquireCmd = BeginCommandBuffer(m_Device, m_AcquirePool);
+        RecordBarriers(batch->acquireCmd, batch->bufferBarriers,
+                       batch->imageBarriers);
+        VK_CHECK(vkEndCommandBuffer(batch->acquireCmd));
+    }
+
+    const uint64_t transferValue = m_LastSubmittedValue + 1;
+    batch->signalValue = transferOwnership ? transferValue + 1 : transferValue;
+
+    VkCommandBufferSubmitInfo transferCmdInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO};
+    transferCmdInfo.commandBuffer = batch->transferCmd;
+    VkSemaphoreSubmitInfo transferSignal{
+        VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO};
+    transferSignal.semaphore = m_Timeline;
+    transferSignal.value = transferValue;
+    transferSignal.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo2 transferSubmit{VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+    transferSubmit.commandBufferInfoCount = 1;
+    transferSubmit.pCommandBufferInfos = &transferCmdInfo;
+    transferSubmit.signalSemaphoreInfoCount = 1;
+    transferSubmit.pSignalSemaphoreInfos = &transferSignal;
+
+    VkCommandBufferSubmitInfo acquireCmdInfo{
+        VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO};
+    acquireCmdInfo.commandBuffer = batch->acquireCmd;
+    VkSemaphoreSubmitInfo acquireWait = transferSignal;
+    VkSemaphoreSubmitInfo acquireSignal = transferSignal;
+    acquireSignal.value = batch->signalValue;
+
+    VkSubmitInfo2 acquireSubmit{VK_STRUCTURE_TYPE_SUBMIT_INFO_2};
+    acquireSubmit.waitSemaphoreInfoCount = 1;
+    acquireSubmit.pWaitSemaphoreInfos = &acquireWait;
+    acquireSubmit.commandBufferInfoCount = 1;
+    acquireSubmit.pCommandBufferInfos = &acquireCmdInfo;
+    acquireSubmit.signalSemaphoreInfoCount = 1;
+    acquireSubmit.pSignalSemaphoreInfos = &acquireSignal;
+
+    {
+        std::lock_guard<std::mutex> lock(VulkanContext::GetGlobalQueueMutex());
+        VK_CHECK(vkQueueSubmit2(m_TransferQueue, 1, &transferSubmit,
+                                VK_NULL_HANDLE));
+        if (transferOwnership)
+        {
+            VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, 1, &acquireSubmit,
+                                    VK_NULL_HANDLE));
+        }
+    }
+
+    m_LastSubmittedValue = batch->signalValue;
+    m_Ring.Close(m_LastSubmittedValue);
+    m_InFlight.push_back(std::move(batch));
+    return UploadToken{m_LastSubmittedValue};
+}
+
+void UploadService::RetireLocked()
+{
+    const uint64_t completed = GetCompletedValue();
+    m_Ring.Retire(completed);
+
+    size_t retired = 0;
+    while (retired < m_InFlight.size() &&
+           m_InFlight[retired]->signalValue <= completed)
+    {
+        const Batch& batch = *m_InFlight[retired];
+        vkFreeCommandBuffers(m_Device, m_TransferPool, 1, &batch.transferCmd);
+        if (batch.acquireCmd != VK_NULL_HANDLE)
+            vkFreeCommandBuffers(m_Device, m_AcquirePool, 1, &batch.acquireCmd);
+        ++retired;
+    }
+    m_InFlight.erase(m_InFlight.begin(), m_InFlight.begin() + retired);
+}
+
+uint64_t UploadService::GetCompletedValue() const
+{
+    uint64_t value = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_Timeline, &value));
+    return value;
+}
+} // namespace Chimera
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "pch.h"
+#include "StagingRing.h"
+#include "Renderer/Resources/Buffer.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Chimera
+{
+class VulkanContext;
+
+    // Value of the upload timeline semaphore that signals once an upload
+    // has landed and is owned by the graphics queue. Zero is always
+    // complete.
+struct UploadToken
+{
+    uint64_t value = 0;
+};
+
+    // Streams CPU data into device-local buffers and images. Data is copied
+    // into a persistently mapped staging ring, copies are batched into one
+    // command buffer, and each Flush() submits the batch on the transfer
+    // queue without waiting for it.
+    //
+    // If the transfer queue belongs to another family, Flush() also submits
+    // the queue family ownership acquire on the graphics queue, waiting on
+    // the transfer submit through the timeline semaphore. Graphics work
+    // submitted after Flush() returns is therefore ordered after the upload
+    // without any CPU wait; tokens are for callers that need to know on the
+    // CPU, such as staging memory reuse or load progress.
+    //
+    // All methods may be called from any thread.
+class UploadService
+{
+public:
+    static constexpr VkDeviceSize DefaultRingSize = 64ull * 1024 * 1024;
+
+    explicit UploadService(VulkanContext& context,
+                           VkDeviceSize ringSize = DefaultRingSize);
+    ~UploadService();
+
+    UploadService(const UploadService&) = delete;
+    UploadService& operator=(const UploadService&) = delete;
+
+        // Record a copy into the open batch. data is copied before these
+        // return. Uploads larger than the ring get a staging buffer of
+        // their own, freed once the batch completes. Destinations must not
+        // be in use by the GPU; these are meant for newly created
+        // resources.
+    void UploadBuffer(VkBuffer dst, const void* data, VkDeviceSize size,
+                      VkDeviceSize dstOffset = 0);
+        // Fills mips [0, mipLevels) of a single-layer color image from
+        // tightly packed texels, level 0 first (the MipChain layout), and
+        // leaves them in finalLayout. extent is the size of level 0. The
+        // previous contents are discarded.
+    void UploadImage(VkImage image, VkFormat format, VkExtent2D extent,
+                     const void* data, VkDeviceSize size,
+                     uint32_t mipLevels = 1,
+                     VkImageLayout finalLayout =
+                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        // Submits the open batch. The token covers everything recorded by
+        // any thread before the call, including work another thread's
+        // Flush() already submitted.
+    UploadToken Flush();
+
+    bool IsComplete(UploadToken token) const;
+    void Wait(UploadToken token) const;
+
+    bool UsesDedicatedTransferQueue() const
+    {
+        return m_TransferFamily != m_GraphicsFamily;
+    }
+
+private:
+    struct Batch
+    {
+        VkCommandBuffer transferCmd = VK_NULL_HANDLE;
+        VkCommandBuffer acquireCmd = VK_NULL_HANDLE;
+        std::vector<VkBufferMemoryBarrier2> bufferBarriers;
+        std::vector<VkImageMemoryBarrier2> imageBarriers;
+        std::vector<std::unique_ptr<Buffer>> ownedStaging;
+        uint64_t signalValue = 0;
+    };
+
+        // Returns the staging buffer and offset holding a copy of data. An
+        // alignment of 0 asks for a dedicated staging buffer.
+    std::pair<VkBuffer, VkDeviceSize> StageLocked(const void* data,
+                                                  VkDeviceSize size,
+                                                  VkDeviceSize alignment);
+        // Copies data into a staging buffer owned by the open batch.
+    std::pair<VkBuffer, VkDeviceSize> StageDedicatedLocked(const void* data,
+                                                           VkDeviceSize size);
+    Batch& GetOpenBatchLocked();
+    UploadToken FlushLocked();
+    void RetireLocked();
+    uint64_t GetCompletedValue() const;
+
+private:
+    VkDevice m_Device = VK_NULL_HANDLE;
+    VkQueue m_TransferQueue = VK_NULL_HANDLE;
+    VkQueue m_GraphicsQueue = VK_NULL_HANDLE;
+    uint32_t m_TransferFamily = 0;
+    uint32_t m_GraphicsFamily = 0;
+
+    VkCommandPool m_TransferPool = VK_NULL_HANDLE;
+    VkCommandPool m_AcquirePool = VK_NULL_HANDLE; // Graphics family
+    VkSemaphore m_Timeline = VK_NULL_HANDLE;
+
+    std::mutex m_Mutex;
+    std::unique_ptr<Buffer> m_StagingBuffer;
+    StagingRing m_Ring;
+    std::unique_ptr<Batch> m_OpenBatch;
+    std::vector<std::unique_ptr<Batch>> m_InFlight; // Oldest first
+    uint64_t m_LastSubmittedValue = 0;
+};
+} // namespace Chimera
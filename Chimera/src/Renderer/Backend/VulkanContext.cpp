@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "VulkanContext.h"
+#include "UploadService.h"
 #include "Core/Application.h"
 
 namespace Chimera
@@ -62,6 +63,7 @@ VulkanContext::~VulkanContext()
 
         // 1. First flush everything pending in the queue
     m_DeletionQueue.FlushAll();
+    m_UploadService.reset();
 
         // 2. Kill the swapchain while device is still idle
     if (m_Swapchain)
@@ -187,6 +189,16 @@ void VulkanContext::SetDebugName(uint64_t handle, VkObjectType type,
     }
 }
 
+UploadService& VulkanContext::GetUploadService()
+{
+    std::lock_guard<std::mutex> lock(m_UploadServiceMutex);
+    if (!m_UploadService)
+    {
+        m_UploadService = std::make_unique<UploadService>(*this);
+    }
+    return *m_UploadService;
+}
+
 VkCommandPool VulkanContext::GetThreadLocalCommandPool()
 {
     std::thread::id tid = std::this_thread::get_id();
@@ -11,6 +11,8 @@
 
 namespace Chimera
 {
+class UploadService;
+
 class VulkanContext : public std::enable_shared_from_this<VulkanContext>
 {
 public:
@@ -69,6 +71,14 @@ public:
     {
         return m_Device->GetComputeQueueFamily();
     }
+    VkQueue GetTransferQueue() const
+    {
+        return m_Device->GetTransferQueue();
+    }
+    uint32_t GetTransferQueueFamily() const
+    {
+        return m_Device->GetTransferQueueFamily();
+    }
 
     VkCommandPool GetCommandPool() const
     {
@@ -120,10 +130,19 @@ public:
     {
         return m_Device->IsRayTracingSupported();
     }
+
+    bool IsTextureCompressionBCSupported() const
+    {
+        return m_Device->IsTextureCompressionBCSupported();
+    }
     const VkPhysicalDeviceProperties& GetDeviceProperties() const
     {
         return m_Device->GetProperties();
     }
+    const VkPhysicalDeviceVulkan12Properties& GetVulkan12Properties() const
+    {
+        return m_Device->GetVulkan12Properties();
+    }
     const VkPhysicalDeviceRayTracingPipelinePropertiesKHR&
     GetRayTracingProperties() const
     {
@@ -149,6 +168,10 @@ public:
         return m_DeletionQueue;
     }
 
+        // Created on first use, since its staging buffer allocates through
+        // VulkanContext::Get().
+    UploadService& GetUploadService();
+
 private:
     VulkanContext();
     void CreateSurface();
@@ -170,5 +193,8 @@ private:
 
     std::mutex m_PoolMutex;
     std::unordered_map<std::thread::id, VkCommandPool> m_ThreadCommandPools;
+
+    std::mutex m_UploadServiceMutex;
+    std::unique_ptr<UploadService> m_UploadService;
 };
 } // namespace Chimera
@@ -115,6 +115,11 @@ void VulkanDevice::PickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface)
         CH_CORE_INFO("Ray Tracing Extensions Available: {}",
                      m_RayTracingSupported ? "YES" : "NO");
 
+        m_Vulkan12Properties.sType =
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+        VkPhysicalDeviceProperties2 prop2{
+            VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
+        prop2.pNext = &m_Vulkan12Properties;
         if (m_RayTracingSupported)
         {
             m_RayTracingProperties.sType =
@@ -123,11 +128,11 @@ void VulkanDevice::PickPhysicalDevice(VkInstance instance, VkSurfaceKHR surface)
                 VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR;
             m_RayTracingProperties.pNext =
                 &m_AccelerationStructureProperties;
-            VkPhysicalDeviceProperties2 prop2{
-                VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2};
-            prop2.pNext = &m_RayTracingProperties;
-            vkGetPhysicalDeviceProperties2(m_PhysicalDevice, &prop2);
+            m_Vulkan12Properties.pNext = &m_RayTracingProperties;
         }
+        vkGetPhysicalDeviceProperties2(m_PhysicalDevice, &prop2);
+        m_Vulkan12Properties.pNext = nullptr;
+        m_RayTracingProperties.pNext = nullptr;
     }
     else
     {
@@ -175,6 +180,8 @@ void VulkanDevice::CreateLogicalDevice(VkSurfaceKHR surface)
     CH_CORE_INFO("  samplerAnisotropy: {}",
                  YesNo(supported.features.samplerAnisotropy));
     CH_CORE_INFO("  shaderInt64: {}", YesNo(supported.features.shaderInt64));
+    CH_CORE_INFO("  textureCompressionBC: {}",
+                 YesNo(supported.features.textureCompressionBC));
 
     CH_CORE_INFO("[Vulkan 1.2]");
     CH_CORE_INFO("  bufferDeviceAddress: {}",
@@ -196,6 +203,8 @@ void VulkanDevice::CreateLogicalDevice(VkSurfaceKHR surface)
     CH_CORE_INFO("  scalarBlockLayout: {}",
                  YesNo(supported12.scalarBlockLayout));
     CH_CORE_INFO("  hostQueryReset: {}", YesNo(supported12.hostQueryReset));
+    CH_CORE_INFO("  timelineSemaphore: {}",
+                 YesNo(supported12.timelineSemaphore));
 
     CH_CORE_INFO("[Vulkan 1.3]");
     CH_CORE_INFO("  dynamicRendering: {}", YesNo(supported13.dynamicRendering));
@@ -279,7 +288,8 @@ void VulkanDevice::CreateLogicalDevice(VkSurfaceKHR surface)
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
     std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(),
                                               indices.computeFamily.value(),
-                                              indices.presentFamily.value()};
+                                              indices.presentFamily.value(),
+                                              indices.transferFamily.value()};
 
     float queuePriorities[] = {
         1.0f, 1.0f}; // Request up to 2 queues if in same family
@@ -314,6 +324,10 @@ void VulkanDevice::CreateLogicalDevice(VkSurfaceKHR surface)
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
     deviceFeatures.shaderInt64 = VK_TRUE;
+    m_TextureCompressionBCSupported =
+        supported.features.textureCompressionBC == VK_TRUE;
+    deviceFeatures.textureCompressionBC =
+        m_TextureCompressionBCSupported ? VK_TRUE : VK_FALSE;
 
     std::vector<const char*> enabledExtensions;
     for (auto ext : requiredDeviceExtensions)
@@ -340,6 +354,7 @@ void VulkanDevice::CreateLogicalDevice(VkSurfaceKHR surface)
     vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
     vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
     vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
 
     VkPhysicalDeviceVulkan13Features vulkan13Features{
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES};
@@ -422,6 +437,17 @@ void VulkanDevice::CreateLogicalDevice(VkSurfaceKHR surface)
 
     vkGetDeviceQueue(m_LogicalDevice, indices.presentFamily.value(), 0,
                      &m_PresentQueue);
+
+    m_TransferQueueFamily = indices.transferFamily.value();
+    if (m_TransferQueueFamily == m_GraphicsQueueFamily)
+    {
+        m_TransferQueue = m_GraphicsQueue;
+    }
+    else
+    {
+        vkGetDeviceQueue(m_LogicalDevice, m_TransferQueueFamily, 0,
+                         &m_TransferQueue);
+    }
 }
 
 void VulkanDevice::CreateAllocator(VkInstance instance)
@@ -516,6 +542,23 @@ QueueFamilyIndices VulkanDevice::FindQueueFamilies(VkPhysicalDevice device,
         indices.computeFamily = indices.graphicsFamily;
     }
 
+    // Uploads prefer a transfer-only family (the DMA engines on discrete
+    // GPUs) and otherwise share the graphics queue
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const VkQueueFlags flags = families[i].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) &&
+            !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+        {
+            indices.transferFamily = i;
+            break;
+        }
+    }
+    if (!indices.transferFamily.has_value())
+    {
+        indices.transferFamily = indices.graphicsFamily;
+    }
+
     return indices;
 }
 
@@ -8,6 +8,7 @@ struct QueueFamilyIndices
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> computeFamily;
     std::optional<uint32_t> presentFamily;
+    std::optional<uint32_t> transferFamily;
     bool isComplete()
     {
         return graphicsFamily.has_value() && computeFamily.has_value() &&
@@ -44,6 +45,16 @@ public:
     uint32_t GetComputeQueueFamily() const
     {
         return m_ComputeQueueFamily;
+    }
+        // Queue of a transfer-only family if the device has one, otherwise
+        // the graphics queue.
+    VkQueue GetTransferQueue() const
+    {
+        return m_TransferQueue;
+    }
+    uint32_t GetTransferQueueFamily() const
+    {
+        return m_TransferQueueFamily;
     }
     VkQueue GetPresentQueue() const
     {
@@ -60,11 +71,24 @@ public:
         return m_RayTracingSupported;
     }
 
+        // Optional; textures fall back to uncompressed formats without it.
+    bool IsTextureCompressionBCSupported() const
+    {
+        return m_TextureCompressionBCSupported;
+    }
+
     const VkPhysicalDeviceProperties& GetProperties() const
     {
         return m_DeviceProperties;
     }
 
+        // Descriptor indexing limits live here (the update-after-bind
+        // counts size the bindless texture table).
+    const VkPhysicalDeviceVulkan12Properties& GetVulkan12Properties() const
+    {
+        return m_Vulkan12Properties;
+    }
+
     const VkPhysicalDeviceRayTracingPipelinePropertiesKHR& GetRTProperties()
         const
     {
@@ -102,6 +126,7 @@ private:
     VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
     VkDevice m_LogicalDevice = VK_NULL_HANDLE;
     VkPhysicalDeviceProperties m_DeviceProperties{};
+    VkPhysicalDeviceVulkan12Properties m_Vulkan12Properties{};
     VkPhysicalDeviceRayTracingPipelinePropertiesKHR m_RayTracingProperties{};
     VkPhysicalDeviceAccelerationStructurePropertiesKHR
         m_AccelerationStructureProperties{};
@@ -109,10 +134,13 @@ private:
     VkQueue m_GraphicsQueue = VK_NULL_HANDLE;
     VkQueue m_ComputeQueue = VK_NULL_HANDLE;
     VkQueue m_PresentQueue = VK_NULL_HANDLE;
+    VkQueue m_TransferQueue = VK_NULL_HANDLE;
     uint32_t m_GraphicsQueueFamily = 0;
     uint32_t m_ComputeQueueFamily = 0;
+    uint32_t m_TransferQueueFamily = 0;
 
     VmaAllocator m_Allocator = VK_NULL_HANDLE;
     bool m_RayTracingSupported = false;
+    bool m_TextureCompressionBCSupported = false;
 };
 } // namespace Chimera
@@ -16,10 +16,25 @@ ComputeExecutionContext::ComputeExecutionContext(RenderGraph& graph,
 {
 }
 
-void ComputeExecutionContext::BindPipeline(const std::string& shaderName)
+bool ComputeExecutionContext::BindPipeline(const std::string& shaderName,
+                                           const std::string& fallbackShaderName)
 {
-    auto& pipe =
-        PipelineManager::Get().GetComputePipeline({shaderName, shaderName});
+    m_RequestedShader = shaderName;
+
+    ComputePipeline* pipeline =
+        PipelineManager::Get().RequestComputePipeline({shaderName, shaderName});
+    if (!pipeline && !fallbackShaderName.empty())
+    {
+        pipeline = &PipelineManager::Get().GetComputePipeline(
+            {fallbackShaderName, fallbackShaderName});
+    }
+    if (!pipeline)
+    {
+        m_ActiveLayout = VK_NULL_HANDLE;
+        return false;
+    }
+
+    auto& pipe = *pipeline;
 
         // --- Record Shader Name ---
     bool alreadyAdded = false;
@@ -151,13 +166,17 @@ void ComputeExecutionContext::BindPipeline(const std::string& shaderName)
                                 pipe.layout, 2, 1, &m_Pass.descriptorSet, 0,
                                 nullptr);
     }
+    return true;
 }
 
 void ComputeExecutionContext::Dispatch(const std::string& shaderName,
                                        uint32_t groupX, uint32_t groupY,
                                        uint32_t groupZ)
 {
-    BindPipeline(shaderName);
+    // Keep whatever BindPipeline() settled on (including a fallback) when the
+    // pass already bound this kernel.
+    if (m_RequestedShader != shaderName) BindPipeline(shaderName);
+    if (!IsPipelineReady()) return;
     vkCmdDispatch(m_Cmd, groupX, groupY, groupZ);
 }
 } // namespace Chimera
@@ -9,8 +9,14 @@ public:
     ComputeExecutionContext(RenderGraph& graph, RenderGraphPass& pass,
                             VkCommandBuffer cmd);
 
-    void BindPipeline(const std::string& shaderName);
+        // Returns false if neither kernel is ready. The fallback kernel is
+        // compiled synchronously when the primary one is still pending.
+    bool BindPipeline(const std::string& shaderName,
+                      const std::string& fallbackShaderName = "");
     void Dispatch(const std::string& shaderName, uint32_t groupX,
                   uint32_t groupY, uint32_t groupZ = 1);
+
+private:
+    std::string m_RequestedShader;
 };
 } // namespace Chimera
@@ -26,6 +26,14 @@ public:
         return m_Graph;
     }
 
+        // False while the last BindPipeline() is still compiling in the
+        // background; draws, dispatches and push constants are dropped so the
+        // pass is skipped for this frame.
+    bool IsPipelineReady() const
+    {
+        return m_ActiveLayout != VK_NULL_HANDLE;
+    }
+
         // Unified PushConstants implementation
     void PushConstants(VkShaderStageFlags stages, const void* data,
                        uint32_t size);
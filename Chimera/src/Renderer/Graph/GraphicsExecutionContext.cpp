@@ -3,6 +3,7 @@
 #include "GraphicsExecutionContext.h"
 #include "RenderGraphCommon.h"
 #include "Renderer/Backend/PipelineManager.h"
+#include "Renderer/Backend/RenderFlagPermutation.h"
 #include "Renderer/Backend/VulkanContext.h"
 #include "Renderer/Backend/Shader.h"
 #include "Renderer/Resources/ResourceManager.h"
@@ -146,11 +147,24 @@ void GraphicsExecutionContext::BindPipelineAndDescriptorSets(
                                 &m_Pass.descriptorSet, 0, nullptr);
 }
 
-void GraphicsExecutionContext::BindPipeline(
-    const GraphicsPipelineDescription& desc)
+bool GraphicsExecutionContext::BindPipeline(
+    const GraphicsPipelineDescription& desc,
+    const GraphicsPipelineDescription* fallback)
 {
-    auto& pipe = PipelineManager::Get().GetGraphicsPipeline(
+    GraphicsPipeline* pipeline = PipelineManager::Get().RequestGraphicsPipeline(
         m_Pass.colorFormats, m_Pass.depthFormat, desc);
+    if (!pipeline && fallback)
+    {
+        pipeline = &PipelineManager::Get().GetGraphicsPipeline(
+            m_Pass.colorFormats, m_Pass.depthFormat, *fallback);
+    }
+    if (!pipeline)
+    {
+        m_ActiveLayout = VK_NULL_HANDLE;
+        return false;
+    }
+
+    auto& pipe = *pipeline;
     for (auto* s : pipe.shaders)
     {
         if (s)
@@ -163,13 +177,35 @@ void GraphicsExecutionContext::BindPipeline(
     }
     BindPipelineAndDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, pipe.handle,
                                   pipe.layout, pipe.shaders);
+    return true;
+}
+
+bool GraphicsExecutionContext::BindPipeline(
+    const GraphicsPipelineDescription& desc,
+    const RenderFlagPermutation& permutation)
+{
+    const RenderFlags flags = Application::Get().GetFrameContext().RenderFlags;
+    return BindPipeline(permutation.Select(desc, flags)) ||
+           BindPipeline(permutation.SelectDynamic(desc));
 }
 
 void GraphicsExecutionContext::DrawMeshes(
     const GraphicsPipelineDescription& desc, Scene* scene)
 {
-    BindPipeline(desc);
+    if (!BindPipeline(desc)) return;
+    DrawBoundMeshes(scene);
+}
 
+void GraphicsExecutionContext::DrawMeshes(
+    const GraphicsPipelineDescription& desc,
+    const RenderFlagPermutation& permutation, Scene* scene)
+{
+    if (!BindPipeline(desc, permutation)) return;
+    DrawBoundMeshes(scene);
+}
+
+void GraphicsExecutionContext::DrawBoundMeshes(Scene* scene)
+{
     if (!scene)
     {
         vkCmdDraw(m_Cmd, 3, 1, 0, 0);
@@ -4,6 +4,7 @@
 namespace Chimera
 {
 class Shader;
+class RenderFlagPermutation;
 
 class GraphicsExecutionContext : public ExecutionContext
 {
@@ -11,7 +12,16 @@ public:
     GraphicsExecutionContext(RenderGraph& graph, RenderGraphPass& pass,
                              VkCommandBuffer cmd);
 
-    void BindPipeline(const struct GraphicsPipelineDescription& desc);
+        // Returns false if neither desc nor the optional fallback is ready.
+        // The fallback is compiled synchronously, so it should be cheap.
+    bool BindPipeline(const struct GraphicsPipelineDescription& desc,
+                      const struct GraphicsPipelineDescription* fallback =
+                          nullptr);
+        // Binds the variant of desc for this frame's RenderFlags. While it
+        // compiles the dynamic variant is used instead; returns false if
+        // neither is ready. Never compiles synchronously.
+    bool BindPipeline(const struct GraphicsPipelineDescription& desc,
+                      const RenderFlagPermutation& permutation);
     void BindPipelineAndDescriptorSets(
         VkPipelineBindPoint bindPoint, VkPipeline handle,
         VkPipelineLayout layout, const std::vector<const Shader*>& shaders);
@@ -20,6 +30,7 @@ public:
                      uint32_t firstIndex, int32_t vertexOffset,
                      uint32_t firstInstance)
     {
+        if (!IsPipelineReady()) return;
         vkCmdDrawIndexed(m_Cmd, indexCount, instanceCount, firstIndex,
                          vertexOffset, firstInstance);
     }
@@ -54,6 +65,12 @@ public:
 
     void DrawMeshes(const struct GraphicsPipelineDescription& desc,
                     class Scene* scene);
+    void DrawMeshes(const struct GraphicsPipelineDescription& desc,
+                    const RenderFlagPermutation& permutation,
+                    class Scene* scene);
     void DispatchRays(const struct RaytracingPipelineDescription& desc);
+
+private:
+    void DrawBoundMeshes(class Scene* scene);
 };
 } // namespace Chimera
@@ -20,17 +20,32 @@ RaytracingExecutionContext::RaytracingExecutionContext(RenderGraph& graph,
 
 static RaytracingPipeline* s_ActiveRTPipe = nullptr;
 
-void RaytracingExecutionContext::BindPipeline(const std::string& name)
+bool RaytracingExecutionContext::BindPipeline(const std::string& name)
 {
     RaytracingPipelineDescription desc;
     desc.raygen_shader = name;
-    BindPipeline(desc);
+    return BindPipeline(desc);
 }
 
-void RaytracingExecutionContext::BindPipeline(
-    const RaytracingPipelineDescription& desc)
+bool RaytracingExecutionContext::BindPipeline(
+    const RaytracingPipelineDescription& desc,
+    const RaytracingPipelineDescription* fallback)
 {
-    auto& pipe = PipelineManager::Get().GetRaytracingPipeline(desc);
+    RaytracingPipeline* pipeline =
+        PipelineManager::Get().RequestRaytracingPipeline(desc);
+    if (!pipeline && fallback)
+    {
+        pipeline = &PipelineManager::Get().GetRaytracingPipeline(*fallback);
+    }
+    if (!pipeline)
+    {
+        // Also forget the previous pass's pipeline so TraceRays() is a no-op.
+        m_ActiveLayout = VK_NULL_HANDLE;
+        s_ActiveRTPipe = nullptr;
+        return false;
+    }
+
+    auto& pipe = *pipeline;
 
         // --- Record Shader Names [NEW] ---
     for (auto* s : pipe.shaders)
@@ -172,12 +187,13 @@ void RaytracingExecutionContext::BindPipeline(
                                 nullptr);
     }
     s_ActiveRTPipe = &pipe;
+    return true;
 }
 
 void RaytracingExecutionContext::TraceRays(uint32_t width, uint32_t height,
                                            uint32_t depth)
 {
-    if (s_ActiveRTPipe)
+    if (s_ActiveRTPipe && IsPipelineReady())
     {
         vkCmdTraceRaysKHR(m_Cmd, &s_ActiveRTPipe->sbt.raygen,
                           &s_ActiveRTPipe->sbt.miss, &s_ActiveRTPipe->sbt.hit,
@@ -11,8 +11,12 @@ public:
     virtual ~RaytracingExecutionContext() = default;
 
         // Support both direct shader name and full description
-    void BindPipeline(const std::string& name);
-    void BindPipeline(const struct RaytracingPipelineDescription& desc);
+        // Both return false if the pipeline (and optional fallback) is not
+        // ready; the fallback is compiled synchronously.
+    bool BindPipeline(const std::string& name);
+    bool BindPipeline(const struct RaytracingPipelineDescription& desc,
+                      const struct RaytracingPipelineDescription* fallback =
+                          nullptr);
 
     void TraceRays(uint32_t w, uint32_t h, uint32_t d = 1);
 };
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "RenderGraph.h"
 #include "Renderer/Backend/VulkanContext.h"
+#include "Renderer/Backend/PipelineManager.h"
+#include "Renderer/Backend/RenderFlagPermutation.h"
 #include "GraphicsExecutionContext.h"
 #include "ComputeExecutionContext.h"
 #include "RaytracingExecutionContext.h"
@@ -10,9 +12,13 @@
 #include "Renderer/Graph/ResourceNames.h"
 #include <sstream>
 #include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <limits>
 #include <unordered_set>
 #include <set>
 #include <imgui.h>
+#include <vulkan/vk_enum_string_helper.h>
 
 namespace Chimera
 {
@@ -62,6 +68,14 @@ static bool IsDescriptorUsage(ResourceUsage usage)
     }
 }
 
+    // How a pass samples an image it reads by name alone, e.g. history.
+static ResourceUsage SampledUsage(const RenderGraphPass& pass)
+{
+    if (pass.isRaytracing) return ResourceUsage::RaytraceSampled;
+    return pass.isCompute ? ResourceUsage::ComputeSampled
+                          : ResourceUsage::GraphicsSampled;
+}
+
 static ResourceState GetStateFromUsage(ResourceUsage usage, bool isDepth)
 {
     ResourceState state{};
@@ -130,6 +144,40 @@ static ResourceState GetStateFromUsage(ResourceUsage usage, bool isDepth)
     return state;
 }
 
+static std::string EscapeJsonString(const std::string& value)
+{
+    std::string escaped;
+    escaped.reserve(value.size() + 2);
+    escaped.push_back('"');
+
+    for (char character : value)
+    {
+        switch (character)
+        {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(character) < 0x20)
+                {
+                    char code[8];
+                    std::snprintf(code, sizeof(code), "\\u%04x", character);
+                    escaped += code;
+                }
+                else
+                {
+                    escaped.push_back(character);
+                }
+                break;
+        }
+    }
+
+    escaped.push_back('"');
+    return escaped;
+}
+
 bool SupportsImageUsage(VkImageUsageFlags actualUsage, ResourceUsage requestUsage)
 {
     if (requestUsage == ResourceUsage::None)
@@ -630,6 +678,11 @@ void RenderGraph::FetchQueryResults()
     {
         m_LatestTimings.clear();
         float period = m_Context->GetDeviceProperties().limits.timestampPeriod;
+
+        uint64_t frameStart = std::numeric_limits<uint64_t>::max();
+        for (uint32_t i = 0; i < (uint32_t)m_LastPassNames.size(); ++i)
+            frameStart = std::min(frameStart, results[i * 2]);
+
         for (uint32_t i = 0; i < (uint32_t)m_LastPassNames.size(); ++i)
         {
             uint64_t start = results[i * 2];
@@ -637,12 +690,49 @@ void RenderGraph::FetchQueryResults()
             float durationMs = (end > start)
                                    ? (float)(end - start) * period / 1000000.0f
                                    : 0.0f;
-            m_LatestTimings.push_back({m_LastPassNames[i], durationMs});
+
+            PassTiming timing{m_LastPassNames[i], durationMs};
+            timing.startMS = (float)(start - frameStart) * period / 1000000.0f;
+
+            // CPU recording times still belong to the frame being resolved:
+            // Execute() overwrites them only after this fetch.
+            if (i < m_LastPassCpuDurationMS.size())
+            {
+                timing.cpuStartMS = m_LastPassCpuStartMS[i];
+                timing.cpuDurationMS = m_LastPassCpuDurationMS[i];
+            }
+            m_LatestTimings.push_back(std::move(timing));
         }
         ++m_TimingSampleId;
     }
 }
 
+uint32_t RenderGraph::PrewarmPipelines()
+{
+    if (!m_Context) return 0;
+
+    auto& pipelines = PipelineManager::Get();
+    uint32_t pending = 0;
+    for (const auto& pass : m_PassStack)
+    {
+        for (const auto& desc : pass.graphicsPipelines)
+        {
+            if (!pipelines.RequestGraphicsPipeline(pass.colorFormats,
+                                                   pass.depthFormat, desc))
+                ++pending;
+        }
+        for (const auto& desc : pass.raytracingPipelines)
+        {
+            if (!pipelines.RequestRaytracingPipeline(desc)) ++pending;
+        }
+        for (const auto& kernel : pass.computeKernels)
+        {
+            if (!pipelines.RequestComputePipeline(kernel)) ++pending;
+        }
+    }
+    return pending;
+}
+
 VkSemaphore RenderGraph::Execute(VkCommandBuffer cmd)
 {
     if (m_PassStack.empty())
@@ -670,6 +760,11 @@ VkSemaphore RenderGraph::Execute(VkCommandBuffer cmd)
 
     m_LastPassNames.clear();
     for (const auto& pass : m_PassStack) m_LastPassNames.push_back(pass.name);
+    m_LastPassCpuStartMS.assign(m_PassStack.size(), 0.0f);
+    m_LastPassCpuDurationMS.assign(m_PassStack.size(), 0.0f);
+
+    using Clock = std::chrono::high_resolution_clock;
+    const auto recordStart = Clock::now();
 
     for (const auto& layer : m_ParallelLayers)
     {
@@ -679,6 +774,8 @@ VkSemaphore RenderGraph::Execute(VkCommandBuffer cmd)
         for (uint32_t passIdx : layer)
         {
             auto& pass = m_PassStack[passIdx];
+            const auto passStart = Clock::now();
+
             // Start Timestamp
             WriteTimestamp(cmd, passIdx * 2,
                            VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT);
@@ -709,6 +806,15 @@ VkSemaphore RenderGraph::Execute(VkCommandBuffer cmd)
             // End Timestamp
             WriteTimestamp(cmd, passIdx * 2 + 1,
                            VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT);
+
+            const auto passEnd = Clock::now();
+            m_LastPassCpuStartMS[passIdx] =
+                std::chrono::duration<float, std::milli>(passStart -
+                                                         recordStart)
+                    .count();
+            m_LastPassCpuDurationMS[passIdx] =
+                std::chrono::duration<float, std::milli>(passEnd - passStart)
+                    .count();
         }
     }
 
@@ -864,18 +970,14 @@ RGResourceHandle RenderGraph::PassBuilder::ReadHistory(const std::string& name,
             graph.m_Resources[h].currentState = hist.state;
         }
 
-        ResourceRequest request{
-            h, pass.isCompute ? ResourceUsage::ComputeSampled
-                              : ResourceUsage::GraphicsSampled};
+        ResourceRequest request{h, SampledUsage(pass)};
         request.name = historyName;
         request.bindingName = bindingName;
         pass.inputs.push_back(std::move(request));
         return h;
     }
 
-    ResourceRequest request{INVALID_RESOURCE,
-                            pass.isCompute ? ResourceUsage::ComputeSampled
-                                           : ResourceUsage::GraphicsSampled};
+    ResourceRequest request{INVALID_RESOURCE, SampledUsage(pass)};
 
     request.name = name;
     request.bindingName = bindingName;
@@ -902,10 +1004,38 @@ RGResourceHandle RenderGraph::PassBuilder::ReadHistorySafe(
         return ReadHistory(name, bindingName);
     }
 
+    if (pass.isRaytracing) return ReadRaytrace(fallbackName, bindingName);
     return pass.isCompute ? ReadCompute(fallbackName, bindingName)
                           : Read(fallbackName, bindingName);
 }
 
+void RenderGraph::PassBuilder::DeclarePipeline(
+    const GraphicsPipelineDescription& desc)
+{
+    pass.graphicsPipelines.push_back(desc);
+}
+
+void RenderGraph::PassBuilder::DeclarePipeline(
+    const GraphicsPipelineDescription& desc,
+    const RenderFlagPermutation& permutation, uint32_t renderFlags)
+{
+    pass.graphicsPipelines.push_back(permutation.Select(desc, renderFlags));
+    pass.graphicsPipelines.push_back(permutation.SelectDynamic(desc));
+}
+
+void RenderGraph::PassBuilder::DeclarePipeline(
+    const RaytracingPipelineDescription& desc)
+{
+    pass.raytracingPipelines.push_back(desc);
+}
+
+void RenderGraph::PassBuilder::DeclareKernel(
+    const std::string& shader,
+    const std::vector<uint32_t>& specializationConstants)
+{
+    pass.computeKernels.push_back({shader, shader, specializationConstants});
+}
+
 ResourceHandleProxy& ResourceHandleProxy::AllowUsage(VkImageUsageFlags additionalUsage)
 {
     graph.m_Resources[handle].desc.usage |= additionalUsage;
@@ -1263,6 +1393,351 @@ std::string RenderGraph::ExportToMermaid() const
     return ss.str();
 }
 
+    // Bytes of graph-owned resources in use while the pass at an execution
+    // position runs.
+static uint64_t LiveBytesAt(const RenderGraphProfile& profile,
+                            uint32_t position)
+{
+    uint64_t liveBytes = 0;
+    for (const ResourceProfile& res : profile.resources)
+    {
+        if (res.isExternal || res.firstPass == 0xFFFFFFFF) continue;
+        if (profile.passes[res.firstPass].position <= position &&
+            position <= profile.passes[res.lastPass].position)
+            liveBytes += res.sizeBytes;
+    }
+    return liveBytes;
+}
+
+RenderGraphProfile RenderGraph::BuildProfile() const
+{
+    RenderGraphProfile profile;
+    const uint32_t passCount = static_cast<uint32_t>(m_PassStack.size());
+
+    // Timings are one frame behind and only valid for the same pass list.
+    bool timingsMatch = m_LatestTimings.size() == passCount;
+    for (uint32_t i = 0; timingsMatch && i < passCount; ++i)
+    {
+        timingsMatch = m_LatestTimings[i].name == m_PassStack[i].name;
+    }
+    profile.hasTimings = timingsMatch && passCount > 0;
+
+    profile.passes.resize(passCount);
+    for (uint32_t i = 0; i < passCount; ++i)
+    {
+        const RenderGraphPass& pass = m_PassStack[i];
+        PassProfile& passProfile = profile.passes[i];
+        passProfile.name = pass.name;
+        passProfile.type = pass.isCompute      ? "compute"
+                           : pass.isRaytracing ? "raytracing"
+                                               : "graphics";
+        passProfile.index = i;
+
+        if (profile.hasTimings)
+        {
+            const PassTiming& timing = m_LatestTimings[i];
+            passProfile.gpuStartMS = timing.startMS;
+            passProfile.gpuDurationMS = timing.durationMS;
+            passProfile.cpuStartMS = timing.cpuStartMS;
+            passProfile.cpuDurationMS = timing.cpuDurationMS;
+        }
+    }
+
+    // Passes run layer by layer, which can differ from the order they were
+    // added in; lifetimes and live memory follow the execution order.
+    for (uint32_t layer = 0; layer < (uint32_t)m_ParallelLayers.size();
+         ++layer)
+    {
+        for (uint32_t passIdx : m_ParallelLayers[layer])
+        {
+            if (passIdx >= passCount) continue;
+            profile.passes[passIdx].layer = layer;
+            profile.passes[passIdx].position =
+                (uint32_t)profile.executionOrder.size();
+            profile.executionOrder.push_back(passIdx);
+        }
+    }
+
+    profile.resources.resize(m_Resources.size());
+    for (uint32_t i = 0; i < (uint32_t)m_Resources.size(); ++i)
+    {
+        const PhysicalResource& res = m_Resources[i];
+        ResourceProfile& resourceProfile = profile.resources[i];
+        resourceProfile.name = res.name;
+        resourceProfile.format = res.desc.format;
+        resourceProfile.width = res.desc.width;
+        resourceProfile.height = res.desc.height;
+        const uint64_t width = res.desc.width, height = res.desc.height;
+        const uint32_t blockSize =
+            VulkanUtils::GetCompressedBlockSize(res.desc.format);
+        const uint64_t levelSize =
+            blockSize ? ((width + 3) / 4) * ((height + 3) / 4) * blockSize
+                      : width * height *
+                            VulkanUtils::GetFormatTexelSize(res.desc.format);
+        resourceProfile.sizeBytes =
+            levelSize * static_cast<uint64_t>(res.desc.samples);
+        if (resourceProfile.sizeBytes == 0 && width * height > 0)
+        {
+            CH_CORE_WARN("RenderGraph: Unknown size of format {} for '{}'; "
+                         "it is left out of the memory totals",
+                         string_VkFormat(res.desc.format), res.name);
+        }
+        resourceProfile.isExternal =
+            res.image.is_external ||
+            (res.desc.flags & (RGResourceFlags)RGResourceFlagBits::External);
+        resourceProfile.isHistory = !res.historyName.empty() &&
+                                    res.name == "History_" + res.historyName;
+
+        // Producers of a history copy once per frame in
+        // UpdatePersistentResources().
+        if (!res.historyName.empty() && !resourceProfile.isHistory)
+        {
+            ++profile.historyCopyCount;
+        }
+    }
+
+    // Lifetimes cover reads as well as writes so history inputs and external
+    // resources get an interval too.
+    auto touch = [&](const ResourceRequest& request, uint32_t passIdx)
+    {
+        if (request.handle == INVALID_RESOURCE ||
+            request.handle >= profile.resources.size())
+            return;
+
+        // Passes are visited in execution order, so the first touch is the
+        // first use and every later one moves the last use
+        ResourceProfile& resourceProfile = profile.resources[request.handle];
+        if (resourceProfile.firstPass == 0xFFFFFFFF)
+            resourceProfile.firstPass = passIdx;
+        resourceProfile.lastPass = passIdx;
+    };
+
+    for (uint32_t passIdx : profile.executionOrder)
+    {
+        for (const auto& input : m_PassStack[passIdx].inputs)
+            touch(input, passIdx);
+        for (const auto& output : m_PassStack[passIdx].outputs)
+            touch(output, passIdx);
+    }
+
+    for (uint32_t position = 0;
+         position < (uint32_t)profile.executionOrder.size(); ++position)
+    {
+        profile.peakMemoryBytes = std::max(profile.peakMemoryBytes,
+                                           LiveBytesAt(profile, position));
+    }
+
+    // Replays BuildBarriers() state tracking in execution order, so the counts
+    // are available without recording a command buffer.
+    std::vector<ResourceState> states(m_Resources.size());
+    for (uint32_t i = 0; i < (uint32_t)m_Resources.size(); ++i)
+    {
+        states[i] = m_Resources[i].currentState;
+    }
+
+    for (const auto& layer : m_ParallelLayers)
+    {
+        for (uint32_t passIdx : layer)
+        {
+            if (passIdx >= passCount) continue;
+
+            const RenderGraphPass& pass = m_PassStack[passIdx];
+            auto simulate = [&](const std::vector<ResourceRequest>& requests)
+            {
+                for (const auto& request : requests)
+                {
+                    if (request.handle == INVALID_RESOURCE ||
+                        request.handle >= states.size())
+                        continue;
+
+                    const bool isDepth = VulkanUtils::IsDepthFormat(
+                        m_Resources[request.handle].desc.format);
+                    const ResourceState target =
+                        GetStateFromUsage(request.usage, isDepth);
+
+                    if (RequiresImageMemoryBarrier(states[request.handle],
+                                                   target))
+                    {
+                        ++profile.passes[passIdx].barrierCount;
+                        states[request.handle] = target;
+                    }
+                }
+            };
+            simulate(pass.inputs);
+            simulate(pass.outputs);
+
+            profile.barrierCount += profile.passes[passIdx].barrierCount;
+        }
+    }
+
+    return profile;
+}
+
+std::string RenderGraph::ExportToJson() const
+{
+    const RenderGraphProfile profile = BuildProfile();
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(6);
+    ss << "{\n";
+    ss << "  \"width\": " << m_Width << ",\n";
+    ss << "  \"height\": " << m_Height << ",\n";
+    ss << "  \"hasTimings\": " << (profile.hasTimings ? "true" : "false")
+       << ",\n";
+    ss << "  \"layerCount\": " << m_ParallelLayers.size() << ",\n";
+    ss << "  \"barrierCount\": " << profile.barrierCount << ",\n";
+    ss << "  \"historyCopyCount\": " << profile.historyCopyCount << ",\n";
+    ss << "  \"peakMemoryBytes\": " << profile.peakMemoryBytes << ",\n";
+
+    ss << "  \"passes\": [";
+    for (size_t i = 0; i < profile.passes.size(); ++i)
+    {
+        const PassProfile& pass = profile.passes[i];
+        const RenderGraphPass& graphPass = m_PassStack[i];
+
+        ss << (i == 0 ? "\n" : ",\n");
+        ss << "    {\"index\": " << pass.index
+           << ", \"name\": " << EscapeJsonString(pass.name)
+           << ", \"type\": " << EscapeJsonString(pass.type)
+           << ", \"layer\": " << pass.layer
+           << ", \"position\": " << pass.position
+           << ", \"gpuStartMs\": " << pass.gpuStartMS
+           << ", \"gpuMs\": " << pass.gpuDurationMS
+           << ", \"cpuStartMs\": " << pass.cpuStartMS
+           << ", \"cpuMs\": " << pass.cpuDurationMS
+           << ", \"barriers\": " << pass.barrierCount;
+
+        auto writeHandles = [&](const char* key,
+                                const std::vector<ResourceRequest>& requests)
+        {
+            ss << ", \"" << key << "\": [";
+            bool first = true;
+            for (const auto& request : requests)
+            {
+                if (request.handle == INVALID_RESOURCE) continue;
+                ss << (first ? "" : ", ") << request.handle;
+                first = false;
+            }
+            ss << "]";
+        };
+        writeHandles("reads", graphPass.inputs);
+        writeHandles("writes", graphPass.outputs);
+
+        const auto& dependencies =
+            i < m_PassDependencies.size() ? m_PassDependencies[i]
+                                          : std::vector<uint32_t>{};
+        ss << ", \"dependsOn\": [";
+        for (size_t d = 0; d < dependencies.size(); ++d)
+            ss << (d == 0 ? "" : ", ") << dependencies[d];
+        ss << "]}";
+    }
+    ss << (profile.passes.empty() ? "],\n" : "\n  ],\n");
+
+    ss << "  \"resources\": [";
+    for (size_t i = 0; i < profile.resources.size(); ++i)
+    {
+        const ResourceProfile& res = profile.resources[i];
+        const bool used = res.firstPass != 0xFFFFFFFF;
+
+        ss << (i == 0 ? "\n" : ",\n");
+        ss << "    {\"handle\": " << i
+           << ", \"name\": " << EscapeJsonString(res.name)
+           << ", \"format\": " << EscapeJsonString(string_VkFormat(res.format))
+           << ", \"width\": " << res.width << ", \"height\": " << res.height
+           << ", \"sizeBytes\": " << res.sizeBytes
+           << ", \"firstPass\": ";
+        if (used)
+            ss << res.firstPass << ", \"lastPass\": " << res.lastPass;
+        else
+            ss << "null, \"lastPass\": null";
+        ss << ", \"external\": " << (res.isExternal ? "true" : "false")
+           << ", \"history\": " << (res.isHistory ? "true" : "false") << "}";
+    }
+    ss << (profile.resources.empty() ? "]\n" : "\n  ]\n");
+    ss << "}\n";
+
+    return ss.str();
+}
+
+std::string RenderGraph::ExportToChromeTrace() const
+{
+    const RenderGraphProfile profile = BuildProfile();
+
+    // Trace Event Format: timestamps are microseconds. pid 1 is the GPU
+    // queue, pid 2 is host-side recording and pid 3 holds resource lifetimes
+    // plus the live-memory counter.
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    ss << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+          "\"args\": {\"name\": \"GPU\"}},\n";
+    ss << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 2, "
+          "\"args\": {\"name\": \"CPU Recording\"}},\n";
+    ss << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 3, "
+          "\"args\": {\"name\": \"Resources\"}}";
+
+    auto passBegin = [&](uint32_t passIdx)
+    { return profile.passes[passIdx].gpuStartMS * 1000.0f; };
+    auto passEnd = [&](uint32_t passIdx)
+    {
+        return (profile.passes[passIdx].gpuStartMS +
+                profile.passes[passIdx].gpuDurationMS) *
+               1000.0f;
+    };
+
+    for (const PassProfile& pass : profile.passes)
+    {
+        ss << ",\n  {\"name\": " << EscapeJsonString(pass.name)
+           << ", \"cat\": " << EscapeJsonString(pass.type)
+           << ", \"ph\": \"X\", \"pid\": 1, \"tid\": 0, \"ts\": "
+           << pass.gpuStartMS * 1000.0f
+           << ", \"dur\": " << pass.gpuDurationMS * 1000.0f
+           << ", \"args\": {\"index\": " << pass.index
+           << ", \"layer\": " << pass.layer
+           << ", \"barriers\": " << pass.barrierCount << "}}";
+
+        ss << ",\n  {\"name\": " << EscapeJsonString(pass.name)
+           << ", \"cat\": \"record\", \"ph\": \"X\", \"pid\": 2, \"tid\": 0, "
+              "\"ts\": "
+           << pass.cpuStartMS * 1000.0f
+           << ", \"dur\": " << pass.cpuDurationMS * 1000.0f << "}";
+    }
+
+    for (uint32_t i = 0; i < (uint32_t)profile.resources.size(); ++i)
+    {
+        const ResourceProfile& res = profile.resources[i];
+        if (res.firstPass == 0xFFFFFFFF) continue;
+
+        const float begin = passBegin(res.firstPass);
+        const float end = std::max(begin, passEnd(res.lastPass));
+        ss << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 3, "
+              "\"tid\": "
+           << i << ", \"args\": {\"name\": " << EscapeJsonString(res.name)
+           << "}}";
+        ss << ",\n  {\"name\": " << EscapeJsonString(res.name)
+           << ", \"cat\": \"resource\", \"ph\": \"X\", \"pid\": 3, \"tid\": "
+           << i << ", \"ts\": " << begin << ", \"dur\": " << end - begin
+           << ", \"args\": {\"format\": "
+           << EscapeJsonString(string_VkFormat(res.format))
+           << ", \"sizeBytes\": " << res.sizeBytes
+           << ", \"firstPass\": " << res.firstPass
+           << ", \"lastPass\": " << res.lastPass << "}}";
+    }
+
+    for (uint32_t position = 0;
+         position < (uint32_t)profile.executionOrder.size(); ++position)
+    {
+        ss << ",\n  {\"name\": \"Live Graph Memory\", \"ph\": \"C\", \"pid\": "
+              "3, \"ts\": "
+           << passBegin(profile.executionOrder[position])
+           << ", \"args\": {\"bytes\": " << LiveBytesAt(profile, position)
+           << "}}";
+    }
+
+    ss << "\n]}\n";
+    return ss.str();
+}
+
 VkImage RenderGraphRegistry::GetImage(RGResourceHandle h)
 {
     if (h == INVALID_RESOURCE || h >= graph.m_Resources.size())
@@ -12,6 +12,7 @@
 namespace Chimera
 {
 class VulkanContext;
+class RenderFlagPermutation;
 
 struct PhysicalResource
 {
@@ -71,6 +72,18 @@ public:
 
         ResourceHandleProxy WriteTransfer(
             const std::string& name, VkFormat format = VK_FORMAT_UNDEFINED);
+
+        // Declare the pipelines Execute() will bind (see PrewarmPipelines).
+        void DeclarePipeline(const GraphicsPipelineDescription& desc);
+        void DeclarePipeline(const RaytracingPipelineDescription& desc);
+            // Declares the variant for renderFlags and the dynamic variant
+            // it falls back to while compiling.
+        void DeclarePipeline(const GraphicsPipelineDescription& desc,
+                             const RenderFlagPermutation& permutation,
+                             uint32_t renderFlags);
+        void DeclareKernel(const std::string& shader,
+                           const std::vector<uint32_t>&
+                               specializationConstants = {});
     };
 
     RenderGraph(VulkanContext& context, uint32_t w, uint32_t h);
@@ -218,6 +231,7 @@ public:
     {
         auto& pass = m_PassStack.emplace_back();
         pass.name = name;
+        pass.isRaytracing = true;
         pass.width = m_Width;
         pass.height = m_Height;
         auto data = std::make_shared<PassData>();
@@ -234,6 +248,13 @@ public:
 
     void Reset();
     void Compile();
+
+        /**
+     * @brief Queues background compiles for every pipeline declared by the
+     * passes. Must run after Compile() so attachment formats are known.
+     * Returns the number of pipelines that are not ready yet.
+     */
+    uint32_t PrewarmPipelines();
     VkSemaphore Execute(VkCommandBuffer cmd);
     void DestroyResources(bool all = false);
 
@@ -264,6 +285,15 @@ public:
     void DrawPerformanceStatistics();
     std::string ExportToMermaid() const;
 
+        /**
+     * @brief Snapshot of pass timings, execution layers, resource lifetimes,
+     * planned barriers and history copies. Compile-only graphs report zeroed
+     * timings.
+     */
+    RenderGraphProfile BuildProfile() const;
+    std::string ExportToJson() const;
+    std::string ExportToChromeTrace() const;
+
     static std::vector<std::vector<uint32_t>> BuildExecutionLayers(
         const std::vector<std::vector<uint32_t>>& dependencies);
 
@@ -372,6 +402,8 @@ private:
     VkQueryPool m_TimestampQueryPool = VK_NULL_HANDLE;
     std::vector<PassTiming> m_LatestTimings;
     std::vector<std::string> m_LastPassNames;
+    std::vector<float> m_LastPassCpuStartMS;
+    std::vector<float> m_LastPassCpuDurationMS;
     uint64_t m_TimingSampleId = 0;
     uint32_t m_PreviousPassCount = 0;
     bool m_StatsReady = false;
@@ -175,6 +175,7 @@ struct RenderGraphPass
 {
     std::string name;
     bool isCompute = false;
+    bool isRaytracing = false;
     uint32_t width = 0;
     uint32_t height = 0;
     std::vector<std::string>
@@ -186,12 +187,60 @@ struct RenderGraphPass
     VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
     std::vector<VkFormat> colorFormats;
     VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+
+    // Pipelines the pass binds in Execute, declared up front so they can be
+    // compiled in the background before the pass first runs.
+    std::vector<GraphicsPipelineDescription> graphicsPipelines;
+    std::vector<RaytracingPipelineDescription> raytracingPipelines;
+    std::vector<ComputePipelineDescription::Kernel> computeKernels;
 };
 
 struct PassTiming
 {
     std::string name;
     float durationMS;
+    float startMS = 0.0f;       // GPU start relative to the first pass
+    float cpuStartMS = 0.0f;    // Recording start relative to Execute()
+    float cpuDurationMS = 0.0f; // Host time spent recording the pass
+};
+
+    // --- Offline profiling snapshot (see RenderGraph::BuildProfile) ---
+struct PassProfile
+{
+    std::string name;
+    std::string type; // "graphics", "compute" or "raytracing"
+    uint32_t index = 0;
+    uint32_t layer = 0;
+    uint32_t position = 0xFFFFFFFF; // Execution position, layer by layer
+    uint32_t barrierCount = 0;
+    float gpuStartMS = 0.0f;
+    float gpuDurationMS = 0.0f;
+    float cpuStartMS = 0.0f;
+    float cpuDurationMS = 0.0f;
+};
+
+struct ResourceProfile
+{
+    std::string name;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint64_t sizeBytes = 0;
+    uint32_t firstPass = 0xFFFFFFFF; // Index of the first pass to touch it
+    uint32_t lastPass = 0;           // in execution order, and of the last
+    bool isExternal = false;
+    bool isHistory = false;
+};
+
+struct RenderGraphProfile
+{
+    std::vector<PassProfile> passes;
+    std::vector<ResourceProfile> resources;
+    std::vector<uint32_t> executionOrder; // Pass indices in execution order
+    uint32_t barrierCount = 0;
+    uint32_t historyCopyCount = 0;
+    uint64_t peakMemoryBytes = 0;
+    bool hasTimings = false;
 };
 
 struct PooledImage
@@ -28,6 +28,7 @@ inline static const std::string RTOutput = "RTOutput";
 inline static const std::string CurColor = "CurColor";
 inline static const std::string Reflections = "Reflections";
 inline static const std::string ReflectionRaw = "ReflectionRaw";
+inline static const std::string RestirDIRaw = "RestirDIRaw";
 
         // --- SVGF / 降噪 ---
 inline static const std::string SVGFOutput = "SVGFOutput";
@@ -0,0 +1,32 @@
+#include "pch.h"
+#include "ClusterLightCullingPass.h"
+#include "Renderer/Backend/ShaderCommon.h"
+#include "Renderer/Graph/ComputeExecutionContext.h"
+
+namespace Chimera
+{
+void ClusterLightCullingPass::Setup(ClusterLightCullingPassData& data,
+                                    RenderGraph::PassBuilder& builder)
+{
+    builder.DeclareKernel("Cluster_Cull");
+}
+
+void ClusterLightCullingPass::Execute(const ClusterLightCullingPassData& data,
+                                      ComputeExecutionContext& ctx)
+{
+    if (!ctx.BindPipeline("Cluster_Cull")) return;
+    ctx.Dispatch("Cluster_Cull", (CLUSTER_COUNT + 63) / 64, 1);
+
+    // The graph only orders images, so the lists are made visible to the
+    // forward pass's fragment shader here
+    VkMemoryBarrier2 barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT;
+    VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    dep.memoryBarrierCount = 1;
+    dep.pMemoryBarriers = &barrier;
+    vkCmdPipelineBarrier2(ctx.GetCommandBuffer(), &dep);
+}
+} // namespace Chimera
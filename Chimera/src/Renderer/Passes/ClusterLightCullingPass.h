@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Renderer/Graph/RenderGraphCommon.h"
+#include "Renderer/Graph/RenderGraph.h"
+#include "IRenderGraphPass.h"
+
+namespace Chimera
+{
+    // Reads and writes only the scene set's punctual light and cluster
+    // buffers, which the graph does not track.
+struct ClusterLightCullingPassData
+{
+};
+
+    /**
+ * @brief Lists the point and spot lights reaching each froxel of the view
+ * (see ClusteredLights.h) for ForwardPass, which must follow it.
+ */
+class ClusterLightCullingPass : public ComputePass<ClusterLightCullingPassData>
+{
+public:
+    static constexpr const char* Name = "ClusterLightCullingPass";
+
+    virtual void Setup(ClusterLightCullingPassData& data,
+                       RenderGraph::PassBuilder& builder) override;
+    virtual void Execute(const ClusterLightCullingPassData& data,
+                         ComputeExecutionContext& ctx) override;
+};
+} // namespace Chimera
@@ -3,12 +3,29 @@
 #include "Renderer/Graph/RenderGraph.h"
 #include "Renderer/Graph/ResourceNames.h"
 #include "Renderer/Graph/GraphicsExecutionContext.h"
+#include "Renderer/Backend/RenderFlagPermutation.h"
 #include "Renderer/Resources/ResourceManager.h"
 #include "Core/Application.h"
 #include "Scene/Scene.h"
 
 namespace Chimera
 {
+static GraphicsPipelineDescription MakeCompositionPipeline()
+{
+    GraphicsPipelineDescription desc{};
+    desc.name = "Composition_Pipeline";
+    desc.vertex_shader = "Fullscreen_Vert";
+    desc.fragment_shader = "Composition_Frag";
+    desc.depth_test = false;
+    desc.depth_write = false;
+    desc.cull_mode = VK_CULL_MODE_NONE;
+    return desc;
+}
+
+    // Lighting toggles are baked into composition.frag variants.
+static const RenderFlagPermutation s_CompositionFlags(
+    RenderFlags_LightBit | RenderFlags_IBLBit | RenderFlags_GIBit);
+
 CompositionPass::CompositionPass(const Config& config) : m_Config(config) {}
 
 void CompositionPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
@@ -33,21 +50,19 @@ void CompositionPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
 
     data.ao_raw = builder.Read(m_Config.aoName, "gAO");
 
+    data.direct_lights =
+        builder.Read(m_Config.directLightName, "gDirectLights");
+
     data.output =
         builder.Write(RS::FinalColor).Format(VK_FORMAT_R16G16B16A16_SFLOAT);
+
+    builder.DeclarePipeline(MakeCompositionPipeline(), s_CompositionFlags,
+                            m_Config.renderFlags);
 }
 
 void CompositionPass::Execute(const PassData& data,
                               GraphicsExecutionContext& ctx)
 {
-    GraphicsPipelineDescription desc{};
-    desc.name = "Composition_Pipeline";
-    desc.vertex_shader = "Fullscreen_Vert";
-    desc.fragment_shader = "Composition_Frag";
-    desc.depth_test = false;
-    desc.depth_write = false;
-    desc.cull_mode = VK_CULL_MODE_NONE;
-
-    ctx.DrawMeshes(desc, nullptr);
+    ctx.DrawMeshes(MakeCompositionPipeline(), s_CompositionFlags, nullptr);
 }
 } // namespace Chimera
@@ -3,6 +3,7 @@
 #include "Renderer/Graph/RenderGraphCommon.h"
 #include "Renderer/Graph/RenderGraph.h"
 #include "IRenderGraphPass.h"
+#include "Renderer/Backend/ShaderCommon.h"
 #include <string>
 #include <memory>
 
@@ -23,6 +24,7 @@ struct CompositionPassData
     RGResourceHandle reflection_raw;
     RGResourceHandle shadow_raw;
     RGResourceHandle ao_raw;
+    RGResourceHandle direct_lights;
 
     RGResourceHandle output;
 };
@@ -39,6 +41,10 @@ public:
         std::string aoName = "AO_Filtered_Final";
         std::string reflectionName = "Refl_Filtered_Final";
         std::string giName = "GI_Filtered_Final";
+            // Emissive geometry lighting from ReSTIR DI.
+        std::string directLightName = "DirectLights_Filtered_Final";
+            // Selects the composition.frag variant declared in Setup.
+        RenderFlags renderFlags = RenderFlags_None;
     };
 
     using Data = PassData;
@@ -11,6 +11,19 @@
 
 namespace Chimera
 {
+static GraphicsPipelineDescription MakeDepthPrepassPipeline()
+{
+    GraphicsPipelineDescription desc;
+    desc.name = "DepthPrepass";
+    desc.vertex_shader = "GBuffer_Vert";
+    desc.fragment_shader = ""; // No fragment shader for depth-only
+    desc.depth_test = true;
+    desc.depth_write = true;
+    desc.depth_compare_op = CH_DEPTH_COMPARE_OP;
+    desc.cull_mode = VK_CULL_MODE_NONE;
+    return desc;
+}
+
 DepthPrepass::DepthPrepass(std::shared_ptr<Scene> scene) : m_Scene(scene) {}
 
 void DepthPrepass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
@@ -19,6 +32,8 @@ void DepthPrepass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
                      .Format(VK_FORMAT_D32_SFLOAT)
                      .ClearDepthStencil(CH_DEPTH_CLEAR_VALUE)
                      .SaveAsHistory(RS::Depth);
+
+    builder.DeclarePipeline(MakeDepthPrepassPipeline());
 }
 
 void DepthPrepass::Execute(const PassData& data, RenderGraphRegistry& reg,
@@ -28,15 +43,7 @@ void DepthPrepass::Execute(const PassData& data, RenderGraphRegistry& reg,
 
     GraphicsExecutionContext ctx(reg.graph, reg.pass, cmd);
 
-    GraphicsPipelineDescription desc;
-    desc.name = "DepthPrepass";
-    desc.vertex_shader = "GBuffer_Vert";
-    desc.fragment_shader = ""; // No fragment shader for depth-only
-    desc.depth_test = true;
-    desc.depth_write = true;
-    desc.depth_compare_op = CH_DEPTH_COMPARE_OP;
-    desc.cull_mode = VK_CULL_MODE_NONE;
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeDepthPrepassPipeline())) return;
 
     const auto& entities = m_Scene->GetEntities();
     const auto& frustum = Application::Get().GetFrameContext().CamFrustum;
@@ -3,12 +3,30 @@
 #include "Renderer/Graph/ResourceNames.h"
 #include "Renderer/Graph/RenderGraph.h"
 #include "Renderer/Graph/GraphicsExecutionContext.h"
+#include "Renderer/Backend/RenderFlagPermutation.h"
 #include "Scene/Scene.h"
 #include "Scene/Model.h"
 #include "Core/Application.h"
 
 namespace Chimera
 {
+static GraphicsPipelineDescription MakeForwardPipeline()
+{
+    GraphicsPipelineDescription desc;
+    desc.name = "Forward";
+    desc.vertex_shader = "Forward_Vert";
+    desc.fragment_shader = "Forward_Frag";
+    desc.depth_test = true;
+    desc.depth_write = true;
+    desc.depth_compare_op = CH_DEPTH_COMPARE_OP;
+    desc.cull_mode = VK_CULL_MODE_BACK_BIT;
+    return desc;
+}
+
+    // Lighting toggles are baked into forward.frag variants.
+static const RenderFlagPermutation s_ForwardFlags(
+    RenderFlags_LightBit | RenderFlags_ShadowBit | RenderFlags_IBLBit);
+
 ForwardPass::ForwardPass(std::shared_ptr<Scene> scene) : m_Scene(scene) {}
 
 void ForwardPass::Setup(ForwardPassData& data,
@@ -29,6 +47,9 @@ void ForwardPass::Setup(ForwardPassData& data,
                      .Format(VK_FORMAT_D32_SFLOAT)
                      .ClearDepthStencil(CH_DEPTH_CLEAR_VALUE)
                      .SaveAsHistory(RS::Depth);
+
+    builder.DeclarePipeline(MakeForwardPipeline(), s_ForwardFlags,
+                            Application::Get().GetFrameContext().RenderFlags);
 }
 
 void ForwardPass::Execute(const ForwardPassData& data, RenderGraphRegistry& reg,
@@ -38,16 +59,7 @@ void ForwardPass::Execute(const ForwardPassData& data, RenderGraphRegistry& reg,
 
     GraphicsExecutionContext ctx(reg.graph, reg.pass, cmd);
 
-    GraphicsPipelineDescription desc;
-    desc.name = "Forward";
-    desc.vertex_shader = "Forward_Vert";
-    desc.fragment_shader = "Forward_Frag";
-    desc.depth_test = true;
-    desc.depth_write = true;
-    desc.depth_compare_op = CH_DEPTH_COMPARE_OP;
-    desc.cull_mode = VK_CULL_MODE_BACK_BIT;
-
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeForwardPipeline(), s_ForwardFlags)) return;
 
     const auto& entities = m_Scene->GetEntities();
     const auto& frustum = Application::Get().GetFrameContext().CamFrustum;
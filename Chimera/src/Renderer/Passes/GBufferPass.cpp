@@ -8,6 +8,19 @@
 
 namespace Chimera
 {
+static GraphicsPipelineDescription MakeGBufferPipeline()
+{
+    GraphicsPipelineDescription desc;
+    desc.name = "GBuffer";
+    desc.vertex_shader = "GBuffer_Vert";
+    desc.fragment_shader = "GBuffer_Frag";
+    desc.depth_test = true;
+    desc.depth_write = true;
+    desc.depth_compare_op = CH_DEPTH_COMPARE_OP;
+    desc.cull_mode = VK_CULL_MODE_NONE;
+    return desc;
+}
+
 GBufferPass::GBufferPass(std::shared_ptr<Scene> scene) : m_Scene(scene) {}
 
 void GBufferPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
@@ -55,6 +68,8 @@ void GBufferPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
     data.depth = builder.Write(RS::Depth)
                      .Format(VK_FORMAT_D32_SFLOAT)
                      .SaveAsHistory(RS::Depth); // Reuse from Prepass
+
+    builder.DeclarePipeline(MakeGBufferPipeline());
 }
 
 void GBufferPass::Execute(const PassData& data, RenderGraphRegistry& reg,
@@ -64,16 +79,7 @@ void GBufferPass::Execute(const PassData& data, RenderGraphRegistry& reg,
 
     GraphicsExecutionContext ctx(reg.graph, reg.pass, cmd);
 
-    GraphicsPipelineDescription desc;
-    desc.name = "GBuffer";
-    desc.vertex_shader = "GBuffer_Vert";
-    desc.fragment_shader = "GBuffer_Frag";
-    desc.depth_test = true;
-    desc.depth_write = true;
-    desc.depth_compare_op = CH_DEPTH_COMPARE_OP;
-    desc.cull_mode = VK_CULL_MODE_NONE;
-
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeGBufferPipeline())) return;
 
     const auto& frustum = Application::Get().GetFrameContext().CamFrustum;
 
@@ -6,6 +6,17 @@
 
 namespace Chimera
 {
+static GraphicsPipelineDescription MakePostProcessPipeline()
+{
+    return GraphicsPipelineDescription{"PostProcess",
+                                       "common/fullscreen.vert",
+                                       "postprocess/postprocess.frag",
+                                       false,
+                                       false,
+                                       (VkCompareOp)0,
+                                       VK_CULL_MODE_NONE};
+}
+
 PostProcessPass::PostProcessPass(const std::string& inputName)
     : m_InputName(inputName)
 {
@@ -15,6 +26,8 @@ void PostProcessPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
 {
     data.input = builder.Read(m_InputName, "inColor");
     data.output = builder.Write(RS::RENDER_OUTPUT);
+
+    builder.DeclarePipeline(MakePostProcessPipeline());
 }
 
 void PostProcessPass::Execute(const PassData& data, RenderGraphRegistry& reg,
@@ -26,15 +39,6 @@ void PostProcessPass::Execute(const PassData& data, RenderGraphRegistry& reg,
                     (float)reg.graph.GetHeight());
     ctx.SetScissor(0, 0, reg.graph.GetWidth(), reg.graph.GetHeight());
 
-    GraphicsPipelineDescription desc{"PostProcess",
-                                     "common/fullscreen.vert",
-                                     "postprocess/postprocess.frag",
-                                     false,
-                                     false,
-                                     (VkCompareOp)0,
-                                     VK_CULL_MODE_NONE};
-
-    ctx.BindPipeline(desc);
-    ctx.DrawMeshes(desc, nullptr);
+    ctx.DrawMeshes(MakePostProcessPipeline(), nullptr);
 }
 } // namespace Chimera
@@ -6,6 +6,15 @@
 
 namespace Chimera
 {
+static RaytracingPipelineDescription MakeAOPipeline()
+{
+    RaytracingPipelineDescription desc;
+    desc.raygen_shader = "RT_AO_Gen";
+    desc.miss_shaders = {"Raytrace_Miss"};
+    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
+    return desc;
+}
+
 RTAOPass::RTAOPass(std::shared_ptr<Scene> scene) : m_Scene(scene) {}
 
 void RTAOPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
@@ -14,6 +23,8 @@ void RTAOPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
         builder.WriteStorage("AORaw").Format(VK_FORMAT_R16G16B16A16_SFLOAT);
     data.normal = builder.ReadRaytrace(RS::Normal);
     data.depth = builder.ReadRaytrace(RS::Depth);
+
+    builder.DeclarePipeline(MakeAOPipeline());
 }
 
 void RTAOPass::Execute(const PassData& data, RenderGraphRegistry& reg,
@@ -21,12 +32,7 @@ void RTAOPass::Execute(const PassData& data, RenderGraphRegistry& reg,
 {
     RaytracingExecutionContext ctx(reg.graph, reg.pass, cmd);
 
-    RaytracingPipelineDescription desc;
-    desc.raygen_shader = "RT_AO_Gen";
-    desc.miss_shaders = {"Raytrace_Miss"};
-    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
-
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeAOPipeline())) return;
     ctx.TraceRays(reg.graph.GetWidth(), reg.graph.GetHeight());
 }
 } // namespace Chimera
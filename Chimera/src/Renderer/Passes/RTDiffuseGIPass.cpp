@@ -7,6 +7,15 @@
 
 namespace Chimera
 {
+static RaytracingPipelineDescription MakeDiffuseGIPipeline()
+{
+    RaytracingPipelineDescription desc;
+    desc.raygen_shader = "DiffuseGI_Gen";
+    desc.miss_shaders = {"Raytrace_Miss"};
+    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
+    return desc;
+}
+
 RTDiffuseGIPass::RTDiffuseGIPass(std::shared_ptr<Scene> scene) : m_Scene(scene)
 {
 }
@@ -22,6 +31,8 @@ void RTDiffuseGIPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
     data.depth = builder.ReadRaytrace(RS::Depth, "gDepth");
 
     data.material = builder.ReadRaytrace(RS::MaterialParams, "gMaterial");
+
+    builder.DeclarePipeline(MakeDiffuseGIPipeline());
 }
 
 void RTDiffuseGIPass::Execute(const PassData& data, RenderGraphRegistry& reg,
@@ -31,14 +42,9 @@ void RTDiffuseGIPass::Execute(const PassData& data, RenderGraphRegistry& reg,
 
     RaytracingExecutionContext ctx(reg.graph, reg.pass, cmd);
 
-    RaytracingPipelineDescription desc;
-    desc.raygen_shader = "DiffuseGI_Gen";
-    desc.miss_shaders = {"Raytrace_Miss"};
-    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
-
     int skyboxIndex = (int)m_Scene->GetSkyboxTextureIndex();
 
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeDiffuseGIPipeline())) return;
     ctx.PushConstants(VK_SHADER_STAGE_ALL, skyboxIndex);
     ctx.TraceRays(reg.graph.GetWidth(), reg.graph.GetHeight());
 }
@@ -7,6 +7,15 @@
 
 namespace Chimera
 {
+static RaytracingPipelineDescription MakeReflectionPipeline()
+{
+    RaytracingPipelineDescription desc;
+    desc.raygen_shader = "Reflection_Gen";
+    desc.miss_shaders = {"Raytrace_Miss"};
+    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
+    return desc;
+}
+
 RTReflectionPass::RTReflectionPass(std::shared_ptr<Scene> scene)
     : m_Scene(scene)
 {
@@ -25,6 +34,8 @@ void RTReflectionPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
     data.material = builder.ReadRaytrace(RS::MaterialParams, "gMaterial");
 
     data.albedo = builder.ReadRaytrace(RS::Albedo, "gAlbedo");
+
+    builder.DeclarePipeline(MakeReflectionPipeline());
 }
 
 void RTReflectionPass::Execute(const PassData& data, RenderGraphRegistry& reg,
@@ -34,14 +45,9 @@ void RTReflectionPass::Execute(const PassData& data, RenderGraphRegistry& reg,
 
     RaytracingExecutionContext ctx(reg.graph, reg.pass, cmd);
 
-    RaytracingPipelineDescription desc;
-    desc.raygen_shader = "Reflection_Gen";
-    desc.miss_shaders = {"Raytrace_Miss"};
-    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
-
     int skyboxIndex = (int)m_Scene->GetSkyboxTextureIndex();
 
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeReflectionPipeline())) return;
     ctx.PushConstants(VK_SHADER_STAGE_ALL, skyboxIndex);
     ctx.TraceRays(reg.graph.GetWidth(), reg.graph.GetHeight());
 }
@@ -6,6 +6,22 @@
 
 namespace Chimera
 {
+static RaytracingPipelineDescription MakeShadowPipeline()
+{
+    RaytracingPipelineDescription desc;
+    desc.raygen_shader = "RT_Shadow_Gen"; // Maps to rt_shadow.rgen
+
+    // Note: While the current rgen uses Ray Query, we provide standard Miss and Hit groups
+    // to ensure pipeline compatibility and support for potential future traceRayEXT transitions.
+    // Index 0: Radiance Miss (used for skybox/AO fallbacks)
+    // Index 1: Shadow Miss (used for binary visibility)
+    desc.miss_shaders = {"Raytrace_Miss", "Shadow_Miss"};
+
+    // Closest Hit group for material evaluation (used if secondary rays are required)
+    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
+    return desc;
+}
+
 RTShadowPass::RTShadowPass(std::shared_ptr<Scene> scene) : m_Scene(scene) {}
 
 /**
@@ -27,6 +43,8 @@ void RTShadowPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
     data.normal = builder.ReadRaytrace(RS::Normal, "gNormal");
 
     data.depth = builder.ReadRaytrace(RS::Depth, "gDepth");
+
+    builder.DeclarePipeline(MakeShadowPipeline());
 }
 
 /**
@@ -43,19 +61,7 @@ void RTShadowPass::Execute(const PassData& data, RenderGraphRegistry& reg,
     // RaytracingExecutionContext handles the binding of Set 0 (UBO) and Set 1 (Global AS/Buffers).
     RaytracingExecutionContext ctx(reg.graph, reg.pass, cmd);
 
-    RaytracingPipelineDescription desc;
-    desc.raygen_shader = "RT_Shadow_Gen"; // Maps to rt_shadow.rgen
-
-    // Note: While the current rgen uses Ray Query, we provide standard Miss and Hit groups
-    // to ensure pipeline compatibility and support for potential future traceRayEXT transitions.
-    // Index 0: Radiance Miss (used for skybox/AO fallbacks)
-    // Index 1: Shadow Miss (used for binary visibility)
-    desc.miss_shaders = {"Raytrace_Miss", "Shadow_Miss"};
-
-    // Closest Hit group for material evaluation (used if secondary rays are required)
-    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
-
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeShadowPipeline())) return;
 
     // Dispatch rays for the entire viewport. 
     // Each thread corresponds to one pixel in the output Shadow/AO buffer.
@@ -3,11 +3,25 @@
 #include "Renderer/Graph/RenderGraph.h"
 #include "Renderer/Graph/ResourceNames.h"
 #include "Renderer/Graph/GraphicsExecutionContext.h"
+#include "Renderer/Backend/RenderFlagPermutation.h"
 #include "Scene/Scene.h"
 #include "Core/Application.h"
 
 namespace Chimera::RayQueryPass
 {
+static GraphicsPipelineDescription MakeRayQueryPipeline()
+{
+    GraphicsPipelineDescription desc{};
+    desc.name = "RayQuery_Pipeline";
+    desc.vertex_shader = "Forward_Vert";
+    desc.fragment_shader = "RayQuery_Frag";
+    return desc;
+}
+
+    // Lighting toggles are baked into rayquery.frag variants.
+static const RenderFlagPermutation s_RayQueryFlags(
+    RenderFlags_LightBit | RenderFlags_ShadowBit | RenderFlags_IBLBit);
+
 struct PassData
 {
     RGResourceHandle output;
@@ -34,18 +48,16 @@ void AddToGraph(RenderGraph& graph, std::shared_ptr<Scene> scene)
             data.depth = builder.Write(RS::Depth)
                              .Format(VK_FORMAT_D32_SFLOAT)
                              .ClearDepthStencil(CH_DEPTH_CLEAR_VALUE);
+            builder.DeclarePipeline(
+                MakeRayQueryPipeline(), s_RayQueryFlags,
+                Application::Get().GetFrameContext().RenderFlags);
         },
         [scene](const PassData& data, RenderGraphRegistry& reg,
                 VkCommandBuffer cmd)
         {
             GraphicsExecutionContext ctx(reg.graph, reg.pass, cmd);
-
-            GraphicsPipelineDescription desc{};
-            desc.name = "RayQuery_Pipeline";
-            desc.vertex_shader = "Forward_Vert";
-            desc.fragment_shader = "RayQuery_Frag";
-
-            ctx.DrawMeshes(desc, scene.get());
+            ctx.DrawMeshes(MakeRayQueryPipeline(), s_RayQueryFlags,
+                           scene.get());
         });
 }
 } // namespace Chimera::RayQueryPass
@@ -6,6 +6,15 @@
 
 namespace Chimera
 {
+static RaytracingPipelineDescription MakeRaytracePipeline()
+{
+    RaytracingPipelineDescription desc{};
+    desc.raygen_shader = "Raytrace_Gen";
+    desc.miss_shaders = {"Raytrace_Miss"};
+    desc.hit_shaders = {{"Raytrace_Hit", "Shadow_AnyHit"}};
+    return desc;
+}
+
 RaytracePass::RaytracePass(std::shared_ptr<Scene> scene, bool useAlphaTest)
     : m_Scene(scene), m_UseAlphaTest(useAlphaTest)
 {
@@ -23,6 +32,8 @@ void RaytracePass::Setup(RaytracePassData& data,
         .Format(VK_FORMAT_R16G16_SFLOAT)
         .AllowUsage(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
         .BindTo("rtMotionVector");
+
+    builder.DeclarePipeline(MakeRaytracePipeline());
 }
 
 void RaytracePass::Execute(const RaytracePassData& data,
@@ -30,12 +41,7 @@ void RaytracePass::Execute(const RaytracePassData& data,
 {
     if (!m_Scene) return;
 
-    RaytracingPipelineDescription desc{};
-    desc.raygen_shader = "Raytrace_Gen";
-    desc.miss_shaders = {"Raytrace_Miss"};
-    desc.hit_shaders = {{"Raytrace_Hit", "Shadow_AnyHit"}};
-
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeRaytracePipeline())) return;
 
     int alphaTest = m_UseAlphaTest ? 1 : 0;
     ctx.PushConstants(VK_SHADER_STAGE_ALL, alphaTest);
@@ -0,0 +1,119 @@
+#include "pch.h"
+#include "RestirDIPass.h"
+#include "Renderer/Graph/ResourceNames.h"
+#include "Renderer/Graph/RenderGraph.h"
+#include "Renderer/Graph/RaytracingExecutionContext.h"
+
+namespace Chimera
+{
+    // Reservoirs after temporal reuse, and after spatial reuse, which are
+    // kept for the next frame under the history names.
+static const std::string s_TemporalSample = "RestirDI_TemporalSample";
+static const std::string s_TemporalWeight = "RestirDI_TemporalWeight";
+static const std::string s_Sample = "RestirDI_Sample";
+static const std::string s_Weight = "RestirDI_Weight";
+static const std::string s_SampleHistory = "RestirDISampleAccum";
+static const std::string s_WeightHistory = "RestirDIWeightAccum";
+
+static RaytracingPipelineDescription MakePipeline(const char* raygen)
+{
+    RaytracingPipelineDescription desc;
+    desc.raygen_shader = raygen;
+    // Visibility is traced with ray queries; the groups keep the layout of
+    // the other ray traced passes
+    desc.miss_shaders = {"Raytrace_Miss", "Shadow_Miss"};
+    desc.hit_shaders = {{"Raytrace_Hit", "", ""}};
+    return desc;
+}
+
+    // --- Initial candidates and temporal reuse ---
+void RestirDITemporalPass::Setup(PassData& data,
+                                 RenderGraph::PassBuilder& builder)
+{
+    // Sample: light, instance, triangle, barycentrics; weight: W and M
+    data.sample = builder.WriteStorage(s_TemporalSample)
+                      .Format(VK_FORMAT_R32G32B32A32_UINT)
+                      .BindTo("restirSample");
+
+    data.weight = builder.WriteStorage(s_TemporalWeight)
+                      .Format(VK_FORMAT_R32G32_SFLOAT)
+                      .BindTo("restirWeight");
+
+    builder.ReadRaytrace(RS::Normal, "gNormal");
+    builder.ReadRaytrace(RS::Depth, "gDepth");
+    builder.ReadRaytrace(RS::Albedo, "gAlbedo");
+    builder.ReadRaytrace(RS::MaterialParams, "gMaterialParams");
+    builder.ReadRaytrace(RS::Motion, "gMotion");
+    builder.ReadRaytrace(RS::ObjectID, "gObjectID");
+    builder.ReadHistorySafe(RS::Normal, RS::Normal, "gPrevNormal");
+    builder.ReadHistorySafe(RS::Motion, RS::Motion, "gPrevMotion");
+    builder.ReadHistorySafe(RS::ObjectID, RS::ObjectID, "gPrevObjectID");
+
+    // Before the first spatial pass has run the fallbacks, of matching
+    // sampler types, are only bound; temporalValid keeps them unread.
+    data.temporalValid = builder.graph.HasHistory(s_SampleHistory) &&
+                         builder.graph.HasHistory(s_WeightHistory);
+    data.prevSample =
+        builder.ReadHistorySafe(s_SampleHistory, RS::ObjectID, "gPrevSample");
+    data.prevWeight =
+        builder.ReadHistorySafe(s_WeightHistory, RS::Motion, "gPrevWeight");
+
+    builder.DeclarePipeline(MakePipeline("ReSTIR_DI_Gen"));
+}
+
+void RestirDITemporalPass::Execute(const PassData& data,
+                                   RenderGraphRegistry& reg,
+                                   VkCommandBuffer cmd)
+{
+    RaytracingExecutionContext ctx(reg.graph, reg.pass, cmd);
+
+    if (!ctx.BindPipeline(MakePipeline("ReSTIR_DI_Gen"))) return;
+    ctx.PushConstants(VK_SHADER_STAGE_ALL, data.temporalValid);
+    ctx.TraceRays(reg.graph.GetWidth(), reg.graph.GetHeight());
+}
+
+    // --- Spatial reuse and shading ---
+void RestirDISpatialPass::Setup(PassData& data,
+                                RenderGraph::PassBuilder& builder)
+{
+    data.sample = builder.WriteStorage(s_Sample)
+                      .Format(VK_FORMAT_R32G32B32A32_UINT)
+                      .BindTo("restirSample")
+                      .SaveAsHistory(s_SampleHistory);
+
+    data.weight = builder.WriteStorage(s_Weight)
+                      .Format(VK_FORMAT_R32G32_SFLOAT)
+                      .BindTo("restirWeight")
+                      .SaveAsHistory(s_WeightHistory);
+
+    data.radiance = builder.WriteStorage(RS::RestirDIRaw)
+                        .Format(VK_FORMAT_R16G16B16A16_SFLOAT)
+                        .BindTo("restirRadiance");
+
+    builder.ReadRaytrace(s_TemporalSample, "gTemporalSample");
+    builder.ReadRaytrace(s_TemporalWeight, "gTemporalWeight");
+    builder.ReadRaytrace(RS::Normal, "gNormal");
+    builder.ReadRaytrace(RS::Depth, "gDepth");
+    builder.ReadRaytrace(RS::Albedo, "gAlbedo");
+    builder.ReadRaytrace(RS::MaterialParams, "gMaterialParams");
+    builder.ReadRaytrace(RS::Motion, "gMotion");
+
+    builder.DeclarePipeline(MakePipeline("ReSTIR_DI_Spatial_Gen"));
+}
+
+void RestirDISpatialPass::Execute(const PassData& data,
+                                  RenderGraphRegistry& reg,
+                                  VkCommandBuffer cmd)
+{
+    RaytracingExecutionContext ctx(reg.graph, reg.pass, cmd);
+
+    if (!ctx.BindPipeline(MakePipeline("ReSTIR_DI_Spatial_Gen"))) return;
+    ctx.TraceRays(reg.graph.GetWidth(), reg.graph.GetHeight());
+}
+
+void RestirDIPass::Add(RenderGraph& graph, std::shared_ptr<Scene> scene)
+{
+    graph.AddPass<RestirDITemporalPass>();
+    graph.AddPass<RestirDISpatialPass>();
+}
+} // namespace Chimera
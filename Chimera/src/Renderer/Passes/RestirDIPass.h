@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Renderer/Graph/RenderGraphCommon.h"
+#include "Renderer/Graph/RenderGraph.h"
+#include "IRenderGraphPass.h"
+#include <memory>
+
+namespace Chimera
+{
+class Scene;
+
+    /**
+ * @brief Initial candidates and temporal reuse step for ReSTIR DI.
+ */
+struct RestirDITemporalData
+{
+    RGResourceHandle sample;
+    RGResourceHandle weight;
+    RGResourceHandle prevSample;
+    RGResourceHandle prevWeight;
+    int temporalValid = 0;
+};
+
+    /**
+ * @brief Spatial reuse and shading step for ReSTIR DI.
+ */
+struct RestirDISpatialData
+{
+    RGResourceHandle sample;
+    RGResourceHandle weight;
+    RGResourceHandle radiance;
+};
+
+    /**
+ * @brief ReSTIR direct lighting from emissive triangles (Bitterli et al.
+ * 2020), writing noisy radiance to RS::RestirDIRaw. Reservoirs are kept as
+ * graph history between frames.
+ */
+class RestirDIPass
+{
+public:
+        /**
+     * @brief Adds the temporal and spatial passes to the graph.
+     */
+    static void Add(RenderGraph& graph, std::shared_ptr<Scene> scene);
+};
+
+    // --- Sub-Pass Classes (Internal use) ---
+
+class RestirDITemporalPass : public RenderPass<RestirDITemporalData>
+{
+public:
+    using PassData = RestirDITemporalData;
+    static constexpr const char* Name = "RestirDITemporalPass";
+
+    virtual void Setup(PassData& data,
+                       RenderGraph::PassBuilder& builder) override;
+    virtual void Execute(const PassData& data, RenderGraphRegistry& reg,
+                         VkCommandBuffer cmd) override;
+};
+
+class RestirDISpatialPass : public RenderPass<RestirDISpatialData>
+{
+public:
+    using PassData = RestirDISpatialData;
+    static constexpr const char* Name = "RestirDISpatialPass";
+
+    virtual void Setup(PassData& data,
+                       RenderGraph::PassBuilder& builder) override;
+    virtual void Execute(const PassData& data, RenderGraphRegistry& reg,
+                         VkCommandBuffer cmd) override;
+};
+} // namespace Chimera
@@ -60,12 +60,14 @@ void SVGFTemporalPass::Setup(SVGFTemporalData& data,
         builder.ReadHistorySafe(RS::Motion, RS::Motion, "gPrevMotion");
 
     builder.ReadCompute(RS::Albedo, "gAlbedo");
+
+    builder.DeclareKernel("SVGF_Temporal");
 }
 void SVGFTemporalPass::Execute(const SVGFTemporalData& data,
                                ComputeExecutionContext& ctx)
 {
     int demod = m_Config.useAlbedoDemod ? 1 : 0;
-    ctx.BindPipeline("SVGF_Temporal");
+    if (!ctx.BindPipeline("SVGF_Temporal")) return;
     ctx.PushConstants(VK_SHADER_STAGE_ALL, demod);
     ctx.Dispatch("SVGF_Temporal", (ctx.GetGraph().GetWidth() + 15) / 16,
                  (ctx.GetGraph().GetHeight() + 15) / 16);
@@ -97,12 +99,14 @@ void SVGFVarianceEstimatePass::Setup(SVGFVarianceEstimateData& data,
     data.outputIllum = builder.WriteStorage(m_OutputIllum)
                            .Format(VK_FORMAT_R16G16B16A16_SFLOAT)
                            .BindTo("outSignal");
+
+    builder.DeclareKernel("SVGF_FilterMoments");
 }
 void SVGFVarianceEstimatePass::Execute(const SVGFVarianceEstimateData& data,
                                        ComputeExecutionContext& ctx)
 {
     int demod = m_Config.useAlbedoDemod ? 1 : 0;
-    ctx.BindPipeline("SVGF_FilterMoments");
+    if (!ctx.BindPipeline("SVGF_FilterMoments")) return;
     ctx.PushConstants(VK_SHADER_STAGE_ALL, demod);
     ctx.Dispatch("SVGF_FilterMoments", (ctx.GetGraph().GetWidth() + 15) / 16,
                  (ctx.GetGraph().GetHeight() + 15) / 16);
@@ -137,6 +141,8 @@ void SVGFAtrousPass::Setup(SVGFAtrousData& data,
         outputProxy.SaveAsHistory(m_HistoryName);
     }
     data.output = outputProxy;
+
+    builder.DeclareKernel("SVGF_Atrous");
 }
 void SVGFAtrousPass::Execute(const SVGFAtrousData& data,
                              ComputeExecutionContext& ctx)
@@ -149,7 +155,7 @@ void SVGFAtrousPass::Execute(const SVGFAtrousData& data,
     pc.step = 1 << m_Iteration;
     pc.useAlbedoDemod = m_Config.useAlbedoDemod ? 1 : 0;
 
-    ctx.BindPipeline("SVGF_Atrous");
+    if (!ctx.BindPipeline("SVGF_Atrous")) return;
     ctx.PushConstants(VK_SHADER_STAGE_ALL, pc);
     ctx.Dispatch("SVGF_Atrous", (ctx.GetGraph().GetWidth() + 15) / 16,
                  (ctx.GetGraph().GetHeight() + 15) / 16);
@@ -172,12 +178,14 @@ void SVGFCombinePass::Setup(SVGFCombineData& data,
                       .Format(VK_FORMAT_R16G16B16A16_SFLOAT)
                       .BindTo("outFinal");
     data.albedo = builder.ReadCompute(RS::Albedo, "gAlbedo");
+
+    builder.DeclareKernel("SVGF_Combine");
 }
 void SVGFCombinePass::Execute(const SVGFCombineData& data,
                               ComputeExecutionContext& ctx)
 {
     int remod = m_Config.useAlbedoDemod ? 1 : 0;
-    ctx.BindPipeline("SVGF_Combine");
+    if (!ctx.BindPipeline("SVGF_Combine")) return;
     ctx.PushConstants(VK_SHADER_STAGE_ALL, remod);
     ctx.Dispatch("SVGF_Combine", (ctx.GetGraph().GetWidth() + 15) / 16,
                  (ctx.GetGraph().GetHeight() + 15) / 16);
@@ -6,10 +6,23 @@
 
 namespace Chimera
 {
+static GraphicsPipelineDescription MakeSkyboxPipeline()
+{
+    GraphicsPipelineDescription desc;
+    desc.name = "Skybox";
+    desc.vertex_shader = "Fullscreen_Vert";
+    desc.fragment_shader = "Skybox_Frag";
+    desc.depth_test = false;
+    desc.depth_write = false;
+    return desc;
+}
+
 void SkyboxPass::Setup(SkyboxPassData& data, RenderGraph::PassBuilder& builder)
 {
     data.output =
         builder.Write(RS::FinalColor).Format(VK_FORMAT_R16G16B16A16_SFLOAT);
+
+    builder.DeclarePipeline(MakeSkyboxPipeline());
 }
 
 void SkyboxPass::Execute(const SkyboxPassData& data, RenderGraphRegistry& reg,
@@ -17,14 +30,7 @@ void SkyboxPass::Execute(const SkyboxPassData& data, RenderGraphRegistry& reg,
 {
     GraphicsExecutionContext ctx(reg.graph, reg.pass, cmd);
 
-    GraphicsPipelineDescription desc;
-    desc.name = "Skybox";
-    desc.vertex_shader = "Fullscreen_Vert";
-    desc.fragment_shader = "Skybox_Frag";
-    desc.depth_test = false;
-    desc.depth_write = false;
-
-    ctx.BindPipeline(desc);
+    if (!ctx.BindPipeline(MakeSkyboxPipeline())) return;
 
         // Use a full-screen triangle to draw skybox
     vkCmdDraw(cmd, 3, 1, 0, 0);
@@ -44,6 +44,8 @@ void AddSkyboxPass(RenderGraph& graph)
         {
             data.output = builder.Write(RS::FinalColor)
                               .Format(VK_FORMAT_R16G16B16A16_SFLOAT);
+            builder.DeclarePipeline(GraphicsPipelineDescription{
+                "Skybox", "Fullscreen_Vert", "Skybox_Frag", false, false});
         },
         [](const SkyboxData& data, RenderGraphRegistry& reg,
            VkCommandBuffer cmd)
@@ -51,7 +53,6 @@ void AddSkyboxPass(RenderGraph& graph)
             GraphicsExecutionContext ctx(reg.graph, reg.pass, cmd);
             GraphicsPipelineDescription desc{"Skybox", "Fullscreen_Vert",
                                              "Skybox_Frag", false, false};
-            ctx.BindPipeline(desc);
             ctx.DrawMeshes(desc, nullptr);
         });
 }
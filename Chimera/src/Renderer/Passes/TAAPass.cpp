@@ -27,13 +27,15 @@ void TAAPass::Setup(PassData& data, RenderGraph::PassBuilder& builder)
                       .Format(VK_FORMAT_R16G16B16A16_SFLOAT)
                       .SaveAsHistory("TAAOutput")
                       .BindTo("outFinal");
+
+    builder.DeclareKernel("TAA_Comp");
 }
 
 void TAAPass::Execute(const PassData& data, RenderGraphRegistry& reg,
                       VkCommandBuffer cmd)
 {
     ComputeExecutionContext ctx(reg.graph, reg.pass, cmd);
-    ctx.BindPipeline("TAA_Comp");
+    if (!ctx.BindPipeline("TAA_Comp")) return;
     ctx.Dispatch("TAA_Comp", (ctx.GetGraph().GetWidth() + 15) / 16,
                  (ctx.GetGraph().GetHeight() + 15) / 16);
 }
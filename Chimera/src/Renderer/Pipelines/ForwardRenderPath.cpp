@@ -3,6 +3,7 @@
 #include "Renderer/Backend/VulkanContext.h"
 #include "Renderer/Graph/RenderGraph.h"
 #include "Renderer/Graph/ResourceNames.h"
+#include "Renderer/Passes/ClusterLightCullingPass.h"
 #include "Renderer/Passes/ForwardPass.h"
 #include "Renderer/Passes/SkyboxPass.h"
 #include "Renderer/Passes/TAAPass.h"
@@ -19,6 +20,7 @@ ForwardRenderPath::ForwardRenderPath(VulkanContext& context)
 void ForwardRenderPath::BuildGraph(RenderGraph& graph,
                                    std::shared_ptr<Scene> scene)
 {
+    graph.AddPass<ClusterLightCullingPass>();
     graph.AddPass<ForwardPass>(scene);
 
     const bool taaEnabled =
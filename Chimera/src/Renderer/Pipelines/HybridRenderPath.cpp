@@ -10,6 +10,7 @@
 #include "Renderer/Passes/RTAOPass.h"
 #include "Renderer/Passes/RTReflectionPass.h"
 #include "Renderer/Passes/RTDiffuseGIPass.h"
+#include "Renderer/Passes/RestirDIPass.h"
 #include "Renderer/Passes/SVGFPass.h"
 #include "Renderer/Passes/CompositionPass.h"
 #include "Renderer/Passes/TAAPass.h"
@@ -50,6 +51,7 @@ void HybridRenderPath::BuildGraph(RenderGraph& graph,
     if (useRayTracing)
     {
         graph.AddPass<RTShadowPass>(scene);
+        graph.AddPass<RestirDIPass>(scene);
 
         graph.AddPass<RTReflectionPass>(scene);
         graph.AddPass<RTDiffuseGIPass>(scene);
@@ -62,6 +64,8 @@ void HybridRenderPath::BuildGraph(RenderGraph& graph,
 
         StandardPasses::AddClearPass(graph, RS::ShadowAO, fullyVisible);
 
+        StandardPasses::AddClearPass(graph, RS::RestirDIRaw, black);
+
         StandardPasses::AddClearPass(graph, "ReflectionRaw", black);
 
         StandardPasses::AddClearPass(graph, "GIRaw", black);
@@ -83,6 +87,14 @@ void HybridRenderPath::BuildGraph(RenderGraph& graph,
             false; // No albedo for raw visibility signals
         graph.AddPass<SVGFPass>(scene, shadowAOConfig);
 
+        // --- ReSTIR direct lighting SVGF ---
+        SVGFPass::Config directConfig = baseConfig;
+        directConfig.inputName = RS::RestirDIRaw;
+        directConfig.prefix = "DirectLights";
+        directConfig.historyBaseName = "DirectLightsAccum";
+        directConfig.useAlbedoDemod = true;
+        graph.AddPass<SVGFPass>(scene, directConfig);
+
         // --- Reflection SVGF ---
         SVGFPass::Config reflConfig = baseConfig;
         reflConfig.inputName = "ReflectionRaw";
@@ -110,6 +122,9 @@ void HybridRenderPath::BuildGraph(RenderGraph& graph,
     compConfig.reflectionName =
         svgfActive ? "Refl_Filtered_Final" : "ReflectionRaw";
     compConfig.giName = svgfActive ? "GI_Filtered_Final" : "GIRaw";
+    compConfig.directLightName =
+        svgfActive ? "DirectLights_Filtered_Final" : RS::RestirDIRaw;
+    compConfig.renderFlags = renderFlags;
 
     graph.AddPass<CompositionPass>(compConfig);
 
@@ -9,6 +9,7 @@
 #include "Renderer/Passes/TAAPass.h"
 #include "Renderer/Passes/PostProcessPass.h"
 #include "Renderer/Graph/RaytracingExecutionContext.h"
+#include "Renderer/Passes/ClusterLightCullingPass.h"
 #include "Renderer/Passes/ForwardPass.h"
 
 #include "Core/Application.h"
@@ -34,6 +35,7 @@ void RayTracedRenderPath::BuildGraph(RenderGraph& graph,
     }
     else
     {
+        graph.AddPass<ClusterLightCullingPass>();
         graph.AddPass<ForwardPass>(scene);
     }
 
@@ -13,6 +13,16 @@
 
 namespace Chimera
 {
+    // CPU cost of the first frame after a graph (re)build and the time until
+    // its prewarmed pipelines finished compiling in the background.
+struct RenderPathColdStartStats
+{
+    uint32_t pipelineCount = 0;
+    double pipelineCreationMS = 0.0; // Summed over all compiling threads
+    double firstFrameMS = 0.0;
+    double pipelinesReadyMS = 0.0;
+};
+
 class RenderPath
 {
 public:
@@ -81,6 +91,11 @@ public:
         return m_BenchmarkRecorder;
     }
 
+    const RenderPathColdStartStats& GetColdStartStats() const
+    {
+        return m_ColdStartStats;
+    }
+
 protected:
         // Pure virtual hook for specific render path logic
     virtual void BuildGraph(RenderGraph& graph,
@@ -97,6 +112,11 @@ protected:
 private:
     BenchmarkRecorder m_BenchmarkRecorder;
     uint64_t m_LastConsumedTimingSampleId = 0;
+
+    RenderPathColdStartStats m_ColdStartStats;
+    std::chrono::high_resolution_clock::time_point m_ColdStartBegin;
+    bool m_MeasuringColdStart = false;
+    bool m_FirstFrameRecorded = false;
 };
 
 } // namespace Chimera
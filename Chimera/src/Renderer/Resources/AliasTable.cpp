@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "AliasTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace Chimera
+{
+uint32_t AliasTable::Sample(float random) const
+{
+    const uint32_t count = (uint32_t)entries.size();
+    const float scaled = random * float(count);
+    const uint32_t index =
+        std::min((uint32_t)std::max(scaled, 0.0f), count - 1);
+    const Entry& entry = entries[index];
+    return scaled - float(index) < entry.threshold ? index : entry.alias;
+}
+
+void AliasTable::AppendTo(std::vector<float>& out) const
+{
+    out.reserve(out.size() + GetPackedSize());
+    for (const Entry& entry : entries)
+    {
+        out.push_back(entry.threshold);
+        out.push_back(std::bit_cast<float>(entry.alias));
+        out.push_back(entry.pmf);
+    }
+}
+
+AliasTable BuildAliasTable(const float* weights, uint32_t count)
+{
+    AliasTable table;
+    if (!weights || count == 0) return table;
+
+    double total = 0.0;
+    for (uint32_t i = 0; i < count; ++i)
+        if (weights[i] > 0.0f && std::isfinite(weights[i])) total += weights[i];
+    if (!(total > 0.0) || !std::isfinite(total)) return table;
+
+    // Vose's method: entries scaled so the mean is one are split into
+    // those below and above it, and each small entry is topped up from a
+    // large one, which becomes its alias.
+    table.entries.resize(count);
+    std::vector<double> scaled(count);
+    std::vector<uint32_t> small, large;
+    uint32_t anyPositive = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const double weight =
+            weights[i] > 0.0f && std::isfinite(weights[i]) ? weights[i] : 0.0;
+        if (weight > 0.0) anyPositive = i;
+        table.entries[i].pmf = float(weight / total);
+        scaled[i] = weight / total * count;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        const uint32_t s = small.back(), l = large.back();
+        small.pop_back();
+        table.entries[s].threshold = float(scaled[s]);
+        table.entries[s].alias = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // What is left is within rounding of one. An entry without weight
+    // must still never be kept.
+    for (uint32_t i : large) table.entries[i] = {1.0f, i, table.entries[i].pmf};
+    for (uint32_t i : small)
+    {
+        const bool keep = table.entries[i].pmf > 0.0f;
+        table.entries[i].threshold = keep ? 1.0f : 0.0f;
+        table.entries[i].alias = keep ? i : anyPositive;
+    }
+    return table;
+}
+} // namespace Chimera
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // Floats one entry takes in the light CDF buffer: the probability of
+    // keeping the entry, its alias as uint bits and its own probability.
+constexpr uint32_t AliasEntryFloats = 3;
+
+    // Walker alias table over discrete weights: one uniform number picks
+    // index i with probability weights[i] / total in constant time,
+    // however many entries there are. Negative and NaN weights count as
+    // zero; a table without any weight is empty.
+struct AliasTable
+{
+    struct Entry
+    {
+        float threshold = 1.0f;
+        uint32_t alias = 0;
+        float pmf = 0.0f;
+    };
+    std::vector<Entry> entries;
+
+    bool IsValid() const
+    {
+        return !entries.empty();
+    }
+
+        // Maps a uniform number in [0, 1) to an index, as SampleAlias in
+        // common.glsl does.
+    uint32_t Sample(float random) const;
+    float Pmf(uint32_t index) const
+    {
+        return entries[index].pmf;
+    }
+
+        // Appends AliasEntryFloats floats per entry, in index order.
+    void AppendTo(std::vector<float>& out) const;
+    uint32_t GetPackedSize() const
+    {
+        return (uint32_t)entries.size() * AliasEntryFloats;
+    }
+};
+
+AliasTable BuildAliasTable(const float* weights, uint32_t count);
+} // namespace Chimera
@@ -0,0 +1,72 @@
+#include "pch.h"
+#include "BLASBatch.h"
+
+#include <algorithm>
+
+namespace Chimera
+{
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+AlignedLayout PackAligned(const std::vector<uint64_t>& sizes,
+                          uint64_t alignment)
+{
+    AlignedLayout layout;
+    layout.offsets.reserve(sizes.size());
+    for (uint64_t size : sizes)
+    {
+        const uint64_t offset = AlignUp(layout.size, alignment);
+        layout.offsets.push_back(offset);
+        layout.size = offset + size;
+    }
+    return layout;
+}
+
+ScratchPlan PlanScratch(const std::vector<uint64_t>& scratchSizes,
+                        uint64_t alignment, uint64_t budget)
+{
+    ScratchPlan plan;
+    plan.offsets.reserve(scratchSizes.size());
+    uint64_t used = 0;
+    for (uint32_t i = 0; i < (uint32_t)scratchSizes.size(); ++i)
+    {
+        uint64_t offset = AlignUp(used, alignment);
+        if (plan.batches.empty() || offset + scratchSizes[i] > budget)
+        {
+            plan.batches.push_back({i, 0});
+            offset = 0;
+        }
+        plan.offsets.push_back(offset);
+        used = offset + scratchSizes[i];
+        plan.batches.back().count++;
+        plan.arenaSize = std::max(plan.arenaSize, used);
+    }
+    return plan;
+}
+
+std::vector<BLASGroup> GroupMeshesForBLAS(
+    const std::vector<BLASMeshInfo>& meshes, BLASGranularity granularity)
+{
+    std::vector<BLASGroup> groups;
+    bool extendable = false;
+    for (uint32_t i = 0; i < (uint32_t)meshes.size(); ++i)
+    {
+        if (meshes[i].triangleCount == 0)
+        {
+            extendable = false;
+            continue;
+        }
+        if (extendable && granularity == BLASGranularity::PerModel &&
+            meshes[i].transform == meshes[groups.back().firstMesh].transform)
+        {
+            groups.back().meshCount++;
+            continue;
+        }
+        groups.push_back({i, 1});
+        extendable = true;
+    }
+    return groups;
+}
+} // namespace Chimera
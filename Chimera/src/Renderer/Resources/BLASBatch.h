@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // Acceleration structures must start on this many bytes inside their
+    // buffer.
+constexpr uint64_t AccelerationStructureAlignment = 256;
+
+    // Regions of the given sizes packed back to back in one buffer, each
+    // starting on alignment, which must be a power of two.
+struct AlignedLayout
+{
+    std::vector<uint64_t> offsets;
+    uint64_t size = 0;
+};
+
+AlignedLayout PackAligned(const std::vector<uint64_t>& sizes,
+                          uint64_t alignment);
+
+    // Bottom level builds split into runs that each fit a scratch budget.
+    // Builds of one run are recorded in a single
+    // vkCmdBuildAccelerationStructuresKHR call and run concurrently, so
+    // each has its own scratch region; the next run reuses the arena after
+    // a barrier. A build larger than the budget gets a run of its own.
+struct ScratchPlan
+{
+    struct Batch
+    {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+    std::vector<Batch> batches;
+        // Per build, from the start of the arena.
+    std::vector<uint64_t> offsets;
+        // Largest run, which the arena must hold.
+    uint64_t arenaSize = 0;
+};
+
+ScratchPlan PlanScratch(const std::vector<uint64_t>& scratchSizes,
+                        uint64_t alignment, uint64_t budget);
+
+    // How a model's meshes map to bottom level structures. PerMesh builds
+    // one per mesh. PerModel merges consecutive meshes that share a
+    // transform into one structure with a geometry per mesh, so a model
+    // whose meshes all sit under one node transform gets a single
+    // structure and instance.
+enum class BLASGranularity
+{
+    PerMesh,
+    PerModel
+};
+
+struct BLASMeshInfo
+{
+    uint32_t triangleCount = 0;
+        // Model space transform, column major.
+    std::array<float, 16> transform{};
+};
+
+    // A structure's meshes, firstMesh onwards. Its geometry g is mesh
+    // firstMesh + g, which hit shaders recover as the instance's custom
+    // index plus gl_GeometryIndexEXT.
+struct BLASGroup
+{
+    uint32_t firstMesh = 0;
+    uint32_t meshCount = 0;
+};
+
+    // Groups in mesh order. Meshes without triangles get no structure and
+    // end the group before them.
+std::vector<BLASGroup> GroupMeshesForBLAS(
+    const std::vector<BLASMeshInfo>& meshes, BLASGranularity granularity);
+} // namespace Chimera
@@ -0,0 +1,24 @@
+#include "pch.h"
+#include "BindlessCapacity.h"
+
+#include <algorithm>
+
+namespace Chimera
+{
+uint32_t ChooseBindlessTextureCapacity(const BindlessLimits& limits,
+                                       uint32_t setCount, uint32_t reserved,
+                                       uint32_t ceiling)
+{
+    uint32_t budget = std::min({limits.maxPerStageSamplers,
+                                limits.maxPerStageSampledImages,
+                                limits.maxPerStageResources,
+                                limits.maxSetSamplers,
+                                limits.maxSetSampledImages});
+    budget = std::min(budget,
+                      limits.maxDescriptorsInAllPools / std::max(setCount, 1u));
+
+        // Small limits cannot spare the full reservation; split them.
+    budget = budget > reserved ? budget - reserved : budget / 2;
+    return std::clamp(budget, 1u, std::max(ceiling, 1u));
+}
+} // namespace Chimera
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Chimera
+{
+    // The update-after-bind limits that bound a bindless combined image
+    // sampler array. Mirrors the fields of
+    // VkPhysicalDeviceVulkan12Properties so this stays free of Vulkan.
+struct BindlessLimits
+{
+    uint32_t maxPerStageSamplers = 0;
+    uint32_t maxPerStageSampledImages = 0;
+    uint32_t maxPerStageResources = 0;
+    uint32_t maxSetSamplers = 0;
+    uint32_t maxSetSampledImages = 0;
+    uint32_t maxDescriptorsInAllPools = 0;
+};
+
+    // Number of texture slots for each of setCount bindless sets. reserved
+    // descriptors are left for the other sets of a pipeline layout and the
+    // result never exceeds ceiling. Always at least 1.
+uint32_t ChooseBindlessTextureCapacity(const BindlessLimits& limits,
+                                       uint32_t setCount, uint32_t reserved,
+                                       uint32_t ceiling);
+} // namespace Chimera
@@ -0,0 +1,760 @@
+#include "pch.h"
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace Chimera
+{
+namespace
+{
+    // Interpolation weights of 4-bit BC6H and BC7 indices, out of 64.
+constexpr std::array<int, 16> Weights4 = {0,  4,  9,  13, 17, 21, 26, 30,
+                                          34, 38, 43, 47, 51, 55, 60, 64};
+
+constexpr uint32_t BC7Mode6Bits = 0x40; // Six zero bits, then a one
+constexpr uint32_t BC6HMode11Bits = 0x03;
+
+void PutBits(uint8_t* block, uint32_t& bit, uint32_t value, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i, ++bit)
+    {
+        if ((value >> i) & 1u) block[bit >> 3] |= uint8_t(1u << (bit & 7));
+    }
+}
+
+uint32_t GetBits(const uint8_t* block, uint32_t& bit, uint32_t count)
+{
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < count; ++i, ++bit)
+        value |= uint32_t((block[bit >> 3] >> (bit & 7)) & 1u) << i;
+    return value;
+}
+
+    // Endpoints spanning the texels' projection onto their principal axis,
+    // found by power iteration on the covariance. Flat blocks get both
+    // endpoints at the mean.
+template <int N>
+void FitEndpoints(const float (&texels)[16][N], float (&e0)[N],
+                  float (&e1)[N])
+{
+    float mean[N] = {};
+    for (const auto& t : texels)
+        for (int c = 0; c < N; ++c) mean[c] += t[c] / 16.0f;
+
+    float cov[N][N] = {};
+    for (const auto& t : texels)
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
+                cov[i][j] += (t[i] - mean[i]) * (t[j] - mean[j]);
+
+    float axis[N];
+    for (int c = 0; c < N; ++c) axis[c] = 1.0f;
+    for (int iteration = 0; iteration < 8; ++iteration)
+    {
+        float next[N] = {};
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j) next[i] += cov[i][j] * axis[j];
+        float length = 0.0f;
+        for (int c = 0; c < N; ++c) length += next[c] * next[c];
+        length = std::sqrt(length);
+        if (length < 1e-6f)
+        {
+            for (int c = 0; c < N; ++c) e0[c] = e1[c] = mean[c];
+            return;
+        }
+        for (int c = 0; c < N; ++c) axis[c] = next[c] / length;
+    }
+
+    float tMin = 0.0f, tMax = 0.0f;
+    for (const auto& t : texels)
+    {
+        float d = 0.0f;
+        for (int c = 0; c < N; ++c) d += (t[c] - mean[c]) * axis[c];
+        tMin = std::min(tMin, d);
+        tMax = std::max(tMax, d);
+    }
+    for (int c = 0; c < N; ++c)
+    {
+        e0[c] = mean[c] + tMin * axis[c];
+        e1[c] = mean[c] + tMax * axis[c];
+    }
+}
+
+    // Endpoints minimising the squared error of texels already assigned the
+    // interpolation factors t. Returns false when the system is singular
+    // (every texel uses the same factor).
+template <int N>
+bool RefineEndpoints(const float (&texels)[16][N], const float (&t)[16],
+                     float (&e0)[N], float (&e1)[N])
+{
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    float r0[N] = {}, r1[N] = {};
+    for (int i = 0; i < 16; ++i)
+    {
+        const float s = 1.0f - t[i];
+        a += s * s;
+        b += s * t[i];
+        c += t[i] * t[i];
+        for (int ch = 0; ch < N; ++ch)
+        {
+            r0[ch] += s * texels[i][ch];
+            r1[ch] += t[i] * texels[i][ch];
+        }
+    }
+    const float det = a * c - b * b;
+    if (std::abs(det) < 1e-6f) return false;
+    for (int ch = 0; ch < N; ++ch)
+    {
+        e0[ch] = (c * r0[ch] - b * r1[ch]) / det;
+        e1[ch] = (a * r1[ch] - b * r0[ch]) / det;
+    }
+    return true;
+}
+
+// --- BC4 ---
+
+struct BC4Fit
+{
+    uint8_t red0 = 0;
+    uint8_t red1 = 0;
+    uint8_t indices[16] = {};
+    uint32_t error = 0;
+};
+
+void BC4Palette(uint8_t red0, uint8_t red1, uint8_t (&palette)[8])
+{
+    palette[0] = red0;
+    palette[1] = red1;
+    if (red0 > red1)
+    {
+        for (int k = 2; k < 8; ++k)
+            palette[k] = uint8_t(((8 - k) * red0 + (k - 1) * red1 + 3) / 7);
+    }
+    else
+    {
+        for (int k = 2; k < 6; ++k)
+            palette[k] = uint8_t(((6 - k) * red0 + (k - 1) * red1 + 2) / 5);
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+BC4Fit FitBC4(const uint8_t (&values)[16], uint8_t red0, uint8_t red1)
+{
+    BC4Fit fit;
+    fit.red0 = red0;
+    fit.red1 = red1;
+    uint8_t palette[8];
+    BC4Palette(red0, red1, palette);
+    for (int i = 0; i < 16; ++i)
+    {
+        uint32_t best = UINT32_MAX;
+        for (uint8_t k = 0; k < 8; ++k)
+        {
+            const int d = int(values[i]) - int(palette[k]);
+            if (uint32_t(d * d) < best)
+            {
+                best = uint32_t(d * d);
+                fit.indices[i] = k;
+            }
+        }
+        fit.error += best;
+    }
+    return fit;
+}
+
+uint8_t ClampToByte(float value)
+{
+    return uint8_t(std::clamp(std::lround(value), 0L, 255L));
+}
+
+void EncodeBC4Channel(const uint8_t* rgba, int channel, uint8_t* out)
+{
+    uint8_t values[16];
+    uint8_t lo = 255, hi = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        values[i] = rgba[i * 4 + channel];
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+
+    BC4Fit best = FitBC4(values, hi, lo);
+    if (hi > lo && best.error > 0)
+    {
+            // Palette entry k of the eight-value mode sits at (k - 1) / 7
+            // between red0 and red1; entries 0 and 1 are the endpoints.
+        float texels[16][1], t[16];
+        for (int i = 0; i < 16; ++i)
+        {
+            texels[i][0] = values[i];
+            const int k = best.indices[i];
+            t[i] = k == 0 ? 0.0f : k == 1 ? 1.0f : (k - 1) / 7.0f;
+        }
+        float e0[1], e1[1];
+        if (RefineEndpoints(texels, t, e0, e1))
+        {
+            const uint8_t red0 = ClampToByte(e0[0]);
+            const uint8_t red1 = ClampToByte(e1[0]);
+            if (red0 > red1)
+            {
+                const BC4Fit refined = FitBC4(values, red0, red1);
+                if (refined.error < best.error) best = refined;
+            }
+        }
+    }
+
+    std::memset(out, 0, 8);
+    uint32_t bit = 0;
+    PutBits(out, bit, best.red0, 8);
+    PutBits(out, bit, best.red1, 8);
+    for (int i = 0; i < 16; ++i) PutBits(out, bit, best.indices[i], 3);
+}
+
+void DecodeBC4Channel(const uint8_t* block, int channel, uint8_t* rgba)
+{
+    uint32_t bit = 0;
+    const uint8_t red0 = uint8_t(GetBits(block, bit, 8));
+    const uint8_t red1 = uint8_t(GetBits(block, bit, 8));
+    uint8_t palette[8];
+    BC4Palette(red0, red1, palette);
+    for (int i = 0; i < 16; ++i)
+        rgba[i * 4 + channel] = palette[GetBits(block, bit, 3)];
+}
+
+// --- BC7 mode 6 ---
+
+struct BC7Fit
+{
+    uint8_t colour[2][4] = {}; // 7-bit endpoint values
+    uint8_t pbit[2] = {};
+    uint8_t indices[16] = {};
+    uint64_t error = 0;
+};
+
+    // Nearest 7-bit value plus shared p-bit for an 8-bit endpoint.
+void QuantizeBC7Endpoint(const float (&endpoint)[4], uint8_t (&colour)[4],
+                         uint8_t& pbit)
+{
+    float bestError = INFINITY;
+    for (uint8_t p = 0; p < 2; ++p)
+    {
+        uint8_t candidate[4];
+        float error = 0.0f;
+        for (int c = 0; c < 4; ++c)
+        {
+            const float v = std::clamp(endpoint[c], 0.0f, 255.0f);
+            candidate[c] =
+                uint8_t(std::clamp(std::lround((v - p) * 0.5f), 0L, 127L));
+            const float d = float(candidate[c] * 2 + p) - v;
+            error += d * d;
+        }
+        if (error < bestError)
+        {
+            bestError = error;
+            std::memcpy(colour, candidate, 4);
+            pbit = p;
+        }
+    }
+}
+
+void BC7Palette(const uint8_t (&colour)[2][4], const uint8_t (&pbit)[2],
+                int (&palette)[16][4])
+{
+    for (int c = 0; c < 4; ++c)
+    {
+        const int a = colour[0][c] * 2 + pbit[0];
+        const int b = colour[1][c] * 2 + pbit[1];
+        for (int k = 0; k < 16; ++k)
+            palette[k][c] = ((64 - Weights4[k]) * a + Weights4[k] * b + 32) >> 6;
+    }
+}
+
+BC7Fit FitBC7(const uint8_t* rgba, const float (&e0)[4], const float (&e1)[4])
+{
+    BC7Fit fit;
+    QuantizeBC7Endpoint(e0, fit.colour[0], fit.pbit[0]);
+    QuantizeBC7Endpoint(e1, fit.colour[1], fit.pbit[1]);
+    int palette[16][4];
+    BC7Palette(fit.colour, fit.pbit, palette);
+    for (int i = 0; i < 16; ++i)
+    {
+        const uint8_t* texel = rgba + i * 4;
+        int best = INT32_MAX;
+        for (uint8_t k = 0; k < 16; ++k)
+        {
+            int error = 0;
+            for (int c = 0; c < 4; ++c)
+            {
+                const int d = int(texel[c]) - palette[k][c];
+                error += d * d;
+            }
+            if (error < best)
+            {
+                best = error;
+                fit.indices[i] = k;
+            }
+        }
+        fit.error += uint64_t(best);
+    }
+    return fit;
+}
+
+// --- BC6H mode 11 ---
+
+uint16_t FloatToHalfUnsigned(float value)
+{
+    if (!(value > 0.0f)) return 0; // Negative, zero or NaN
+    if (value >= 65504.0f) return 0x7BFF;
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const int exponent = int((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if (exponent <= 0)
+    {
+        if (exponent < -10) return 0;
+        mantissa |= 0x800000;
+        const uint32_t shift = uint32_t(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        if ((mantissa >> (shift - 1)) & 1u) ++half;
+        return uint16_t(half);
+    }
+    uint32_t half = (uint32_t(exponent) << 10) | (mantissa >> 13);
+    if (mantissa & 0x1000) ++half; // Carries into the exponent correctly
+    return uint16_t(std::min(half, 0x7BFFu));
+}
+
+float HalfToFloat(uint16_t half)
+{
+    const uint32_t exponent = (half >> 10) & 0x1F;
+    const uint32_t mantissa = half & 0x3FF;
+    float value;
+    if (exponent == 0)
+        value = std::ldexp(float(mantissa), -24);
+    else if (exponent == 31)
+        value = mantissa ? NAN : INFINITY;
+    else
+        value = std::ldexp(float(mantissa | 0x400), int(exponent) - 25);
+    return (half & 0x8000) ? -value : value;
+}
+
+    // BC6H interpolates in the 16-bit "unquantized" space and maps the
+    // result to half-float bits with (x * 31) >> 6. Encoding works in the
+    // inverse of that mapping so errors are measured where blocks are
+    // interpolated.
+float HalfToUnquantized(uint16_t half)
+{
+    return float(half) * 64.0f / 31.0f;
+}
+
+int UnquantizeBC6H10(int q)
+{
+    if (q == 0) return 0;
+    if (q == 1023) return 0xFFFF;
+    return ((q << 16) + 0x8000) >> 10;
+}
+
+struct BC6HFit
+{
+    uint16_t endpoint[2][3] = {}; // 10-bit values
+    uint8_t indices[16] = {};
+    double error = 0.0;
+};
+
+void BC6HPalette(const uint16_t (&endpoint)[2][3], int (&palette)[16][3])
+{
+    for (int c = 0; c < 3; ++c)
+    {
+        const int a = UnquantizeBC6H10(endpoint[0][c]);
+        const int b = UnquantizeBC6H10(endpoint[1][c]);
+        for (int k = 0; k < 16; ++k)
+            palette[k][c] = ((64 - Weights4[k]) * a + Weights4[k] * b + 32) >> 6;
+    }
+}
+
+BC6HFit FitBC6H(const float (&texels)[16][3], const float (&e0)[3],
+                const float (&e1)[3])
+{
+    BC6HFit fit;
+    for (int c = 0; c < 3; ++c)
+    {
+        fit.endpoint[0][c] = uint16_t(
+            std::clamp(std::lround((e0[c] - 32.0f) / 64.0f), 0L, 1023L));
+        fit.endpoint[1][c] = uint16_t(
+            std::clamp(std::lround((e1[c] - 32.0f) / 64.0f), 0L, 1023L));
+    }
+    int palette[16][3];
+    BC6HPalette(fit.endpoint, palette);
+    for (int i = 0; i < 16; ++i)
+    {
+        float best = INFINITY;
+        for (uint8_t k = 0; k < 16; ++k)
+        {
+            float error = 0.0f;
+            for (int c = 0; c < 3; ++c)
+            {
+                const float d = texels[i][c] - float(palette[k][c]);
+                error += d * d;
+            }
+            if (error < best)
+            {
+                best = error;
+                fit.indices[i] = k;
+            }
+        }
+        fit.error += best;
+    }
+    return fit;
+}
+
+    // Texel 0 stores three index bits, so its index must be below 8;
+    // otherwise the endpoints are swapped and every index inverted.
+void FixAnchor(BC7Fit& fit)
+{
+    if (fit.indices[0] < 8) return;
+    for (auto& index : fit.indices) index = uint8_t(15 - index);
+    std::swap(fit.colour[0], fit.colour[1]);
+    std::swap(fit.pbit[0], fit.pbit[1]);
+}
+
+void FixAnchor(BC6HFit& fit)
+{
+    if (fit.indices[0] < 8) return;
+    for (auto& index : fit.indices) index = uint8_t(15 - index);
+    std::swap(fit.endpoint[0], fit.endpoint[1]);
+}
+
+void PutIndices(uint8_t* out, uint32_t& bit, const uint8_t (&indices)[16])
+{
+    PutBits(out, bit, indices[0], 3);
+    for (int i = 1; i < 16; ++i) PutBits(out, bit, indices[i], 4);
+}
+
+void GetIndices(const uint8_t* block, uint32_t& bit, uint8_t (&indices)[16])
+{
+    indices[0] = uint8_t(GetBits(block, bit, 3));
+    for (int i = 1; i < 16; ++i) indices[i] = uint8_t(GetBits(block, bit, 4));
+}
+
+template <typename Texel, typename Encode>
+void CompressLevel(const Texel* level, uint32_t width, uint32_t height,
+                   uint32_t blockBytes, Encode encode, uint8_t* out)
+{
+    Texel block[64];
+    for (uint32_t by = 0; by < height; by += 4)
+    {
+        for (uint32_t bx = 0; bx < width; bx += 4)
+        {
+            for (uint32_t y = 0; y < 4; ++y)
+            {
+                const uint32_t sy = std::min(by + y, height - 1);
+                for (uint32_t x = 0; x < 4; ++x)
+                {
+                    const uint32_t sx = std::min(bx + x, width - 1);
+                    std::memcpy(block + (y * 4 + x) * 4,
+                                level + ((size_t)sy * width + sx) * 4,
+                                4 * sizeof(Texel));
+                }
+            }
+            encode(block, out);
+            out += blockBytes;
+        }
+    }
+}
+} // namespace
+
+const char* BlockFormatToString(BlockFormat format)
+{
+    switch (format)
+    {
+        case BlockFormat::BC4:
+            return "BC4";
+        case BlockFormat::BC5:
+            return "BC5";
+        case BlockFormat::BC6H:
+            return "BC6H";
+        case BlockFormat::BC7:
+            return "BC7";
+    }
+    return "unknown";
+}
+
+uint32_t GetBlockBytes(BlockFormat format)
+{
+    return format == BlockFormat::BC4 ? 8 : 16;
+}
+
+uint64_t GetCompressedLevelSize(BlockFormat format, uint32_t width,
+                                uint32_t height)
+{
+    const uint64_t blocksX = (uint64_t(width) + 3) / 4;
+    const uint64_t blocksY = (uint64_t(height) + 3) / 4;
+    return blocksX * blocksY * GetBlockBytes(format);
+}
+
+uint64_t GetCompressedChainSize(BlockFormat format, uint32_t width,
+                                uint32_t height, uint32_t levelCount)
+{
+    uint64_t size = 0;
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        size += GetCompressedLevelSize(format, std::max(width >> level, 1u),
+                                       std::max(height >> level, 1u));
+    }
+    return size;
+}
+
+BlockFormat ChooseBlockFormat(const uint8_t* rgbaPixels, uint64_t texelCount,
+                              bool srgb, bool normalMap)
+{
+    if (normalMap) return BlockFormat::BC5;
+    if (srgb) return BlockFormat::BC7;
+    for (uint64_t i = 0; i < texelCount; ++i)
+    {
+        const uint8_t* texel = rgbaPixels + i * 4;
+        if (texel[0] != texel[1] || texel[0] != texel[2] || texel[3] != 255)
+            return BlockFormat::BC7;
+    }
+    return BlockFormat::BC4;
+}
+
+void EncodeBC4Block(const uint8_t* rgba, uint8_t* out)
+{
+    EncodeBC4Channel(rgba, 0, out);
+}
+
+void EncodeBC5Block(const uint8_t* rgba, uint8_t* out)
+{
+    EncodeBC4Channel(rgba, 0, out);
+    EncodeBC4Channel(rgba, 1, out + 8);
+}
+
+void EncodeBC7Block(const uint8_t* rgba, uint8_t* out)
+{
+    float texels[16][4];
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 4; ++c) texels[i][c] = rgba[i * 4 + c];
+
+    float e0[4], e1[4];
+    FitEndpoints(texels, e0, e1);
+    BC7Fit best = FitBC7(rgba, e0, e1);
+    if (best.error > 0)
+    {
+        float t[16];
+        for (int i = 0; i < 16; ++i) t[i] = Weights4[best.indices[i]] / 64.0f;
+        if (RefineEndpoints(texels, t, e0, e1))
+        {
+            const BC7Fit refined = FitBC7(rgba, e0, e1);
+            if (refined.error < best.error) best = refined;
+        }
+    }
+    FixAnchor(best);
+
+    std::memset(out, 0, 16);
+    uint32_t bit = 0;
+    PutBits(out, bit, BC7Mode6Bits, 7);
+    for (int c = 0; c < 4; ++c)
+    {
+        PutBits(out, bit, best.colour[0][c], 7);
+        PutBits(out, bit, best.colour[1][c], 7);
+    }
+    PutBits(out, bit, best.pbit[0], 1);
+    PutBits(out, bit, best.pbit[1], 1);
+    PutIndices(out, bit, best.indices);
+}
+
+void EncodeBC6HBlock(const float* rgba, uint8_t* out)
+{
+    float texels[16][3];
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+            texels[i][c] =
+                HalfToUnquantized(FloatToHalfUnsigned(rgba[i * 4 + c]));
+    }
+
+    float e0[3], e1[3];
+    FitEndpoints(texels, e0, e1);
+    BC6HFit best = FitBC6H(texels, e0, e1);
+    if (best.error > 0.0)
+    {
+        float t[16];
+        for (int i = 0; i < 16; ++i) t[i] = Weights4[best.indices[i]] / 64.0f;
+        if (RefineEndpoints(texels, t, e0, e1))
+        {
+            const BC6HFit refined = FitBC6H(texels, e0, e1);
+            if (refined.error < best.error) best = refined;
+        }
+    }
+    FixAnchor(best);
+
+    std::memset(out, 0, 16);
+    uint32_t bit = 0;
+    PutBits(out, bit, BC6HMode11Bits, 5);
+    for (int e = 0; e < 2; ++e)
+        for (int c = 0; c < 3; ++c) PutBits(out, bit, best.endpoint[e][c], 10);
+    PutIndices(out, bit, best.indices);
+}
+
+void DecodeBC4Block(const uint8_t* block, uint8_t* rgba)
+{
+    DecodeBC4Channel(block, 0, rgba);
+    for (int i = 0; i < 16; ++i)
+    {
+        rgba[i * 4 + 1] = rgba[i * 4 + 2] = rgba[i * 4];
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+void DecodeBC5Block(const uint8_t* block, uint8_t* rgba)
+{
+    DecodeBC4Channel(block, 0, rgba);
+    DecodeBC4Channel(block + 8, 1, rgba);
+    for (int i = 0; i < 16; ++i)
+    {
+        rgba[i * 4 + 2] = 0;
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+void DecodeBC7Block(const uint8_t* block, uint8_t* rgba)
+{
+    uint32_t bit = 0;
+    if (GetBits(block, bit, 7) != BC7Mode6Bits)
+        throw std::invalid_argument("DecodeBC7Block: only mode 6 is supported");
+
+    uint8_t colour[2][4];
+    for (int c = 0; c < 4; ++c)
+    {
+        colour[0][c] = uint8_t(GetBits(block, bit, 7));
+        colour[1][c] = uint8_t(GetBits(block, bit, 7));
+    }
+    uint8_t pbit[2];
+    pbit[0] = uint8_t(GetBits(block, bit, 1));
+    pbit[1] = uint8_t(GetBits(block, bit, 1));
+    uint8_t indices[16];
+    GetIndices(block, bit, indices);
+
+    int palette[16][4];
+    BC7Palette(colour, pbit, palette);
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < 4; ++c)
+            rgba[i * 4 + c] = uint8_t(palette[indices[i]][c]);
+}
+
+void DecodeBC6HBlock(const uint8_t* block, float* rgba)
+{
+    uint32_t bit = 0;
+    uint32_t mode = GetBits(block, bit, 2);
+    if (mode > 1) mode |= GetBits(block, bit, 3) << 2;
+    if (mode != BC6HMode11Bits)
+        throw std::invalid_argument(
+            "DecodeBC6HBlock: only mode 11 is supported");
+
+    uint16_t endpoint[2][3];
+    for (int e = 0; e < 2; ++e)
+        for (int c = 0; c < 3; ++c)
+            endpoint[e][c] = uint16_t(GetBits(block, bit, 10));
+    uint8_t indices[16];
+    GetIndices(block, bit, indices);
+
+    int palette[16][3];
+    BC6HPalette(endpoint, palette);
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+            rgba[i * 4 + c] =
+                HalfToFloat(uint16_t((palette[indices[i]][c] * 31) >> 6));
+        rgba[i * 4 + 3] = 1.0f;
+    }
+}
+
+std::vector<uint8_t> CompressMipChainRGBA8(BlockFormat format,
+                                           const uint8_t* chain,
+                                           uint32_t width, uint32_t height,
+                                           uint32_t levelCount)
+{
+    void (*encode)(const uint8_t*, uint8_t*) = nullptr;
+    switch (format)
+    {
+        case BlockFormat::BC4:
+            encode = EncodeBC4Block;
+            break;
+        case BlockFormat::BC5:
+            encode = EncodeBC5Block;
+            break;
+        case BlockFormat::BC7:
+            encode = EncodeBC7Block;
+            break;
+        case BlockFormat::BC6H:
+            throw std::invalid_argument(
+                "CompressMipChainRGBA8: BC6H needs float input");
+    }
+
+    const uint32_t blockBytes = GetBlockBytes(format);
+    std::vector<uint8_t> blocks(
+        GetCompressedChainSize(format, width, height, levelCount));
+    uint8_t* out = blocks.data();
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        const uint32_t w = std::max(width >> level, 1u);
+        const uint32_t h = std::max(height >> level, 1u);
+        CompressLevel(chain, w, h, blockBytes, encode, out);
+        chain += (size_t)w * h * 4;
+        out += GetCompressedLevelSize(format, w, h);
+    }
+    return blocks;
+}
+
+std::vector<uint8_t> CompressMipChainRGBA32F(const float* chain,
+                                             uint32_t width, uint32_t height,
+                                             uint32_t levelCount)
+{
+    std::vector<uint8_t> blocks(
+        GetCompressedChainSize(BlockFormat::BC6H, width, height, levelCount));
+    uint8_t* out = blocks.data();
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        const uint32_t w = std::max(width >> level, 1u);
+        const uint32_t h = std::max(height >> level, 1u);
+        CompressLevel(chain, w, h, GetBlockBytes(BlockFormat::BC6H),
+                      EncodeBC6HBlock, out);
+        chain += (size_t)w * h * 4;
+        out += GetCompressedLevelSize(BlockFormat::BC6H, w, h);
+    }
+    return blocks;
+}
+
+std::vector<float> DecompressLevelBC6H(const uint8_t* blocks, uint32_t width,
+                                       uint32_t height)
+{
+    std::vector<float> rgba((size_t)width * height * 4);
+    float decoded[64];
+    for (uint32_t by = 0; by < height; by += 4)
+    {
+        for (uint32_t bx = 0; bx < width; bx += 4)
+        {
+            DecodeBC6HBlock(blocks, decoded);
+            blocks += GetBlockBytes(BlockFormat::BC6H);
+            for (uint32_t y = by; y < std::min(by + 4, height); ++y)
+                std::memcpy(rgba.data() + ((size_t)y * width + bx) * 4,
+                            decoded + (y - by) * 16,
+                            std::min(4u, width - bx) * 4 * sizeof(float));
+        }
+    }
+    return rgba;
+}
+
+std::vector<uint16_t> ConvertToHalfUnsigned(const float* values,
+                                            uint64_t count)
+{
+    std::vector<uint16_t> halves(count);
+    for (uint64_t i = 0; i < count; ++i)
+        halves[i] = FloatToHalfUnsigned(values[i]);
+    return halves;
+}
+} // namespace Chimera
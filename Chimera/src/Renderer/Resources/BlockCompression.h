@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // Block-compressed texture formats produced by the texture cache. All of
+    // them store 4x4 texel blocks.
+    //   BC4  - one channel, 8 bytes per block (greyscale masks)
+    //   BC5  - two channels, 16 bytes (tangent-space normal XY)
+    //   BC6H - unsigned half-float RGB, 16 bytes (HDR environment maps)
+    //   BC7  - RGBA, 16 bytes (colour)
+enum class BlockFormat : uint32_t
+{
+    BC4,
+    BC5,
+    BC6H,
+    BC7
+};
+
+const char* BlockFormatToString(BlockFormat format);
+
+uint32_t GetBlockBytes(BlockFormat format);
+    // Bytes of one width x height level, partial edge blocks included.
+uint64_t GetCompressedLevelSize(BlockFormat format, uint32_t width,
+                                uint32_t height);
+uint64_t GetCompressedChainSize(BlockFormat format, uint32_t width,
+                                uint32_t height, uint32_t levelCount);
+
+    // Picks the format for an 8-bit texture. Normal maps get BC5. Linear
+    // textures whose RGB channels are equal and alpha is opaque get BC4 and
+    // are meant to be sampled through an RRR1 swizzle, so shaders reading G
+    // or B see the same value. Everything else gets BC7.
+BlockFormat ChooseBlockFormat(const uint8_t* rgbaPixels, uint64_t texelCount,
+                              bool srgb, bool normalMap);
+
+    // Single-block encoders. Inputs are 16 RGBA texels in row order; BC4
+    // reads R and BC5 reads R and G. The encoders fit endpoints along the
+    // principal axis of the block, pick the nearest palette entry per texel
+    // and refine the endpoints once by least squares. BC7 always emits mode
+    // 6 and BC6H mode 11 (one region, 10-bit endpoints); negative and
+    // non-finite BC6H inputs encode as zero.
+void EncodeBC4Block(const uint8_t* rgba, uint8_t* out);
+void EncodeBC5Block(const uint8_t* rgba, uint8_t* out);
+void EncodeBC7Block(const uint8_t* rgba, uint8_t* out);
+void EncodeBC6HBlock(const float* rgba, uint8_t* out);
+
+    // Decoders for the blocks the encoders above emit, used to measure
+    // them. BC7 blocks other than mode 6 and BC6H blocks other than mode 11
+    // throw std::invalid_argument.
+void DecodeBC4Block(const uint8_t* block, uint8_t* rgba);
+void DecodeBC5Block(const uint8_t* block, uint8_t* rgba);
+void DecodeBC7Block(const uint8_t* block, uint8_t* rgba);
+void DecodeBC6HBlock(const uint8_t* block, float* rgba);
+
+    // Compress a tightly packed chain in the MipChain layout into the same
+    // layout of blocks, level 0 first. Edge blocks repeat the last row and
+    // column. Throws std::invalid_argument for BC6H input given as RGBA8
+    // or any other format given as float.
+std::vector<uint8_t> CompressMipChainRGBA8(BlockFormat format,
+                                           const uint8_t* chain,
+                                           uint32_t width, uint32_t height,
+                                           uint32_t levelCount);
+std::vector<uint8_t> CompressMipChainRGBA32F(const float* chain,
+                                             uint32_t width, uint32_t height,
+                                             uint32_t levelCount);
+    // Decodes one width x height level of BC6H blocks to tightly packed
+    // RGBA floats, for CPU work on cached HDR maps.
+std::vector<float> DecompressLevelBC6H(const uint8_t* blocks, uint32_t width,
+                                       uint32_t height);
+    // Converts floats to the unsigned half floats BC6H stores, for HDR
+    // maps uploaded as RGBA16F. Negative and NaN values become zero and
+    // large ones saturate at 65504.
+std::vector<uint16_t> ConvertToHalfUnsigned(const float* values,
+                                            uint64_t count);
+} // namespace Chimera
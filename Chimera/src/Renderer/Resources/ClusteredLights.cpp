@@ -0,0 +1,154 @@
+#include "pch.h"
+#include "ClusteredLights.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Chimera
+{
+float PunctualLightRange(float peakIntensity)
+{
+    return peakIntensity > 0.0f
+               ? std::sqrt(peakIntensity / PunctualLightCutoff)
+               : 0.0f;
+}
+
+uint32_t ClusterGrid::Slice(float depth) const
+{
+    if (!(depth > nearPlane)) return 0;
+    const float slice =
+        std::log(depth / nearPlane) / std::log(farPlane / nearPlane) * float(z);
+    return std::min((uint32_t)slice, z - 1);
+}
+
+float ClusterGrid::SliceDepth(uint32_t k) const
+{
+    return nearPlane * std::pow(farPlane / nearPlane, float(k) / float(z));
+}
+
+void ClusterGrid::Bounds(uint32_t i, uint32_t j, uint32_t k, float min[3],
+                         float max[3]) const
+{
+    // Each tile is a range of x / depth and y / depth; the box spans it
+    // over the slice's depths
+    const float slopeX0 = (2.0f * float(i) / float(x) - 1.0f) / scaleX;
+    const float slopeX1 = (2.0f * float(i + 1) / float(x) - 1.0f) / scaleX;
+    const float slopeY0 = (1.0f - 2.0f * float(j + 1) / float(y)) / scaleY;
+    const float slopeY1 = (1.0f - 2.0f * float(j) / float(y)) / scaleY;
+    const float near = SliceDepth(k);
+    const float far = SliceDepth(k + 1);
+
+    min[0] = std::min(slopeX0 * near, slopeX0 * far);
+    max[0] = std::max(slopeX1 * near, slopeX1 * far);
+    min[1] = std::min(slopeY0 * near, slopeY0 * far);
+    max[1] = std::max(slopeY1 * near, slopeY1 * far);
+    min[2] = near;
+    max[2] = far;
+}
+
+bool SphereIntersectsCluster(const ClusterGrid& grid, uint32_t i, uint32_t j,
+                             uint32_t k, const ClusterLight& light)
+{
+    if (!(light.radius > 0.0f)) return false;
+    float min[3], max[3];
+    grid.Bounds(i, j, k, min, max);
+    float distanceSquared = 0.0f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float p = light.position[axis];
+        const float outside =
+            std::max(std::max(min[axis] - p, p - max[axis]), 0.0f);
+        distanceSquared += outside * outside;
+    }
+    return distanceSquared <= light.radius * light.radius;
+}
+
+static ClusterLightLists EmptyLists(const ClusterGrid& grid)
+{
+    ClusterLightLists lists;
+    lists.counts.assign(grid.Count(), 0);
+    lists.indices.assign(
+        (size_t)grid.Count() * grid.maxLightsPerCluster, 0);
+    return lists;
+}
+
+static void Append(const ClusterGrid& grid, ClusterLightLists& lists,
+                   uint32_t cluster, uint32_t light)
+{
+    uint32_t& count = lists.counts[cluster];
+    if (count >= grid.maxLightsPerCluster) return;
+    lists.indices[(size_t)cluster * grid.maxLightsPerCluster + count++] =
+        light;
+}
+
+ClusterLightLists AssignLightsBruteForce(
+    const ClusterGrid& grid, const std::vector<ClusterLight>& lights)
+{
+    ClusterLightLists lists = EmptyLists(grid);
+    for (uint32_t k = 0; k < grid.z; ++k)
+        for (uint32_t j = 0; j < grid.y; ++j)
+            for (uint32_t i = 0; i < grid.x; ++i)
+                for (uint32_t l = 0; l < (uint32_t)lights.size(); ++l)
+                    if (SphereIntersectsCluster(grid, i, j, k, lights[l]))
+                        Append(grid, lists, grid.Index(i, j, k), l);
+    return lists;
+}
+
+    // Tiles along one axis whose boxes within a slice from near to far can
+    // overlap [low, high]. A box reaches out to its upper slope times the
+    // far depth, or the near one when that slope is negative, and in from
+    // its lower slope likewise; the range is widened by one each side so
+    // rounding never leaves out a tile the exact test would accept.
+static void TileRange(float low, float high, float near, float far,
+                      float scale, uint32_t tiles, bool flip, uint32_t& first,
+                      uint32_t& last)
+{
+    const float slopeLow = low / (low >= 0.0f ? far : near);
+    const float slopeHigh = high / (high >= 0.0f ? near : far);
+    auto tile = [&](float slope)
+    {
+        const float t = flip ? 1.0f - slope * scale : slope * scale + 1.0f;
+        return std::floor(t * 0.5f * float(tiles));
+    };
+    float a = tile(slopeLow), b = tile(slopeHigh);
+    if (a > b) std::swap(a, b);
+    const float limit = float(tiles - 1);
+    first = (uint32_t)std::clamp(a - 1.0f, 0.0f, limit);
+    last = (uint32_t)std::clamp(b + 1.0f, 0.0f, limit);
+}
+
+ClusterLightLists AssignLights(const ClusterGrid& grid,
+                               const std::vector<ClusterLight>& lights)
+{
+    ClusterLightLists lists = EmptyLists(grid);
+    for (uint32_t l = 0; l < (uint32_t)lights.size(); ++l)
+    {
+        const ClusterLight& light = lights[l];
+        const float r = light.radius;
+        const float x = light.position[0], y = light.position[1];
+        const float depth = light.position[2];
+        if (!(r > 0.0f) || depth + r < grid.nearPlane ||
+            depth - r > grid.farPlane)
+            continue;
+
+        const uint32_t first = grid.Slice(depth - r);
+        const uint32_t k0 = first > 0 ? first - 1 : 0;
+        const uint32_t k1 = std::min(grid.Slice(depth + r) + 1, grid.z - 1);
+        for (uint32_t k = k0; k <= k1; ++k)
+        {
+            const float near = grid.SliceDepth(k);
+            const float far = grid.SliceDepth(k + 1);
+            uint32_t i0, i1, j0, j1;
+            TileRange(x - r, x + r, near, far, grid.scaleX, grid.x, false, i0,
+                      i1);
+            TileRange(y - r, y + r, near, far, grid.scaleY, grid.y, true, j0,
+                      j1);
+            for (uint32_t j = j0; j <= j1; ++j)
+                for (uint32_t i = i0; i <= i1; ++i)
+                    if (SphereIntersectsCluster(grid, i, j, k, light))
+                        Append(grid, lists, grid.Index(i, j, k), l);
+        }
+    }
+    return lists;
+}
+} // namespace Chimera
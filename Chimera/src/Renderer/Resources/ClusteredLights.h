@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // Point and spot lights fade to nothing at the range where their peak
+    // intensity falls to this, unless given a range of their own.
+constexpr float PunctualLightCutoff = 1.0f / 256.0f;
+
+float PunctualLightRange(float peakIntensity);
+
+    // View volume split into froxels: x by y screen tiles, rows counted down
+    // from the top of the framebuffer, and z slices spaced exponentially in
+    // depth between the near and far planes (Olsson et al., "Clustered
+    // Deferred and Forward Shading"). Positions are in cluster space: view
+    // space with depth measured forward, so a point at view (x, y, z) is
+    // (x, y, -z). Matches clusters.glsl.
+struct ClusterGrid
+{
+    uint32_t x = 16;
+    uint32_t y = 9;
+    uint32_t z = 24;
+    uint32_t maxLightsPerCluster = 128;
+    float nearPlane = 0.1f;
+    float farPlane = 1000.0f;
+        // Projection scales of view x and y, |P[0][0]| and |P[1][1]|; the
+        // projection must flip y as Vulkan projections do.
+    float scaleX = 1.0f;
+    float scaleY = 1.0f;
+
+    uint32_t Count() const
+    {
+        return x * y * z;
+    }
+    uint32_t Index(uint32_t i, uint32_t j, uint32_t k) const
+    {
+        return (k * y + j) * x + i;
+    }
+
+        // Slice holding a point at depth, clamped to the grid.
+    uint32_t Slice(float depth) const;
+        // Depth where slice k starts; SliceDepth(z) is the far plane.
+    float SliceDepth(uint32_t k) const;
+        // Cluster space box around froxel (i, j, k).
+    void Bounds(uint32_t i, uint32_t j, uint32_t k, float min[3],
+                float max[3]) const;
+};
+
+    // Sphere a light reaches, in cluster space.
+struct ClusterLight
+{
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float radius = 0.0f;
+};
+
+bool SphereIntersectsCluster(const ClusterGrid& grid, uint32_t i, uint32_t j,
+                             uint32_t k, const ClusterLight& light);
+
+    // Per cluster light lists as the GPU cluster buffer holds them: every
+    // cluster's count, then maxLightsPerCluster slots per cluster filled in
+    // ascending light order. Lights past a full cluster are dropped.
+struct ClusterLightLists
+{
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> indices;
+
+    bool operator==(const ClusterLightLists& other) const = default;
+};
+
+    // Tests every light against every cluster, as cluster_cull.comp does
+    // with one thread per cluster.
+ClusterLightLists AssignLightsBruteForce(
+    const ClusterGrid& grid, const std::vector<ClusterLight>& lights);
+
+    // Same lists, testing each light only against the clusters its bounds
+    // span, so the cost follows how far lights reach rather than lights
+    // times clusters.
+ClusterLightLists AssignLights(const ClusterGrid& grid,
+                               const std::vector<ClusterLight>& lights);
+} // namespace Chimera
@@ -0,0 +1,153 @@
+#include "pch.h"
+#include "EnvironmentDistribution.h"
+#include "Core/TaskSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+
+namespace Chimera
+{
+namespace
+{
+constexpr double Pi = 3.14159265358979323846;
+constexpr uint32_t RowsPerTask = 32;
+
+float Luminance(const float* texel)
+{
+    const float luminance =
+        0.2126f * texel[0] + 0.7152f * texel[1] + 0.0722f * texel[2];
+    // Negative and NaN texels carry no light
+    return luminance > 0.0f && std::isfinite(luminance) ? luminance : 0.0f;
+}
+
+    // Fills rows [first, end) of the conditional CDF. uniform ignores the
+    // texels and weights by solid angle alone.
+void BuildRows(const float* rgba, uint32_t width, uint32_t height,
+               bool uniform, uint32_t first, uint32_t end, float* cdf)
+{
+    for (uint32_t y = first; y < end; ++y)
+    {
+        const double sinTheta = std::sin(Pi * (y + 0.5) / height);
+        const float* row = rgba + (size_t)y * width * 4;
+        float* rowCdf = cdf + (size_t)y * width;
+        double sum = 0.0;
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            sum += (uniform ? 1.0 : Luminance(row + x * 4)) * sinTheta;
+            rowCdf[x] = (float)sum;
+        }
+    }
+}
+
+    // First index in [0, count) whose running sum exceeds x, skipping
+    // zero-weight entries.
+uint32_t FindInterval(const float* cdf, uint32_t count, float x)
+{
+    const uint32_t index =
+        (uint32_t)(std::upper_bound(cdf, cdf + count, x) - cdf);
+    return std::min(index, count - 1);
+}
+} // namespace
+
+float EnvironmentDistribution::PdfUV(float u, float v) const
+{
+    if (!IsValid()) return 0.0f;
+    const uint32_t x = std::min((uint32_t)std::max(u * width, 0.0f), width - 1);
+    const uint32_t y =
+        std::min((uint32_t)std::max(v * height, 0.0f), height - 1);
+    const float* row = conditionalCdf.data() + (size_t)y * width;
+    const float weight = row[x] - (x > 0 ? row[x - 1] : 0.0f);
+    return weight / marginalCdf.back() * float(width) * float(height);
+}
+
+float EnvironmentDistribution::SampleUV(float random0, float random1,
+                                        float& u, float& v) const
+{
+    u = v = 0.5f;
+    if (!IsValid()) return 0.0f;
+
+    const float rowTarget = random0 * marginalCdf.back();
+    const uint32_t y = FindInterval(marginalCdf.data(), height, rowTarget);
+    const float rowStart = y > 0 ? marginalCdf[y - 1] : 0.0f;
+    const float rowWeight = marginalCdf[y] - rowStart;
+    const float rowOffset =
+        rowWeight > 0.0f
+            ? std::clamp((rowTarget - rowStart) / rowWeight, 0.0f, 1.0f)
+            : 0.5f;
+
+    const float* row = conditionalCdf.data() + (size_t)y * width;
+    const float texelTarget = random1 * row[width - 1];
+    const uint32_t x = FindInterval(row, width, texelTarget);
+    const float texelStart = x > 0 ? row[x - 1] : 0.0f;
+    const float texelWeight = row[x] - texelStart;
+    const float texelOffset =
+        texelWeight > 0.0f
+            ? std::clamp((texelTarget - texelStart) / texelWeight, 0.0f, 1.0f)
+            : 0.5f;
+
+    u = std::min((x + texelOffset) / float(width), 1.0f);
+    v = std::min((y + rowOffset) / float(height), 1.0f);
+    return texelWeight / marginalCdf.back() * float(width) * float(height);
+}
+
+void EnvironmentDistribution::AppendTo(std::vector<float>& out) const
+{
+    out.reserve(out.size() + GetPackedSize());
+    out.push_back(float(width));
+    out.push_back(float(height));
+    out.insert(out.end(), marginalCdf.begin(), marginalCdf.end());
+    out.insert(out.end(), conditionalCdf.begin(), conditionalCdf.end());
+}
+
+EnvironmentDistribution BuildEnvironmentDistribution(const float* rgba,
+                                                     uint32_t width,
+                                                     uint32_t height,
+                                                     TaskSystem* tasks)
+{
+    EnvironmentDistribution distribution;
+    if (!rgba || width == 0 || height == 0) return distribution;
+    distribution.width = width;
+    distribution.height = height;
+    distribution.conditionalCdf.resize((size_t)width * height);
+    distribution.marginalCdf.resize(height);
+
+    // Returns the total weight.
+    auto build = [&](bool uniform)
+    {
+        float* cdf = distribution.conditionalCdf.data();
+        if (!tasks || height <= RowsPerTask)
+        {
+            BuildRows(rgba, width, height, uniform, 0, height, cdf);
+        }
+        else
+        {
+            std::vector<std::future<void>> rows;
+            for (uint32_t first = 0; first < height; first += RowsPerTask)
+            {
+                const uint32_t end = std::min(first + RowsPerTask, height);
+                rows.push_back(tasks->Enqueue(
+                    [=]()
+                    {
+                        BuildRows(rgba, width, height, uniform, first, end,
+                                  cdf);
+                    }));
+            }
+            // Every task must finish before one's exception can unwind
+            for (auto& future : rows) tasks->Wait(future);
+            for (auto& future : rows) future.get();
+        }
+
+        double total = 0.0;
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            total += cdf[(size_t)y * width + width - 1];
+            distribution.marginalCdf[y] = (float)total;
+        }
+        return total;
+    };
+
+    if (build(false) <= 0.0) build(true);
+    return distribution;
+}
+} // namespace Chimera
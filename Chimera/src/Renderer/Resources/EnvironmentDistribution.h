@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+class TaskSystem;
+
+    // Environment maps wider than this are sampled from the first mip that
+    // is not; the distribution only has to follow the radiance, not resolve
+    // every texel.
+constexpr uint32_t EnvironmentDistributionMaxWidth = 1024;
+
+    // Piecewise-constant distribution over an equirectangular map, with
+    // each texel weighted by its luminance times the sine of its polar
+    // angle, so directions are drawn in proportion to the light arriving
+    // from them. Rows run from +Y down, matching SampleEquirectangular's v.
+    // A map without any light falls back to uniform directions.
+struct EnvironmentDistribution
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+        // Running sums of the row totals, one per row.
+    std::vector<float> marginalCdf;
+        // Running sums of each row's texel weights, height rows of width.
+    std::vector<float> conditionalCdf;
+
+    bool IsValid() const
+    {
+        return width > 0 && height > 0 && !marginalCdf.empty() &&
+               marginalCdf.back() > 0.0f;
+    }
+
+        // Density with respect to uv of the texel containing (u, v).
+    float PdfUV(float u, float v) const;
+        // Maps two uniform numbers in [0, 1) to a uv in the chosen texel.
+        // Returns PdfUV at that uv.
+    float SampleUV(float random0, float random1, float& u, float& v) const;
+
+        // Appends the layout SampleEnvironment in common.glsl reads: width
+        // and height as floats, the marginal CDF, then the conditional rows.
+    void AppendTo(std::vector<float>& out) const;
+    uint32_t GetPackedSize() const
+    {
+        return 2 + height + width * height;
+    }
+};
+
+    // Builds the distribution for width x height RGBA float texels. Rows
+    // are split across tasks when a TaskSystem is given.
+EnvironmentDistribution BuildEnvironmentDistribution(const float* rgba,
+                                                     uint32_t width,
+                                                     uint32_t height,
+                                                     TaskSystem* tasks =
+                                                         nullptr);
+} // namespace Chimera
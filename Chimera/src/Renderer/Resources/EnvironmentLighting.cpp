@@ -0,0 +1,384 @@
+#include "pch.h"
+#include "EnvironmentLighting.h"
+#include "MipChain.h"
+#include "Core/TaskSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHIMERA_SH_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace Chimera
+{
+namespace
+{
+constexpr double Pi = 3.14159265358979323846;
+constexpr uint32_t RowsPerTask = 16;
+constexpr uint32_t PrefilterSamples = 64;
+
+    // Real SH basis normalisation constants.
+constexpr float Sh0 = 0.282095f;
+constexpr float Sh1 = 0.488603f;
+constexpr float Sh2 = 1.092548f;
+constexpr float Sh3 = 0.315392f;
+constexpr float Sh4 = 0.546274f;
+    // Clamped cosine convolution per band, divided by pi.
+constexpr float CosineBand[3] = {1.0f, 2.0f / 3.0f, 0.25f};
+constexpr int BandOf[9] = {0, 1, 1, 1, 2, 2, 2, 2, 2};
+
+struct Direction
+{
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+void ShBasis(float x, float y, float z, float out[9])
+{
+    out[0] = Sh0;
+    out[1] = Sh1 * y;
+    out[2] = Sh1 * z;
+    out[3] = Sh1 * x;
+    out[4] = Sh2 * x * y;
+    out[5] = Sh2 * y * z;
+    out[6] = Sh3 * (3.0f * z * z - 1.0f);
+    out[7] = Sh2 * x * z;
+    out[8] = Sh4 * (x * x - y * y);
+}
+
+    // Negative and NaN texels carry no light.
+float Radiance(float value)
+{
+    return value > 0.0f ? value : 0.0f;
+}
+
+    // Inverse of SampleEquirectangular in common.glsl.
+Direction UVToDirection(double u, double v)
+{
+    const double phi = (u - 0.5) * 2.0 * Pi;
+    const double lat = (0.5 - v) * Pi;
+    return {float(std::cos(lat) * std::cos(phi)), float(std::sin(lat)),
+            float(std::cos(lat) * std::sin(phi))};
+}
+
+void DirectionToUV(const Direction& d, float& u, float& v)
+{
+    u = float(std::atan2(d.z, d.x) / (2.0 * Pi) + 0.5);
+    v = float(0.5 - std::asin(std::clamp(d.y, -1.0f, 1.0f)) / Pi);
+}
+
+    // Accumulates one row's unweighted projection into sums[9 * 3].
+void ProjectRow(const float* row, uint32_t width, const float* cosPhi,
+                const float* sinPhi, float cosLat, float sinLat,
+                float* sums)
+{
+    uint32_t x = 0;
+#ifdef CHIMERA_SH_SSE
+    __m128 acc[27];
+    for (__m128& a : acc) a = _mm_setzero_ps();
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 vCosLat = _mm_set1_ps(cosLat);
+    const __m128 y = _mm_set1_ps(sinLat);
+    for (; x + 4 <= width; x += 4)
+    {
+        // Four RGBA texels transposed into R, G, B and A lanes
+        __m128 r = _mm_loadu_ps(row + x * 4);
+        __m128 g = _mm_loadu_ps(row + x * 4 + 4);
+        __m128 b = _mm_loadu_ps(row + x * 4 + 8);
+        __m128 a = _mm_loadu_ps(row + x * 4 + 12);
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        const __m128 colour[3] = {_mm_max_ps(r, zero), _mm_max_ps(g, zero),
+                                  _mm_max_ps(b, zero)};
+
+        const __m128 dx = _mm_mul_ps(vCosLat, _mm_loadu_ps(cosPhi + x));
+        const __m128 dz = _mm_mul_ps(vCosLat, _mm_loadu_ps(sinPhi + x));
+        const __m128 basis[9] = {
+            _mm_set1_ps(Sh0),
+            _mm_mul_ps(_mm_set1_ps(Sh1), y),
+            _mm_mul_ps(_mm_set1_ps(Sh1), dz),
+            _mm_mul_ps(_mm_set1_ps(Sh1), dx),
+            _mm_mul_ps(_mm_set1_ps(Sh2), _mm_mul_ps(dx, y)),
+            _mm_mul_ps(_mm_set1_ps(Sh2), _mm_mul_ps(y, dz)),
+            _mm_mul_ps(_mm_set1_ps(Sh3),
+                       _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(3.0f),
+                                             _mm_mul_ps(dz, dz)),
+                                  _mm_set1_ps(1.0f))),
+            _mm_mul_ps(_mm_set1_ps(Sh2), _mm_mul_ps(dx, dz)),
+            _mm_mul_ps(_mm_set1_ps(Sh4),
+                       _mm_sub_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(y, y)))};
+        for (int k = 0; k < 9; ++k)
+            for (int c = 0; c < 3; ++c)
+                acc[k * 3 + c] = _mm_add_ps(acc[k * 3 + c],
+                                            _mm_mul_ps(basis[k], colour[c]));
+    }
+    for (int i = 0; i < 27; ++i)
+    {
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, acc[i]);
+        sums[i] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+#endif
+    for (; x < width; ++x)
+    {
+        const float* texel = row + x * 4;
+        float basis[9];
+        ShBasis(cosLat * cosPhi[x], sinLat, cosLat * sinPhi[x], basis);
+        for (int k = 0; k < 9; ++k)
+            for (int c = 0; c < 3; ++c)
+                sums[k * 3 + c] += basis[k] * Radiance(texel[c]);
+    }
+}
+
+    // Box filtered chain of the prefilter source, sampled bilinearly with
+    // u wrapping and v clamped, and linearly between levels.
+struct SourceChain
+{
+    std::vector<float> texels;
+    std::vector<size_t> offsets;
+    std::vector<uint32_t> widths;
+    std::vector<uint32_t> heights;
+
+    void Bilinear(uint32_t level, float u, float v, float out[3]) const
+    {
+        const uint32_t w = widths[level], h = heights[level];
+        const float fx = u * w - 0.5f, fy = v * h - 0.5f;
+        const float x0f = std::floor(fx), y0f = std::floor(fy);
+        const float tx = fx - x0f, ty = fy - y0f;
+        const int32_t x0 = int32_t(x0f), y0 = int32_t(y0f);
+        const uint32_t xs[2] = {uint32_t((x0 % int32_t(w) + w) % w),
+                                uint32_t(((x0 + 1) % int32_t(w) + w) % w)};
+        const uint32_t ys[2] = {
+            uint32_t(std::clamp(y0, 0, int32_t(h) - 1)),
+            uint32_t(std::clamp(y0 + 1, 0, int32_t(h) - 1))};
+        const float wx[2] = {1.0f - tx, tx}, wy[2] = {1.0f - ty, ty};
+        const float* base = texels.data() + offsets[level];
+        out[0] = out[1] = out[2] = 0.0f;
+        for (int j = 0; j < 2; ++j)
+            for (int i = 0; i < 2; ++i)
+            {
+                const float* texel = base + ((size_t)ys[j] * w + xs[i]) * 4;
+                const float weight = wx[i] * wy[j];
+                for (int c = 0; c < 3; ++c)
+                    out[c] += weight * Radiance(texel[c]);
+            }
+    }
+
+    void Sample(const Direction& d, float lod, float out[3]) const
+    {
+        float u, v;
+        DirectionToUV(d, u, v);
+        lod = std::clamp(lod, 0.0f, float(widths.size() - 1));
+        const uint32_t level = uint32_t(lod);
+        Bilinear(level, u, v, out);
+        const float t = lod - float(level);
+        if (t <= 0.0f || level + 1 >= widths.size()) return;
+        float coarse[3];
+        Bilinear(level + 1, u, v, coarse);
+        for (int c = 0; c < 3; ++c) out[c] += (coarse[c] - out[c]) * t;
+    }
+};
+
+float RadicalInverse(uint32_t bits)
+{
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return float(bits) * 2.3283064365386963e-10f;
+}
+
+    // GGX lobe of roughness around each texel's direction, with the view
+    // along it. Fills rows [first, end) of a width x height level.
+void PrefilterRows(const SourceChain& source, float roughness,
+                   uint32_t width, uint32_t height, uint32_t first,
+                   uint32_t end, float* out)
+{
+    const float alpha = std::max(roughness * roughness, 1e-4f);
+    const float alpha2 = alpha * alpha;
+    // Average solid angle of a source texel at level 0
+    const float texelSolidAngle =
+        float(4.0 * Pi / (double(source.widths[0]) * source.heights[0]));
+    for (uint32_t y = first; y < end; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const Direction n =
+                UVToDirection((x + 0.5) / width, (y + 0.5) / height);
+            const Direction up = std::abs(n.y) < 0.999f
+                                     ? Direction{0.0f, 1.0f, 0.0f}
+                                     : Direction{1.0f, 0.0f, 0.0f};
+            // Tangent frame around n
+            Direction t{up.y * n.z - up.z * n.y, up.z * n.x - up.x * n.z,
+                        up.x * n.y - up.y * n.x};
+            const float tl = std::sqrt(t.x * t.x + t.y * t.y + t.z * t.z);
+            t = {t.x / tl, t.y / tl, t.z / tl};
+            const Direction b{n.y * t.z - n.z * t.y, n.z * t.x - n.x * t.z,
+                              n.x * t.y - n.y * t.x};
+
+            float sum[3] = {0.0f, 0.0f, 0.0f};
+            float weight = 0.0f;
+            for (uint32_t i = 0; i < PrefilterSamples; ++i)
+            {
+                const float e0 = (i + 0.5f) / PrefilterSamples;
+                const float e1 = RadicalInverse(i);
+                const float cosH = std::sqrt(
+                    (1.0f - e0) / (1.0f + (alpha2 - 1.0f) * e0));
+                const float sinH =
+                    std::sqrt(std::max(1.0f - cosH * cosH, 0.0f));
+                const float phi = float(2.0 * Pi) * e1;
+                const float hx = sinH * std::cos(phi);
+                const float hy = sinH * std::sin(phi);
+                const Direction h{t.x * hx + b.x * hy + n.x * cosH,
+                                  t.y * hx + b.y * hy + n.y * cosH,
+                                  t.z * hx + b.z * hy + n.z * cosH};
+                // Reflect the view (n) about h
+                const float vh = cosH;
+                const Direction l{2.0f * vh * h.x - n.x, 2.0f * vh * h.y - n.y,
+                                  2.0f * vh * h.z - n.z};
+                const float nl = n.x * l.x + n.y * l.y + n.z * l.z;
+                if (nl <= 0.0f) continue;
+
+                // pdf(l) = D(h) / 4 with v = n; wider lobes read coarser
+                // source mips so few samples do not alias
+                const float denom = cosH * cosH * (alpha2 - 1.0f) + 1.0f;
+                const float d = alpha2 / (float(Pi) * denom * denom);
+                const float sampleSolidAngle =
+                    1.0f / (PrefilterSamples * d * 0.25f + 1e-6f);
+                const float lod =
+                    0.5f * std::log2(sampleSolidAngle / texelSolidAngle);
+                float radiance[3];
+                source.Sample(l, lod, radiance);
+                for (int c = 0; c < 3; ++c) sum[c] += radiance[c] * nl;
+                weight += nl;
+            }
+            float* texel = out + ((size_t)y * width + x) * 4;
+            for (int c = 0; c < 3; ++c)
+                texel[c] = weight > 0.0f ? sum[c] / weight : 0.0f;
+            texel[3] = 1.0f;
+        }
+    }
+}
+} // namespace
+
+IrradianceSH ProjectIrradianceSH(const float* rgba, uint32_t width,
+                                 uint32_t height)
+{
+    IrradianceSH sh;
+    if (!rgba || width == 0 || height == 0) return sh;
+
+    std::vector<float> cosPhi(width), sinPhi(width);
+    for (uint32_t x = 0; x < width; ++x)
+    {
+        const double phi = ((x + 0.5) / width - 0.5) * 2.0 * Pi;
+        cosPhi[x] = float(std::cos(phi));
+        sinPhi[x] = float(std::sin(phi));
+    }
+
+    // Each row shares its latitude, so its solid angle weight is applied
+    // once to the row's sums, which accumulate in double
+    double totals[27] = {};
+    const double texelArea = (2.0 * Pi / width) * (Pi / height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const double lat = (0.5 - (y + 0.5) / height) * Pi;
+        float sums[27] = {};
+        ProjectRow(rgba + (size_t)y * width * 4, width, cosPhi.data(),
+                   sinPhi.data(), float(std::cos(lat)), float(std::sin(lat)),
+                   sums);
+        const double weight = texelArea * std::cos(lat);
+        for (int i = 0; i < 27; ++i) totals[i] += sums[i] * weight;
+    }
+    for (int k = 0; k < 9; ++k)
+        for (int c = 0; c < 3; ++c)
+            sh.coefficients[k][c] =
+                float(totals[k * 3 + c] * CosineBand[BandOf[k]]);
+    return sh;
+}
+
+void EvaluateIrradianceSH(const IrradianceSH& sh, float x, float y, float z,
+                          float rgb[3])
+{
+    float basis[9];
+    ShBasis(x, y, z, basis);
+    for (int c = 0; c < 3; ++c)
+    {
+        rgb[c] = 0.0f;
+        for (int k = 0; k < 9; ++k) rgb[c] += sh.coefficients[k][c] * basis[k];
+    }
+}
+
+PrefilteredEnvironment PrefilterEnvironmentGGX(const float* rgba,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               TaskSystem* tasks)
+{
+    PrefilteredEnvironment result;
+    if (!rgba || width == 0 || height == 0) return result;
+
+    SourceChain source;
+    source.texels = BuildMipChainRGBA32F(rgba, width, height);
+    const uint32_t sourceLevels = GetMipLevelCount(width, height);
+    size_t offset = 0;
+    uint32_t first = 0;
+    for (uint32_t level = 0; level < sourceLevels; ++level)
+    {
+        const uint32_t w = std::max(width >> level, 1u);
+        const uint32_t h = std::max(height >> level, 1u);
+        source.offsets.push_back(offset);
+        source.widths.push_back(w);
+        source.heights.push_back(h);
+        offset += (size_t)w * h * 4;
+        if (w > EnvironmentPrefilterWidth) first = level + 1;
+    }
+    first = std::min(first, sourceLevels - 1);
+
+    // Level 0 is the mirror lobe: the source level itself
+    result.width = source.widths[first];
+    result.height = source.heights[first];
+    result.levelCount = std::min(EnvironmentPrefilterLevels,
+                                 GetMipLevelCount(result.width, result.height));
+    result.texels.resize(
+        GetMipChainTexelCount(result.width, result.height, result.levelCount) *
+        4);
+    const float* mirror = source.texels.data() + source.offsets[first];
+    std::copy(mirror, mirror + (size_t)result.width * result.height * 4,
+              result.texels.begin());
+
+    size_t levelOffset = (size_t)result.width * result.height * 4;
+    for (uint32_t level = 1; level < result.levelCount; ++level)
+    {
+        const uint32_t w = std::max(result.width >> level, 1u);
+        const uint32_t h = std::max(result.height >> level, 1u);
+        const float roughness =
+            float(level) / float(EnvironmentPrefilterLevels - 1);
+        float* out = result.texels.data() + levelOffset;
+        if (!tasks || h <= RowsPerTask)
+        {
+            PrefilterRows(source, roughness, w, h, 0, h, out);
+        }
+        else
+        {
+            std::vector<std::future<void>> rows;
+            for (uint32_t row = 0; row < h; row += RowsPerTask)
+            {
+                const uint32_t end = std::min(row + RowsPerTask, h);
+                rows.push_back(tasks->Enqueue(
+                    [&source, roughness, w, h, row, end, out]()
+                    {
+                        PrefilterRows(source, roughness, w, h, row, end,
+                                      out);
+                    }));
+            }
+            // Every task must finish before one's exception can unwind
+            for (auto& future : rows) tasks->Wait(future);
+            for (auto& future : rows) future.get();
+        }
+        levelOffset += (size_t)w * h * 4;
+    }
+    return result;
+}
+} // namespace Chimera
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+class TaskSystem;
+
+    // Widest level of a prefiltered specular chain; sources are read from
+    // their first mip that is no wider.
+constexpr uint32_t EnvironmentPrefilterWidth = 512;
+    // Level i of the chain holds the GGX lobe of roughness
+    // i / (EnvironmentPrefilterLevels - 1), so level 0 is a mirror.
+constexpr uint32_t EnvironmentPrefilterLevels = 6;
+
+    // Order 2 spherical harmonics of the irradiance arriving from an
+    // environment map, already convolved with the clamped cosine and
+    // divided by pi: evaluated at a normal they give the radiance a white
+    // Lambertian surface reflects. Basis order is Y00, Y1-1 (y), Y10 (z),
+    // Y11 (x), Y2-2 (xy), Y2-1 (yz), Y20, Y21 (xz), Y22, matching
+    // EvaluateIrradianceSH in common.glsl.
+struct IrradianceSH
+{
+    float coefficients[9][3] = {};
+};
+
+    // Projects width x height RGBA float texels of an equirectangular map,
+    // laid out as SampleEquirectangular reads them, four texels at a time
+    // with SSE where it is available.
+IrradianceSH ProjectIrradianceSH(const float* rgba, uint32_t width,
+                                 uint32_t height);
+    // Evaluates sh at the unit direction (x, y, z).
+void EvaluateIrradianceSH(const IrradianceSH& sh, float x, float y, float z,
+                          float rgb[3]);
+
+    // GGX prefiltered specular chain of an equirectangular map, for the
+    // split sum approximation (view direction along the normal). Texels are
+    // RGBA float, levels tightly packed, level 0 first.
+struct PrefilteredEnvironment
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t levelCount = 0;
+    std::vector<float> texels;
+};
+
+    // Rows of each level are split across tasks when a TaskSystem is
+    // given. The lobes are importance sampled from a box filtered chain of
+    // the source, reading coarser mips for wider lobes.
+PrefilteredEnvironment PrefilterEnvironmentGGX(const float* rgba,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               TaskSystem* tasks = nullptr);
+} // namespace Chimera
@@ -0,0 +1,63 @@
+#include "pch.h"
+#include "FrameDirtyRanges.h"
+
+#include <algorithm>
+
+namespace Chimera
+{
+FrameDirtyRanges::FrameDirtyRanges(uint32_t frameCount) : m_Frames(frameCount)
+{
+}
+
+void FrameDirtyRanges::Mark(uint32_t first, uint32_t count)
+{
+    if (count == 0) return;
+    for (auto& frame : m_Frames)
+    {
+        if (frame.full) continue; // Already rewriting everything
+        frame.ranges.push_back({first, count});
+    }
+}
+
+void FrameDirtyRanges::MarkAll(uint32_t count)
+{
+    for (auto& frame : m_Frames)
+    {
+        frame.ranges.clear();
+        frame.full = true;
+        frame.fullCount = count;
+    }
+}
+
+void FrameDirtyRanges::Take(uint32_t frame, std::vector<Range>& out)
+{
+    out.clear();
+    FrameState& state = m_Frames[frame];
+    if (state.full)
+    {
+        if (state.fullCount > 0) out.push_back({0, state.fullCount});
+        state.full = false;
+        state.fullCount = 0;
+        return;
+    }
+    if (state.ranges.empty()) return;
+
+    std::sort(state.ranges.begin(), state.ranges.end(),
+              [](const Range& a, const Range& b) { return a.first < b.first; });
+    for (const Range& range : state.ranges)
+    {
+        if (!out.empty() &&
+            range.first <= out.back().first + out.back().count)
+        {
+            const uint32_t end = std::max(out.back().first + out.back().count,
+                                          range.first + range.count);
+            out.back().count = end - out.back().first;
+        }
+        else
+        {
+            out.push_back(range);
+        }
+    }
+    state.ranges.clear();
+}
+} // namespace Chimera
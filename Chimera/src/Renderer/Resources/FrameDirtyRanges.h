@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // Tracks which element ranges of a per-frame-in-flight buffer still
+    // need to be written. A CPU-side change is marked once and then copied
+    // into each frame's buffer when that frame is next recorded, so a frame
+    // never writes memory the GPU may still be reading for another frame.
+    // Frames with nothing pending cost one empty check.
+class FrameDirtyRanges
+{
+public:
+    struct Range
+    {
+        uint32_t first = 0;
+        uint32_t count = 0;
+
+        bool operator==(const Range& other) const = default;
+    };
+
+    explicit FrameDirtyRanges(uint32_t frameCount);
+
+        // Every frame must rewrite [first, first + count).
+    void Mark(uint32_t first, uint32_t count);
+        // Every frame must rewrite [0, count); drops the finer ranges.
+    void MarkAll(uint32_t count);
+
+        // Moves the pending ranges of frame into out, sorted with
+        // overlapping and adjacent ranges merged.
+    void Take(uint32_t frame, std::vector<Range>& out);
+
+    bool HasPending(uint32_t frame) const
+    {
+        return m_Frames[frame].full || !m_Frames[frame].ranges.empty();
+    }
+
+private:
+    struct FrameState
+    {
+        std::vector<Range> ranges;
+        bool full = false;
+        uint32_t fullCount = 0;
+    };
+
+    std::vector<FrameState> m_Frames;
+};
+} // namespace Chimera
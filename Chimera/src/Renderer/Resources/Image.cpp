@@ -7,7 +7,8 @@ namespace Chimera
 Image::Image(uint32_t width, uint32_t height, VkFormat format,
              VkImageUsageFlags usage, VkImageAspectFlags aspectFlags,
              uint32_t mipLevels, VkSampleCountFlagBits numSamples,
-             VkImageTiling tiling, const std::string& name)
+             VkImageTiling tiling, const std::string& name,
+             const VkComponentMapping& components)
     : m_Width(width), m_Height(height), m_Format(format), m_MipLevels(mipLevels)
 {
     m_Device = VulkanContext::Get().GetDevice();
@@ -47,6 +48,7 @@ Image::Image(uint32_t width, uint32_t height, VkFormat format,
     viewInfo.image = m_Image;
     viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
     viewInfo.format = format;
+    viewInfo.components = components;
     viewInfo.subresourceRange.aspectMask = aspectFlags;
     viewInfo.subresourceRange.baseMipLevel = 0;
     viewInfo.subresourceRange.levelCount = mipLevels;
@@ -14,7 +14,8 @@ public:
           uint32_t mipLevels = 1,
           VkSampleCountFlagBits numSamples = VK_SAMPLE_COUNT_1_BIT,
           VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL,
-          const std::string& name = "");
+          const std::string& name = "",
+          const VkComponentMapping& components = {});
 
     ~Image();
 
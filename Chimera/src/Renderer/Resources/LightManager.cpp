@@ -2,18 +2,92 @@
 #include "LightManager.h"
 #include "Scene/Scene.h"
 #include "Scene/Model.h"
+#include "Renderer/Resources/AliasTable.h"
 #include "Renderer/Resources/Buffer.h"
 #include "Renderer/Resources/ResourceManager.h"
 #include "Renderer/Backend/VulkanContext.h"
+#include "Core/Application.h"
+#include "Core/TaskSystem.h"
+
+#include <bit>
 
 namespace Chimera
 {
-static float TriangleArea(const glm::vec3& v0, const glm::vec3& v1,
-                          const glm::vec3& v2)
+namespace
+{
+    // Emissive triangles one task builds tables for, at least.
+constexpr uint32_t TrianglesPerTask = 4096;
+
+struct EmissiveMesh
+{
+    const Model* model = nullptr;
+    glm::mat4 transform{1.0f};
+    uint32_t firstTriangle = 0;
+    uint32_t triangleCount = 0;
+    int instance = INVALID_ID;
+    float luminance = 0.0f;
+
+    // Where its triangles start among the light tree's primitives
+    uint32_t firstPrimitive = 0;
+
+    // Filled by BuildTriangleTables
+    AliasTable table;
+    float area = 0.0f;
+};
+
+float TriangleArea(const glm::vec3& v0, const glm::vec3& v1,
+                   const glm::vec3& v2)
 {
     return glm::length(glm::cross(v1 - v0, v2 - v0)) * 0.5f;
 }
 
+float Luminance(const glm::vec3& c)
+{
+    return glm::dot(c, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+    // Builds each mesh's table over its triangles' world space areas and
+    // writes their light tree primitives.
+void BuildTriangleTables(EmissiveMesh* meshes, size_t count,
+                         LightTreePrimitive* primitives)
+{
+    std::vector<float> areas;
+    for (size_t m = 0; m < count; ++m)
+    {
+        EmissiveMesh& mesh = meshes[m];
+        const auto& triangles = mesh.model->GetTriangleData();
+        const uint32_t available =
+            mesh.firstTriangle < triangles.size()
+                ? (uint32_t)triangles.size() - mesh.firstTriangle
+                : 0;
+        const uint32_t triangleCount = std::min(mesh.triangleCount, available);
+        areas.resize(triangleCount);
+        double total = 0.0;
+        for (uint32_t i = 0; i < triangleCount; ++i)
+        {
+            const auto& tri = triangles[mesh.firstTriangle + i];
+            const glm::vec3 v0 = glm::vec3(
+                mesh.transform * glm::vec4(glm::vec3(tri.positionUvX0), 1.0f));
+            const glm::vec3 v1 = glm::vec3(
+                mesh.transform * glm::vec4(glm::vec3(tri.positionUvX1), 1.0f));
+            const glm::vec3 v2 = glm::vec3(
+                mesh.transform * glm::vec4(glm::vec3(tri.positionUvX2), 1.0f));
+            areas[i] = TriangleArea(v0, v1, v2);
+            total += areas[i];
+
+            LightTreePrimitive& primitive =
+                primitives[mesh.firstPrimitive + i];
+            primitive.bounds = TriangleLightBounds(
+                &v0.x, &v1.x, &v2.x, mesh.luminance);
+            primitive.instance = (uint32_t)mesh.instance;
+            primitive.triangle = i;
+        }
+        mesh.table = BuildAliasTable(areas.data(), triangleCount);
+        mesh.area = (float)total;
+    }
+}
+} // namespace
+
 LightManager::LightManager() {}
 
 LightManager::~LightManager() {}
@@ -25,76 +99,144 @@ void LightManager::Build(Scene* scene)
 
     if (!scene) return;
 
-    const auto& entities = scene->GetEntities();
-    uint32_t currentInstanceIdx = 0;
-
-    for (const auto& entity : entities)
+    std::vector<EmissiveMesh> meshes;
+    uint32_t triangleTotal = 0;
+    for (const auto& entity : scene->GetEntities())
     {
         auto model = entity.mesh.model;
-        if (!model || !model->IsReady())
-        {
-            // Even if not ready, we need to keep track of instance indices if
-            // the renderer expects 1:1 mapping with entity meshes.
-            // In Chimera, SyncInstancesToGPU flattens all meshes of all
-            // entities.
-            if (model)
-                currentInstanceIdx += (uint32_t)model->GetMeshes().size();
-            continue;
-        }
+        if (!model || !model->IsReady()) continue;
 
-        const auto& meshes = model->GetMeshes();
-        glm::mat4 entityTransform = entity.transform.GetTransform();
-
-        for (const auto& mesh : meshes)
+        const auto& modelMeshes = model->GetMeshes();
+        const glm::mat4 entityTransform = entity.transform.GetTransform();
+        for (size_t m = 0; m < modelMeshes.size(); ++m)
         {
-            uint32_t instanceIdx = currentInstanceIdx++;
-
-            // Check if material is emissive
+            const auto& mesh = modelMeshes[m];
             Material* mat = ResourceManager::Get().GetMaterial(
                 MaterialHandle(mesh.materialIndex));
-            if (!mat || glm::length(mat->GetData().emission) < 0.001f) continue;
-GpuLight light{};
-light.instance = (int)instanceIdx;
-light.environment = INVALID_ID;
-light.cdfStart = (int)m_LightsCDF.size();
-light.cdfCount = (uint32_t)mesh.indexCount / 3;
+            if (!mat || !IsEmissive(mat->GetData())) continue;
 
-const auto& triangleData = model->GetTriangleData();
-
-for (uint32_t i = 0; i < (uint32_t)light.cdfCount; ++i)
-{
-    // Each mesh starts at its own offset in the model's triangle array
-    uint32_t triIdx = (mesh.indexOffset / 3) + i;
-    if (triIdx >= triangleData.size()) break;
-
-    const auto& tri = triangleData[triIdx];
+            // Same instance index and transform as WriteEntityInstances
+            EmissiveMesh& light = meshes.emplace_back();
+            light.model = model.get();
+            light.transform = entityTransform * mesh.transform;
+            light.firstTriangle = mesh.indexOffset / 3;
+            light.triangleCount = mesh.indexCount / 3;
+            light.instance = (int)(entity.primitiveOffset + m);
+            light.luminance = Luminance(mat->GetData().emission);
+            light.firstPrimitive = triangleTotal;
+            triangleTotal += light.triangleCount;
+        }
+    }
 
-    // Transform vertices to world space
-    glm::vec3 v0 = glm::vec3(entityTransform * glm::vec4(glm::vec3(tri.positionUvX0), 1.0f));
-    glm::vec3 v1 = glm::vec3(entityTransform * glm::vec4(glm::vec3(tri.positionUvX1), 1.0f));
-    glm::vec3 v2 = glm::vec3(entityTransform * glm::vec4(glm::vec3(tri.positionUvX2), 1.0f));
+    // Triangles missing from a model's data stay powerless primitives,
+    // which are never sampled
+    std::vector<LightTreePrimitive> primitives(triangleTotal);
+    LightTreePrimitive* primitiveData = primitives.data();
+    TaskSystem* tasks = Application::Get().GetTaskSystem();
+    if (!tasks || triangleTotal <= TrianglesPerTask)
+    {
+        BuildTriangleTables(meshes.data(), meshes.size(), primitiveData);
+    }
+    else
+    {
+        std::vector<std::future<void>> batches;
+        size_t first = 0;
+        uint32_t batchTriangles = 0;
+        for (size_t m = 0; m < meshes.size(); ++m)
+        {
+            batchTriangles += meshes[m].triangleCount;
+            if (batchTriangles < TrianglesPerTask && m + 1 < meshes.size())
+                continue;
+            EmissiveMesh* batch = meshes.data() + first;
+            const size_t count = m + 1 - first;
+            batches.push_back(tasks->Enqueue(
+                [=]() { BuildTriangleTables(batch, count, primitiveData); }));
+            first = m + 1;
+            batchTriangles = 0;
+        }
+        // Every task must finish before one's exception can unwind
+        for (auto& future : batches) tasks->Wait(future);
+        for (auto& future : batches) future.get();
+    }
 
-    float area = TriangleArea(v0, v1, v2);
-    m_LightsCDF.push_back(area + (m_LightsCDF.size() > (size_t)light.cdfStart ? m_LightsCDF.back() : 0.0f));
-}
+    // Moving emissive instances keeps the same primitives, so the tree
+    // is only refit; any other change rebuilds it
+    std::vector<LightTreeKey> treeKey;
+    for (const EmissiveMesh& mesh : meshes)
+        treeKey.push_back({mesh.model, mesh.instance, mesh.firstTriangle,
+                           mesh.triangleCount});
+    if (treeKey == m_LightTreeKey && m_LightTree.IsValid())
+    {
+        m_LightTree.Refit(primitives);
+    }
+    else
+    {
+        m_LightTree = BuildLightTree(primitives);
+        m_LightTreeKey = std::move(treeKey);
+    }
 
-m_GpuLights.push_back(light);
-        }
+    std::vector<float> power;
+    for (const EmissiveMesh& mesh : meshes)
+    {
+        if (!mesh.table.IsValid()) continue; // No area to emit from
+        GpuLight light{};
+        light.instance = mesh.instance;
+        light.environment = INVALID_ID;
+        light.cdfStart = (int)m_LightsCDF.size();
+        light.cdfCount = (int)mesh.table.entries.size();
+        mesh.table.AppendTo(m_LightsCDF);
+        m_GpuLights.push_back(light);
+        power.push_back(mesh.luminance * mesh.area);
     }
 
     // Add environment light if exists
     uint32_t skyboxIdx = scene->GetSkyboxTextureIndex();
+    std::shared_ptr<const EnvironmentDistribution> environment;
+    if (skyboxIdx != 0xFFFFFFFF)
+        if (auto map = ResourceManager::Get().GetEnvironmentMap(skyboxIdx))
+            environment = map->distribution;
+    const uint32_t environmentFloats =
+        environment ? environment->GetPackedSize() : 0;
     if (skyboxIdx != 0xFFFFFFFF)
     {
+        // The sky's power is not comparable with the meshes', so it keeps
+        // the share uniform selection gave it.
+        double meshPower = 0.0;
+        for (float p : power) meshPower += p;
+        power.push_back(power.empty() ? 1.0f
+                                      : float(meshPower / power.size()));
+
         GpuLight light{};
         light.instance = INVALID_ID;
         light.environment = 0; // Assume first environment
-        light.cdfStart = (int)m_LightsCDF.size();
-        light.cdfCount = 0; // Environment sampling might use a different logic
-                            // or pre-built texture CDF
+        // Zero falls back to uniform sphere sampling
+        light.cdfCount = (int)environmentFloats;
         m_GpuLights.push_back(light);
     }
 
+    AliasTable lightTable =
+        BuildAliasTable(power.data(), (uint32_t)power.size());
+    if (!lightTable.IsValid() && !power.empty())
+    {
+        power.assign(power.size(), 1.0f);
+        lightTable = BuildAliasTable(power.data(), (uint32_t)power.size());
+    }
+
+    // After the header come the light table, the environment's
+    // distribution, the triangle tables and the light tree
+    const uint32_t lightTableFloats = lightTable.GetPackedSize();
+    const uint32_t tablesStart =
+        LightCDFHeaderFloats + lightTableFloats + environmentFloats;
+    for (GpuLight& light : m_GpuLights)
+    {
+        if (light.instance != INVALID_ID)
+            light.cdfStart += tablesStart;
+        else
+            light.cdfStart = LightCDFHeaderFloats + lightTableFloats;
+    }
+    const uint32_t treeStart = tablesStart + (uint32_t)m_LightsCDF.size();
+    m_LightTree.AppendTo(primitives, m_LightsCDF);
+
     // Sync to GPU
     if (!m_GpuLights.empty())
     {
@@ -109,17 +251,43 @@ m_GpuLights.push_back(light);
         }
         m_LightBuffer->Update(m_GpuLights.data(), lightSize);
 
+        VkDeviceSize headerSize = LightCDFHeaderFloats * sizeof(float);
+        VkDeviceSize lightTableSize = lightTableFloats * sizeof(float);
+        VkDeviceSize environmentSize = environmentFloats * sizeof(float);
         VkDeviceSize cdfSize = m_LightsCDF.size() * sizeof(float);
-        VkDeviceSize actualSize = std::max(cdfSize, (VkDeviceSize)sizeof(float));
+        VkDeviceSize actualSize =
+            std::max(headerSize + lightTableSize + environmentSize + cdfSize,
+                     (VkDeviceSize)sizeof(float));
         if (!m_CDFBuffer || m_CDFBuffer->GetSize() < actualSize)
         {
+            m_UploadedEnvironment.reset();
             m_CDFBuffer = std::make_unique<Buffer>(
                 actualSize * 2,
                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
                     VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                 VMA_MEMORY_USAGE_CPU_TO_GPU, "CDFBuffer");
         }
-        if (cdfSize > 0) m_CDFBuffer->Update(m_LightsCDF.data(), cdfSize);
+        std::vector<float> packed = {
+            std::bit_cast<float>(treeStart),
+            std::bit_cast<float>((uint32_t)m_LightTree.nodes.size()), 0.0f,
+            0.0f};
+        lightTable.AppendTo(packed);
+        m_CDFBuffer->Update(packed.data(), headerSize + lightTableSize);
+        const uint32_t environmentOffset =
+            LightCDFHeaderFloats + lightTableFloats;
+        if (environment && (environment != m_UploadedEnvironment ||
+                            environmentOffset != m_UploadedEnvironmentOffset))
+        {
+            packed.clear();
+            environment->AppendTo(packed);
+            m_CDFBuffer->Update(packed.data(), environmentSize,
+                                environmentOffset * sizeof(float));
+        }
+        m_UploadedEnvironment = environment;
+        m_UploadedEnvironmentOffset = environmentOffset;
+        if (cdfSize > 0)
+            m_CDFBuffer->Update(m_LightsCDF.data(), cdfSize,
+                                tablesStart * sizeof(float));
     }
 }
 } // namespace Chimera
@@ -2,6 +2,7 @@
 
 #include "pch.h"
 #include "Renderer/Backend/ShaderCommon.h"
+#include "Renderer/Resources/LightTree.h"
 #include <vector>
 #include <memory>
 
@@ -9,10 +10,23 @@ namespace Chimera
 {
 class Scene;
 class Buffer;
+class Model;
+struct EnvironmentDistribution;
+
+constexpr uint32_t LightCDFHeaderFloats = 4;
 
 /**
  * @brief Manages emissive objects and environment lights for importance
  * sampling. Based on SVGF reference implementation.
+ *
+ * The CDF buffer starts with a header of LightCDFHeaderFloats: the light
+ * tree's offset and node count as uint bits. Then come alias tables (see
+ * AliasTable.h): one over the lights weighted by power, the environment's
+ * distribution, and one table per emissive mesh over its triangles
+ * weighted by world space area. Last is a light tree (see LightTree.h)
+ * over every emissive triangle, which SampleLights descends. Lights are
+ * only rebuilt when ResourceManager sees an emissive material or an
+ * emissive instance change; when only instances moved, the tree is refit.
  */
 class LightManager
 {
@@ -22,6 +36,12 @@ public:
 
     void Build(Scene* scene);
 
+        // Whether a material makes its meshes lights.
+    static bool IsEmissive(const GpuMaterial& material)
+    {
+        return glm::length(material.emission) >= 0.001f;
+    }
+
     Buffer* GetLightBuffer() const
     {
         return m_LightBuffer.get();
@@ -41,5 +61,24 @@ private:
 
     std::unique_ptr<Buffer> m_LightBuffer;
     std::unique_ptr<Buffer> m_CDFBuffer;
+
+        // The environment's distribution follows the light table and is
+        // only rewritten when it changes, moves or the buffer is
+        // reallocated; triangle tables follow it.
+    std::shared_ptr<const EnvironmentDistribution> m_UploadedEnvironment;
+    uint32_t m_UploadedEnvironmentOffset = 0;
+
+        // What the tree was built over, to tell moves from new lights.
+    struct LightTreeKey
+    {
+        const Model* model;
+        int instance;
+        uint32_t firstTriangle;
+        uint32_t triangleCount;
+
+        bool operator==(const LightTreeKey&) const = default;
+    };
+    LightTree m_LightTree;
+    std::vector<LightTreeKey> m_LightTreeKey;
 };
 } // namespace Chimera
@@ -0,0 +1,420 @@
+#include "pch.h"
+#include "LightTree.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace Chimera
+{
+namespace
+{
+constexpr float Pi = 3.14159265358979323846f;
+constexpr uint32_t SplitBins = 12;
+constexpr float OneMinusEpsilon = 0x1.fffffep-1f;
+
+struct Vec3
+{
+    float x, y, z;
+
+    Vec3 operator+(const Vec3& o) const
+    {
+        return {x + o.x, y + o.y, z + o.z};
+    }
+    Vec3 operator-(const Vec3& o) const
+    {
+        return {x - o.x, y - o.y, z - o.z};
+    }
+    Vec3 operator*(float s) const
+    {
+        return {x * s, y * s, z * s};
+    }
+};
+
+Vec3 Load(const float v[3])
+{
+    return {v[0], v[1], v[2]};
+}
+
+void Store(const Vec3& v, float out[3])
+{
+    out[0] = v.x;
+    out[1] = v.y;
+    out[2] = v.z;
+}
+
+float Dot(const Vec3& a, const Vec3& b)
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Vec3 Cross(const Vec3& a, const Vec3& b)
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+            a.x * b.y - a.y * b.x};
+}
+
+float Length(const Vec3& v)
+{
+    return std::sqrt(Dot(v, v));
+}
+
+float SafeSqrt(float x)
+{
+    return std::sqrt(std::max(x, 0.0f));
+}
+
+float SafeAcos(float x)
+{
+    return std::acos(std::clamp(x, -1.0f, 1.0f));
+}
+
+    // cos(max(0, a - b)) and sin(max(0, a - b)) from the sines and
+    // cosines of a and b.
+float CosSubClamped(float sinA, float cosA, float sinB, float cosB)
+{
+    return cosA > cosB ? 1.0f : cosA * cosB + sinA * sinB;
+}
+
+float SinSubClamped(float sinA, float cosA, float sinB, float cosB)
+{
+    return cosA > cosB ? 0.0f : sinA * cosB - cosA * sinB;
+}
+
+    // Rotates v by angle around the unit axis k (Rodrigues' formula).
+Vec3 Rotate(const Vec3& v, const Vec3& k, float angle)
+{
+    const float c = std::cos(angle), s = std::sin(angle);
+    return v * c + Cross(k, v) * s + k * (Dot(k, v) * (1.0f - c));
+}
+
+float Centroid(const LightBounds& b, int axis)
+{
+    return 0.5f * (b.min[axis] + b.max[axis]);
+}
+
+    // Surface area orientation heuristic cost of b, with Kr penalising
+    // splits across the node's short axes.
+float SplitCost(const LightBounds& b, const LightBounds& node, int axis)
+{
+    const float thetaO = SafeAcos(b.cosThetaO);
+    const float thetaE = SafeAcos(b.cosThetaE);
+    const float thetaW = std::min(thetaO + thetaE, Pi);
+    const float sinThetaO = SafeSqrt(1.0f - b.cosThetaO * b.cosThetaO);
+    const float mOmega =
+        2.0f * Pi * (1.0f - b.cosThetaO) +
+        Pi / 2.0f *
+            (2.0f * thetaW * sinThetaO - std::cos(thetaO - 2.0f * thetaW) -
+             2.0f * thetaO * sinThetaO + b.cosThetaO);
+    float diagonal[3], widest = 0.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+        diagonal[i] = node.max[i] - node.min[i];
+        widest = std::max(widest, diagonal[i]);
+    }
+    const float kr = diagonal[axis] > 0.0f ? widest / diagonal[axis] : 1.0f;
+    const float dx = b.max[0] - b.min[0], dy = b.max[1] - b.min[1],
+                dz = b.max[2] - b.min[2];
+    const float area = 2.0f * (dx * dy + dy * dz + dz * dx);
+    return b.power * mOmega * kr * area;
+}
+
+    // Appends the subtree over order[begin, end) and returns its root.
+uint32_t BuildNode(const std::vector<LightTreePrimitive>& primitives,
+                   std::vector<uint32_t>& order, uint32_t begin, uint32_t end,
+                   std::vector<LightTree::Node>& nodes)
+{
+    const uint32_t nodeIndex = (uint32_t)nodes.size();
+    nodes.emplace_back();
+    if (end - begin == 1)
+    {
+        nodes[nodeIndex].leaf = true;
+        nodes[nodeIndex].index = order[begin];
+        nodes[nodeIndex].bounds = primitives[order[begin]].bounds;
+        return nodeIndex;
+    }
+
+    LightBounds bounds;
+    float centroidMin[3] = {INFINITY, INFINITY, INFINITY};
+    float centroidMax[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const LightBounds& b = primitives[order[i]].bounds;
+        bounds = i == begin ? b : Union(bounds, b);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            centroidMin[axis] = std::min(centroidMin[axis], Centroid(b, axis));
+            centroidMax[axis] = std::max(centroidMax[axis], Centroid(b, axis));
+        }
+    }
+
+    // Binned split with the lowest cost over all three axes
+    float bestCost = INFINITY;
+    int bestAxis = -1;
+    uint32_t bestBin = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float extent = centroidMax[axis] - centroidMin[axis];
+        if (!(extent > 0.0f)) continue;
+        LightBounds bins[SplitBins];
+        bool used[SplitBins] = {};
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const LightBounds& b = primitives[order[i]].bounds;
+            const uint32_t bin = std::min(
+                (uint32_t)((Centroid(b, axis) - centroidMin[axis]) / extent *
+                           SplitBins),
+                SplitBins - 1);
+            bins[bin] = used[bin] ? Union(bins[bin], b) : b;
+            used[bin] = true;
+        }
+        for (uint32_t split = 0; split + 1 < SplitBins; ++split)
+        {
+            LightBounds below, above;
+            bool anyBelow = false, anyAbove = false;
+            for (uint32_t bin = 0; bin < SplitBins; ++bin)
+            {
+                if (!used[bin]) continue;
+                if (bin <= split)
+                {
+                    below = anyBelow ? Union(below, bins[bin]) : bins[bin];
+                    anyBelow = true;
+                }
+                else
+                {
+                    above = anyAbove ? Union(above, bins[bin]) : bins[bin];
+                    anyAbove = true;
+                }
+            }
+            if (!anyBelow || !anyAbove) continue;
+            const float cost = SplitCost(below, bounds, axis) +
+                               SplitCost(above, bounds, axis);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = split;
+            }
+        }
+    }
+
+    uint32_t mid = begin + (end - begin) / 2;
+    if (bestAxis >= 0)
+    {
+        const float extent = centroidMax[bestAxis] - centroidMin[bestAxis];
+        auto below = [&](uint32_t primitive)
+        {
+            const float c = Centroid(primitives[primitive].bounds, bestAxis);
+            const uint32_t bin = std::min(
+                (uint32_t)((c - centroidMin[bestAxis]) / extent * SplitBins),
+                SplitBins - 1);
+            return bin <= bestBin;
+        };
+        mid = (uint32_t)(std::partition(order.begin() + begin,
+                                        order.begin() + end, below) -
+                         order.begin());
+    }
+    // Coincident centroids (or a NaN cost) split by count instead
+    if (mid == begin || mid == end) mid = begin + (end - begin) / 2;
+
+    BuildNode(primitives, order, begin, mid, nodes);
+    const uint32_t second = BuildNode(primitives, order, mid, end, nodes);
+    LightTree::Node& node = nodes[nodeIndex];
+    node.index = second;
+    node.bounds = Union(nodes[nodeIndex + 1].bounds, nodes[second].bounds);
+    return nodeIndex;
+}
+} // namespace
+
+LightBounds TriangleLightBounds(const float v0[3], const float v1[3],
+                                const float v2[3], float luminance)
+{
+    LightBounds b;
+    for (int i = 0; i < 3; ++i)
+    {
+        b.min[i] = std::min({v0[i], v1[i], v2[i]});
+        b.max[i] = std::max({v0[i], v1[i], v2[i]});
+    }
+    const Vec3 normal = Cross(Load(v1) - Load(v0), Load(v2) - Load(v0));
+    const float length = Length(normal);
+    if (length > 0.0f) Store(normal * (1.0f / length), b.axis);
+    b.cosThetaO = 1.0f;
+    b.cosThetaE = 0.0f; // Lambertian, out to the tangent plane
+    b.power = std::max(luminance, 0.0f) * 0.5f * length;
+    return b;
+}
+
+LightBounds Union(const LightBounds& a, const LightBounds& b)
+{
+    if (a.power == 0.0f) return b;
+    if (b.power == 0.0f) return a;
+
+    LightBounds u;
+    for (int i = 0; i < 3; ++i)
+    {
+        u.min[i] = std::min(a.min[i], b.min[i]);
+        u.max[i] = std::max(a.max[i], b.max[i]);
+    }
+    u.power = a.power + b.power;
+    u.cosThetaE = std::min(a.cosThetaE, b.cosThetaE);
+
+    // Emitters are two sided, so b's cone may be mirrored towards a's
+    const Vec3 wa = Load(a.axis);
+    Vec3 wb = Load(b.axis);
+    if (Dot(wa, wb) < 0.0f) wb = wb * -1.0f;
+    const float thetaA = SafeAcos(a.cosThetaO);
+    const float thetaB = SafeAcos(b.cosThetaO);
+    const float thetaD = SafeAcos(Dot(wa, wb));
+    if (std::min(thetaD + thetaB, Pi) <= thetaA)
+    {
+        Store(wa, u.axis);
+        u.cosThetaO = a.cosThetaO;
+        return u;
+    }
+    if (std::min(thetaD + thetaA, Pi) <= thetaB)
+    {
+        Store(wb, u.axis);
+        u.cosThetaO = b.cosThetaO;
+        return u;
+    }
+    const float thetaO = 0.5f * (thetaA + thetaD + thetaB);
+    const Vec3 k = Cross(wa, wb);
+    const float kLength = Length(k);
+    if (thetaO >= Pi || kLength == 0.0f)
+    {
+        Store(wa, u.axis);
+        u.cosThetaO = -1.0f; // Every direction
+        return u;
+    }
+    Store(Rotate(wa, k * (1.0f / kLength), thetaO - thetaA), u.axis);
+    u.cosThetaO = std::cos(thetaO);
+    return u;
+}
+
+float LightImportance(const LightBounds& bounds, const float p[3],
+                      const float n[3])
+{
+    if (bounds.power <= 0.0f) return 0.0f;
+    const Vec3 point = Load(p);
+    const Vec3 lo = Load(bounds.min), hi = Load(bounds.max);
+    const Vec3 centre = (lo + hi) * 0.5f;
+    const Vec3 toPoint = point - centre;
+    const float distanceSquared = Dot(toPoint, toPoint);
+    // Keeps points inside the bounds from blowing up
+    const float d2 = std::max(distanceSquared, Length(hi - lo) * 0.5f);
+
+    const Vec3 axis = Load(bounds.axis);
+    const Vec3 wi = distanceSquared > 0.0f
+                        ? toPoint * (1.0f / std::sqrt(distanceSquared))
+                        : axis;
+    const float cosThetaW = std::abs(Dot(axis, wi));
+    const float sinThetaW = SafeSqrt(1.0f - cosThetaW * cosThetaW);
+
+    // Half angle the bounding sphere subtends at p
+    const float radiusSquared = Dot(hi - centre, hi - centre);
+    const float cosThetaB =
+        distanceSquared < radiusSquared
+            ? -1.0f
+            : SafeSqrt(1.0f - radiusSquared / distanceSquared);
+    const float sinThetaB = SafeSqrt(1.0f - cosThetaB * cosThetaB);
+
+    // Angle between p and the nearest direction the cone emits along
+    const float sinThetaO =
+        SafeSqrt(1.0f - bounds.cosThetaO * bounds.cosThetaO);
+    const float cosThetaX =
+        CosSubClamped(sinThetaW, cosThetaW, sinThetaO, bounds.cosThetaO);
+    const float sinThetaX =
+        SinSubClamped(sinThetaW, cosThetaW, sinThetaO, bounds.cosThetaO);
+    const float cosThetaP =
+        CosSubClamped(sinThetaX, cosThetaX, sinThetaB, cosThetaB);
+    if (cosThetaP <= bounds.cosThetaE) return 0.0f;
+
+    float importance = bounds.power * cosThetaP / d2;
+    const Vec3 normal = Load(n);
+    if (Dot(normal, normal) > 0.0f)
+    {
+        const float cosThetaI = std::abs(Dot(wi, normal));
+        const float sinThetaI = SafeSqrt(1.0f - cosThetaI * cosThetaI);
+        importance *= CosSubClamped(sinThetaI, cosThetaI, sinThetaB,
+                                    cosThetaB);
+    }
+    return std::max(importance, 0.0f);
+}
+
+void LightTree::Refit(const std::vector<LightTreePrimitive>& primitives)
+{
+    // Children always follow their parent
+    for (size_t i = nodes.size(); i-- > 0;)
+    {
+        Node& node = nodes[i];
+        node.bounds =
+            node.leaf ? primitives[node.index].bounds
+                      : Union(nodes[i + 1].bounds, nodes[node.index].bounds);
+    }
+}
+
+bool LightTree::Sample(const float p[3], const float n[3], float random,
+                       uint32_t& primitive, float& pmf) const
+{
+    pmf = 1.0f;
+    if (nodes.empty()) return false;
+    uint32_t current = 0;
+    while (!nodes[current].leaf)
+    {
+        const uint32_t first = current + 1, second = nodes[current].index;
+        const float importance0 = LightImportance(nodes[first].bounds, p, n);
+        const float importance1 = LightImportance(nodes[second].bounds, p, n);
+        if (importance0 <= 0.0f && importance1 <= 0.0f) return false;
+        const float p0 = importance0 / (importance0 + importance1);
+        if (random < p0)
+        {
+            current = first;
+            random = std::min(random / p0, OneMinusEpsilon);
+            pmf *= p0;
+        }
+        else
+        {
+            current = second;
+            random = std::min((random - p0) / (1.0f - p0), OneMinusEpsilon);
+            pmf *= 1.0f - p0;
+        }
+    }
+    // A lone leaf was never weighed against a sibling
+    if (current == 0 && LightImportance(nodes[0].bounds, p, n) <= 0.0f)
+        return false;
+    primitive = nodes[current].index;
+    return true;
+}
+
+void LightTree::AppendTo(const std::vector<LightTreePrimitive>& primitives,
+                         std::vector<float>& out) const
+{
+    out.reserve(out.size() + GetPackedSize());
+    for (const Node& node : nodes)
+    {
+        const LightBounds& b = node.bounds;
+        out.insert(out.end(), {b.min[0], b.min[1], b.min[2], b.power});
+        out.insert(out.end(), {b.max[0], b.max[1], b.max[2], b.cosThetaO});
+        out.insert(out.end(), {b.axis[0], b.axis[1], b.axis[2], b.cosThetaE});
+        const uint32_t first =
+            node.leaf ? primitives[node.index].instance : node.index;
+        const uint32_t triangle =
+            node.leaf ? primitives[node.index].triangle : 0;
+        out.push_back(std::bit_cast<float>(first));
+        out.push_back(std::bit_cast<float>(triangle));
+        out.push_back(std::bit_cast<float>(uint32_t(node.leaf)));
+        out.push_back(0.0f);
+    }
+}
+
+LightTree BuildLightTree(const std::vector<LightTreePrimitive>& primitives)
+{
+    LightTree tree;
+    if (primitives.empty()) return tree;
+    std::vector<uint32_t> order(primitives.size());
+    for (uint32_t i = 0; i < (uint32_t)order.size(); ++i) order[i] = i;
+    tree.nodes.reserve(2 * primitives.size() - 1);
+    BuildNode(primitives, order, 0, (uint32_t)order.size(), tree.nodes);
+    return tree;
+}
+} // namespace Chimera
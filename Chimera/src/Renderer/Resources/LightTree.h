@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // Floats one node takes in the light CDF buffer, laid out as
+    // LightTree::AppendTo describes.
+constexpr uint32_t LightTreeNodeFloats = 16;
+
+    // What a set of emitters covers: where they are, the cone their
+    // normals lie in (cosThetaO around axis) widened by how far they emit
+    // past their normals (cosThetaE), and their total power. Emitters
+    // light both sides of their surface.
+struct LightBounds
+{
+    float min[3] = {0.0f, 0.0f, 0.0f};
+    float max[3] = {0.0f, 0.0f, 0.0f};
+    float axis[3] = {0.0f, 0.0f, 1.0f};
+    float cosThetaO = 1.0f;
+    float cosThetaE = 0.0f;
+    float power = 0.0f;
+};
+
+    // Bounds of a triangle emitting luminance over its area.
+LightBounds TriangleLightBounds(const float v0[3], const float v1[3],
+                                const float v2[3], float luminance);
+LightBounds Union(const LightBounds& a, const LightBounds& b);
+
+    // How much light bounds may send to a point p whose surface normal is
+    // n, up to a constant; n may be zero for points in a medium. Matches
+    // LightImportance in common.glsl.
+float LightImportance(const LightBounds& bounds, const float p[3],
+                      const float n[3]);
+
+    // One emissive triangle: the instance it belongs to and its index
+    // within that instance's index buffer.
+struct LightTreePrimitive
+{
+    LightBounds bounds;
+    uint32_t instance = 0;
+    uint32_t triangle = 0;
+};
+
+    // Bounding volume hierarchy over emissive triangles, split by the
+    // surface area orientation heuristic of Conty and Kulla's "Importance
+    // Sampling of Many Lights". Nodes are in depth first order, so an
+    // interior node's first child follows it; every leaf holds one
+    // primitive.
+struct LightTree
+{
+    struct Node
+    {
+        LightBounds bounds;
+        bool leaf = false;
+            // The second child of an interior node, the primitive of a leaf.
+        uint32_t index = 0;
+    };
+    std::vector<Node> nodes;
+
+    bool IsValid() const
+    {
+        return !nodes.empty();
+    }
+
+        // Recomputes every node's bounds from primitives moved in place;
+        // the topology is kept, so it must be the set the tree was built
+        // from, in the same order.
+    void Refit(const std::vector<LightTreePrimitive>& primitives);
+
+        // Descends the tree by one uniform number in [0, 1), choosing each
+        // child in proportion to its importance to (p, n) as SampleLights
+        // does in common.glsl. Returns false when nothing lights p.
+    bool Sample(const float p[3], const float n[3], float random,
+                uint32_t& primitive, float& pmf) const;
+
+        // Appends LightTreeNodeFloats floats per node: bounds min and power,
+        // bounds max and cosThetaO, axis and cosThetaE, then as uint bits
+        // the second child or the leaf's instance, the leaf's triangle and
+        // whether it is a leaf, and one float of padding.
+    void AppendTo(const std::vector<LightTreePrimitive>& primitives,
+                  std::vector<float>& out) const;
+    uint32_t GetPackedSize() const
+    {
+        return (uint32_t)nodes.size() * LightTreeNodeFloats;
+    }
+};
+
+LightTree BuildLightTree(const std::vector<LightTreePrimitive>& primitives);
+} // namespace Chimera
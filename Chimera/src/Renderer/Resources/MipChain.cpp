@@ -0,0 +1,207 @@
+#include "pch.h"
+#include "MipChain.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace Chimera
+{
+namespace
+{
+const std::array<float, 256>& SrgbToLinearTable()
+{
+    static const std::array<float, 256> table = []
+    {
+        std::array<float, 256> t{};
+        for (int i = 0; i < 256; ++i)
+        {
+            const float c = i / 255.0f;
+            t[i] = c <= 0.04045f ? c / 12.92f
+                                 : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return table;
+}
+
+uint8_t EncodeUnorm(float value)
+{
+    return (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+}
+
+uint8_t EncodeSrgb(float linear)
+{
+    linear = std::clamp(linear, 0.0f, 1.0f);
+    const float c = linear <= 0.0031308f
+                        ? linear * 12.92f
+                        : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+    return EncodeUnorm(c);
+}
+
+    // Halves a float RGBA level. The four taps are summed channel by
+    // channel in fixed-width loops so the compiler can keep a texel in one
+    // vector register.
+void DownsampleRGBA32F(const float* src, uint32_t srcWidth, uint32_t srcHeight,
+                       float* dst, uint32_t dstWidth, uint32_t dstHeight)
+{
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        const uint32_t y0 = std::min(2 * y, srcHeight - 1);
+        const uint32_t y1 = std::min(2 * y + 1, srcHeight - 1);
+        const float* row0 = src + (size_t)y0 * srcWidth * 4;
+        const float* row1 = src + (size_t)y1 * srcWidth * 4;
+        float* out = dst + (size_t)y * dstWidth * 4;
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            const uint32_t x0 = std::min(2 * x, srcWidth - 1) * 4;
+            const uint32_t x1 = std::min(2 * x + 1, srcWidth - 1) * 4;
+            for (int c = 0; c < 4; ++c)
+                out[x * 4 + c] = 0.25f * (row0[x0 + c] + row0[x1 + c] +
+                                          row1[x0 + c] + row1[x1 + c]);
+        }
+    }
+}
+
+void DecodeRGBA8(const uint8_t* src, uint64_t texels, MipFilter filter,
+                 float* dst)
+{
+    const auto& srgb = SrgbToLinearTable();
+    for (uint64_t i = 0; i < texels; ++i)
+    {
+        const uint8_t* in = src + i * 4;
+        float* out = dst + i * 4;
+        for (int c = 0; c < 3; ++c)
+        {
+            switch (filter)
+            {
+            case MipFilter::Srgb:
+                out[c] = srgb[in[c]];
+                break;
+            case MipFilter::NormalMap:
+                out[c] = in[c] / 255.0f * 2.0f - 1.0f;
+                break;
+            default:
+                out[c] = in[c] / 255.0f;
+                break;
+            }
+        }
+        out[3] = in[3] / 255.0f;
+    }
+}
+
+void EncodeRGBA8(float* src, uint64_t texels, MipFilter filter, uint8_t* dst)
+{
+    for (uint64_t i = 0; i < texels; ++i)
+    {
+        float* in = src + i * 4;
+        uint8_t* out = dst + i * 4;
+        if (filter == MipFilter::NormalMap)
+        {
+                // Renormalised in place so the next level averages unit
+                // vectors too. Near-cancelled vectors are mostly 8-bit
+                // quantisation noise and fall back to +Z.
+            const float length =
+                std::sqrt(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+            if (length > 1.0f / 64.0f)
+            {
+                for (int c = 0; c < 3; ++c) in[c] /= length;
+            }
+            else
+            {
+                in[0] = 0.0f;
+                in[1] = 0.0f;
+                in[2] = 1.0f;
+            }
+            for (int c = 0; c < 3; ++c)
+                out[c] = EncodeUnorm(in[c] * 0.5f + 0.5f);
+        }
+        else
+        {
+            for (int c = 0; c < 3; ++c)
+                out[c] = filter == MipFilter::Srgb ? EncodeSrgb(in[c])
+                                                   : EncodeUnorm(in[c]);
+        }
+        out[3] = EncodeUnorm(in[3]);
+    }
+}
+} // namespace
+
+uint32_t GetMipLevelCount(uint32_t width, uint32_t height)
+{
+    uint32_t levels = 1;
+    for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+        ++levels;
+    return levels;
+}
+
+uint64_t GetMipChainTexelCount(uint32_t width, uint32_t height,
+                               uint32_t levelCount)
+{
+    uint64_t texels = 0;
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        texels += (uint64_t)width * height;
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+    return texels;
+}
+
+std::vector<uint8_t> BuildMipChainRGBA8(const uint8_t* pixels, uint32_t width,
+                                        uint32_t height, MipFilter filter)
+{
+    if (!pixels || width == 0 || height == 0) return {};
+    const uint32_t levels = GetMipLevelCount(width, height);
+    std::vector<uint8_t> chain(GetMipChainTexelCount(width, height, levels) *
+                               4);
+    std::copy(pixels, pixels + (size_t)width * height * 4, chain.begin());
+    if (levels == 1) return chain;
+
+        // Filtering happens on decoded floats; each level is encoded once
+        // and never re-decoded, so rounding does not accumulate.
+    std::vector<float> current((size_t)width * height * 4);
+    DecodeRGBA8(pixels, (uint64_t)width * height, filter, current.data());
+    std::vector<float> next;
+
+    size_t offset = (size_t)width * height * 4;
+    for (uint32_t level = 1; level < levels; ++level)
+    {
+        const uint32_t w = std::max(width / 2, 1u);
+        const uint32_t h = std::max(height / 2, 1u);
+        next.resize((size_t)w * h * 4);
+        DownsampleRGBA32F(current.data(), width, height, next.data(), w, h);
+        EncodeRGBA8(next.data(), (uint64_t)w * h, filter,
+                    chain.data() + offset);
+        offset += (size_t)w * h * 4;
+        current.swap(next);
+        width = w;
+        height = h;
+    }
+    return chain;
+}
+
+std::vector<float> BuildMipChainRGBA32F(const float* pixels, uint32_t width,
+                                        uint32_t height)
+{
+    if (!pixels || width == 0 || height == 0) return {};
+    const uint32_t levels = GetMipLevelCount(width, height);
+    std::vector<float> chain(GetMipChainTexelCount(width, height, levels) * 4);
+    std::copy(pixels, pixels + (size_t)width * height * 4, chain.begin());
+
+    size_t srcOffset = 0;
+    size_t dstOffset = (size_t)width * height * 4;
+    for (uint32_t level = 1; level < levels; ++level)
+    {
+        const uint32_t w = std::max(width / 2, 1u);
+        const uint32_t h = std::max(height / 2, 1u);
+        DownsampleRGBA32F(chain.data() + srcOffset, width, height,
+                          chain.data() + dstOffset, w, h);
+        srcOffset = dstOffset;
+        dstOffset += (size_t)w * h * 4;
+        width = w;
+        height = h;
+    }
+    return chain;
+}
+} // namespace Chimera
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Chimera
+{
+    // How texels are averaged when building a mip chain. Srgb averages in
+    // linear light and re-encodes; NormalMap averages the decoded vectors
+    // and renormalises them. Alpha is always averaged linearly.
+enum class MipFilter
+{
+    Linear,
+    Srgb,
+    NormalMap
+};
+
+    // Levels in a full chain down to 1x1.
+uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+    // Texels in levels [0, levelCount) of a width x height chain.
+uint64_t GetMipChainTexelCount(uint32_t width, uint32_t height,
+                               uint32_t levelCount);
+
+    // Full mip chains built with a 2x2 box filter, each level from the one
+    // above it. Levels are tightly packed RGBA, level 0 first, which is the
+    // layout UploadService::UploadImage expects. An odd dimension drops its
+    // last row or column when halved. Both run on the calling thread; the
+    // texture loaders already run on TaskSystem workers.
+std::vector<uint8_t> BuildMipChainRGBA8(const uint8_t* pixels, uint32_t width,
+                                        uint32_t height, MipFilter filter);
+std::vector<float> BuildMipChainRGBA32F(const float* pixels, uint32_t width,
+                                        uint32_t height);
+} // namespace Chimera
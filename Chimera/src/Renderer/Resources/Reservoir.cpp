@@ -0,0 +1,38 @@
+#include "pch.h"
+#include "Reservoir.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Chimera
+{
+bool Reservoir::Update(uint32_t candidate, float weight, float count,
+                       float random)
+{
+    M += count;
+    if (!(weight > 0.0f) || !std::isfinite(weight)) return false;
+    weightSum += weight;
+    if (random * weightSum >= weight) return false;
+    sample = candidate;
+    return true;
+}
+
+bool Reservoir::Merge(const Reservoir& other, float targetPdf, float random)
+{
+    return Update(other.sample, targetPdf * other.W * other.M, other.M,
+                  random);
+}
+
+void Reservoir::Finalize(float targetPdf)
+{
+    W = targetPdf > 0.0f && M > 0.0f ? weightSum / (M * targetPdf) : 0.0f;
+    if (!std::isfinite(W)) W = 0.0f;
+}
+
+void Reservoir::ClampM(float limit)
+{
+    if (M <= limit) return;
+    weightSum *= limit / M;
+    M = limit;
+}
+} // namespace Chimera
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Chimera
+{
+    // Weighted reservoir of resampled importance sampling as ReSTIR uses it
+    // (Bitterli et al., "Spatiotemporal Reservoir Resampling"): it streams
+    // candidates, keeps one with probability proportional to its weight and
+    // ends with an unbiased contribution weight W for it, so f(sample) * W
+    // estimates the integral of f. Mirrors Reservoir in restir.glsl.
+struct Reservoir
+{
+    uint32_t sample = 0;
+    float weightSum = 0.0f;
+        // Candidates seen so far, fractional only after clamping history.
+    float M = 0.0f;
+    float W = 0.0f;
+
+    bool IsValid() const
+    {
+        return W > 0.0f;
+    }
+
+        // Streams in a candidate of resampling weight standing for count
+        // candidates, replacing the sample with probability weight /
+        // weightSum given random in [0, 1). A fresh candidate weighs
+        // targetPdf / sourcePdf with count one. Returns whether it was kept.
+    bool Update(uint32_t candidate, float weight, float count, float random);
+
+        // Streams in another reservoir; targetPdf is the target density of
+        // its sample here, which differs from its own on another pixel.
+    bool Merge(const Reservoir& other, float targetPdf, float random);
+
+        // Sets W once every candidate is in, targetPdf being the target
+        // density of the kept sample.
+    void Finalize(float targetPdf);
+
+        // Scales the reservoir down to at most limit candidates, keeping W,
+        // so a long history cannot outweigh new samples.
+    void ClampM(float limit);
+};
+} // namespace Chimera
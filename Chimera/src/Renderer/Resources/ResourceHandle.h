@@ -4,13 +4,21 @@
 namespace Chimera
 {
 
+    // id is the slot index, which is also what shaders see. generation
+    // tells a handle to a freed slot apart from one to the slot's next
+    // occupant; 0 means "whatever occupies the slot now" and is what a
+    // handle rebuilt from a bare index carries.
 template <typename T>
 struct Handle
 {
     uint32_t id = 0xFFFFFFFF;
+    uint32_t generation = 0;
 
     Handle() = default;
-    explicit Handle(uint32_t id) : id(id) {}
+    explicit Handle(uint32_t id, uint32_t generation = 0)
+        : id(id), generation(generation)
+    {
+    }
 
     bool IsValid() const
     {
@@ -18,11 +26,11 @@ struct Handle
     }
     bool operator==(const Handle& other) const
     {
-        return id == other.id;
+        return id == other.id && generation == other.generation;
     }
     bool operator!=(const Handle& other) const
     {
-        return id != other.id;
+        return !(*this == other);
     }
 
     operator uint32_t() const
@@ -2,9 +2,13 @@
 #include "ResourceManager.h"
 #include "Renderer/Backend/VulkanContext.h"
 #include "Renderer/Backend/RenderContext.h"
+#include "Renderer/Backend/UploadService.h"
 #include "Renderer/Resources/Buffer.h"
 #include "Renderer/Resources/Image.h"
 #include "Renderer/Resources/Material.h"
+#include "Renderer/Resources/BlockCompression.h"
+#include "Renderer/Resources/MipChain.h"
+#include "Renderer/Resources/ClusteredLights.h"
 #include "Utils/VulkanBarrier.h"
 #include "Core/Application.h"
 #include "Renderer/RenderState.h"
@@ -16,10 +20,150 @@
 #include "Core/TaskSystem.h"
 
 #include "stb_image.h"
+#include <fstream>
 #include <random>
 
 namespace Chimera
 {
+namespace
+{
+    // Places item at a slot handed out by a SlotAllocator, growing the
+    // parallel arrays when the allocator appended a new index.
+template <typename Ptr>
+void StoreInSlot(std::vector<Ptr>& items, std::vector<uint32_t>& refCounts,
+                 uint32_t index, Ptr item)
+{
+    if (index >= items.size())
+    {
+        items.resize(index + 1);
+        refCounts.resize(index + 1, 0);
+    }
+    items[index] = std::move(item);
+    refCounts[index] = 1;
+}
+
+    // Drops the name cache entries of a freed slot so a later lookup loads
+    // the resource again instead of returning a stale handle.
+template <typename Map>
+void EraseSlotNames(Map& names, uint32_t index)
+{
+    for (auto it = names.begin(); it != names.end();)
+        it = it->second.id == index ? names.erase(it) : std::next(it);
+}
+
+std::vector<uint8_t> ReadBinaryFile(const std::filesystem::path& path)
+{
+    std::vector<uint8_t> data;
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return data;
+    data.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(data.data()),
+              static_cast<std::streamsize>(data.size()));
+    if (!file) data.clear();
+    return data;
+}
+
+    // Written next to the target and renamed, so a crash or a concurrent
+    // writer of the same entry never leaves a half-written file behind.
+void WriteTextureCacheFile(const std::filesystem::path& path,
+                           const TextureCacheEntry& entry, uint64_t sourceHash)
+{
+    const std::vector<uint8_t> fileData =
+        SerializeTextureCache(entry, sourceHash);
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    std::filesystem::path tempPath = path;
+    tempPath += "." +
+                std::to_string(
+                    std::hash<std::thread::id>{}(std::this_thread::get_id())) +
+                ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(fileData.data()),
+                   static_cast<std::streamsize>(fileData.size()));
+        if (!file.good())
+        {
+            CH_CORE_WARN("ResourceManager: Failed to write texture cache {}",
+                         tempPath.string());
+            return;
+        }
+    }
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        CH_CORE_WARN("ResourceManager: Failed to replace texture cache {}: {}",
+                     path.string(), error.message());
+        std::filesystem::remove(tempPath, error);
+    }
+}
+
+const char* GetTextureCacheVariant(bool srgb, bool normalMap)
+{
+    if (normalMap) return "normal";
+    return srgb ? "srgb" : "linear";
+}
+
+VkFormat GetBlockVkFormat(BlockFormat format, bool srgb)
+{
+    switch (format)
+    {
+        case BlockFormat::BC4:
+            return VK_FORMAT_BC4_UNORM_BLOCK;
+        case BlockFormat::BC5:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case BlockFormat::BC6H:
+            return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+        case BlockFormat::BC7:
+            return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    }
+    return VK_FORMAT_UNDEFINED;
+}
+
+    // Offset of every level of a tightly packed chain, plus the chain size.
+std::vector<uint64_t> GetLevelOffsets(VkFormat format, uint32_t width,
+                                      uint32_t height, uint32_t levelCount)
+{
+    const uint32_t blockSize = VulkanUtils::GetCompressedBlockSize(format);
+    const uint32_t texelSize = VulkanUtils::GetFormatTexelSize(format);
+    std::vector<uint64_t> offsets(levelCount + 1, 0);
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        const uint64_t w = std::max(width >> level, 1u);
+        const uint64_t h = std::max(height >> level, 1u);
+        const uint64_t size = blockSize ? ((w + 3) / 4) * ((h + 3) / 4) *
+                                              blockSize
+                                        : w * h * texelSize;
+        offsets[level + 1] = offsets[level] + size;
+    }
+    return offsets;
+}
+
+    // Height in pixels of the sphere around bounds, measured at its nearest
+    // point so close objects err towards finer mips.
+float GetProjectedSize(const ChimeraAABB& bounds, const glm::vec3& eye,
+                       float projectionScale, float viewportHeight)
+{
+    const glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+    const float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+    const float distance = glm::length(center - eye) - radius;
+    if (distance <= 1e-4f) return std::numeric_limits<float>::max();
+    return radius / distance * projectionScale * viewportHeight;
+}
+
+    // First mip of an HDR chain narrow enough to build its EnvironmentMap
+    // from.
+uint32_t GetEnvironmentMapMip(uint32_t width, uint32_t levelCount)
+{
+    uint32_t mip = 0;
+    while (mip + 1 < levelCount &&
+           (width >> mip) > EnvironmentDistributionMaxWidth)
+        ++mip;
+    return mip;
+}
+} // namespace
+
 ResourceManager* ResourceManager::s_Instance = nullptr;
 
 ResourceManager::ResourceManager()
@@ -32,6 +176,22 @@ ResourceManager::ResourceManager()
     m_IsCleared = false;
     m_Context = Application::Get().GetContext();
     m_ResourceFreeQueue.resize(MAX_FRAMES_IN_FLIGHT);
+    m_UseTextureCache = m_Context->IsTextureCompressionBCSupported();
+    m_TextureCacheDir =
+        std::filesystem::current_path() / "cache" / "textures";
+
+    // A quarter of the largest device-local heap leaves the rest to render
+    // targets, geometry and acceleration structures.
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(m_Context->GetAllocator(), &memoryProperties);
+    VkDeviceSize deviceLocalBytes = 0;
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i)
+        if (memoryProperties->memoryHeaps[i].flags &
+            VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+            deviceLocalBytes = std::max(
+                deviceLocalBytes, memoryProperties->memoryHeaps[i].size);
+    if (deviceLocalBytes > 0)
+        m_TextureResidency.SetBudget(deviceLocalBytes / 4);
     m_SceneDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
 }
 
@@ -57,11 +217,24 @@ void ResourceManager::Clear()
     m_Textures.clear();
     m_TextureMap.clear();
     m_TextureRefCount.clear();
+    m_StreamedTextures.clear();
+    m_TextureReloads.clear();
+    m_TextureAlphaModes.clear();
+    m_TextureResidency.Clear();
+    m_EnvironmentMaps.clear();
     m_Buffers.clear();
     m_BufferRefCount.clear();
+    m_TextureSlots = SlotAllocator(MAX_FRAMES_IN_FLIGHT);
+    m_MaterialSlots = SlotAllocator(MAX_FRAMES_IN_FLIGHT);
+    m_BufferSlots = SlotAllocator(MAX_FRAMES_IN_FLIGHT);
     m_UniformBuffers.clear();
     if (m_MaterialBuffer) m_MaterialBuffer.reset();
-    if (m_InstanceBuffer) m_InstanceBuffer.reset();
+    for (auto& instanceBuffer : m_InstanceBuffers) instanceBuffer.reset();
+    m_BLASScratch.Release();
+    for (auto& lightBuffer : m_PunctualLightBuffers) lightBuffer.reset();
+    for (auto& clusterBuffer : m_ClusterBuffers) clusterBuffer.reset();
+    m_InstanceData.clear();
+    m_InstanceLayoutVersion = 0;
     for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
         ClearResourceFreeQueue(i);
     if (m_SceneDescriptorSetLayout != VK_NULL_HANDLE)
@@ -94,32 +267,44 @@ void ResourceManager::ClearRuntimeAssets()
 {
     if (!m_Context) return;
     vkDeviceWaitIdle(m_Context->GetDevice());
-    if (m_Materials.size() > 1)
-    {
-        auto defaultMat = std::move(m_Materials[0]);
-        m_Materials.clear();
-        m_Materials.push_back(std::move(defaultMat));
-        m_MaterialMap.clear();
-        m_MaterialMap["Default"] = MaterialHandle(0);
-        m_MaterialRefCount.clear();
-        m_MaterialRefCount.push_back(1);
-    }
+    // Everything but the defaults goes back to the slot allocators. The
+    // device is idle and the free queues are drained below, which also
+    // retires the freed slots.
+    for (uint32_t i = 1; i < (uint32_t)m_Materials.size(); ++i)
+        if (m_MaterialSlots.Free(i))
+        {
+            m_Materials[i].reset();
+            m_MaterialRefCount[i] = 0;
+        }
+    m_MaterialMap.clear();
+    if (!m_Materials.empty())
+        m_MaterialMap["Default"] =
+            MaterialHandle(0, m_MaterialSlots.GetGeneration(0));
+
     uint32_t sysCount =
         (m_Textures.size() >= 2) ? 2 : (uint32_t)m_Textures.size();
-    if (m_Textures.size() > sysCount)
-    {
-        std::vector<std::unique_ptr<Image>> sys;
-        for (uint32_t i = 0; i < sysCount; ++i)
-            sys.push_back(std::move(m_Textures[i]));
-        m_Textures.clear();
-        for (auto& t : sys) m_Textures.push_back(std::move(t));
-        m_TextureMap.clear();
-        m_TextureMap["Default"] = TextureHandle(0);
-        m_TextureRefCount.clear();
-        m_TextureRefCount.resize(sysCount, 1);
-    }
-    m_Buffers.clear();
-    m_BufferRefCount.clear();
+    for (uint32_t i = sysCount; i < (uint32_t)m_Textures.size(); ++i)
+        if (m_TextureSlots.Free(i))
+        {
+            m_Textures[i].reset();
+            m_TextureRefCount[i] = 0;
+            m_TextureSlotsDirty.Mark(i, 1);
+            m_StreamedTextures.erase(i);
+            m_TextureReloads.erase(i);
+            m_TextureResidency.Remove(i);
+            m_EnvironmentMaps.erase(i);
+        }
+    m_TextureMap.clear();
+    if (!m_Textures.empty())
+        m_TextureMap["Default"] =
+            TextureHandle(0, m_TextureSlots.GetGeneration(0));
+
+    for (uint32_t i = 0; i < (uint32_t)m_Buffers.size(); ++i)
+        if (m_BufferSlots.Free(i))
+        {
+            m_Buffers[i].reset();
+            m_BufferRefCount[i] = 0;
+        }
 
     // Material and instance buffers are global resources referenced by the
     // persistent scene descriptor sets. Keep their Vulkan handles alive while
@@ -136,11 +321,23 @@ void ResourceManager::InitGlobalResources()
         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
             VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
         VMA_MEMORY_USAGE_CPU_TO_GPU, "Global_MaterialBuffer");
-    m_InstanceBuffer = std::make_unique<Buffer>(
-        sizeof(GpuInstance) * 4096,
-        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY, "Global_InstanceBuffer");
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        m_InstanceBuffers[i] = std::make_unique<Buffer>(
+            sizeof(GpuInstance) * 4096, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU, "Global_InstanceBuffer");
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+        m_PunctualLightBuffers[i] = std::make_unique<Buffer>(
+            sizeof(GpuPunctualLight) * 256, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU, "Global_PunctualLightBuffer");
+        // Every cluster's count, then CLUSTER_MAX_LIGHTS indices per cluster
+        m_ClusterBuffers[i] = std::make_unique<Buffer>(
+            sizeof(uint32_t) * CLUSTER_COUNT * (1 + CLUSTER_MAX_LIGHTS),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY,
+            "Global_ClusterBuffer");
+    }
     CreateTextureSampler();
+    SizeBindlessTextureTable();
     CreateDescriptorPool();
     CreateTransientDescriptorPools();
     CreateSceneDescriptorSetLayout();
@@ -194,7 +391,7 @@ void ResourceManager::CreateTextureSampler()
             VK_FALSE,
             VK_COMPARE_OP_ALWAYS,
             0.0f,
-            10.0f,
+            VK_LOD_CLAMP_NONE,
             VK_BORDER_COLOR_INT_OPAQUE_BLACK,
             VK_FALSE};
         vkCreateSampler(m_Context->GetDevice(), &i, nullptr, &m_TextureSampler);
@@ -228,7 +425,8 @@ void ResourceManager::CreateDescriptorPool()
 {
     std::vector<VkDescriptorPoolSize> s = {
         {VK_DESCRIPTOR_TYPE_SAMPLER, 1000},
-        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4096},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+         m_BindlessTextureCapacity * MAX_FRAMES_IN_FLIGHT + 1024},
         {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1000},
         {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1000},
         {VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, 100}};
@@ -253,13 +451,21 @@ void ResourceManager::CreateSceneDescriptorSetLayout()
          VK_SHADER_STAGE_ALL, nullptr},
         {BINDING_INSTANCES, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1,
          VK_SHADER_STAGE_ALL, nullptr},
-        {BINDING_TEXTURES, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1024,
-         VK_SHADER_STAGE_ALL, nullptr},
+        {BINDING_TEXTURES, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+         m_BindlessTextureCapacity, VK_SHADER_STAGE_ALL, nullptr},
         {BINDING_LIGHTS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1,
          VK_SHADER_STAGE_ALL, nullptr},
         {BINDING_LIGHTS_CDF, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1,
+         VK_SHADER_STAGE_ALL, nullptr},
+        {BINDING_PUNCTUAL_LIGHTS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1,
+         VK_SHADER_STAGE_ALL, nullptr},
+        {BINDING_CLUSTERS, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1,
          VK_SHADER_STAGE_ALL, nullptr}};
-    VkDescriptorBindingFlags f[6] = {
+    VkDescriptorBindingFlags f[8] = {
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
         VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
             VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
         VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
@@ -274,7 +480,7 @@ void ResourceManager::CreateSceneDescriptorSetLayout()
             VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT};
     VkDescriptorSetLayoutBindingFlagsCreateInfo lf{
         VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
-        nullptr, 6, f};
+        nullptr, 8, f};
     VkDescriptorSetLayoutCreateInfo li{
         VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, &lf,
         VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
@@ -299,6 +505,26 @@ void ResourceManager::AllocatePersistentSets()
         m_DescriptorPool, MAX_FRAMES_IN_FLIGHT, ls.data()};
     vkAllocateDescriptorSets(m_Context->GetDevice(), &aI,
                              m_SceneDescriptorSets.data());
+    for (auto& bound : m_SceneSetBindings) bound = SceneSetBindings{};
+}
+
+void ResourceManager::SizeBindlessTextureTable()
+{
+    const auto& p = m_Context->GetVulkan12Properties();
+    BindlessLimits limits;
+    limits.maxPerStageSamplers = p.maxPerStageDescriptorUpdateAfterBindSamplers;
+    limits.maxPerStageSampledImages =
+        p.maxPerStageDescriptorUpdateAfterBindSampledImages;
+    limits.maxPerStageResources = p.maxPerStageUpdateAfterBindResources;
+    limits.maxSetSamplers = p.maxDescriptorSetUpdateAfterBindSamplers;
+    limits.maxSetSampledImages = p.maxDescriptorSetUpdateAfterBindSampledImages;
+    limits.maxDescriptorsInAllPools = p.maxUpdateAfterBindDescriptorsInAllPools;
+    // Leave room for the per-pass sets that share a pipeline layout with
+    // the scene set.
+    m_BindlessTextureCapacity = Chimera::ChooseBindlessTextureCapacity(
+        limits, MAX_FRAMES_IN_FLIGHT, 256, 1u << 16);
+    CH_CORE_INFO("ResourceManager: bindless texture capacity {}",
+                 m_BindlessTextureCapacity);
 }
 
 void ResourceManager::CreateDefaultResources()
@@ -309,25 +535,10 @@ void ResourceManager::CreateDefaultResources()
         VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_SAMPLE_COUNT_1_BIT,
         VK_IMAGE_TILING_OPTIMAL, "Texture_Default");
     uint8_t m[] = {0, 0, 0, 255};
-    Buffer s(4, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY,
-             "Staging_DefaultTexture");
-    s.Update(m, 4);
-    {
-        ScopedCommandBuffer c;
-        VulkanUtils::TransitionImageLayout(
-            c, (VkImage)f->GetImage(), VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
-        VkBufferImageCopy r{0,         0,
-                            0,         {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-                            {0, 0, 0}, {1, 1, 1}};
-        vkCmdCopyBufferToImage(c, (VkBuffer)s.GetBuffer(),
-                               (VkImage)f->GetImage(),
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &r);
-        VulkanUtils::TransitionImageLayout(
-            c, (VkImage)f->GetImage(), VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
-    }
+    UploadService& uploads = m_Context->GetUploadService();
+    uploads.UploadImage(f->GetImage(), VK_FORMAT_R8G8B8A8_UNORM, {1, 1}, m,
+                        sizeof(m));
+    uploads.Flush();
     AddTexture(std::move(f), "Default");
     CreateMaterial("Default");
     SyncMaterialsToGPU();
@@ -353,93 +564,151 @@ void ResourceManager::UpdateSceneDescriptorSet(Scene* s, uint32_t fI)
     {
         VkDescriptorSet tS = m_SceneDescriptorSets[i];
         if (tS == VK_NULL_HANDLE) continue;
-        std::vector<VkWriteDescriptorSet> wS;
+        SceneSetBindings& bound = m_SceneSetBindings[i];
+        std::vector<VkWriteDescriptorSet>& wS = m_DescriptorWriteScratch;
+        wS.clear();
+
         VkAccelerationStructureKHR tlas = s->GetTLAS();
         VkWriteDescriptorSetAccelerationStructureKHR aW{
             VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR,
             nullptr, 1, &tlas};
-        if (tlas != VK_NULL_HANDLE)
+        if (bound.tlasVersion != s->GetTLASVersion())
         {
-            VkWriteDescriptorSet w{
-                VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                &aW,
-                tS,
-                BINDING_AS,
-                0,
-                1,
-                VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR};
-            wS.push_back(w);
-        }
-        static VkDescriptorBufferInfo mI, iI, lI, cI;
-        if (m_MaterialBuffer && m_MaterialBuffer->GetBuffer() != VK_NULL_HANDLE)
-        {
-            mI = {(VkBuffer)m_MaterialBuffer->GetBuffer(), 0, VK_WHOLE_SIZE};
-            VkWriteDescriptorSet mW{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                                    nullptr,
-                                    tS,
-                                    BINDING_MATERIALS,
-                                    0,
-                                    1,
-                                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                    nullptr,
-                                    &mI};
-            wS.push_back(mW);
-        }
-        if (m_InstanceBuffer && m_InstanceBuffer->GetBuffer() != VK_NULL_HANDLE)
-        {
-            iI = {(VkBuffer)m_InstanceBuffer->GetBuffer(), 0, VK_WHOLE_SIZE};
-            VkWriteDescriptorSet iW{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                                    nullptr,
-                                    tS,
-                                    BINDING_INSTANCES,
-                                    0,
-                                    1,
-                                    VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                    nullptr,
-                                    &iI};
-            wS.push_back(iW);
-        }
-        if (m_LightManager.GetLightBuffer())
-        {
-            lI = {(VkBuffer)m_LightManager.GetLightBuffer()->GetBuffer(), 0,
-                  VK_WHOLE_SIZE};
-            wS.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, tS,
-                          BINDING_LIGHTS, 0, 1,
-                          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &lI});
+            bound.tlasVersion = s->GetTLASVersion();
+            if (tlas != VK_NULL_HANDLE)
+            {
+                VkWriteDescriptorSet w{
+                    VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    &aW,
+                    tS,
+                    BINDING_AS,
+                    0,
+                    1,
+                    VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR};
+                wS.push_back(w);
+            }
         }
-        if (m_LightManager.GetCDFBuffer())
+
+        VkDescriptorBufferInfo mI, iI, lI, cI, pI, kI;
+        if (bound.buffersDirty)
         {
-            cI = {(VkBuffer)m_LightManager.GetCDFBuffer()->GetBuffer(), 0,
-                  VK_WHOLE_SIZE};
-            wS.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, tS,
-                          BINDING_LIGHTS_CDF, 0, 1,
-                          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &cI});
+            bound.buffersDirty = false;
+            if (m_MaterialBuffer &&
+                m_MaterialBuffer->GetBuffer() != VK_NULL_HANDLE)
+            {
+                mI = {(VkBuffer)m_MaterialBuffer->GetBuffer(), 0, VK_WHOLE_SIZE};
+                wS.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr,
+                              tS, BINDING_MATERIALS, 0, 1,
+                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &mI});
+            }
+            const auto& instanceBuffer = m_InstanceBuffers[i];
+            if (instanceBuffer && instanceBuffer->GetBuffer() != VK_NULL_HANDLE)
+            {
+                iI = {(VkBuffer)instanceBuffer->GetBuffer(), 0, VK_WHOLE_SIZE};
+                wS.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr,
+                              tS, BINDING_INSTANCES, 0, 1,
+                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &iI});
+            }
+            if (m_LightManager.GetLightBuffer())
+            {
+                lI = {(VkBuffer)m_LightManager.GetLightBuffer()->GetBuffer(), 0,
+                      VK_WHOLE_SIZE};
+                wS.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr,
+                              tS, BINDING_LIGHTS, 0, 1,
+                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &lI});
+            }
+            if (m_LightManager.GetCDFBuffer())
+            {
+                cI = {(VkBuffer)m_LightManager.GetCDFBuffer()->GetBuffer(), 0,
+                      VK_WHOLE_SIZE};
+                wS.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr,
+                              tS, BINDING_LIGHTS_CDF, 0, 1,
+                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &cI});
+            }
+            if (m_PunctualLightBuffers[i])
+            {
+                pI = {(VkBuffer)m_PunctualLightBuffers[i]->GetBuffer(), 0,
+                      VK_WHOLE_SIZE};
+                wS.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr,
+                              tS, BINDING_PUNCTUAL_LIGHTS, 0, 1,
+                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &pI});
+            }
+            if (m_ClusterBuffers[i])
+            {
+                kI = {(VkBuffer)m_ClusterBuffers[i]->GetBuffer(), 0,
+                      VK_WHOLE_SIZE};
+                wS.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr,
+                              tS, BINDING_CLUSTERS, 0, 1,
+                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &kI});
+            }
         }
-        std::vector<VkDescriptorImageInfo> iIs;
-        for (uint32_t j = 0; j < (uint32_t)m_Textures.size(); ++j)
-            if (m_Textures[j] &&
-                m_Textures[j]->GetImageView() != VK_NULL_HANDLE)
-                iIs.push_back({m_TextureSampler, m_Textures[j]->GetImageView(),
-                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
-        if (!iIs.empty())
+
         {
-            VkWriteDescriptorSet tW{
-                VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                nullptr,
-                tS,
-                BINDING_TEXTURES,
-                0,
-                (uint32_t)std::min((size_t)1024, iIs.size()),
-                VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                iIs.data()};
-            wS.push_back(tW);
+            std::lock_guard<std::mutex> lock(m_AssetMutex);
+            AppendTextureSlotWrites(tS, i, wS);
         }
+
         if (!wS.empty())
             vkUpdateDescriptorSets(m_Context->GetDevice(), (uint32_t)wS.size(),
                                    wS.data(), 0, nullptr);
     }
 }
 
+void ResourceManager::AppendTextureSlotWrites(
+    VkDescriptorSet set, uint32_t frameIndex,
+    std::vector<VkWriteDescriptorSet>& writes)
+{
+    if (!m_TextureSlotsDirty.HasPending(frameIndex)) return;
+    m_TextureSlotsDirty.Take(frameIndex, m_TextureRangeScratch);
+
+    // Released slots point at the default texture so no descriptor outlives
+    // its image view. Slots with nothing to show yet are left unwritten; the
+    // binding is partially bound.
+    const VkImageView fallback =
+        (!m_Textures.empty() && m_Textures[0]) ? m_Textures[0]->GetImageView()
+                                               : VK_NULL_HANDLE;
+    auto viewAt = [&](uint32_t slot)
+    {
+        if (slot < m_Textures.size() && m_Textures[slot] &&
+            m_Textures[slot]->GetImageView() != VK_NULL_HANDLE)
+            return m_Textures[slot]->GetImageView();
+        return fallback;
+    };
+
+    size_t total = 0;
+    for (const auto& range : m_TextureRangeScratch) total += range.count;
+    // Writes point into the scratch array, so it must not reallocate
+    m_TextureInfoScratch.clear();
+    m_TextureInfoScratch.reserve(total);
+
+    for (const auto& range : m_TextureRangeScratch)
+    {
+        const uint32_t last =
+            std::min(range.first + range.count, m_BindlessTextureCapacity);
+        for (uint32_t slot = range.first; slot < last;)
+        {
+            const uint32_t runStart = slot;
+            const size_t infoStart = m_TextureInfoScratch.size();
+            for (; slot < last; ++slot)
+            {
+                const VkImageView view = viewAt(slot);
+                if (view == VK_NULL_HANDLE) break;
+                m_TextureInfoScratch.push_back(
+                    {m_TextureSampler, view,
+                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL});
+            }
+            if (slot > runStart)
+                writes.push_back({VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                                  nullptr, set, BINDING_TEXTURES, runStart,
+                                  slot - runStart,
+                                  VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                  m_TextureInfoScratch.data() + infoStart});
+            else
+                ++slot; // No view and no fallback: leave it unwritten
+        }
+    }
+}
+
 std::shared_ptr<Model> ResourceManager::LoadModelAsync(
     const std::string& path, std::shared_ptr<Scene> targetScene)
 {
@@ -477,69 +746,192 @@ void ResourceManager::UpdateLoadingTasks()
     }
 }
 
-void ResourceManager::SyncInstancesToGPU(Scene* scene)
+void ResourceManager::SyncInstancesToGPU(Scene* scene, uint32_t frameIndex)
 {
-    if (!scene || !m_InstanceBuffer) return;
+    if (!scene || frameIndex >= MAX_FRAMES_IN_FLIGHT) return;
     const auto& entities = scene->GetEntities();
-    if (entities.empty()) return;
-    std::vector<GpuInstance> instanceData;
-    uint32_t instanceIdx = 0;
-    for (const auto& entity : entities)
+
+    if (scene->GetInstanceLayoutVersion() != m_InstanceLayoutVersion)
     {
-        auto model = entity.mesh.model;
-        if (!model || !model->IsReady())
+        // Instance indices may have shifted: rebuild everything
+        m_InstanceLayoutVersion = scene->GetInstanceLayoutVersion();
+        m_InstanceData.clear();
+        for (const auto& entity : entities)
         {
-            if (model) instanceIdx += (uint32_t)model->GetMeshes().size();
-            continue;
+            const uint32_t first = (uint32_t)m_InstanceData.size();
+            if (entity.mesh.model)
+                m_InstanceData.resize(
+                    first + entity.mesh.model->GetMeshes().size());
+            WriteEntityInstances(entity, m_InstanceData.data() + first);
         }
-        const auto& meshes = model->GetMeshes();
-        glm::mat4 modelMatrix = entity.transform.GetTransform();
-        for (const auto& mesh : meshes)
+        scene->ClearDirtyInstanceEntities();
+        m_InstanceDirtyRanges.MarkAll((uint32_t)m_InstanceData.size());
+        m_LightsDirty = true;
+    }
+    else if (!scene->GetDirtyInstanceEntities().empty())
+    {
+        for (uint32_t index : scene->GetDirtyInstanceEntities())
         {
-            GpuInstance gpuInst{};
-            gpuInst.transform = modelMatrix * mesh.transform;
-            gpuInst.inverseTransform = glm::inverse(gpuInst.transform);
-            gpuInst.normalTransform = glm::transpose(gpuInst.inverseTransform);
-            gpuInst.bounds = mesh.localBounds.ToGpuAABB();
-            gpuInst.shape = 0;
-            gpuInst.index = instanceIdx++;
-            gpuInst.material = (uint)mesh.materialIndex;
-            gpuInst.selected = 0;
-            gpuInst.vertexAddress =
-                model->GetVertexBuffer()->GetDeviceAddress() +
-                (mesh.vertexOffset * sizeof(GpuVertex));
-            gpuInst.indexAddress = model->GetIndexBuffer()->GetDeviceAddress() +
-                                   (mesh.indexOffset * sizeof(uint32_t));
-            gpuInst.prevTransform = entity.prevTransform * mesh.transform;
-            instanceData.push_back(gpuInst);
+            if (index >= entities.size()) continue;
+            const Entity& entity = entities[index];
+            if (!entity.mesh.model) continue;
+            const uint32_t count =
+                (uint32_t)entity.mesh.model->GetMeshes().size();
+            if (entity.primitiveOffset + count > m_InstanceData.size())
+                continue;
+            WriteEntityInstances(entity,
+                                 m_InstanceData.data() + entity.primitiveOffset);
+            m_InstanceDirtyRanges.Mark(entity.primitiveOffset, count);
+            if (HasEmissiveMesh(entity)) m_LightsDirty = true;
         }
+        scene->ClearDirtyInstanceEntities();
     }
-    if (instanceData.empty()) return;
-    VkDeviceSize dataSize = instanceData.size() * sizeof(GpuInstance);
-    if (m_InstanceBuffer->GetSize() < dataSize)
-        m_InstanceBuffer = std::make_unique<Buffer>(
-            dataSize * 2,
-            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY, "Global_InstanceBuffer_Resized");
-    Buffer staging(dataSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                   VMA_MEMORY_USAGE_CPU_ONLY, "Staging_SyncInstances");
-    staging.UploadData(instanceData.data(), dataSize);
+
+    if (m_InstanceDirtyRanges.HasPending(frameIndex))
+    {
+        m_InstanceDirtyRanges.Take(frameIndex, m_InstanceRangeScratch);
+        auto& buffer = m_InstanceBuffers[frameIndex];
+        const VkDeviceSize required = m_InstanceData.size() * sizeof(GpuInstance);
+        if (!buffer || buffer->GetSize() < required)
+        {
+            // This frame's fence has signaled, so its old buffer is idle and
+            // can go right away. The new one is empty, so every instance is
+            // written rather than just the ranges.
+            buffer = std::make_unique<Buffer>(
+                required * 2, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VMA_MEMORY_USAGE_CPU_TO_GPU, "Global_InstanceBuffer_Resized");
+            m_InstanceRangeScratch.assign(
+                1, {0, (uint32_t)m_InstanceData.size()});
+            m_SceneSetBindings[frameIndex].buffersDirty = true;
+        }
+        for (const auto& range : m_InstanceRangeScratch)
+            buffer->Update(m_InstanceData.data() + range.first,
+                           range.count * sizeof(GpuInstance),
+                           range.first * sizeof(GpuInstance));
+    }
+
+    const uint32_t skyboxIndex = scene->GetSkyboxTextureIndex();
+    if (m_LightsDirty || skyboxIndex != m_LightsSkyboxIndex)
+    {
+        m_LightManager.Build(scene);
+        MarkSceneBuffersDirty(); // Build may have replaced the light buffers
+        m_LightsSkyboxIndex = skyboxIndex;
+        m_LightsDirty = false;
+    }
+}
+
+uint32_t ResourceManager::SyncPunctualLightsToGPU(Scene* scene,
+                                                 uint32_t frameIndex)
+{
+    if (!scene || frameIndex >= MAX_FRAMES_IN_FLIGHT) return 0;
+
+    m_PunctualLightScratch.clear();
+    for (const Light& light : scene->GetLights())
+    {
+        const auto type = (LightType)(int)light.position.w;
+        if (type != LightType::Point && type != LightType::Spot) continue;
+        const float intensity = light.color.a;
+        const float peak = intensity * std::max(light.color.r,
+                                                std::max(light.color.g,
+                                                         light.color.b));
+        const float range = light.params.x > 0.0f
+                                ? light.params.x
+                                : PunctualLightRange(peak);
+        if (!(range > 0.0f)) continue;
+
+        GpuPunctualLight gpu{};
+        gpu.positionRange = glm::vec4(glm::vec3(light.position), range);
+        gpu.colorIntensity = light.color;
+        const glm::vec3 direction = glm::vec3(light.direction);
+        gpu.directionType = glm::vec4(
+            glm::length(direction) > 0.0f ? glm::normalize(direction)
+                                          : direction,
+            (float)type);
+        // Point lights keep a cone that admits every direction
+        gpu.spotCos = glm::vec4(-2.0f, -1.0f, 0.0f, 0.0f);
+        if (type == LightType::Spot)
+            gpu.spotCos = glm::vec4(light.params.y, light.params.z, 0, 0);
+        m_PunctualLightScratch.push_back(gpu);
+    }
+
+    auto& buffer = m_PunctualLightBuffers[frameIndex];
+    const VkDeviceSize required =
+        m_PunctualLightScratch.size() * sizeof(GpuPunctualLight);
+    if (!buffer || buffer->GetSize() < required)
     {
-        ScopedCommandBuffer cmd;
-        VkBufferCopy copy{0, 0, dataSize};
-        vkCmdCopyBuffer(cmd, (VkBuffer)staging.GetBuffer(),
-                        (VkBuffer)m_InstanceBuffer->GetBuffer(), 1, &copy);
+        // This frame's fence has signaled, so its old buffer is idle
+        buffer = std::make_unique<Buffer>(
+            required * 2, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU, "Global_PunctualLightBuffer_Resized");
+        m_SceneSetBindings[frameIndex].buffersDirty = true;
     }
-    m_LightManager.Build(scene);
+    if (required > 0)
+        buffer->Update(m_PunctualLightScratch.data(), required, 0);
+    return (uint32_t)m_PunctualLightScratch.size();
+}
+
+void ResourceManager::WriteEntityInstances(const Entity& entity,
+                                           GpuInstance* out) const
+{
+    auto model = entity.mesh.model;
+    if (!model) return;
+    const auto& meshes = model->GetMeshes();
+    if (!model->IsReady())
+    {
+        std::fill(out, out + meshes.size(), GpuInstance{});
+        return;
+    }
+    const glm::mat4 modelMatrix = entity.transform.GetTransform();
+    const uint32_t first = entity.primitiveOffset;
+    for (size_t m = 0; m < meshes.size(); ++m)
+    {
+        const auto& mesh = meshes[m];
+        GpuInstance& gpuInst = out[m];
+        gpuInst = GpuInstance{};
+        gpuInst.transform = modelMatrix * mesh.transform;
+        gpuInst.inverseTransform = glm::inverse(gpuInst.transform);
+        gpuInst.normalTransform = glm::transpose(gpuInst.inverseTransform);
+        gpuInst.bounds = mesh.localBounds.ToGpuAABB();
+        gpuInst.shape = 0;
+        gpuInst.index = first + (uint32_t)m;
+        gpuInst.material = (uint)mesh.materialIndex;
+        gpuInst.selected = 0;
+        gpuInst.vertexAddress = model->GetVertexBuffer()->GetDeviceAddress() +
+                                (mesh.vertexOffset * sizeof(GpuVertex));
+        gpuInst.indexAddress = model->GetIndexBuffer()->GetDeviceAddress() +
+                               (mesh.indexOffset * sizeof(uint32_t));
+        gpuInst.prevTransform = entity.prevTransform * mesh.transform;
+    }
+}
+
+bool ResourceManager::HasEmissiveMesh(const Entity& entity) const
+{
+    auto model = entity.mesh.model;
+    if (!model || !model->IsReady()) return false;
+    for (const auto& mesh : model->GetMeshes())
+    {
+        const uint32_t index = (uint32_t)mesh.materialIndex;
+        if (index < m_Materials.size() && m_Materials[index] &&
+            LightManager::IsEmissive(m_Materials[index]->GetData()))
+            return true;
+    }
+    return false;
 }
 
 void ResourceManager::UpdateMaterial(uint32_t materialIndex,
                                      const GpuMaterial& material)
 {
-    if (materialIndex < m_Materials.size())
+    if (materialIndex < m_Materials.size() && m_Materials[materialIndex])
     {
         m_Materials[materialIndex]->SetData(material);
+        // Emission feeds the light list
+        if (materialIndex >= m_MaterialEmission.size())
+            m_MaterialEmission.resize(materialIndex + 1, glm::vec3(0.0f));
+        if (m_MaterialEmission[materialIndex] != material.emission)
+        {
+            m_MaterialEmission[materialIndex] = material.emission;
+            m_LightsDirty = true;
+        }
         if (m_MaterialBuffer)
             m_MaterialBuffer->Update(&material, sizeof(GpuMaterial),
                                      materialIndex * sizeof(GpuMaterial));
@@ -552,24 +944,30 @@ void ResourceManager::SyncMaterialsToGPU()
         std::max((VkDeviceSize)1024,
                  (VkDeviceSize)(sizeof(GpuMaterial) * m_Materials.size()));
     if (!m_MaterialBuffer || m_MaterialBuffer->GetSize() < bufferSize)
+    {
         m_MaterialBuffer = std::make_unique<Buffer>(
             bufferSize,
             VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
                 VK_BUFFER_USAGE_TRANSFER_DST_BIT |
                 VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
             VMA_MEMORY_USAGE_CPU_TO_GPU, "Global_MaterialBuffer_Resized");
+        MarkSceneBuffersDirty();
+    }
     std::vector<GpuMaterial> materialData;
+    std::vector<glm::vec3> emission;
     for (const auto& mat : m_Materials)
+    {
         materialData.push_back(mat ? mat->GetData() : GpuMaterial{});
-    Buffer staging(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                   VMA_MEMORY_USAGE_CPU_ONLY, "Staging_SyncMaterials");
-    staging.UploadData(materialData.data(),
-                       sizeof(GpuMaterial) * materialData.size());
+        emission.push_back(materialData.back().emission);
+    }
+    // The material buffer is host visible, so it is written in place like
+    // UpdateMaterial does.
+    m_MaterialBuffer->Update(materialData.data(),
+                             sizeof(GpuMaterial) * materialData.size());
+    if (emission != m_MaterialEmission)
     {
-        ScopedCommandBuffer cmd;
-        VkBufferCopy copy{0, 0, sizeof(GpuMaterial) * materialData.size()};
-        vkCmdCopyBuffer(cmd, (VkBuffer)staging.GetBuffer(),
-                        (VkBuffer)m_MaterialBuffer->GetBuffer(), 1, &copy);
+        m_MaterialEmission = std::move(emission);
+        m_LightsDirty = true;
     }
 }
 
@@ -651,42 +1049,66 @@ void ResourceManager::DestroyGraphImage(GraphImage& i)
     i.handle = VK_NULL_HANDLE;
 }
 
-TextureHandle ResourceManager::LoadTexture(const std::string& p, bool srgb)
+TextureHandle ResourceManager::LoadTexture(const std::string& p, bool srgb,
+                                           bool normalMap)
 {
     const std::string cacheKey = MakeTextureCacheKey(p, srgb);
     {
         std::lock_guard<std::mutex> lock(m_AssetMutex);
         if (m_TextureMap.count(cacheKey)) return m_TextureMap[cacheKey];
     }
-    int tw, th, tc;
-    unsigned char* px = stbi_load(p.c_str(), &tw, &th, &tc, 4);
-    if (!px) return TextureHandle();
-    TextureHandle handle = LoadTextureFromPixels(
-        p, px, static_cast<uint32_t>(tw), static_cast<uint32_t>(th), srgb);
-    stbi_image_free(px);
-    return handle;
+    // Read the file ourselves so the cache can be keyed by its bytes.
+    const std::vector<uint8_t> encoded = ReadBinaryFile(p);
+    if (encoded.empty()) return TextureHandle();
+    return LoadEncodedTexture(p, encoded.data(), encoded.size(), srgb,
+                              normalMap, p);
 }
 
 TextureHandle ResourceManager::LoadTextureFromMemory(
     const std::string& identity, const unsigned char* encodedData,
-    size_t encodedSize, bool srgb)
+    size_t encodedSize, bool srgb, bool normalMap)
+{
+    return LoadEncodedTexture(identity, encodedData, encodedSize, srgb,
+                              normalMap, {});
+}
+
+TextureHandle ResourceManager::LoadEncodedTexture(
+    const std::string& identity, const unsigned char* encodedData,
+    size_t encodedSize, bool srgb, bool normalMap,
+    const std::string& sourcePath)
 {
     if (!encodedData || encodedSize == 0) return TextureHandle();
 
+    const std::string cacheKey = MakeTextureCacheKey(identity, srgb);
+    {
+        std::lock_guard<std::mutex> lock(m_AssetMutex);
+        if (m_TextureMap.count(cacheKey)) return m_TextureMap[cacheKey];
+    }
+
+    uint64_t sourceHash = 0;
+    if (m_UseTextureCache)
+    {
+        sourceHash = HashTextureSource(encodedData, encodedSize);
+        TextureHandle cached =
+            LoadCachedTexture(identity, cacheKey, sourceHash,
+                              GetTextureCacheVariant(srgb, normalMap));
+        if (cached.IsValid()) return cached;
+    }
+
     int tw, th, tc;
     unsigned char* px = stbi_load_from_memory(
         encodedData, static_cast<int>(encodedSize), &tw, &th, &tc, 4);
     if (!px) return TextureHandle();
-    TextureHandle handle = LoadTextureFromPixels(
-        identity, px, static_cast<uint32_t>(tw), static_cast<uint32_t>(th),
-        srgb);
+    TextureHandle handle = UploadTexturePixels(
+        identity, cacheKey, px, static_cast<uint32_t>(tw),
+        static_cast<uint32_t>(th), srgb, normalMap, sourceHash, sourcePath);
     stbi_image_free(px);
     return handle;
 }
 
 TextureHandle ResourceManager::LoadTextureFromPixels(
     const std::string& identity, const unsigned char* rgbaPixels,
-    uint32_t width, uint32_t height, bool srgb)
+    uint32_t width, uint32_t height, bool srgb, bool normalMap)
 {
     if (!rgbaPixels || width == 0 || height == 0) return TextureHandle();
 
@@ -696,34 +1118,422 @@ TextureHandle ResourceManager::LoadTextureFromPixels(
         if (m_TextureMap.count(cacheKey)) return m_TextureMap[cacheKey];
     }
 
-    const VkDeviceSize s = static_cast<VkDeviceSize>(width) * height * 4;
-    Buffer st(s, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
-              "Staging_LoadTexture");
-    st.Update(rgbaPixels, s);
-    VkFormat format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    uint64_t sourceHash = 0;
+    if (m_UseTextureCache)
+    {
+        const uint32_t extent[2] = {width, height};
+        sourceHash = HashTextureSource(
+            extent, sizeof(extent),
+            HashTextureSource(rgbaPixels, (size_t)width * height * 4));
+        TextureHandle cached =
+            LoadCachedTexture(identity, cacheKey, sourceHash,
+                              GetTextureCacheVariant(srgb, normalMap));
+        if (cached.IsValid()) return cached;
+    }
+    return UploadTexturePixels(identity, cacheKey, rgbaPixels, width, height,
+                               srgb, normalMap, sourceHash);
+}
+
+TextureHandle ResourceManager::UploadTexturePixels(
+    const std::string& identity, const std::string& cacheKey,
+    const unsigned char* rgbaPixels, uint32_t width, uint32_t height,
+    bool srgb, bool normalMap, uint64_t sourceHash,
+    const std::string& sourcePath)
+{
+    const MipFilter filter = normalMap ? MipFilter::NormalMap
+                             : srgb    ? MipFilter::Srgb
+                                       : MipFilter::Linear;
+    auto chain = std::make_shared<const std::vector<uint8_t>>(
+        BuildMipChainRGBA8(rgbaPixels, width, height, filter));
+    const uint32_t mipLevels = GetMipLevelCount(width, height);
+
+    StreamedTexture texture;
+    texture.data = chain;
+    texture.format =
+        srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    texture.width = width;
+    texture.height = height;
+    texture.levelCount = mipLevels;
+    texture.name = "Texture_" + identity;
+    if (!sourcePath.empty())
+    {
+        texture.reload = [sourcePath, width, height, filter]() -> TextureChain
+        {
+            const std::vector<uint8_t> encoded = ReadBinaryFile(sourcePath);
+            int w = 0, h = 0, c = 0;
+            unsigned char* px =
+                encoded.empty()
+                    ? nullptr
+                    : stbi_load_from_memory(encoded.data(),
+                                            static_cast<int>(encoded.size()),
+                                            &w, &h, &c, 4);
+            if (!px) return nullptr;
+            // A file changed on disk since the load no longer fits the
+            // image's chain
+            TextureChain chain;
+            if ((uint32_t)w == width && (uint32_t)h == height)
+                chain = std::make_shared<const std::vector<uint8_t>>(
+                    BuildMipChainRGBA8(px, width, height, filter));
+            stbi_image_free(px);
+            return chain;
+        };
+    }
+    // Decided on the source pixels, before compression can blur edges
+    texture.alphaMode =
+        normalMap ? AlphaMode::Opaque
+                  : ClassifyAlpha(rgbaPixels, (uint64_t)width * height,
+                                  Application::Get().GetTaskSystem());
+    const AlphaMode alphaMode = texture.alphaMode;
+    TextureHandle handle = AddStreamedTexture(std::move(texture), cacheKey);
+
+    if (m_UseTextureCache)
+    {
+        QueueTextureCacheWrite(
+            sourceHash, GetTextureCacheVariant(srgb, normalMap),
+            [chain = std::move(chain), width, height, mipLevels, srgb,
+             normalMap, alphaMode]()
+            {
+                TextureCacheEntry entry;
+                entry.format = ChooseBlockFormat(
+                    chain->data(), (uint64_t)width * height, srgb, normalMap);
+                entry.srgb = srgb;
+                entry.width = width;
+                entry.height = height;
+                entry.levelCount = mipLevels;
+                entry.alphaMode = alphaMode;
+                entry.data = CompressMipChainRGBA8(
+                    entry.format, chain->data(), width, height, mipLevels);
+                return entry;
+            });
+    }
+    return handle;
+}
+
+TextureHandle ResourceManager::LoadCachedTexture(const std::string& identity,
+                                                 const std::string& cacheKey,
+                                                 uint64_t sourceHash,
+                                                 const std::string& variant,
+                                                 bool stream,
+                                                 const std::function<void(
+                                                     const TextureCacheEntry&)>&
+                                                     onLoaded)
+{
+    const std::filesystem::path path =
+        m_TextureCacheDir / MakeTextureCacheFileName(sourceHash, variant);
+    TextureCacheEntry entry;
+    const TextureCacheLoadStatus status =
+        DeserializeTextureCache(ReadBinaryFile(path), sourceHash, entry);
+    if (status != TextureCacheLoadStatus::Loaded)
+    {
+        if (status != TextureCacheLoadStatus::Missing)
+        {
+            CH_CORE_WARN("ResourceManager: Texture cache for {} is {}; "
+                         "re-encoding",
+                         identity, TextureCacheLoadStatusToString(status));
+        }
+        return TextureHandle();
+    }
+    if (onLoaded) onLoaded(entry);
+
+    // BC4 holds greyscale data in R only; the swizzle makes G and B (and so
+    // packed roughness/metal reads) see the same value.
+    StreamedTexture texture;
+    if (entry.format == BlockFormat::BC4)
+    {
+        texture.components = {
+            VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_R,
+            VK_COMPONENT_SWIZZLE_R, VK_COMPONENT_SWIZZLE_ONE};
+    }
+    texture.format = GetBlockVkFormat(entry.format, entry.srgb);
+    texture.width = entry.width;
+    texture.height = entry.height;
+    texture.levelCount = entry.levelCount;
+    texture.name = "Texture_" + identity;
+    texture.alphaMode = entry.alphaMode;
+    texture.data =
+        std::make_shared<const std::vector<uint8_t>>(std::move(entry.data));
+    texture.reload = [path, sourceHash]() -> TextureChain
+    {
+        TextureCacheEntry reloaded;
+        if (DeserializeTextureCache(ReadBinaryFile(path), sourceHash,
+                                    reloaded) != TextureCacheLoadStatus::Loaded)
+            return nullptr;
+        return std::make_shared<const std::vector<uint8_t>>(
+            std::move(reloaded.data));
+    };
+    return AddStreamedTexture(std::move(texture), cacheKey, stream);
+}
+
+TextureHandle ResourceManager::AddStreamedTexture(
+    StreamedTexture texture, const std::string& cacheKey, bool stream)
+{
+    texture.levelOffsets =
+        GetLevelOffsets(texture.format, texture.width, texture.height,
+                        texture.levelCount);
+    uint32_t tailMip = 0;
+    while (stream && tailMip + 1 < texture.levelCount &&
+           std::max(texture.width >> tailMip, texture.height >> tailMip) >
+               StreamingTailSize)
+        ++tailMip;
+
+    // Flushed before the handle is published, so any frame that can see the
+    // texture is submitted after the copy's graphics-queue acquire.
+    auto im = CreateTextureLevels(texture, tailMip);
+    m_Context->GetUploadService().Flush();
+    TextureHandle handle = AddTexture(std::move(im), cacheKey);
+
+    std::vector<uint64_t> levelBytes(texture.levelCount);
+    for (uint32_t level = 0; level < texture.levelCount; ++level)
+        levelBytes[level] =
+            texture.levelOffsets[level + 1] - texture.levelOffsets[level];
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    if (!m_TextureSlots.IsCurrent(handle.id, handle.generation))
+        return handle;
+    m_TextureAlphaModes[handle.id] = texture.alphaMode;
+    if (tailMip == 0) return handle;
+    m_TextureResidency.Add(handle.id, std::move(levelBytes), tailMip);
+    m_TextureResidency.SetSourceData(handle.id, texture.data->size(),
+                                     (bool)texture.reload);
+    m_StreamedTextures[handle.id] = std::move(texture);
+    return handle;
+}
+
+std::unique_ptr<Image> ResourceManager::CreateTextureLevels(
+    const StreamedTexture& texture, uint32_t firstMip)
+{
+    const uint32_t width = std::max(texture.width >> firstMip, 1u);
+    const uint32_t height = std::max(texture.height >> firstMip, 1u);
+    const uint32_t levelCount = texture.levelCount - firstMip;
     auto im = std::make_unique<Image>(
-        width, height, format,
+        width, height, texture.format,
         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
             VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_SAMPLE_COUNT_1_BIT,
-        VK_IMAGE_TILING_OPTIMAL, "Texture_" + identity);
-    {
-        ScopedCommandBuffer c;
-        VulkanUtils::TransitionImageLayout(
-            c, (VkImage)im->GetImage(), format, VK_IMAGE_LAYOUT_UNDEFINED,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
-        VkBufferImageCopy r{0,         0,
-                            0,         {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-                            {0, 0, 0}, {width, height, 1}};
-        vkCmdCopyBufferToImage(c, (VkBuffer)st.GetBuffer(),
-                               (VkImage)im->GetImage(),
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &r);
-        VulkanUtils::TransitionImageLayout(
-            c, (VkImage)im->GetImage(), format,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
-    }
-    return AddTexture(std::move(im), cacheKey);
+        VK_IMAGE_ASPECT_COLOR_BIT, levelCount, VK_SAMPLE_COUNT_1_BIT,
+        VK_IMAGE_TILING_OPTIMAL, texture.name, texture.components);
+    const uint64_t offset = texture.levelOffsets[firstMip];
+    m_Context->GetUploadService().UploadImage(
+        im->GetImage(), texture.format, {width, height},
+        texture.data->data() + offset,
+        texture.levelOffsets[texture.levelCount] - offset, levelCount);
+    return im;
+}
+
+void ResourceManager::UpdateTextureStreaming(Scene* scene,
+                                             const Frustum& frustum,
+                                             const glm::vec3& cameraPosition,
+                                             float projectionScale,
+                                             float viewportHeight,
+                                             uint32_t frameIndex)
+{
+    if (!scene || frameIndex >= MAX_FRAMES_IN_FLIGHT) return;
+    const uint64_t frame = ++m_StreamingFrame;
+
+    struct PendingImage
+    {
+        uint32_t id;
+        uint32_t generation;
+        StreamedTexture texture;
+        uint32_t firstMip;
+        std::unique_ptr<Image> image;
+    };
+    std::vector<PendingImage> pending;
+    {
+        std::lock_guard<std::mutex> lock(m_AssetMutex);
+        if (m_StreamedTextures.empty()) return;
+        CollectTextureReloads();
+
+        auto request = [&](int textureIndex, float pixels)
+        {
+            if (textureIndex < 0) return;
+            auto it = m_StreamedTextures.find((uint32_t)textureIndex);
+            if (it == m_StreamedTextures.end()) return;
+            const StreamedTexture& texture = it->second;
+            // Its chain was dropped; it keeps the tail until read back
+            if (!texture.data)
+            {
+                StartTextureReload(it->first, texture);
+                return;
+            }
+            m_TextureResidency.Request(
+                it->first,
+                ComputeDesiredMip(std::max(texture.width, texture.height),
+                                  texture.levelCount, pixels),
+                frame);
+        };
+        for (const auto& entity : scene->GetEntities())
+        {
+            const auto& model = entity.mesh.model;
+            if (!model || !model->IsReady()) continue;
+            const glm::mat4 modelMatrix = entity.transform.GetTransform();
+            for (const auto& mesh : model->GetMeshes())
+            {
+                const ChimeraAABB bounds =
+                    mesh.localBounds.Transform(modelMatrix * mesh.transform);
+                if (!frustum.Intersects(bounds) ||
+                    mesh.materialIndex >= m_Materials.size() ||
+                    !m_Materials[mesh.materialIndex])
+                    continue;
+                const float pixels = GetProjectedSize(
+                    bounds, cameraPosition, projectionScale, viewportHeight);
+                const GpuMaterial& material =
+                    m_Materials[mesh.materialIndex]->GetData();
+                request(material.colourTexture, pixels);
+                request(material.normalTexture, pixels);
+                request(material.roughnessTexture, pixels);
+                request(material.metallicTexture, pixels);
+                request(material.emissionTexture, pixels);
+            }
+        }
+
+        m_StreamingChangeScratch.clear();
+        m_TextureResidency.Update(frame, m_StreamingChangeScratch);
+        for (const auto& change : m_StreamingChangeScratch)
+            pending.push_back({change.id,
+                               m_TextureSlots.GetGeneration(change.id),
+                               m_StreamedTextures[change.id],
+                               change.residentMip, nullptr});
+
+        // The pending copies keep the chains they upload from alive
+        m_DroppedChainScratch.clear();
+        m_TextureResidency.TrimSourceData(frame, m_DroppedChainScratch);
+        for (uint32_t id : m_DroppedChainScratch)
+            m_StreamedTextures[id].data.reset();
+    }
+    if (pending.empty()) return;
+
+    // Uploaded outside the lock so loader threads are not held up.
+    for (auto& image : pending)
+        image.image = CreateTextureLevels(image.texture, image.firstMip);
+    m_Context->GetUploadService().Flush();
+
+    // Frames still in flight sample the old images through their own
+    // descriptor sets, so those are freed only once this frame's slot
+    // comes around again.
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    auto& freeQueue = m_ResourceFreeQueue[frameIndex];
+    for (auto& image : pending)
+    {
+        std::unique_ptr<Image>& slot = m_Textures[image.id];
+        if (m_TextureSlots.IsCurrent(image.id, image.generation) && slot)
+        {
+            std::swap(slot, image.image);
+            m_TextureSlotsDirty.Mark(image.id, 1);
+        }
+        Image* retired = image.image.release();
+        freeQueue.push_back([retired]() { delete retired; });
+    }
+}
+
+void ResourceManager::SetTextureStreamingBudget(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    m_TextureResidency.SetBudget(bytes);
+}
+
+uint64_t ResourceManager::GetTextureStreamingBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    return m_TextureResidency.GetBudget();
+}
+
+uint64_t ResourceManager::GetStreamedTextureBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    return m_TextureResidency.GetResidentBytes();
+}
+
+void ResourceManager::SetTextureStreamingCpuBudget(uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    m_TextureResidency.SetSourceBudget(bytes);
+}
+
+uint64_t ResourceManager::GetTextureStreamingCpuBudget() const
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    return m_TextureResidency.GetSourceBudget();
+}
+
+uint64_t ResourceManager::GetStreamedTextureCpuBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    return m_TextureResidency.GetSourceBytes();
+}
+
+void ResourceManager::StartTextureReload(uint32_t id,
+                                         const StreamedTexture& texture)
+{
+    TaskSystem* tasks = Application::Get().GetTaskSystem();
+    if (!texture.reload || !tasks || m_TextureReloads.count(id)) return;
+    try
+    {
+        m_TextureReloads.emplace(id, tasks->Enqueue(texture.reload));
+    }
+    catch (const std::runtime_error&)
+    {
+        // The task system is shutting down; the texture keeps its tail.
+    }
+}
+
+void ResourceManager::CollectTextureReloads()
+{
+    for (auto it = m_TextureReloads.begin(); it != m_TextureReloads.end();)
+    {
+        if (it->second.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+        TextureChain chain;
+        try
+        {
+            chain = it->second.get();
+        }
+        catch (const std::exception&)
+        {
+            // Handled like a read that found nothing
+        }
+        auto streamed = m_StreamedTextures.find(it->first);
+        if (streamed != m_StreamedTextures.end())
+        {
+            StreamedTexture& texture = streamed->second;
+            if (chain && chain->size() == texture.levelOffsets.back())
+            {
+                texture.data = std::move(chain);
+                m_TextureResidency.SetSourceData(
+                    it->first, texture.data->size(), true);
+            }
+            else
+            {
+                // Not retried, so a missing source cannot reload every
+                // frame
+                CH_CORE_WARN("ResourceManager: Could not read {} back; it "
+                             "keeps its coarse mips",
+                             texture.name);
+                texture.reload = nullptr;
+            }
+        }
+        it = m_TextureReloads.erase(it);
+    }
+}
+
+void ResourceManager::QueueTextureCacheWrite(
+    uint64_t sourceHash, const std::string& variant,
+    std::function<TextureCacheEntry()> encode)
+{
+    const std::filesystem::path path =
+        m_TextureCacheDir / MakeTextureCacheFileName(sourceHash, variant);
+    try
+    {
+        Application::Get().GetTaskSystem()->Enqueue(
+            [path, sourceHash, encode = std::move(encode)]()
+            { WriteTextureCacheFile(path, encode(), sourceHash); });
+    }
+    catch (const std::runtime_error&)
+    {
+        // The task system is shutting down; the next load encodes instead.
+    }
 }
 
 TextureHandle ResourceManager::LoadHDRTexture(const std::string& p)
@@ -732,37 +1542,146 @@ TextureHandle ResourceManager::LoadHDRTexture(const std::string& p)
         std::lock_guard<std::mutex> lock(m_AssetMutex);
         if (m_TextureMap.count(p)) return m_TextureMap[p];
     }
+    const std::vector<uint8_t> encoded = ReadBinaryFile(p);
+    if (encoded.empty()) return TextureHandle();
+
+    uint64_t sourceHash = 0;
+    if (m_UseTextureCache)
+    {
+        sourceHash = HashTextureSource(encoded.data(), encoded.size());
+        std::vector<float> level;
+        uint32_t levelWidth = 0, levelHeight = 0;
+        TextureHandle cached = LoadCachedTexture(
+            p, p, sourceHash, "hdr", false,
+            [&](const TextureCacheEntry& entry)
+            {
+                if (entry.format != BlockFormat::BC6H) return;
+                const uint32_t mip =
+                    GetEnvironmentMapMip(entry.width, entry.levelCount);
+                const uint64_t offset =
+                    GetLevelOffsets(VK_FORMAT_BC6H_UFLOAT_BLOCK, entry.width,
+                                    entry.height, mip + 1)[mip];
+                levelWidth = std::max(entry.width >> mip, 1u);
+                levelHeight = std::max(entry.height >> mip, 1u);
+                level = DecompressLevelBC6H(entry.data.data() + offset,
+                                            levelWidth, levelHeight);
+            });
+        if (cached.IsValid())
+        {
+            if (!level.empty())
+                BuildEnvironmentMap(cached.id, p, level.data(), levelWidth,
+                                    levelHeight);
+            return cached;
+        }
+    }
+
     int tw, th, tc;
-    float* px = stbi_loadf(p.c_str(), &tw, &th, &tc, 4);
+    float* px = stbi_loadf_from_memory(
+        encoded.data(), static_cast<int>(encoded.size()), &tw, &th, &tc, 4);
     if (!px) return TextureHandle();
-    VkDeviceSize s = (VkDeviceSize)tw * th * 4 * sizeof(float);
-    Buffer st(s, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
-              "Staging_LoadHDRTexture");
-    st.UploadData(px, s);
+    std::vector<float> chain =
+        BuildMipChainRGBA32F(px, (uint32_t)tw, (uint32_t)th);
     stbi_image_free(px);
+    const uint32_t mipLevels = GetMipLevelCount((uint32_t)tw, (uint32_t)th);
+
+    // Half floats halve the memory of RGBA32F; the cache entry written
+    // below is BC6H, a quarter of that again
+    const std::vector<uint16_t> halves =
+        ConvertToHalfUnsigned(chain.data(), chain.size());
     auto im = std::make_unique<Image>(
-        (uint32_t)tw, (uint32_t)th, VK_FORMAT_R32G32B32A32_SFLOAT,
+        (uint32_t)tw, (uint32_t)th, VK_FORMAT_R16G16B16A16_SFLOAT,
         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
             VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-        VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_SAMPLE_COUNT_1_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT, mipLevels, VK_SAMPLE_COUNT_1_BIT,
         VK_IMAGE_TILING_OPTIMAL, "Texture_HDR_" + p);
+    UploadService& uploads = m_Context->GetUploadService();
+    uploads.UploadImage(im->GetImage(), VK_FORMAT_R16G16B16A16_SFLOAT,
+                        {(uint32_t)tw, (uint32_t)th}, halves.data(),
+                        halves.size() * sizeof(uint16_t), mipLevels);
+    uploads.Flush();
+    TextureHandle handle = AddTexture(std::move(im), p);
+
+    // The chain is RGBA32F, so level offsets are texel counts times four
+    const uint32_t environmentMip =
+        GetEnvironmentMapMip((uint32_t)tw, mipLevels);
+    const uint64_t environmentOffset =
+        GetLevelOffsets(VK_FORMAT_R32G32B32A32_SFLOAT, (uint32_t)tw,
+                        (uint32_t)th, environmentMip + 1)[environmentMip] /
+        sizeof(float);
+    BuildEnvironmentMap(handle.id, p, chain.data() + environmentOffset,
+                        std::max((uint32_t)tw >> environmentMip, 1u),
+                        std::max((uint32_t)th >> environmentMip, 1u));
+
+    if (m_UseTextureCache)
     {
-        ScopedCommandBuffer c;
-        VulkanUtils::TransitionImageLayout(
-            c, (VkImage)im->GetImage(), VK_FORMAT_R32G32B32A32_SFLOAT,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
-        VkBufferImageCopy r{0,         0,
-                            0,         {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-                            {0, 0, 0}, {(uint32_t)tw, (uint32_t)th, 1}};
-        vkCmdCopyBufferToImage(c, (VkBuffer)st.GetBuffer(),
-                               (VkImage)im->GetImage(),
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &r);
-        VulkanUtils::TransitionImageLayout(
-            c, (VkImage)im->GetImage(), VK_FORMAT_R32G32B32A32_SFLOAT,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
+        const uint32_t width = (uint32_t)tw, height = (uint32_t)th;
+        QueueTextureCacheWrite(
+            sourceHash, "hdr",
+            [chain = std::move(chain), width, height, mipLevels]()
+            {
+                TextureCacheEntry entry;
+                entry.format = BlockFormat::BC6H;
+                entry.width = width;
+                entry.height = height;
+                entry.levelCount = mipLevels;
+                entry.data = CompressMipChainRGBA32F(chain.data(), width,
+                                                     height, mipLevels);
+                return entry;
+            });
     }
-    return AddTexture(std::move(im), p);
+    return handle;
+}
+
+void ResourceManager::BuildEnvironmentMap(uint32_t textureIndex,
+                                          const std::string& name,
+                                          const float* rgba, uint32_t width,
+                                          uint32_t height)
+{
+    TaskSystem* tasks = Application::Get().GetTaskSystem();
+    auto map = std::make_shared<EnvironmentMap>();
+    EnvironmentDistribution distribution =
+        BuildEnvironmentDistribution(rgba, width, height, tasks);
+    if (distribution.IsValid())
+        map->distribution = std::make_shared<const EnvironmentDistribution>(
+            std::move(distribution));
+    map->irradiance = ProjectIrradianceSH(rgba, width, height);
+
+    const PrefilteredEnvironment prefiltered =
+        PrefilterEnvironmentGGX(rgba, width, height, tasks);
+    const std::vector<uint16_t> halves =
+        ConvertToHalfUnsigned(prefiltered.texels.data(),
+                              prefiltered.texels.size());
+    auto image = std::make_unique<Image>(
+        prefiltered.width, prefiltered.height, VK_FORMAT_R16G16B16A16_SFLOAT,
+        VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT, prefiltered.levelCount,
+        VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TILING_OPTIMAL,
+        "Texture_HDR_GGX_" + name);
+    UploadService& uploads = m_Context->GetUploadService();
+    uploads.UploadImage(image->GetImage(), VK_FORMAT_R16G16B16A16_SFLOAT,
+                        {prefiltered.width, prefiltered.height},
+                        halves.data(), halves.size() * sizeof(uint16_t),
+                        prefiltered.levelCount);
+    uploads.Flush();
+    // Unnamed, so only the map's entry reaches it
+    map->prefiltered = AddTexture(std::move(image), "");
+    map->prefilteredLevels = prefiltered.levelCount;
+
+    {
+        std::lock_guard<std::mutex> lock(m_AssetMutex);
+        auto& entry = m_EnvironmentMaps[textureIndex];
+        if (entry) ReleaseTextureLocked(entry->prefiltered);
+        entry = std::move(map);
+    }
+    m_LightsDirty = true;
+}
+
+std::shared_ptr<const ResourceManager::EnvironmentMap>
+ResourceManager::GetEnvironmentMap(uint32_t textureIndex) const
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    auto it = m_EnvironmentMaps.find(textureIndex);
+    return it != m_EnvironmentMaps.end() ? it->second : nullptr;
 }
 
 void ResourceManager::LoadHDR(const std::string& path)
@@ -837,11 +1756,16 @@ TextureHandle ResourceManager::AddTexture(std::unique_ptr<Image> t,
                                           const std::string& n)
 {
     std::lock_guard<std::mutex> lock(m_AssetMutex);
-    uint32_t idx = (uint32_t)m_Textures.size();
-    m_Textures.push_back(std::move(t));
-    m_TextureRefCount.push_back(1);
-    if (!n.empty()) m_TextureMap[n] = TextureHandle(idx);
-    return TextureHandle(idx);
+    const SlotAllocator::Slot slot = m_TextureSlots.Allocate();
+    if (slot.index == m_BindlessTextureCapacity)
+        CH_CORE_WARN("ResourceManager: {} textures exceed the bindless "
+                     "capacity; later textures will not be sampled",
+                     m_BindlessTextureCapacity);
+    StoreInSlot(m_Textures, m_TextureRefCount, slot.index, std::move(t));
+    m_TextureSlotsDirty.Mark(slot.index, 1);
+    TextureHandle handle(slot.index, slot.generation);
+    if (!n.empty()) m_TextureMap[n] = handle;
+    return handle;
 }
 MaterialHandle ResourceManager::CreateMaterial(const std::string& n)
 {
@@ -851,49 +1775,91 @@ MaterialHandle ResourceManager::AddMaterial(std::unique_ptr<Material> m,
                                             const std::string& n)
 {
     std::lock_guard<std::mutex> lock(m_AssetMutex);
-    uint32_t idx = (uint32_t)m_Materials.size();
-    m_Materials.push_back(std::move(m));
-    m_MaterialRefCount.push_back(1);
-    if (!n.empty()) m_MaterialMap[n] = MaterialHandle(idx);
-    return MaterialHandle(idx);
+    const SlotAllocator::Slot slot = m_MaterialSlots.Allocate();
+    StoreInSlot(m_Materials, m_MaterialRefCount, slot.index, std::move(m));
+    MaterialHandle handle(slot.index, slot.generation);
+    if (!n.empty()) m_MaterialMap[n] = handle;
+    return handle;
+}
+BufferHandle ResourceManager::AddBuffer(std::shared_ptr<Buffer> b)
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    const SlotAllocator::Slot slot = m_BufferSlots.Allocate();
+    StoreInSlot(m_Buffers, m_BufferRefCount, slot.index, std::move(b));
+    return BufferHandle(slot.index, slot.generation);
 }
 void ResourceManager::AddRef(TextureHandle h)
 {
-    if (h.id < m_TextureRefCount.size()) m_TextureRefCount[h.id]++;
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    if (m_TextureSlots.IsCurrent(h.id, h.generation)) m_TextureRefCount[h.id]++;
 }
 void ResourceManager::Release(TextureHandle h)
 {
-    if (h.id < m_TextureRefCount.size() && --m_TextureRefCount[h.id] == 0 &&
-        h.id != 0)
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    ReleaseTextureLocked(h);
+}
+void ResourceManager::ReleaseTextureLocked(TextureHandle h)
+{
+    if (!m_TextureSlots.IsCurrent(h.id, h.generation)) return;
+    if (--m_TextureRefCount[h.id] != 0 || h.id == 0) return;
+    Image* r = m_Textures[h.id].release();
+    SubmitResourceFree([r]() { delete r; });
+    m_TextureSlots.Free(h.id);
+    m_TextureSlotsDirty.Mark(h.id, 1);
+    m_StreamedTextures.erase(h.id);
+    m_TextureReloads.erase(h.id);
+    m_TextureAlphaModes.erase(h.id);
+    m_TextureResidency.Remove(h.id);
+    auto environment = m_EnvironmentMaps.find(h.id);
+    if (environment != m_EnvironmentMaps.end())
     {
-        Image* r = m_Textures[h.id].release();
-        SubmitResourceFree([r]() { delete r; });
+        const TextureHandle prefiltered = environment->second->prefiltered;
+        m_EnvironmentMaps.erase(environment);
+        ReleaseTextureLocked(prefiltered);
     }
+    EraseSlotNames(m_TextureMap, h.id);
 }
 uint32_t ResourceManager::GetRefCount(TextureHandle h)
 {
-    return h.id < m_TextureRefCount.size() ? m_TextureRefCount[h.id] : 0;
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    return m_TextureSlots.IsCurrent(h.id, h.generation) ? m_TextureRefCount[h.id]
+                                                        : 0;
 }
 void ResourceManager::AddRef(BufferHandle h)
 {
-    if (h.id < m_BufferRefCount.size()) m_BufferRefCount[h.id]++;
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    if (m_BufferSlots.IsCurrent(h.id, h.generation)) m_BufferRefCount[h.id]++;
 }
 void ResourceManager::Release(BufferHandle h)
 {
-    if (h.id < m_BufferRefCount.size() && --m_BufferRefCount[h.id] == 0)
-        m_Buffers[h.id].reset();
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    if (!m_BufferSlots.IsCurrent(h.id, h.generation)) return;
+    if (--m_BufferRefCount[h.id] != 0) return;
+    std::shared_ptr<Buffer> r = std::move(m_Buffers[h.id]);
+    SubmitResourceFree([r]() {});
+    m_BufferSlots.Free(h.id);
 }
 void ResourceManager::AddRef(MaterialHandle h)
 {
-    if (h.id < m_MaterialRefCount.size()) m_MaterialRefCount[h.id]++;
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    if (m_MaterialSlots.IsCurrent(h.id, h.generation))
+        m_MaterialRefCount[h.id]++;
 }
 void ResourceManager::Release(MaterialHandle h)
 {
-    if (h.id < m_MaterialRefCount.size() && --m_MaterialRefCount[h.id] == 0 &&
-        h.id != 0)
-    {
-        if (m_Materials[h.id]) m_Materials[h.id]->SetData(GpuMaterial{});
-    }
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    if (!m_MaterialSlots.IsCurrent(h.id, h.generation)) return;
+    if (--m_MaterialRefCount[h.id] != 0 || h.id == 0) return;
+    m_Materials[h.id].reset();
+    m_MaterialSlots.Free(h.id);
+    EraseSlotNames(m_MaterialMap, h.id);
+    // Instances still in flight may index the slot until it is reused
+    const GpuMaterial empty{};
+    if (m_MaterialBuffer &&
+        m_MaterialBuffer->GetSize() >= (h.id + 1) * sizeof(GpuMaterial))
+        m_MaterialBuffer->Update(&empty, sizeof(GpuMaterial),
+                                 h.id * sizeof(GpuMaterial));
+    m_LightsDirty = true;
 }
 void ResourceManager::SubmitResourceFree(std::function<void()>&& f)
 {
@@ -909,23 +1875,30 @@ void ResourceManager::ClearResourceFreeQueue(uint32_t fI)
         m_ResourceFreeQueue[fI].clear();
     }
     if (fI < MAX_FRAMES_IN_FLIGHT) m_TransientBuffers[fI].clear();
+
+    // Called once the frame's fence has signaled, which retires the oldest
+    // frame that could still bind a freed slot.
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    m_TextureSlots.AdvanceFrame();
+    m_MaterialSlots.AdvanceFrame();
+    m_BufferSlots.AdvanceFrame();
 }
 Image* ResourceManager::GetTexture(TextureHandle h)
 {
-    if (h.id < m_Textures.size() && m_Textures[h.id])
+    if (m_TextureSlots.IsCurrent(h.id, h.generation) && m_Textures[h.id])
         return m_Textures[h.id].get();
     return m_Textures.empty() ? nullptr : m_Textures[0].get();
 }
 Material* ResourceManager::GetMaterial(MaterialHandle h)
 {
-    if (h.id < m_Materials.size() && m_Materials[h.id])
+    if (m_MaterialSlots.IsCurrent(h.id, h.generation) && m_Materials[h.id])
         return m_Materials[h.id].get();
     return m_Materials.empty() ? nullptr : m_Materials[0].get();
 }
 Buffer* ResourceManager::GetBuffer(BufferHandle h)
 {
-    return (h.id < m_Buffers.size() && m_Buffers[h.id]) ? m_Buffers[h.id].get()
-                                                        : nullptr;
+    return m_BufferSlots.IsCurrent(h.id, h.generation) ? m_Buffers[h.id].get()
+                                                       : nullptr;
 }
 TextureHandle ResourceManager::GetTextureIndex(const std::string& n)
 {
@@ -936,6 +1909,14 @@ TextureHandle ResourceManager::GetTextureIndex(const std::string& path,
 {
     return GetTextureIndex(MakeTextureCacheKey(path, srgb));
 }
+AlphaMode ResourceManager::GetTextureAlphaMode(TextureHandle h) const
+{
+    std::lock_guard<std::mutex> lock(m_AssetMutex);
+    if (!m_TextureSlots.IsCurrent(h.id, h.generation))
+        return AlphaMode::Masked;
+    auto it = m_TextureAlphaModes.find(h.id);
+    return it != m_TextureAlphaModes.end() ? it->second : AlphaMode::Masked;
+}
 void AddRefInternal(Handle<Image> h)
 {
     ResourceManager::Get().AddRef(h);
@@ -976,33 +1957,18 @@ TextureHandle ResourceManager::GenerateBlueNoise(uint32_t width,
         data[i * 4 + 3] = 255;
     }
 
+    // Single mip on purpose: averaging noise just flattens it to grey, and
+    // the shaders fetch it texel by texel anyway.
     auto im = std::make_unique<Image>(
         width, height, VK_FORMAT_R8G8B8A8_UNORM,
         VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
         VK_IMAGE_ASPECT_COLOR_BIT, 1, VK_SAMPLE_COUNT_1_BIT,
         VK_IMAGE_TILING_OPTIMAL, "ProceduralBlueNoise");
 
-    VkDeviceSize s = width * height * 4;
-    Buffer st(s, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
-              "Staging_BlueNoise");
-    st.Update(data.data(), s);
-
-    {
-        ScopedCommandBuffer c;
-        VulkanUtils::TransitionImageLayout(
-            c, (VkImage)im->GetImage(), VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
-        VkBufferImageCopy r{0,         0,
-                            0,         {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
-                            {0, 0, 0}, {width, height, 1}};
-        vkCmdCopyBufferToImage(c, (VkBuffer)st.GetBuffer(),
-                               (VkImage)im->GetImage(),
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &r);
-        VulkanUtils::TransitionImageLayout(
-            c, (VkImage)im->GetImage(), VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
-    }
+    UploadService& uploads = m_Context->GetUploadService();
+    uploads.UploadImage(im->GetImage(), VK_FORMAT_R8G8B8A8_UNORM,
+                        {width, height}, data.data(), data.size());
+    uploads.Flush();
 
     return AddTexture(std::move(im), "BlueNoise");
 }
@@ -2,13 +2,22 @@
 
 #include "pch.h"
 #include "Renderer/ChimeraCommon.h"
+#include "Renderer/Resources/BindlessCapacity.h"
 #include "Renderer/Resources/Buffer.h"
+#include "Renderer/Resources/EnvironmentDistribution.h"
+#include "Renderer/Resources/EnvironmentLighting.h"
+#include "Renderer/Resources/FrameDirtyRanges.h"
 #include "Renderer/Resources/Image.h"
 #include "Renderer/Resources/Material.h"
 #include "Renderer/Resources/ResourceHandle.h"
+#include "Renderer/Resources/ScratchArena.h"
+#include "Renderer/Resources/SlotAllocator.h"
+#include "Renderer/Resources/TextureCacheFile.h"
+#include "Renderer/Resources/TextureResidency.h"
 #include "Renderer/Graph/RenderGraphCommon.h"
 #include "Scene/SceneCommon.h"
 #include "LightManager.h"
+#include <filesystem>
 #include <future>
 
 namespace Chimera
@@ -114,16 +123,42 @@ public:
     Material* GetMaterial(MaterialHandle handle);
     Buffer* GetBuffer(BufferHandle handle);
 
-    TextureHandle LoadTexture(const std::string& path, bool srgb = true);
+        // Textures get a full mip chain built on the calling thread.
+        // normalMap renormalises the averaged vectors in each level. When
+        // the device supports BC formats, sources are looked up in the
+        // block-compressed texture cache by content hash first; a miss
+        // uploads uncompressed and encodes a cache file in the background
+        // for the next load. Textures larger than StreamingTailSize only
+        // upload their coarse tail here; UpdateTextureStreaming brings in
+        // finer mips as they are needed.
+    TextureHandle LoadTexture(const std::string& path, bool srgb = true,
+                              bool normalMap = false);
     TextureHandle LoadTextureFromMemory(const std::string& identity,
                                         const unsigned char* encodedData,
                                         size_t encodedSize,
-                                        bool srgb = true);
+                                        bool srgb = true,
+                                        bool normalMap = false);
     TextureHandle LoadTextureFromPixels(const std::string& identity,
                                         const unsigned char* rgbaPixels,
                                         uint32_t width, uint32_t height,
-                                        bool srgb = true);
+                                        bool srgb = true,
+                                        bool normalMap = false);
+        // Lighting precomputed from an HDR map when LoadHDRTexture loads
+        // it, on the TaskSystem.
+    struct EnvironmentMap
+    {
+        std::shared_ptr<const EnvironmentDistribution> distribution;
+        IrradianceSH irradiance;
+            // RGBA16F GGX chain, released along with the map
+        TextureHandle prefiltered;
+        uint32_t prefilteredLevels = 0;
+    };
+        // Stores the map as RGBA16F, or BC6H from the texture cache, and
+        // builds its EnvironmentMap.
     TextureHandle LoadHDRTexture(const std::string& path);
+        // Null unless textureIndex holds an HDR map from LoadHDRTexture.
+    std::shared_ptr<const EnvironmentMap> GetEnvironmentMap(
+        uint32_t textureIndex) const;
     void LoadHDR(const std::string& path);
 
     // High-level scene management
@@ -134,10 +169,14 @@ public:
                              const std::string& name = "");
     TextureHandle GetTextureIndex(const std::string& name);
     TextureHandle GetTextureIndex(const std::string& path, bool srgb);
+        // Alpha class of a texture loaded from pixels or the texture
+        // cache; Masked, which keeps alpha testing, for any other.
+    AlphaMode GetTextureAlphaMode(TextureHandle handle) const;
 
     MaterialHandle CreateMaterial(const std::string& name = "");
     MaterialHandle AddMaterial(std::unique_ptr<Material> material,
                                const std::string& name = "");
+    BufferHandle AddBuffer(std::shared_ptr<Buffer> buffer);
 
     VkBuffer GetMaterialBuffer() const
     {
@@ -145,10 +184,48 @@ public:
     }
 
     void SyncMaterialsToGPU();
-    void SyncInstancesToGPU(class Scene* scene);
+        // Writes the instances that changed since frameIndex last synced
+        // into that frame's mapped instance buffer, and rebuilds the light
+        // list only when instances, materials or the skybox changed. Must
+        // run after the frame's fence wait.
+    void SyncInstancesToGPU(class Scene* scene, uint32_t frameIndex);
+        // Writes the scene's point and spot lights into frameIndex's
+        // punctual light buffer for cluster_cull.comp and returns how many
+        // there are. Must run after the frame's fence wait and before
+        // UpdateSceneDescriptorSet.
+    uint32_t SyncPunctualLightsToGPU(class Scene* scene, uint32_t frameIndex);
 
     TextureHandle GenerateBlueNoise(uint32_t width, uint32_t height);
 
+        // Levels at most this many texels on a side are uploaded at load
+        // and stay resident.
+    static constexpr uint32_t StreamingTailSize = 128;
+        // Requests mips for the textures of every mesh inside frustum,
+        // sized from the projected bounds, then applies the residency
+        // changes that fit the budget: images are recreated with the new
+        // level count and the replaced ones freed once frameIndex comes
+        // around again. projectionScale is |Projection[1][1]|. Call after the
+        // frame's fence wait and before UpdateSceneDescriptorSet.
+    void UpdateTextureStreaming(class Scene* scene, const Frustum& frustum,
+                                const glm::vec3& cameraPosition,
+                                float projectionScale, float viewportHeight,
+                                uint32_t frameIndex);
+    void SetTextureStreamingBudget(uint64_t bytes);
+    uint64_t GetTextureStreamingBudget() const;
+    uint64_t GetStreamedTextureBytes() const;
+        // Budget for the CPU copies of streamed chains. Copies of textures
+        // holding only their tail are dropped over it and read back from
+        // the cache file or source image when the texture is wanted again.
+    void SetTextureStreamingCpuBudget(uint64_t bytes);
+    uint64_t GetTextureStreamingCpuBudget() const;
+    uint64_t GetStreamedTextureCpuBytes() const;
+
+        // Scratch memory every model's bottom level builds share.
+    ScratchArena& GetBLASScratchArena()
+    {
+        return m_BLASScratch;
+    }
+
     LightManager& GetLightManager()
     {
         return m_LightManager;
@@ -227,6 +304,92 @@ private:
     void CreateSceneDescriptorSetLayout();
     void AllocatePersistentSets();
     void CreateDefaultResources();
+    void SizeBindlessTextureTable();
+        // Appends the texture slot writes frameIndex still owes to writes.
+        // Caller holds m_AssetMutex.
+    void AppendTextureSlotWrites(VkDescriptorSet set, uint32_t frameIndex,
+                                 std::vector<VkWriteDescriptorSet>& writes);
+    void MarkSceneBuffersDirty()
+    {
+        for (auto& bound : m_SceneSetBindings) bound.buffersDirty = true;
+    }
+        // Fills one GpuInstance per mesh of entity, starting at out.
+    void WriteEntityInstances(const Entity& entity, GpuInstance* out) const;
+        // Whether moving entity moves a light.
+    bool HasEmissiveMesh(const Entity& entity) const;
+        // sourcePath is the file the pixels were decoded from, if any.
+    TextureHandle LoadEncodedTexture(const std::string& identity,
+                                     const unsigned char* encodedData,
+                                     size_t encodedSize, bool srgb,
+                                     bool normalMap,
+                                     const std::string& sourcePath);
+        // Without a sourcePath the decoded chain cannot be read again, so
+        // it stays on the CPU for as long as the texture is streamed.
+    TextureHandle UploadTexturePixels(const std::string& identity,
+                                      const std::string& cacheKey,
+                                      const unsigned char* rgbaPixels,
+                                      uint32_t width, uint32_t height,
+                                      bool srgb, bool normalMap,
+                                      uint64_t sourceHash,
+                                      const std::string& sourcePath = {});
+    using TextureChain = std::shared_ptr<const std::vector<uint8_t>>;
+        // A texture's whole chain, kept on the CPU so finer mips can be
+        // uploaded (again) after load. Levels are tightly packed, level 0
+        // first. data is null while dropped to the CPU budget; reload reads
+        // it back, returning null on failure, and is empty when it cannot.
+    struct StreamedTexture
+    {
+        TextureChain data;
+        std::function<TextureChain()> reload;
+        std::vector<uint64_t> levelOffsets; // One past the end last
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        VkComponentMapping components{};
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t levelCount = 0;
+        std::string name;
+        AlphaMode alphaMode = AlphaMode::Masked;
+    };
+        // Uploads the tail of texture (or all of it when it is small) and
+        // registers the rest for streaming. Without stream, every level is
+        // uploaded and stays resident; environment maps need that, since
+        // no mesh requests their mips.
+    TextureHandle AddStreamedTexture(StreamedTexture texture,
+                                     const std::string& cacheKey,
+                                     bool stream = true);
+        // Image holding levels [firstMip, levelCount) of texture, with
+        // their upload recorded but not flushed.
+    std::unique_ptr<Image> CreateTextureLevels(const StreamedTexture& texture,
+                                               uint32_t firstMip);
+        // Returns an invalid handle unless a valid cache file exists.
+        // onLoaded sees the entry before it is uploaded.
+    TextureHandle LoadCachedTexture(const std::string& identity,
+                                    const std::string& cacheKey,
+                                    uint64_t sourceHash,
+                                    const std::string& variant,
+                                    bool stream = true,
+                                    const std::function<void(
+                                        const TextureCacheEntry&)>& onLoaded =
+                                        {});
+        // Runs encode on a TaskSystem worker and writes its result to the
+        // cache file for sourceHash and variant.
+    void QueueTextureCacheWrite(uint64_t sourceHash,
+                                const std::string& variant,
+                                std::function<TextureCacheEntry()> encode);
+        // Builds the EnvironmentMap of the HDR map at textureIndex from
+        // one of its levels, width x height RGBA floats, and rebuilds
+        // lights.
+    void BuildEnvironmentMap(uint32_t textureIndex, const std::string& name,
+                             const float* rgba, uint32_t width,
+                             uint32_t height);
+        // Release without taking m_AssetMutex.
+    void ReleaseTextureLocked(TextureHandle handle);
+        // Queues texture's reload on the TaskSystem unless one is running.
+        // Caller holds m_AssetMutex.
+    void StartTextureReload(uint32_t id, const StreamedTexture& texture);
+        // Gives finished reloads their data back. Caller holds
+        // m_AssetMutex.
+    void CollectTextureReloads();
 
 private:
     static ResourceManager* s_Instance;
@@ -244,17 +407,74 @@ private:
     VkSampler m_NearestSampler = VK_NULL_HANDLE;
     std::unordered_map<std::string, TextureHandle> m_TextureMap;
     std::vector<uint32_t> m_TextureRefCount;
+    SlotAllocator m_TextureSlots{MAX_FRAMES_IN_FLIGHT};
 
     std::vector<std::unique_ptr<Material>> m_Materials;
     std::unordered_map<std::string, MaterialHandle> m_MaterialMap;
     std::vector<uint32_t> m_MaterialRefCount;
+    SlotAllocator m_MaterialSlots{MAX_FRAMES_IN_FLIGHT};
     std::unique_ptr<Buffer> m_MaterialBuffer;
-    std::unique_ptr<Buffer> m_InstanceBuffer;
+    std::unique_ptr<Buffer> m_InstanceBuffers[MAX_FRAMES_IN_FLIGHT];
+    ScratchArena m_BLASScratch{VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                                   VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                               "BLAS_ScratchArena"};
+        // Point and spot lights, and the cluster lists cluster_cull.comp
+        // writes from them; per frame, as the lists are rebuilt every frame.
+    std::unique_ptr<Buffer> m_PunctualLightBuffers[MAX_FRAMES_IN_FLIGHT];
+    std::unique_ptr<Buffer> m_ClusterBuffers[MAX_FRAMES_IN_FLIGHT];
+    std::vector<GpuPunctualLight> m_PunctualLightScratch;
+
+        // CPU copy of every GpuInstance, indexed like the GPU buffers.
+        // Each frame's buffer is only written while that frame is not in
+        // flight, so edits are queued per frame.
+    std::vector<GpuInstance> m_InstanceData;
+    FrameDirtyRanges m_InstanceDirtyRanges{MAX_FRAMES_IN_FLIGHT};
+    std::vector<FrameDirtyRanges::Range> m_InstanceRangeScratch;
+    uint64_t m_InstanceLayoutVersion = 0;
+    uint32_t m_LightsSkyboxIndex = 0xFFFFFFFF;
+        // Lights are rebuilt only when this is set: by emissive instances
+        // moving, by emission changing (m_MaterialEmission is what the
+        // last sync saw) or by the sky changing.
+    bool m_LightsDirty = true;
+    std::vector<glm::vec3> m_MaterialEmission;
+
+        // What each frame's scene set still has to be rewritten with. The
+        // sets are update-after-bind, but a set is only written while its
+        // frame is not in flight.
+    struct SceneSetBindings
+    {
+        uint64_t tlasVersion = 0;
+        bool buffersDirty = true;
+    };
+    SceneSetBindings m_SceneSetBindings[MAX_FRAMES_IN_FLIGHT];
+    uint32_t m_BindlessTextureCapacity = 1024;
+    FrameDirtyRanges m_TextureSlotsDirty{MAX_FRAMES_IN_FLIGHT};
+    std::vector<FrameDirtyRanges::Range> m_TextureRangeScratch;
+    std::vector<VkDescriptorImageInfo> m_TextureInfoScratch;
+    std::vector<VkWriteDescriptorSet> m_DescriptorWriteScratch;
+
+    bool m_UseTextureCache = false;
+    std::filesystem::path m_TextureCacheDir;
+
+        // Keyed by texture slot, guarded by m_AssetMutex like the slots.
+    std::unordered_map<uint32_t, StreamedTexture> m_StreamedTextures;
+    TextureResidency m_TextureResidency;
+    std::unordered_map<uint32_t, AlphaMode> m_TextureAlphaModes;
+    uint64_t m_StreamingFrame = 0;
+    std::vector<TextureResidency::Change> m_StreamingChangeScratch;
+    std::vector<uint32_t> m_DroppedChainScratch;
+        // Chains being read back, keyed by texture slot.
+    std::unordered_map<uint32_t, std::future<TextureChain>> m_TextureReloads;
+
+        // Keyed by texture slot, guarded by m_AssetMutex.
+    std::unordered_map<uint32_t, std::shared_ptr<const EnvironmentMap>>
+        m_EnvironmentMaps;
 
     LightManager m_LightManager;
 
     std::vector<std::shared_ptr<Buffer>> m_Buffers;
     std::vector<uint32_t> m_BufferRefCount;
+    SlotAllocator m_BufferSlots{MAX_FRAMES_IN_FLIGHT};
     std::vector<std::shared_ptr<Buffer>>
         m_TransientBuffers[MAX_FRAMES_IN_FLIGHT];
 
@@ -0,0 +1,43 @@
+#include "pch.h"
+#include "ScratchArena.h"
+#include "Renderer/Resources/Buffer.h"
+
+namespace Chimera
+{
+ScratchArena::ScratchArena(VkBufferUsageFlags usage, std::string name)
+    : m_Usage(usage), m_Name(std::move(name))
+{
+}
+
+ScratchArena::~ScratchArena() = default;
+
+ScratchArena::Lease ScratchArena::Acquire(VkDeviceSize size,
+                                          VkDeviceSize alignment)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    if (!m_Buffer || m_Buffer->GetSize() < size || m_Alignment < alignment)
+    {
+        // Whoever used the old buffer waited for it before letting go
+        const VkDeviceSize current = m_Buffer ? m_Buffer->GetSize() : 0;
+        m_Alignment = std::max(m_Alignment, alignment);
+        m_Buffer.reset();
+        m_Buffer = std::make_unique<Buffer>(std::max(size, current), m_Usage,
+                                            VMA_MEMORY_USAGE_GPU_ONLY, m_Name,
+                                            m_Alignment);
+    }
+    return Lease(std::move(lock), m_Buffer.get());
+}
+
+void ScratchArena::Release()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Buffer.reset();
+    m_Alignment = 0;
+}
+
+VkDeviceSize ScratchArena::GetSize() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Buffer ? m_Buffer->GetSize() : 0;
+}
+} // namespace Chimera
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "pch.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Chimera
+{
+class Buffer;
+
+    // Device local scratch buffer shared by one kind of transient GPU work,
+    // such as bottom level acceleration structure builds, so each build
+    // does not allocate and free its own. It only grows; Release() gives
+    // the memory back.
+class ScratchArena
+{
+public:
+    ScratchArena(VkBufferUsageFlags usage, std::string name);
+    ~ScratchArena();
+
+        // Exclusive use of the arena until destroyed. The holder must have
+        // waited for the GPU work using the buffer before letting go.
+    class Lease
+    {
+    public:
+        Buffer& GetBuffer() const
+        {
+            return *m_Buffer;
+        }
+
+    private:
+        friend class ScratchArena;
+        Lease(std::unique_lock<std::mutex> lock, Buffer* buffer)
+            : m_Lock(std::move(lock)), m_Buffer(buffer)
+        {
+        }
+
+        std::unique_lock<std::mutex> m_Lock;
+        Buffer* m_Buffer;
+    };
+
+        // Waits for any other holder, then grows the buffer to at least
+        // size bytes with its address aligned to alignment.
+    Lease Acquire(VkDeviceSize size, VkDeviceSize alignment);
+    void Release();
+
+    VkDeviceSize GetSize() const;
+
+private:
+    VkBufferUsageFlags m_Usage;
+    std::string m_Name;
+    mutable std::mutex m_Mutex;
+    std::unique_ptr<Buffer> m_Buffer;
+    VkDeviceSize m_Alignment = 0;
+};
+} // namespace Chimera
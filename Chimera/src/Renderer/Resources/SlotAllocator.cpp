@@ -0,0 +1,53 @@
+#include "pch.h"
+#include "SlotAllocator.h"
+
+namespace Chimera
+{
+SlotAllocator::SlotAllocator(uint32_t reuseDelay) : m_ReuseDelay(reuseDelay)
+{
+}
+
+SlotAllocator::Slot SlotAllocator::Allocate()
+{
+    uint32_t index;
+    if (!m_FreeList.empty())
+    {
+        index = m_FreeList.top();
+        m_FreeList.pop();
+    }
+    else
+    {
+        index = (uint32_t)m_Generations.size();
+        m_Generations.push_back(0);
+        m_Alive.push_back(false);
+    }
+    // Generation 0 is reserved for unversioned handles
+    if (++m_Generations[index] == 0) m_Generations[index] = 1;
+    m_Alive[index] = true;
+    ++m_AliveCount;
+    return {index, m_Generations[index]};
+}
+
+bool SlotAllocator::Free(uint32_t index)
+{
+    if (!IsAlive(index)) return false;
+    m_Alive[index] = false;
+    --m_AliveCount;
+    if (m_ReuseDelay == 0)
+        m_FreeList.push(index);
+    else
+        m_Retiring.push_back({m_Frame, index});
+    return true;
+}
+
+void SlotAllocator::AdvanceFrame()
+{
+    ++m_Frame;
+    while (!m_Retiring.empty() &&
+           m_Retiring.front().frame + m_ReuseDelay <= m_Frame)
+    {
+        m_FreeList.push(m_Retiring.front().index);
+        m_Retiring.pop_front();
+    }
+}
+} // namespace Chimera
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace Chimera
+{
+    // Hands out dense slot indices with a generation count per slot, so a
+    // handle to a freed slot can be told apart from one to its next
+    // occupant. A freed index is only handed out again after reuseDelay
+    // calls to AdvanceFrame(), which lets frames still in flight finish
+    // with whatever they bound at that index. The lowest free index is
+    // reused first to keep bindless arrays compact.
+class SlotAllocator
+{
+public:
+    struct Slot
+    {
+        uint32_t index = 0;
+        uint32_t generation = 0;
+    };
+
+    explicit SlotAllocator(uint32_t reuseDelay);
+
+    Slot Allocate();
+        // Returns false if index is not allocated.
+    bool Free(uint32_t index);
+
+    bool IsAlive(uint32_t index) const
+    {
+        return index < m_Alive.size() && m_Alive[index];
+    }
+        // Generation 0 stands for "whatever occupies the slot now"; it is
+        // what handles rebuilt from a bare index (such as a shader-side
+        // material index) carry.
+    bool IsCurrent(uint32_t index, uint32_t generation) const
+    {
+        return IsAlive(index) &&
+               (generation == 0 || m_Generations[index] == generation);
+    }
+    uint32_t GetGeneration(uint32_t index) const
+    {
+        return index < m_Generations.size() ? m_Generations[index] : 0;
+    }
+
+        // Call once per frame after the oldest frame in flight retired.
+    void AdvanceFrame();
+
+        // Number of indices ever handed out; one past the highest index.
+    uint32_t GetSlotCount() const
+    {
+        return (uint32_t)m_Generations.size();
+    }
+    uint32_t GetAliveCount() const
+    {
+        return m_AliveCount;
+    }
+
+private:
+    struct Retiring
+    {
+        uint64_t frame = 0;
+        uint32_t index = 0;
+    };
+
+    uint32_t m_ReuseDelay = 0;
+    uint64_t m_Frame = 0;
+    uint32_t m_AliveCount = 0;
+    std::vector<uint32_t> m_Generations;
+    std::vector<bool> m_Alive;
+    std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<>>
+        m_FreeList;
+    std::deque<Retiring> m_Retiring; // Oldest first
+};
+} // namespace Chimera
@@ -0,0 +1,30 @@
+#include "pch.h"
+#include "TLASRefit.h"
+
+namespace Chimera
+{
+uint32_t TLASCapacity(uint32_t instanceCount)
+{
+    uint32_t capacity = 64;
+    while (capacity < instanceCount && capacity < (1u << 31)) capacity <<= 1;
+    return capacity < instanceCount ? instanceCount : capacity;
+}
+
+TLASBuildMode TLASRefitPolicy::Next(uint32_t instanceCount,
+                                    uint64_t layoutVersion)
+{
+    if (m_HasBuild && instanceCount == m_BuiltCount &&
+        layoutVersion == m_BuiltLayout &&
+        m_UpdatesSinceBuild < m_RebuildInterval)
+    {
+        ++m_UpdatesSinceBuild;
+        return TLASBuildMode::Update;
+    }
+
+    m_HasBuild = true;
+    m_BuiltCount = instanceCount;
+    m_BuiltLayout = layoutVersion;
+    m_UpdatesSinceBuild = 0;
+    return TLASBuildMode::Build;
+}
+} // namespace Chimera
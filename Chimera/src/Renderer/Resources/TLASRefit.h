@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Chimera
+{
+    // Instances a top level structure is sized for: at least the count,
+    // rounded up to a power of two so a growing scene recreates it rarely.
+uint32_t TLASCapacity(uint32_t instanceCount);
+
+enum class TLASBuildMode
+{
+    Build,
+    Update
+};
+
+    // Chooses between a full build and an in-place update of the top level
+    // structure. An update keeps the hierarchy and only refits its bounds,
+    // so it needs the same instances as the build it started from and
+    // traces slower the further they move; every rebuildInterval updates
+    // the structure is built from scratch again.
+class TLASRefitPolicy
+{
+public:
+    explicit TLASRefitPolicy(uint32_t rebuildInterval = 60)
+        : m_RebuildInterval(rebuildInterval)
+    {
+    }
+
+        // Mode for the next build of instanceCount instances laid out as
+        // layoutVersion describes, recording it as done.
+    TLASBuildMode Next(uint32_t instanceCount, uint64_t layoutVersion);
+        // The structure was recreated or destroyed; it must be built.
+    void Reset()
+    {
+        m_HasBuild = false;
+    }
+
+    uint32_t GetUpdatesSinceBuild() const
+    {
+        return m_UpdatesSinceBuild;
+    }
+
+private:
+    uint32_t m_RebuildInterval;
+    bool m_HasBuild = false;
+    uint32_t m_BuiltCount = 0;
+    uint64_t m_BuiltLayout = 0;
+    uint32_t m_UpdatesSinceBuild = 0;
+};
+} // namespace Chimera
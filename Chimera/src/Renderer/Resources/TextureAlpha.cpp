@@ -0,0 +1,84 @@
+#include "pch.h"
+#include "TextureAlpha.h"
+#include "Core/TaskSystem.h"
+
+#include <algorithm>
+#include <future>
+#include <vector>
+
+namespace Chimera
+{
+    // Texels one task counts; images up to this are counted inline.
+static constexpr uint64_t s_AlphaChunkTexels = 256 * 1024;
+
+void AlphaCoverage::Add(const uint8_t* rgbaPixels, uint64_t texelCount)
+{
+    for (uint64_t i = 0; i < texelCount; ++i)
+    {
+        const uint8_t alpha = rgbaPixels[i * 4 + 3];
+        if (alpha >= 255 - AlphaTolerance)
+            ++opaque;
+        else if (alpha <= AlphaTolerance)
+            ++transparent;
+        else
+            ++partial;
+    }
+}
+
+void AlphaCoverage::Merge(const AlphaCoverage& other)
+{
+    opaque += other.opaque;
+    transparent += other.transparent;
+    partial += other.partial;
+}
+
+AlphaMode AlphaCoverage::Classify() const
+{
+    if (transparent == 0 && partial == 0) return AlphaMode::Opaque;
+    const uint64_t total = opaque + transparent + partial;
+    return (double)partial <= MaskedPartialFraction * (double)total
+               ? AlphaMode::Masked
+               : AlphaMode::Blended;
+}
+
+AlphaMode ClassifyAlpha(const uint8_t* rgbaPixels, uint64_t texelCount,
+                        TaskSystem* tasks)
+{
+    AlphaCoverage coverage;
+    if (!tasks || texelCount <= s_AlphaChunkTexels)
+    {
+        coverage.Add(rgbaPixels, texelCount);
+        return coverage.Classify();
+    }
+
+    std::vector<std::future<AlphaCoverage>> chunks;
+    uint64_t first = 0;
+    try
+    {
+        for (; first < texelCount; first += s_AlphaChunkTexels)
+        {
+            const uint64_t count =
+                std::min(s_AlphaChunkTexels, texelCount - first);
+            const uint8_t* pixels = rgbaPixels + first * 4;
+            chunks.push_back(tasks->Enqueue(
+                [pixels, count]()
+                {
+                    AlphaCoverage chunk;
+                    chunk.Add(pixels, count);
+                    return chunk;
+                }));
+        }
+    }
+    catch (const std::runtime_error&)
+    {
+        // The task system is shutting down; count the rest here.
+        coverage.Add(rgbaPixels + first * 4, texelCount - first);
+    }
+    for (auto& chunk : chunks)
+    {
+        tasks->Wait(chunk);
+        coverage.Merge(chunk.get());
+    }
+    return coverage.Classify();
+}
+} // namespace Chimera
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Chimera
+{
+class TaskSystem;
+
+    // What a texture's alpha does to the surface it covers. Opaque alpha
+    // never fails the 0.5 alpha test, so geometry using it can be marked
+    // opaque and skip any-hit shaders; masked alpha cuts holes with hard
+    // edges; blended alpha has wide ranges of partial coverage.
+enum class AlphaMode : uint32_t
+{
+    Opaque,
+    Masked,
+    Blended
+};
+
+    // Texels within this of 255 count as opaque and within this of 0 as
+    // transparent, so encoder noise does not demote a texture.
+constexpr uint8_t AlphaTolerance = 8;
+    // Share of partial texels a masked texture may have, for the filtered
+    // edges around its cut-outs.
+constexpr double MaskedPartialFraction = 0.05;
+
+    // Texels counted by alpha. Counts of disjoint ranges of a texture merge
+    // into the counts of the whole.
+struct AlphaCoverage
+{
+    uint64_t opaque = 0;
+    uint64_t transparent = 0;
+    uint64_t partial = 0;
+
+    void Add(const uint8_t* rgbaPixels, uint64_t texelCount);
+    void Merge(const AlphaCoverage& other);
+    AlphaMode Classify() const;
+};
+
+    // Classifies RGBA8 pixels. With tasks, large images are counted in
+    // chunks on its workers; waiting from a worker helps run them.
+AlphaMode ClassifyAlpha(const uint8_t* rgbaPixels, uint64_t texelCount,
+                        TaskSystem* tasks = nullptr);
+} // namespace Chimera
@@ -0,0 +1,208 @@
+#include "pch.h"
+#include "TextureCacheFile.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace Chimera
+{
+namespace
+{
+    // KTX2's identifier with our own tag, so neither loader mistakes the
+    // other's files for its own.
+constexpr uint8_t TextureCacheIdentifier[12] = {0xAB, 'C',  'H',  'T',
+                                                'X',  ' ',  '1',  0xBB,
+                                                '\r', '\n', 0x1A, '\n'};
+    // Bump whenever the encoders change output, so old files re-encode.
+constexpr uint32_t TextureCacheFormatVersion = 2;
+constexpr uint32_t MaxCachedLevels = 32;
+
+struct TextureCacheFileHeader
+{
+    uint8_t identifier[12];
+    uint32_t formatVersion;
+    uint32_t blockFormat;
+    uint32_t srgb;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t alphaMode; // AlphaMode; keeps the 64-bit fields aligned
+    uint64_t sourceHash;
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+static_assert(sizeof(TextureCacheFileHeader) == 64,
+              "texture cache header must not contain implicit padding");
+
+struct TextureCacheLevelIndex
+{
+    uint64_t byteOffset; // From the start of the level data
+    uint64_t byteLength;
+};
+static_assert(sizeof(TextureCacheLevelIndex) == 16,
+              "texture cache level index must not contain implicit padding");
+
+std::vector<TextureCacheLevelIndex> BuildLevelIndex(BlockFormat format,
+                                                    uint32_t width,
+                                                    uint32_t height,
+                                                    uint32_t levelCount)
+{
+    std::vector<TextureCacheLevelIndex> index(levelCount);
+    uint64_t offset = 0;
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        index[level].byteOffset = offset;
+        index[level].byteLength =
+            GetCompressedLevelSize(format, std::max(width >> level, 1u),
+                                   std::max(height >> level, 1u));
+        offset += index[level].byteLength;
+    }
+    return index;
+}
+} // namespace
+
+const char* TextureCacheLoadStatusToString(TextureCacheLoadStatus status)
+{
+    switch (status)
+    {
+        case TextureCacheLoadStatus::Loaded:
+            return "loaded";
+        case TextureCacheLoadStatus::Missing:
+            return "missing";
+        case TextureCacheLoadStatus::Corrupt:
+            return "corrupt";
+        case TextureCacheLoadStatus::Stale:
+            return "stale";
+    }
+    return "unknown";
+}
+
+uint64_t HashTextureSource(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::string MakeTextureCacheFileName(uint64_t sourceHash,
+                                     const std::string& variant)
+{
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx",
+                  static_cast<unsigned long long>(sourceHash));
+    return std::string(hex) + "_" + variant + ".chtex";
+}
+
+std::vector<uint8_t> SerializeTextureCache(const TextureCacheEntry& entry,
+                                           uint64_t sourceHash)
+{
+    const std::vector<TextureCacheLevelIndex> index = BuildLevelIndex(
+        entry.format, entry.width, entry.height, entry.levelCount);
+    const uint64_t expectedSize =
+        index.empty() ? 0 : index.back().byteOffset + index.back().byteLength;
+    if (entry.levelCount == 0 || entry.levelCount > MaxCachedLevels ||
+        entry.data.size() != expectedSize)
+    {
+        throw std::invalid_argument(
+            "SerializeTextureCache: data does not match the level layout");
+    }
+
+    TextureCacheFileHeader header{};
+    std::memcpy(header.identifier, TextureCacheIdentifier,
+                sizeof(header.identifier));
+    header.formatVersion = TextureCacheFormatVersion;
+    header.blockFormat = static_cast<uint32_t>(entry.format);
+    header.srgb = entry.srgb ? 1 : 0;
+    header.width = entry.width;
+    header.height = entry.height;
+    header.levelCount = entry.levelCount;
+    header.alphaMode = static_cast<uint32_t>(entry.alphaMode);
+    header.sourceHash = sourceHash;
+    header.payloadSize = entry.data.size();
+    header.payloadHash = HashTextureSource(entry.data.data(), entry.data.size());
+
+    const size_t indexBytes = index.size() * sizeof(TextureCacheLevelIndex);
+    std::vector<uint8_t> fileData(sizeof(header) + indexBytes +
+                                  entry.data.size());
+    std::memcpy(fileData.data(), &header, sizeof(header));
+    std::memcpy(fileData.data() + sizeof(header), index.data(), indexBytes);
+    std::memcpy(fileData.data() + sizeof(header) + indexBytes,
+                entry.data.data(), entry.data.size());
+    return fileData;
+}
+
+TextureCacheLoadStatus DeserializeTextureCache(
+    const std::vector<uint8_t>& fileData, uint64_t sourceHash,
+    TextureCacheEntry& outEntry)
+{
+    outEntry = {};
+
+    if (fileData.empty())
+    {
+        return TextureCacheLoadStatus::Missing;
+    }
+
+    TextureCacheFileHeader header{};
+    if (fileData.size() < sizeof(header))
+    {
+        return TextureCacheLoadStatus::Corrupt;
+    }
+    std::memcpy(&header, fileData.data(), sizeof(header));
+
+    if (std::memcmp(header.identifier, TextureCacheIdentifier,
+                    sizeof(header.identifier)) != 0)
+    {
+        return TextureCacheLoadStatus::Corrupt;
+    }
+
+    if (header.formatVersion != TextureCacheFormatVersion ||
+        header.sourceHash != sourceHash)
+    {
+        return TextureCacheLoadStatus::Stale;
+    }
+
+    if (header.blockFormat > static_cast<uint32_t>(BlockFormat::BC7) ||
+        header.width == 0 || header.height == 0 || header.levelCount == 0 ||
+        header.levelCount > MaxCachedLevels ||
+        header.alphaMode > static_cast<uint32_t>(AlphaMode::Blended))
+    {
+        return TextureCacheLoadStatus::Corrupt;
+    }
+
+    const BlockFormat format = static_cast<BlockFormat>(header.blockFormat);
+    const std::vector<TextureCacheLevelIndex> expected = BuildLevelIndex(
+        format, header.width, header.height, header.levelCount);
+    const size_t indexBytes = expected.size() * sizeof(TextureCacheLevelIndex);
+    const uint64_t expectedPayload =
+        expected.back().byteOffset + expected.back().byteLength;
+    if (header.payloadSize != expectedPayload ||
+        fileData.size() != sizeof(header) + indexBytes + header.payloadSize ||
+        std::memcmp(fileData.data() + sizeof(header), expected.data(),
+                    indexBytes) != 0)
+    {
+        return TextureCacheLoadStatus::Corrupt;
+    }
+
+    const uint8_t* payload = fileData.data() + sizeof(header) + indexBytes;
+    if (HashTextureSource(payload, header.payloadSize) != header.payloadHash)
+    {
+        return TextureCacheLoadStatus::Corrupt;
+    }
+
+    outEntry.format = format;
+    outEntry.srgb = header.srgb != 0;
+    outEntry.width = header.width;
+    outEntry.height = header.height;
+    outEntry.levelCount = header.levelCount;
+    outEntry.alphaMode = static_cast<AlphaMode>(header.alphaMode);
+    outEntry.data.assign(payload, payload + header.payloadSize);
+    return TextureCacheLoadStatus::Loaded;
+}
+} // namespace Chimera
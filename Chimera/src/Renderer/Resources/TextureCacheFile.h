@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BlockCompression.h"
+#include "TextureAlpha.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Chimera
+{
+    // A block-compressed texture ready for upload. data holds every level
+    // tightly packed, level 0 first, as UploadService::UploadImage expects.
+struct TextureCacheEntry
+{
+    BlockFormat format = BlockFormat::BC7;
+    bool srgb = false;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t levelCount = 0;
+        // Of the source pixels, which block compression may blur.
+    AlphaMode alphaMode = AlphaMode::Masked;
+    std::vector<uint8_t> data;
+};
+
+enum class TextureCacheLoadStatus
+{
+    Loaded,
+    Missing,
+    Corrupt,
+    Stale
+};
+
+const char* TextureCacheLoadStatusToString(TextureCacheLoadStatus status);
+
+    // FNV-1a over the source file (or pixels). Cache files are named after
+    // it, so editing a texture in place never serves the old encoding.
+uint64_t HashTextureSource(const void* data, size_t size,
+                           uint64_t seed = 0xcbf29ce484222325ull);
+
+    // File name for a source hash and the options that select the
+    // encoding. variant distinguishes sRGB colour, linear data, normal maps
+    // and HDR sources that happen to share bytes.
+std::string MakeTextureCacheFileName(uint64_t sourceHash,
+                                     const std::string& variant);
+
+    // The layout follows KTX2 - a fixed header, a per-level index of
+    // offsets and lengths, then the level data - but with its own
+    // identifier, a source hash and a payload checksum instead of the KTX2
+    // data format descriptor. Levels are stored level 0 first so the
+    // payload uploads in one copy.
+std::vector<uint8_t> SerializeTextureCache(const TextureCacheEntry& entry,
+                                           uint64_t sourceHash);
+
+    // Stale covers files written by another encoder version or for other
+    // source bytes (a hash collision in the file name).
+TextureCacheLoadStatus DeserializeTextureCache(
+    const std::vector<uint8_t>& fileData, uint64_t sourceHash,
+    TextureCacheEntry& outEntry);
+} // namespace Chimera
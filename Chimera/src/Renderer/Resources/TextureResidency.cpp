@@ -0,0 +1,262 @@
+#include "pch.h"
+#include "TextureResidency.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Chimera
+{
+uint32_t ComputeDesiredMip(uint32_t maxDimension, uint32_t levelCount,
+                           float screenPixels)
+{
+    if (levelCount <= 1) return 0;
+    if (!(screenPixels >= 1.0f)) return levelCount - 1;
+    const float ratio = float(maxDimension) / screenPixels;
+    if (ratio <= 1.0f) return 0;
+    const uint32_t mip = (uint32_t)std::floor(std::log2(ratio));
+    return std::min(mip, levelCount - 1);
+}
+
+void TextureResidency::Add(uint32_t id, std::vector<uint64_t> levelBytes,
+                           uint32_t tailMip)
+{
+    Remove(id);
+    if (levelBytes.empty()) return;
+    Texture texture;
+    texture.levelBytes = std::move(levelBytes);
+    texture.tailMip =
+        std::min(tailMip, (uint32_t)texture.levelBytes.size() - 1);
+    texture.residentMip = texture.tailMip;
+    texture.reportedMip = texture.tailMip;
+    texture.requestedMip = texture.tailMip;
+    m_ResidentBytes += BytesBetween(texture, texture.residentMip,
+                                    (uint32_t)texture.levelBytes.size());
+    m_Textures.emplace(id, std::move(texture));
+}
+
+void TextureResidency::Remove(uint32_t id)
+{
+    auto it = m_Textures.find(id);
+    if (it == m_Textures.end()) return;
+    const Texture& texture = it->second;
+    m_ResidentBytes -= BytesBetween(texture, texture.residentMip,
+                                    (uint32_t)texture.levelBytes.size());
+    m_SourceBytes -= texture.sourceBytes;
+    m_Textures.erase(it);
+}
+
+void TextureResidency::Clear()
+{
+    m_Textures.clear();
+    m_ResidentBytes = 0;
+    m_SourceBytes = 0;
+}
+
+void TextureResidency::SetSourceData(uint32_t id, uint64_t bytes,
+                                     bool reloadable)
+{
+    auto it = m_Textures.find(id);
+    if (it == m_Textures.end()) return;
+    Texture& texture = it->second;
+    m_SourceBytes = m_SourceBytes - texture.sourceBytes + bytes;
+    texture.sourceBytes = bytes;
+    texture.reloadable = reloadable;
+}
+
+void TextureResidency::TrimSourceData(uint64_t frame,
+                                      std::vector<uint32_t>& dropped)
+{
+    while (m_SourceBytes > m_SourceBudget)
+    {
+        Texture* victim = nullptr;
+        uint32_t victimId = 0;
+        for (auto& [id, texture] : m_Textures)
+        {
+            if (texture.sourceBytes == 0 || !texture.reloadable ||
+                texture.residentMip != texture.tailMip ||
+                texture.reportedMip != texture.tailMip ||
+                GetWantedMip(texture, frame) != texture.tailMip)
+                continue;
+            // Least recently used first, then the largest copy, then the
+            // lowest id for a stable order.
+            const bool better =
+                !victim || texture.lastUsedFrame < victim->lastUsedFrame ||
+                (texture.lastUsedFrame == victim->lastUsedFrame &&
+                 (texture.sourceBytes > victim->sourceBytes ||
+                  (texture.sourceBytes == victim->sourceBytes &&
+                   id < victimId)));
+            if (better)
+            {
+                victim = &texture;
+                victimId = id;
+            }
+        }
+        if (!victim) return;
+        m_SourceBytes -= victim->sourceBytes;
+        victim->sourceBytes = 0;
+        dropped.push_back(victimId);
+    }
+}
+
+void TextureResidency::Request(uint32_t id, uint32_t mip, uint64_t frame)
+{
+    auto it = m_Textures.find(id);
+    if (it == m_Textures.end()) return;
+    Texture& texture = it->second;
+    mip = std::min(mip, (uint32_t)texture.levelBytes.size() - 1);
+    if (texture.requestFrame != frame || texture.lastUsedFrame == 0)
+        texture.requestedMip = mip;
+    else
+        texture.requestedMip = std::min(texture.requestedMip, mip);
+    texture.requestFrame = frame;
+    texture.lastUsedFrame = frame + 1; // 0 means never requested
+}
+
+uint32_t TextureResidency::GetResidentMip(uint32_t id) const
+{
+    auto it = m_Textures.find(id);
+    return it == m_Textures.end() ? 0 : it->second.residentMip;
+}
+
+uint64_t TextureResidency::BytesBetween(const Texture& texture,
+                                        uint32_t first, uint32_t end)
+{
+    uint64_t bytes = 0;
+    for (uint32_t level = first; level < end; ++level)
+        bytes += texture.levelBytes[level];
+    return bytes;
+}
+
+uint32_t TextureResidency::GetWantedMip(const Texture& texture,
+                                        uint64_t frame) const
+{
+    if (texture.lastUsedFrame == 0 || texture.requestFrame != frame)
+        return texture.tailMip;
+    return std::min(texture.requestedMip, texture.tailMip);
+}
+
+uint32_t TextureResidency::GetEvictionFloor(const Texture& victim,
+                                            const Texture* requester,
+                                            uint64_t frame) const
+{
+    if (victim.promotedThisUpdate) return victim.residentMip;
+    if (!requester || victim.lastUsedFrame < requester->lastUsedFrame)
+        return victim.tailMip;
+    // Equally recent textures only give up mips they hold beyond their own
+    // request, so two visible textures never trade levels back and forth.
+    return std::max(victim.residentMip, GetWantedMip(victim, frame));
+}
+
+bool TextureResidency::EvictOneLevel(const Texture* requester, uint64_t frame)
+{
+    Texture* victim = nullptr;
+    uint32_t victimId = 0;
+    for (auto& [id, texture] : m_Textures)
+    {
+        if (&texture == requester ||
+            texture.residentMip >= GetEvictionFloor(texture, requester, frame))
+            continue;
+        // Least recently used first; among equals, the one whose finest
+        // level frees the most, then the lowest id for a stable order.
+        const bool better =
+            !victim || texture.lastUsedFrame < victim->lastUsedFrame ||
+            (texture.lastUsedFrame == victim->lastUsedFrame &&
+             (texture.levelBytes[texture.residentMip] >
+                  victim->levelBytes[victim->residentMip] ||
+              (texture.levelBytes[texture.residentMip] ==
+                   victim->levelBytes[victim->residentMip] &&
+               id < victimId)));
+        if (better)
+        {
+            victim = &texture;
+            victimId = id;
+        }
+    }
+    if (!victim) return false;
+    m_ResidentBytes -= victim->levelBytes[victim->residentMip];
+    ++victim->residentMip;
+    return true;
+}
+
+void TextureResidency::Update(uint64_t frame, std::vector<Change>& changes)
+{
+    struct Candidate
+    {
+        uint32_t id;
+        Texture* texture;
+        uint32_t wantedMip;
+    };
+    std::vector<Candidate> candidates;
+    for (auto& [id, texture] : m_Textures)
+    {
+        texture.promotedThisUpdate = false;
+        const uint32_t wanted = GetWantedMip(texture, frame);
+        if (wanted < texture.residentMip)
+            candidates.push_back({id, &texture, wanted});
+    }
+
+    // A lowered budget is met before anything is promoted.
+    while (m_ResidentBytes > m_Budget && EvictOneLevel(nullptr, frame))
+    {
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b)
+              {
+                  const uint32_t gapA = a.texture->residentMip - a.wantedMip;
+                  const uint32_t gapB = b.texture->residentMip - b.wantedMip;
+                  if (gapA != gapB) return gapA > gapB;
+                  if (a.texture->lastUsedFrame != b.texture->lastUsedFrame)
+                      return a.texture->lastUsedFrame >
+                             b.texture->lastUsedFrame;
+                  return a.id < b.id;
+              });
+
+    uint64_t uploaded = 0;
+    for (const Candidate& candidate : candidates)
+    {
+        if (uploaded > 0 && uploaded >= m_UploadBytesPerUpdate) break;
+        Texture& texture = *candidate.texture;
+
+        // Settle for a coarser level when even evicting everything allowed
+        // would not make room for the wanted one.
+        uint64_t available =
+            m_Budget > m_ResidentBytes ? m_Budget - m_ResidentBytes : 0;
+        for (const auto& [id, other] : m_Textures)
+        {
+            if (&other == &texture) continue;
+            available += BytesBetween(
+                other, other.residentMip,
+                GetEvictionFloor(other, &texture, frame));
+        }
+        uint32_t target = candidate.wantedMip;
+        while (target < texture.residentMip &&
+               BytesBetween(texture, target, texture.residentMip) > available)
+            ++target;
+        if (target >= texture.residentMip) continue;
+
+        const uint64_t extra =
+            BytesBetween(texture, target, texture.residentMip);
+        while (m_ResidentBytes + extra > m_Budget &&
+               EvictOneLevel(&texture, frame))
+        {
+        }
+        m_ResidentBytes += extra;
+        texture.residentMip = target;
+        texture.promotedThisUpdate = true;
+        // The new image is uploaded whole, coarse levels included.
+        uploaded += BytesBetween(texture, target,
+                                 (uint32_t)texture.levelBytes.size());
+    }
+
+    const size_t firstChange = changes.size();
+    for (auto& [id, texture] : m_Textures)
+    {
+        if (texture.residentMip == texture.reportedMip) continue;
+        changes.push_back({id, texture.residentMip});
+        texture.reportedMip = texture.residentMip;
+    }
+    std::sort(changes.begin() + firstChange, changes.end(),
+              [](const Change& a, const Change& b) { return a.id < b.id; });
+}
+} // namespace Chimera
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Chimera
+{
+    // Finest mip worth sampling for a texture of maxDimension texels drawn
+    // across screenPixels pixels: about one texel per pixel, rounded
+    // towards the finer level. Assumes the UVs span the texture once.
+uint32_t ComputeDesiredMip(uint32_t maxDimension, uint32_t levelCount,
+                           float screenPixels);
+
+    // Decides which mips of each streamed texture stay resident. It only
+    // does the bookkeeping; ResourceManager performs the uploads and image
+    // swaps the returned changes describe.
+    //
+    // A texture's resident mips are always a contiguous run [residentMip,
+    // levelCount). Levels from tailMip down are the tail: uploaded at load
+    // time and never evicted, so every texture can always be sampled.
+    // Requests record the finest mip the renderer wants this frame; a
+    // texture that stops being requested keeps its mips until memory is
+    // needed, and the least recently requested ones are dropped first.
+    //
+    // The CPU copies of whole chains that mips are uploaded from have a
+    // budget of their own. A copy may be dropped while its texture holds
+    // only the tail and its source can be read again; the texture is then
+    // not requested until ResourceManager has reloaded it.
+class TextureResidency
+{
+public:
+    struct Change
+    {
+        uint32_t id = 0;
+        uint32_t residentMip = 0;
+    };
+
+        // levelBytes[i] is the size of mip i; levels from tailMip on start
+        // resident.
+    void Add(uint32_t id, std::vector<uint64_t> levelBytes, uint32_t tailMip);
+    void Remove(uint32_t id);
+    void Clear();
+
+        // Several requests in one frame keep the finest mip.
+    void Request(uint32_t id, uint32_t mip, uint64_t frame);
+
+        // Brings resident mips towards the requested ones, largest shortfall
+        // first. Finer mips only fit under the budget by evicting mips of
+        // textures requested less recently (or held finer than requested),
+        // one level at a time from the least recently used. At most
+        // uploadBytesPerUpdate bytes are promoted per call, though the first
+        // promotion always goes ahead so a large level cannot starve.
+        // Appends one Change per texture whose residentMip moved.
+    void Update(uint64_t frame, std::vector<Change>& changes);
+
+        // Size of the CPU copy of a texture's chain, 0 once dropped.
+        // Copies that cannot be reloaded are counted but never dropped.
+    void SetSourceData(uint32_t id, uint64_t bytes, bool reloadable);
+        // Drops copies, least recently requested first, until they fit the
+        // source budget. Only textures holding just their tail and not
+        // wanted finer this frame qualify. Appends the dropped ids.
+    void TrimSourceData(uint64_t frame, std::vector<uint32_t>& dropped);
+
+    void SetBudget(uint64_t bytes)
+    {
+        m_Budget = bytes;
+    }
+    uint64_t GetBudget() const
+    {
+        return m_Budget;
+    }
+    void SetUploadBytesPerUpdate(uint64_t bytes)
+    {
+        m_UploadBytesPerUpdate = bytes;
+    }
+    void SetSourceBudget(uint64_t bytes)
+    {
+        m_SourceBudget = bytes;
+    }
+    uint64_t GetSourceBudget() const
+    {
+        return m_SourceBudget;
+    }
+
+    bool Contains(uint32_t id) const
+    {
+        return m_Textures.count(id) != 0;
+    }
+        // Returns 0 for ids that are not streamed.
+    uint32_t GetResidentMip(uint32_t id) const;
+    uint64_t GetResidentBytes() const
+    {
+        return m_ResidentBytes;
+    }
+    uint64_t GetSourceBytes() const
+    {
+        return m_SourceBytes;
+    }
+
+private:
+    struct Texture
+    {
+        std::vector<uint64_t> levelBytes;
+        uint32_t tailMip = 0;
+        uint32_t residentMip = 0;
+        uint32_t reportedMip = 0; // residentMip as of the last Change
+        uint32_t requestedMip = 0;
+        uint64_t requestFrame = 0;
+        uint64_t lastUsedFrame = 0; // One past the frame; 0 if never used
+        bool promotedThisUpdate = false;
+        uint64_t sourceBytes = 0;
+        bool reloadable = false;
+    };
+
+    static uint64_t BytesBetween(const Texture& texture, uint32_t first,
+                                 uint32_t end);
+        // Finest mip the texture should hold: its request while it is
+        // current, otherwise the tail.
+    uint32_t GetWantedMip(const Texture& texture, uint64_t frame) const;
+        // Coarsest level victim may be evicted to when making room for
+        // requester, or for the budget when requester is null.
+    uint32_t GetEvictionFloor(const Texture& victim, const Texture* requester,
+                              uint64_t frame) const;
+        // Drops the finest resident level of the least recently used
+        // texture other than requester that may lose one. Returns false
+        // when no texture can give memory back.
+    bool EvictOneLevel(const Texture* requester, uint64_t frame);
+
+    std::unordered_map<uint32_t, Texture> m_Textures;
+    uint64_t m_ResidentBytes = 0;
+    uint64_t m_Budget = 512ull << 20;
+    uint64_t m_UploadBytesPerUpdate = 32ull << 20;
+    uint64_t m_SourceBytes = 0;
+    uint64_t m_SourceBudget = 512ull << 20;
+};
+} // namespace Chimera
@@ -3,12 +3,38 @@
 #include "Renderer/Resources/ResourceManager.h"
 #include "Renderer/Backend/VulkanContext.h"
 #include "Renderer/Backend/RenderContext.h"
+#include "Renderer/Backend/UploadService.h"
 #include "Renderer/Resources/Buffer.h"
+#include "Renderer/Resources/BLASBatch.h"
+#include "Renderer/Resources/ScratchArena.h"
 #include "Renderer/Backend/ShaderCommon.h"
 #include "Utils/VulkanBarrier.h"
 
+#include <atomic>
+#include <chrono>
+
 namespace Chimera
 {
+    // Compaction needs the structures built to allow it.
+static constexpr VkBuildAccelerationStructureFlagsKHR s_BLASBuildFlags =
+    VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+    VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+    // Scratch one build call may use before the rest of a model's builds
+    // wait for it in a later call.
+static constexpr uint64_t s_BLASScratchBudget = 64ull * 1024 * 1024;
+static std::atomic<BLASGranularity> s_BLASGranularity{
+    BLASGranularity::PerModel};
+
+void Model::SetBLASGranularity(BLASGranularity granularity)
+{
+    s_BLASGranularity = granularity;
+}
+
+BLASGranularity Model::GetBLASGranularity()
+{
+    return s_BLASGranularity;
+}
+
 Model::Model(std::shared_ptr<VulkanContext> context,
              const ImportedScene& importedScene)
     : m_Context(context), m_Status(LoadingStatus::Loading)
@@ -46,25 +72,7 @@ void Model::UploadToGPU(const ImportedScene& importedScene)
     VkDeviceSize indexBufferSize = sizeof(uint32_t) * m_IndexCount;
     VkDeviceSize triangleBufferSize = sizeof(GpuTriangle) * triangleCount;
 
-    // 1. Staging
-    Buffer stagingVBO(vertexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                      VMA_MEMORY_USAGE_CPU_ONLY);
-    stagingVBO.Update(importedScene.Vertices.data(), vertexBufferSize);
-
-    Buffer stagingIBO(indexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                      VMA_MEMORY_USAGE_CPU_ONLY);
-    stagingIBO.Update(importedScene.Indices.data(), indexBufferSize);
-
-    std::unique_ptr<Buffer> stagingTBO;
-    if (triangleCount > 0)
-    {
-        stagingTBO = std::make_unique<Buffer>(triangleBufferSize,
-                                              VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                              VMA_MEMORY_USAGE_CPU_ONLY);
-        stagingTBO->Update(importedScene.Triangles.data(), triangleBufferSize);
-    }
-
-    // 2. GPU Buffers
+    // 1. GPU Buffers
     m_VertexBuffer = std::make_unique<Buffer>(
         vertexBufferSize,
         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
@@ -91,22 +99,20 @@ void Model::UploadToGPU(const ImportedScene& importedScene)
             VMA_MEMORY_USAGE_GPU_ONLY);
     }
 
-    // 3. Transfer
+    // 2. Transfer. The BLAS build below is submitted to the graphics queue
+    // after Flush(), so it is ordered after the copies without a CPU wait.
+    UploadService& uploads = m_Context->GetUploadService();
+    uploads.UploadBuffer(m_VertexBuffer->GetBuffer(),
+                         importedScene.Vertices.data(), vertexBufferSize);
+    uploads.UploadBuffer(m_IndexBuffer->GetBuffer(),
+                         importedScene.Indices.data(), indexBufferSize);
+    if (triangleCount > 0)
     {
-        ScopedCommandBuffer cmd;
-        VkBufferCopy vCopy{0, 0, vertexBufferSize};
-        VkBufferCopy iCopy{0, 0, indexBufferSize};
-        vkCmdCopyBuffer(cmd, (VkBuffer)stagingVBO.GetBuffer(),
-                        (VkBuffer)m_VertexBuffer->GetBuffer(), 1, &vCopy);
-        vkCmdCopyBuffer(cmd, (VkBuffer)stagingIBO.GetBuffer(),
-                        (VkBuffer)m_IndexBuffer->GetBuffer(), 1, &iCopy);
-        if (triangleCount > 0)
-        {
-            VkBufferCopy tCopy{0, 0, triangleBufferSize};
-            vkCmdCopyBuffer(cmd, (VkBuffer)stagingTBO->GetBuffer(),
-                            (VkBuffer)m_TriangleBuffer->GetBuffer(), 1, &tCopy);
-        }
+        uploads.UploadBuffer(m_TriangleBuffer->GetBuffer(),
+                             importedScene.Triangles.data(),
+                             triangleBufferSize);
     }
+    m_UploadToken = uploads.Flush();
 
     m_Meshes = importedScene.Meshes;
     m_TriangleData = importedScene.Triangles;
@@ -131,89 +137,246 @@ void Model::DestroyBLAS()
         }
     }
 
+    m_BLASGroups.clear();
     m_BLASHandles.clear();
+    m_BLASAddresses.clear();
     m_BLASBuffers.clear();
 }
 
 void Model::BuildBLAS()
 {
     VkDevice device = m_Context->GetDevice();
-    m_BLASBuffers.resize(m_Meshes.size());
-    m_BLASHandles.resize(m_Meshes.size(), VK_NULL_HANDLE);
+    const auto startTime = std::chrono::steady_clock::now();
 
+    // 1. Geometry of every mesh with triangles, and the sizes of each
+    // group's structure
+    std::vector<BLASMeshInfo> meshInfos(m_Meshes.size());
     for (uint32_t i = 0; i < m_Meshes.size(); ++i)
     {
         const auto& mesh = m_Meshes[i];
-        uint32_t maxPrimitiveCount = mesh.indexCount / 3;
-        if (maxPrimitiveCount == 0 || mesh.vertexCount == 0) continue;
-
-        VkAccelerationStructureGeometryKHR geo{
-            VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR};
-        geo.flags = 0;
-        geo.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
-        geo.geometry.triangles.sType =
-            VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
-        geo.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
-        geo.geometry.triangles.vertexData.deviceAddress =
-            m_VertexBuffer->GetDeviceAddress() +
-            (mesh.vertexOffset * sizeof(GpuVertex));
-        geo.geometry.triangles.vertexStride = sizeof(GpuVertex);
-        geo.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
-        geo.geometry.triangles.indexData.deviceAddress =
-            m_IndexBuffer->GetDeviceAddress() +
-            (mesh.indexOffset * sizeof(uint32_t));
-        geo.geometry.triangles.maxVertex = mesh.vertexCount - 1;
-
-        VkAccelerationStructureBuildGeometryInfoKHR buildInfo{
-            VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR};
-        buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
-        buildInfo.flags =
-            VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
-        buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-        buildInfo.geometryCount = 1;
-        buildInfo.pGeometries = &geo;
+        if (mesh.vertexCount > 0)
+            meshInfos[i].triangleCount = mesh.indexCount / 3;
+        memcpy(meshInfos[i].transform.data(), &mesh.transform,
+               sizeof(meshInfos[i].transform));
+    }
+    m_BLASGroups = GroupMeshesForBLAS(meshInfos, s_BLASGranularity);
+    const uint32_t buildCount = (uint32_t)m_BLASGroups.size();
+    m_BLASHandles.assign(buildCount, VK_NULL_HANDLE);
+    m_BLASAddresses.assign(buildCount, 0);
+    if (buildCount == 0) return;
 
+    std::vector<VkAccelerationStructureGeometryKHR> geometries;
+    std::vector<VkAccelerationStructureBuildRangeInfoKHR> ranges;
+    std::vector<uint32_t> primitiveCounts;
+    std::vector<uint64_t> structureSizes, scratchSizes;
+    uint64_t opaqueTriangles = 0, totalTriangles = 0;
+    for (const BLASGroup& group : m_BLASGroups)
+    {
+        const size_t first = geometries.size();
+        for (uint32_t i = group.firstMesh;
+             i < group.firstMesh + group.meshCount; ++i)
+        {
+            const auto& mesh = m_Meshes[i];
+            VkAccelerationStructureGeometryKHR geo{
+                VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_KHR};
+            // Opaque geometry never invokes any-hit shaders and ray queries
+            // commit its hits without returning them as candidates
+            const bool opaque = mesh.alphaMode == AlphaMode::Opaque;
+            geo.flags = opaque ? VK_GEOMETRY_OPAQUE_BIT_KHR : 0;
+            geo.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
+            geo.geometry.triangles.sType =
+                VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
+            geo.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+            geo.geometry.triangles.vertexData.deviceAddress =
+                m_VertexBuffer->GetDeviceAddress() +
+                (mesh.vertexOffset * sizeof(GpuVertex));
+            geo.geometry.triangles.vertexStride = sizeof(GpuVertex);
+            geo.geometry.triangles.indexType = VK_INDEX_TYPE_UINT32;
+            geo.geometry.triangles.indexData.deviceAddress =
+                m_IndexBuffer->GetDeviceAddress() +
+                (mesh.indexOffset * sizeof(uint32_t));
+            geo.geometry.triangles.maxVertex = mesh.vertexCount - 1;
+
+            geometries.push_back(geo);
+            ranges.push_back({meshInfos[i].triangleCount, 0, 0, 0});
+            primitiveCounts.push_back(meshInfos[i].triangleCount);
+            totalTriangles += meshInfos[i].triangleCount;
+            if (opaque) opaqueTriangles += meshInfos[i].triangleCount;
+        }
+
+        VkAccelerationStructureBuildGeometryInfoKHR sizeQuery{
+            VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR};
+        sizeQuery.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        sizeQuery.flags = s_BLASBuildFlags;
+        sizeQuery.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+        sizeQuery.geometryCount = group.meshCount;
+        sizeQuery.pGeometries = &geometries[first];
         VkAccelerationStructureBuildSizesInfoKHR sizeInfo{
             VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR};
         vkGetAccelerationStructureBuildSizesKHR(
-            device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &buildInfo,
-            &maxPrimitiveCount, &sizeInfo);
+            device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+            &sizeQuery, &primitiveCounts[first], &sizeInfo);
 
-        auto blasBuffer = std::make_unique<Buffer>(
-            sizeInfo.accelerationStructureSize,
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
-                VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY);
+        structureSizes.push_back(sizeInfo.accelerationStructureSize);
+        scratchSizes.push_back(sizeInfo.buildScratchSize);
+    }
+
+    // 2. Every structure in one buffer, and scratch from the shared arena
+    const AlignedLayout buildLayout =
+        PackAligned(structureSizes, AccelerationStructureAlignment);
+    Buffer buildBuffer(buildLayout.size,
+                       VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
+                           VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                       VMA_MEMORY_USAGE_GPU_ONLY, "BLAS_Build");
+    std::vector<VkAccelerationStructureKHR> built(buildCount);
+    for (uint32_t b = 0; b < buildCount; ++b)
+    {
         VkAccelerationStructureCreateInfoKHR createInfo{
             VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR};
-        createInfo.buffer = (VkBuffer)blasBuffer->GetBuffer();
-        createInfo.size = sizeInfo.accelerationStructureSize;
+        createInfo.buffer = (VkBuffer)buildBuffer.GetBuffer();
+        createInfo.offset = buildLayout.offsets[b];
+        createInfo.size = structureSizes[b];
         createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+        vkCreateAccelerationStructureKHR(device, &createInfo, nullptr,
+                                         &built[b]);
+    }
 
-        VkAccelerationStructureKHR handle;
-        vkCreateAccelerationStructureKHR(device, &createInfo, nullptr, &handle);
+    const VkDeviceSize scratchAlignment =
+        m_Context->GetAccelerationStructureProperties()
+            .minAccelerationStructureScratchOffsetAlignment;
+    const ScratchPlan plan =
+        PlanScratch(scratchSizes, std::max<VkDeviceSize>(scratchAlignment, 1),
+                    s_BLASScratchBudget);
 
-        const VkDeviceSize scratchAlignment =
-            m_Context->GetAccelerationStructureProperties()
-                .minAccelerationStructureScratchOffsetAlignment;
-        Buffer scratch(sizeInfo.buildScratchSize,
-                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-                           VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                       VMA_MEMORY_USAGE_GPU_ONLY, "BLAS_Scratch",
-                       scratchAlignment);
-        buildInfo.dstAccelerationStructure = handle;
-        buildInfo.scratchData.deviceAddress = scratch.GetDeviceAddress();
-
-        VkAccelerationStructureBuildRangeInfoKHR rangeInfo{maxPrimitiveCount, 0,
-                                                           0, 0};
-        const VkAccelerationStructureBuildRangeInfoKHR* pRange = &rangeInfo;
+    VkQueryPoolCreateInfo queryInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    queryInfo.queryType =
+        VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+    queryInfo.queryCount = buildCount;
+    VkQueryPool queryPool = VK_NULL_HANDLE;
+    vkCreateQueryPool(device, &queryInfo, nullptr, &queryPool);
+
+    // 3. One submission: a build call per scratch run, then the compacted
+    // sizes
+    {
+        ScratchArena::Lease scratch =
+            ResourceManager::Get().GetBLASScratchArena().Acquire(
+                plan.arenaSize, scratchAlignment);
+        const VkDeviceAddress scratchAddress =
+            scratch.GetBuffer().GetDeviceAddress();
+
+        std::vector<VkAccelerationStructureBuildGeometryInfoKHR> infos(
+            buildCount);
+        std::vector<const VkAccelerationStructureBuildRangeInfoKHR*>
+            rangePointers(buildCount);
+        size_t geometryStart = 0;
+        for (uint32_t b = 0; b < buildCount; ++b)
         {
-            ScopedCommandBuffer cmd;
-            vkCmdBuildAccelerationStructuresKHR(cmd, 1, &buildInfo, &pRange);
+            auto& info = infos[b];
+            info.sType =
+                VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
+            info.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+            info.flags = s_BLASBuildFlags;
+            info.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+            info.geometryCount = m_BLASGroups[b].meshCount;
+            info.pGeometries = &geometries[geometryStart];
+            info.dstAccelerationStructure = built[b];
+            info.scratchData.deviceAddress = scratchAddress + plan.offsets[b];
+            rangePointers[b] = &ranges[geometryStart];
+            geometryStart += m_BLASGroups[b].meshCount;
+        }
+
+        // Orders a run after the previous one's scratch use, and the size
+        // query after the last run
+        VkMemoryBarrier2 barrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+        barrier.srcStageMask =
+            VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+        barrier.srcAccessMask =
+            VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+        barrier.dstStageMask =
+            VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+        barrier.dstAccessMask =
+            VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+            VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+        VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+        dep.memoryBarrierCount = 1;
+        dep.pMemoryBarriers = &barrier;
+
+        ScopedCommandBuffer cmd;
+        vkCmdResetQueryPool(cmd, queryPool, 0, buildCount);
+        for (const ScratchPlan::Batch& batch : plan.batches)
+        {
+            if (batch.first > 0) vkCmdPipelineBarrier2(cmd, &dep);
+            vkCmdBuildAccelerationStructuresKHR(
+                cmd, batch.count, infos.data() + batch.first,
+                rangePointers.data() + batch.first);
+        }
+        vkCmdPipelineBarrier2(cmd, &dep);
+        vkCmdWriteAccelerationStructuresPropertiesKHR(
+            cmd, buildCount, built.data(),
+            VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, queryPool,
+            0);
+    }
+
+    // 4. Compact into one tightly sized buffer
+    std::vector<uint64_t> compactSizes(buildCount);
+    vkGetQueryPoolResults(device, queryPool, 0, buildCount,
+                          buildCount * sizeof(uint64_t), compactSizes.data(),
+                          sizeof(uint64_t),
+                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    vkDestroyQueryPool(device, queryPool, nullptr);
+
+    const AlignedLayout compactLayout =
+        PackAligned(compactSizes, AccelerationStructureAlignment);
+    auto compactBuffer = std::make_unique<Buffer>(
+        compactLayout.size,
+        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
+            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY, "BLAS");
+    {
+        ScopedCommandBuffer cmd;
+        for (uint32_t b = 0; b < buildCount; ++b)
+        {
+            VkAccelerationStructureCreateInfoKHR createInfo{
+                VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR};
+            createInfo.buffer = (VkBuffer)compactBuffer->GetBuffer();
+            createInfo.offset = compactLayout.offsets[b];
+            createInfo.size = compactSizes[b];
+            createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_BOTTOM_LEVEL_KHR;
+            VkAccelerationStructureKHR& handle = m_BLASHandles[b];
+            vkCreateAccelerationStructureKHR(device, &createInfo, nullptr,
+                                             &handle);
+            VkAccelerationStructureDeviceAddressInfoKHR addressInfo{
+                VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
+                nullptr, handle};
+            m_BLASAddresses[b] =
+                vkGetAccelerationStructureDeviceAddressKHR(device,
+                                                           &addressInfo);
+
+            VkCopyAccelerationStructureInfoKHR copy{
+                VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR};
+            copy.src = built[b];
+            copy.dst = handle;
+            copy.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+            vkCmdCopyAccelerationStructureKHR(cmd, &copy);
         }
-        m_BLASBuffers[i] = std::move(blasBuffer);
-        m_BLASHandles[i] = handle;
     }
+    for (VkAccelerationStructureKHR handle : built)
+        vkDestroyAccelerationStructureKHR(device, handle, nullptr);
+    m_BLASBuffers.push_back(std::move(compactBuffer));
+
+    const double milliseconds = std::chrono::duration<double, std::milli>(
+                                    std::chrono::steady_clock::now() -
+                                    startTime)
+                                    .count();
+    CH_CORE_INFO("Model: Built {} BLAS for {} meshes in {} build call(s), "
+                 "{:.2f} ms; {:.2f} MB compacted to {:.2f} MB, {:.2f} MB "
+                 "scratch; {:.1f}% of triangles opaque",
+                 buildCount, geometries.size(), plan.batches.size(),
+                 milliseconds,
+                 buildLayout.size / (1024.0 * 1024.0),
+                 compactLayout.size / (1024.0 * 1024.0),
+                 plan.arenaSize / (1024.0 * 1024.0),
+                 100.0 * opaqueTriangles / totalTriangles);
 }
 
 Model::~Model()
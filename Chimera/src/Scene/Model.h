@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Scene/SceneCommon.h"
+#include "Renderer/Backend/UploadService.h"
 #include "Renderer/Backend/VulkanContext.h"
+#include "Renderer/Resources/BLASBatch.h"
 #include "Renderer/Resources/Buffer.h"
 #include <vector>
 #include <memory>
@@ -35,6 +37,12 @@ public:
     }
 
     void UploadToGPU(const ImportedScene& sceneData);
+        // Completes once the geometry copies of UploadToGPU have landed.
+        // Graphics work does not need to wait on it; see UploadService.
+    UploadToken GetUploadToken() const
+    {
+        return m_UploadToken;
+    }
 
     const std::vector<Mesh>& GetMeshes() const
     {
@@ -70,10 +78,25 @@ public:
         return m_TriangleBuffer ? m_TriangleBuffer->GetDeviceAddress() : 0;
     }
 
+        // Bottom level structures and the meshes each holds, one entry per
+        // group. The TLAS instances a group with the custom index of its
+        // first mesh; a hit on geometry g is on mesh firstMesh + g.
+    const std::vector<BLASGroup>& GetBLASGroups() const
+    {
+        return m_BLASGroups;
+    }
     const std::vector<VkAccelerationStructureKHR>& GetBLASHandles() const
     {
         return m_BLASHandles;
     }
+    const std::vector<VkDeviceAddress>& GetBLASAddresses() const
+    {
+        return m_BLASAddresses;
+    }
+
+        // Granularity of models whose BLAS are built from now on.
+    static void SetBLASGranularity(BLASGranularity granularity);
+    static BLASGranularity GetBLASGranularity();
 
     uint32_t GetVertexCount() const
     {
@@ -104,10 +127,13 @@ private:
     std::vector<Mesh> m_Meshes;
 
     std::vector<std::unique_ptr<Buffer>> m_BLASBuffers;
+    std::vector<BLASGroup> m_BLASGroups;
     std::vector<VkAccelerationStructureKHR> m_BLASHandles;
+    std::vector<VkDeviceAddress> m_BLASAddresses;
 
     uint32_t m_VertexCount = 0;
     uint32_t m_IndexCount = 0;
+    UploadToken m_UploadToken;
 
     LoadingStatus m_Status = LoadingStatus::Uninitialized;
 };
@@ -8,12 +8,24 @@
 #include "Core/Application.h"
 #include "Renderer/Pipelines/RenderPath.h"
 #include <glm/gtc/matrix_transform.hpp>
+#include <atomic>
 #include <filesystem>
 
 namespace Chimera
 {
+namespace
+{
+uint64_t NextSceneVersion()
+{
+    static std::atomic<uint64_t> s_Version{0};
+    return ++s_Version;
+}
+} // namespace
 
-Scene::Scene(std::shared_ptr<VulkanContext> context) : m_Context(context.get())
+Scene::Scene(std::shared_ptr<VulkanContext> context)
+    : m_Context(context.get()),
+      m_InstanceLayoutVersion(NextSceneVersion()),
+      m_TLASVersion(NextSceneVersion())
 {
 }
 
@@ -86,14 +98,13 @@ void Scene::FinalizeAsyncModelLoad(std::shared_ptr<Model> model,
     entity.primitiveOffset = currentOffset;
 
     m_Entities.push_back(entity);
+    // Instances and emissive lights are rebuilt by the next frame's sync
+    InvalidateInstanceLayout();
 
     m_WorldTransforms.resize(m_Nodes.size(), glm::mat4(1.0f));
     UpdateWorldTransforms();
     BuildOctree();
-    UpdateTLAS();
-
-    // Sync instances and rebuild light structures (for Emissive mesh sampling)
-    ResourceManager::Get().SyncInstancesToGPU(this);
+    MarkDirty();
 
     if (auto* renderPath = Application::Get().GetActiveRenderPath())
         renderPath->OnSceneUpdated();
@@ -128,10 +139,40 @@ void Scene::DestroyTLAS()
     }
 
     m_TopLevelAS = VK_NULL_HANDLE;
+    m_TLASVersion = NextSceneVersion();
 
     // 必须在 AS handle 销毁之后释放 backing buffer
     m_TLASBuffer.reset();
-    m_ASInstanceBuffer.reset();
+    m_TLASScratch.reset();
+    for (auto& buffer : m_ASInstanceBuffers) buffer.reset();
+    m_TLASCapacity = 0;
+    m_TLASRefit.Reset();
+}
+
+void Scene::RetireTLAS()
+{
+    if (m_TopLevelAS == VK_NULL_HANDLE) return;
+
+    // Frames still in flight may trace or build the structure, so it goes
+    // once they have finished
+    VkDevice device = m_Context->GetDevice();
+    VkAccelerationStructureKHR tlas = m_TopLevelAS;
+    std::shared_ptr<Buffer> tlasBuffer = std::move(m_TLASBuffer);
+    std::shared_ptr<Buffer> scratch = std::move(m_TLASScratch);
+    ResourceManager::SubmitResourceFree(
+        [device, tlas, tlasBuffer, scratch]()
+        { vkDestroyAccelerationStructureKHR(device, tlas, nullptr); });
+
+    m_TopLevelAS = VK_NULL_HANDLE;
+    m_TLASVersion = NextSceneVersion();
+    m_TLASCapacity = 0;
+    m_TLASRefit.Reset();
+}
+
+void Scene::InvalidateInstanceLayout()
+{
+    m_InstanceLayoutVersion = NextSceneVersion();
+    m_DirtyInstanceEntities.clear();
 }
 
 void Scene::ComputeWorldTransform(uint32_t nodeIndex,
@@ -175,16 +216,11 @@ void Scene::OnUpdate(float ts)
         }
         BuildOctree();
         MarkDirty();
+        InvalidateInstanceLayout();
     }
 
     UpdateWorldTransforms();
 
-    if (m_NeedsTLASRebuild)
-    {
-        UpdateTLAS();
-        m_NeedsTLASRebuild = false;
-    }
-
     if (m_NeedsMaterialSync)
     {
         ResourceManager::Get().SyncMaterialsToGPU();
@@ -203,6 +239,10 @@ void Scene::UpdateEntityTRS(uint32_t index, const glm::vec3& pos,
         e.transform.rotation = rot;
         e.transform.scale = scale;
         MarkDirty();
+        if (std::find(m_DirtyInstanceEntities.begin(),
+                      m_DirtyInstanceEntities.end(),
+                      index) == m_DirtyInstanceEntities.end())
+            m_DirtyInstanceEntities.push_back(index);
     }
 }
 
@@ -212,7 +252,8 @@ void Scene::ClearScene()
     m_Nodes.clear();
     m_WorldTransforms.clear();
     m_OctreeRoot.reset();
-    UpdateTLAS();
+    InvalidateInstanceLayout();
+    MarkDirty();
 }
 
 bool Scene::TryGetWorldBounds(ChimeraAABB& outBounds) const
@@ -344,71 +385,70 @@ void Scene::ClearSkybox()
     m_SkyboxTexture = TextureHandle();
 }
 
-void Scene::UpdateTLAS()
+void Scene::UpdateTLAS(VkCommandBuffer cmd, uint32_t frameIndex)
 {
-    if (!m_Context || !m_Context->IsRayTracingSupported()) return;
+    if (!m_NeedsTLASRebuild) return;
+    m_NeedsTLASRebuild = false;
+    if (!m_Context || !m_Context->IsRayTracingSupported() ||
+        frameIndex >= MAX_FRAMES_IN_FLIGHT)
+        return;
     VkDevice device = m_Context->GetDevice();
-    std::vector<VkAccelerationStructureInstanceKHR> instances;
 
+    m_ASInstances.clear();
     for (const auto& entity : m_Entities)
     {
         auto model = entity.mesh.model;
         if (!model) continue;
-        const auto& blasHandles = model->GetBLASHandles();
+        const auto& blasGroups = model->GetBLASGroups();
+        const auto& blasAddresses = model->GetBLASAddresses();
         const auto& meshes = model->GetMeshes();
-        if (blasHandles.empty()) continue;
+        if (blasAddresses.size() != blasGroups.size()) continue;
         glm::mat4 entityTransform = entity.transform.GetTransform();
 
-        for (uint32_t i = 0; i < (uint32_t)meshes.size(); ++i)
+        // Meshes of a group share a transform; hits add the geometry index
+        // to the custom index to find their mesh
+        for (uint32_t g = 0; g < (uint32_t)blasGroups.size(); ++g)
         {
-            if (i >= (uint32_t)blasHandles.size()) break;
-            const Mesh& mesh = meshes[i];
-            if (mesh.indexCount == 0 ||
-                blasHandles[i] == VK_NULL_HANDLE)
+            const BLASGroup& group = blasGroups[g];
+            if (blasAddresses[g] == 0 ||
+                group.firstMesh >= (uint32_t)meshes.size())
                 continue;
 
             VkAccelerationStructureInstanceKHR inst{};
-            glm::mat4 modelMatrix = entityTransform * mesh.transform;
+            glm::mat4 modelMatrix =
+                entityTransform * meshes[group.firstMesh].transform;
             glm::mat4 transpose = glm::transpose(modelMatrix);
             memcpy(&inst.transform, &transpose, sizeof(inst.transform));
-            inst.instanceCustomIndex = entity.primitiveOffset + i;
+            inst.instanceCustomIndex = entity.primitiveOffset + group.firstMesh;
             inst.mask = 0xFF;
-            VkAccelerationStructureDeviceAddressInfoKHR addrInfo{
-                VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_DEVICE_ADDRESS_INFO_KHR,
-                nullptr, blasHandles[i]};
-            inst.accelerationStructureReference =
-                vkGetAccelerationStructureDeviceAddressKHR(device, &addrInfo);
+            inst.accelerationStructureReference = blasAddresses[g];
             inst.flags =
                 VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR;
-            instances.push_back(inst);
+            m_ASInstances.push_back(inst);
         }
     }
 
-    if (instances.empty())
+    if (m_ASInstances.empty())
     {
-        VK_CHECK(vkDeviceWaitIdle(device));
-        DestroyTLAS();
+        RetireTLAS();
         return;
     }
 
-    VkDeviceSize instSize =
-        instances.size() * sizeof(VkAccelerationStructureInstanceKHR);
-    auto newInstanceBuffer = std::make_unique<Buffer>(
-        instSize,
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY);
-
-    Buffer instStaging(instSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                       VMA_MEMORY_USAGE_CPU_ONLY);
-    instStaging.UploadData(instances.data(), instSize);
+    // This frame's fence has signaled, so the build that last read its
+    // instance buffer is done and the buffer can be rewritten or replaced
+    const uint32_t count = (uint32_t)m_ASInstances.size();
+    const VkDeviceSize instanceSize =
+        count * sizeof(VkAccelerationStructureInstanceKHR);
+    auto& instanceBuffer = m_ASInstanceBuffers[frameIndex];
+    if (!instanceBuffer || instanceBuffer->GetSize() < instanceSize)
     {
-        ScopedCommandBuffer cmd;
-        VkBufferCopy copy{0, 0, instSize};
-        vkCmdCopyBuffer(cmd, (VkBuffer)instStaging.GetBuffer(),
-                        (VkBuffer)newInstanceBuffer->GetBuffer(), 1, &copy);
+        instanceBuffer = std::make_unique<Buffer>(
+            TLASCapacity(count) * sizeof(VkAccelerationStructureInstanceKHR),
+            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_CPU_TO_GPU, "TLAS_Instances");
     }
+    instanceBuffer->Update(m_ASInstances.data(), instanceSize);
 
     VkAccelerationStructureBuildGeometryInfoKHR buildInfo{
         VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR};
@@ -418,55 +458,92 @@ void Scene::UpdateTLAS()
     geom.geometry.instances.sType =
         VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
     geom.geometry.instances.data.deviceAddress =
-        newInstanceBuffer->GetDeviceAddress();
+        instanceBuffer->GetDeviceAddress();
     buildInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-    buildInfo.flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR;
+    // Updates must use the flags the structure was built with
+    buildInfo.flags =
+        VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR |
+        VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR;
     buildInfo.geometryCount = 1;
     buildInfo.pGeometries = &geom;
-    buildInfo.mode = VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
-
-    uint32_t count = (uint32_t)instances.size();
-    VkAccelerationStructureBuildSizesInfoKHR sizeInfo{
-        VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR};
-    vkGetAccelerationStructureBuildSizesKHR(
-        device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, &buildInfo,
-        &count, &sizeInfo);
-
-    auto newTLASBuffer = std::make_unique<Buffer>(
-        sizeInfo.accelerationStructureSize,
-        VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
-            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-        VMA_MEMORY_USAGE_GPU_ONLY);
-
-    VkAccelerationStructureKHR newTLAS = VK_NULL_HANDLE;
-    VkAccelerationStructureCreateInfoKHR createInfo{
-        VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR};
-    createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
-    createInfo.buffer = (VkBuffer)newTLASBuffer->GetBuffer();
-    createInfo.size = sizeInfo.accelerationStructureSize;
-    VK_CHECK(vkCreateAccelerationStructureKHR(device, &createInfo, nullptr,
-                                              &newTLAS));
-
-    const VkDeviceSize scratchAlignment =
-        m_Context->GetAccelerationStructureProperties()
-            .minAccelerationStructureScratchOffsetAlignment;
-    Buffer scratch(sizeInfo.buildScratchSize,
-                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
-                       VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                   VMA_MEMORY_USAGE_GPU_ONLY, "TLAS_Scratch",
-                   scratchAlignment);
-    buildInfo.dstAccelerationStructure = newTLAS;
-    buildInfo.scratchData.deviceAddress = scratch.GetDeviceAddress();
-    VkAccelerationStructureBuildRangeInfoKHR rangeInfo{count, 0, 0, 0};
-    const VkAccelerationStructureBuildRangeInfoKHR* pRange = &rangeInfo;
+
+    // The structure is sized for a capacity rather than the count, so it
+    // is only recreated when the scene outgrows it
+    if (m_TopLevelAS == VK_NULL_HANDLE || count > m_TLASCapacity)
     {
-        ScopedCommandBuffer cmd;
-        vkCmdBuildAccelerationStructuresKHR(cmd, 1, &buildInfo, &pRange);
+        RetireTLAS();
+        const uint32_t capacity = TLASCapacity(count);
+        VkAccelerationStructureBuildSizesInfoKHR sizeInfo{
+            VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_SIZES_INFO_KHR};
+        vkGetAccelerationStructureBuildSizesKHR(
+            device, VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR,
+            &buildInfo, &capacity, &sizeInfo);
+
+        m_TLASBuffer = std::make_unique<Buffer>(
+            sizeInfo.accelerationStructureSize,
+            VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR |
+                VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY, "TLAS");
+        VkAccelerationStructureCreateInfoKHR createInfo{
+            VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_CREATE_INFO_KHR};
+        createInfo.type = VK_ACCELERATION_STRUCTURE_TYPE_TOP_LEVEL_KHR;
+        createInfo.buffer = (VkBuffer)m_TLASBuffer->GetBuffer();
+        createInfo.size = sizeInfo.accelerationStructureSize;
+        VK_CHECK(vkCreateAccelerationStructureKHR(device, &createInfo, nullptr,
+                                                  &m_TopLevelAS));
+
+        const VkDeviceSize scratchAlignment =
+            m_Context->GetAccelerationStructureProperties()
+                .minAccelerationStructureScratchOffsetAlignment;
+        m_TLASScratch = std::make_unique<Buffer>(
+            std::max(sizeInfo.buildScratchSize, sizeInfo.updateScratchSize),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_ONLY, "TLAS_Scratch", scratchAlignment);
+        m_TLASCapacity = capacity;
+        m_TLASVersion = NextSceneVersion();
     }
 
-    DestroyTLAS();
-    m_ASInstanceBuffer = std::move(newInstanceBuffer);
-    m_TLASBuffer = std::move(newTLASBuffer);
-    m_TopLevelAS = newTLAS;
+    const bool update = m_TLASRefit.Next(count, m_InstanceLayoutVersion) ==
+                        TLASBuildMode::Update;
+    buildInfo.mode = update ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR
+                            : VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR;
+    buildInfo.srcAccelerationStructure =
+        update ? m_TopLevelAS : VK_NULL_HANDLE;
+    buildInfo.dstAccelerationStructure = m_TopLevelAS;
+    buildInfo.scratchData.deviceAddress = m_TLASScratch->GetDeviceAddress();
+
+    // Earlier frames on the queue may still trace the structure or use the
+    // scratch buffer; the build waits for them, and this frame's tracing
+    // waits for the build
+    const VkPipelineStageFlags2 traceStages =
+        VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR |
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT |
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    VkMemoryBarrier2 before{VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    before.srcStageMask =
+        traceStages | VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+    before.srcAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    before.dstStageMask =
+        VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+    before.dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR |
+                           VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    dep.memoryBarrierCount = 1;
+    dep.pMemoryBarriers = &before;
+    vkCmdPipelineBarrier2(cmd, &dep);
+
+    VkAccelerationStructureBuildRangeInfoKHR rangeInfo{count, 0, 0, 0};
+    const VkAccelerationStructureBuildRangeInfoKHR* pRange = &rangeInfo;
+    vkCmdBuildAccelerationStructuresKHR(cmd, 1, &buildInfo, &pRange);
+
+    VkMemoryBarrier2 after{VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    after.srcStageMask =
+        VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+    after.srcAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    after.dstStageMask = traceStages;
+    after.dstAccessMask = VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+    dep.pMemoryBarriers = &after;
+    vkCmdPipelineBarrier2(cmd, &dep);
 }
 } // namespace Chimera
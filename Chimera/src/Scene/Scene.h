@@ -1,7 +1,9 @@
 #pragma once
 
 #include "SceneCommon.h"
+#include "Renderer/ChimeraCommon.h"
 #include "Renderer/Resources/ResourceHandle.h"
+#include "Renderer/Resources/TLASRefit.h"
 #include <vector>
 #include <string>
 #include <memory>
@@ -69,12 +71,23 @@ public:
         return m_Lights[0];
     }
 
-    void UpdateTLAS();
+        // Records this frame's top level build into cmd when instances
+        // changed since the last one: a refit of the persistent structure
+        // while the instances stay the same, a full build when they change
+        // and periodically between refits. Call before anything that traces
+        // the scene is recorded.
+    void UpdateTLAS(VkCommandBuffer cmd, uint32_t frameIndex);
 
     VkAccelerationStructureKHR GetTLAS() const
     {
         return m_TopLevelAS;
     }
+        // Changes whenever GetTLAS() may return a different structure;
+        // unique across scenes.
+    uint64_t GetTLASVersion() const
+    {
+        return m_TLASVersion;
+    }
 
     const std::vector<Entity>& GetEntities() const
     {
@@ -98,12 +111,32 @@ public:
 
     void UpdateWorldTransforms();
 
+        // Instance bookkeeping for ResourceManager::SyncInstancesToGPU. The
+        // layout version changes whenever instance indices may shift
+        // (entities added, removed or cleared) and is unique across scenes.
+        // Between layout changes only the dirty entities need their
+        // instances rewritten.
+    uint64_t GetInstanceLayoutVersion() const
+    {
+        return m_InstanceLayoutVersion;
+    }
+    const std::vector<uint32_t>& GetDirtyInstanceEntities() const
+    {
+        return m_DirtyInstanceEntities;
+    }
+    void ClearDirtyInstanceEntities()
+    {
+        m_DirtyInstanceEntities.clear();
+    }
+
     void BuildOctree();
     void GetVisibleEntities(const Frustum& frustum,
                             std::vector<uint32_t>& outVisibleIndices) const;
 
 private:
     void DestroyTLAS();
+    void RetireTLAS();
+    void InvalidateInstanceLayout();
     void ComputeWorldTransform(uint32_t nodeIndex,
                                const glm::mat4& parentTransform);
     void SubdivideOctree(OctreeNode* node, uint32_t depth);
@@ -126,8 +159,16 @@ private:
 
     VkAccelerationStructureKHR m_TopLevelAS = VK_NULL_HANDLE;
     std::unique_ptr<Buffer> m_TLASBuffer;
-    std::unique_ptr<Buffer> m_ASInstanceBuffer;
+    std::unique_ptr<Buffer> m_TLASScratch;
+    std::unique_ptr<Buffer> m_ASInstanceBuffers[MAX_FRAMES_IN_FLIGHT];
+    std::vector<VkAccelerationStructureInstanceKHR> m_ASInstances;
+    uint32_t m_TLASCapacity = 0;
+    TLASRefitPolicy m_TLASRefit;
 
     std::vector<uint32_t> m_EntitiesToRemove;
+
+    uint64_t m_InstanceLayoutVersion = 0;
+    uint64_t m_TLASVersion = 0;
+    std::vector<uint32_t> m_DirtyInstanceEntities;
 };
 } // namespace Chimera
@@ -9,6 +9,7 @@
 #include <array>
 
 #include "Renderer/Resources/ResourceHandle.h"
+#include "Renderer/Resources/TextureAlpha.h"
 #include "Renderer/Backend/ShaderCommon.h"
 
 namespace Chimera
@@ -177,11 +178,17 @@ enum class LightType
     Spot = 2
 };
 
+    // position.w is the LightType and color.a the intensity; for
+    // directional lights direction.w is the angular radius. Point and spot
+    // lights are culled into clusters for the forward path; params.x is
+    // their range (0 derives it from the intensity), and params.y and
+    // params.z the cosines of a spot's outer and inner cone angles.
 struct Light
 {
     glm::vec4 position;
     glm::vec4 color;
     glm::vec4 direction;
+    glm::vec4 params = glm::vec4(0.0f, 0.5f, 0.9f, 0.0f);
 };
 
 struct VertexInfo : public GpuVertex
@@ -234,6 +241,9 @@ struct Mesh
     int materialIndex = 0;
     glm::mat4 transform{1.0f};
     ChimeraAABB localBounds;
+        // Of its material's base colour. Only Opaque lets ray tracing skip
+        // the alpha test.
+    AlphaMode alphaMode = AlphaMode::Masked;
 };
 
 struct Node
@@ -284,6 +294,8 @@ struct ImportedScene
     std::vector<uint32_t> Indices;
     std::vector<Mesh> Meshes;
     std::vector<GpuMaterial> Materials;
+        // Per material, from its base colour texture's alpha.
+    std::vector<AlphaMode> MaterialAlphaModes;
     std::vector<Node> Nodes;
     std::vector<GpuTriangle> Triangles;
 };
@@ -41,6 +41,11 @@ void TransitionImageLayout(VkImage image, VkFormat format,
 
 bool IsDepthFormat(VkFormat format);
 bool IsSRGBFormat(VkFormat format);
+        // Bytes per texel of uncompressed formats; 0 for block-compressed
+        // and unknown ones.
+uint32_t GetFormatTexelSize(VkFormat format);
+        // Bytes per 4x4 block of the BC formats; 0 for everything else.
+uint32_t GetCompressedBlockSize(VkFormat format);
 
 uint32_t AlignUp(uint32_t value, uint32_t alignment);
 
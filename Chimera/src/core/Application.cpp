@@ -70,6 +70,8 @@ Application::Application(const ApplicationSpecification& spec)
     m_ResourceManager.reset(&ResourceManager::Get());
 
     ShaderRegistry::RegisterAll();
+    ShaderManager::Init(m_Specification.ShaderDir,
+                        m_Specification.ShaderSourceDir);
     CH_CORE_INFO(
         "Application: Initialized with latest SVGF ShaderRegistry mappings.");
     m_PipelineManager = std::make_unique<PipelineManager>();
@@ -249,10 +251,14 @@ void Application::Run()
             {
                 uint32_t frameIndex = m_Renderer->GetCurrentFrameIndex();
                 m_ResourceManager->UpdateLoadingTasks();
+                ShaderManager::CheckForUpdates();
                 for (auto& layer : m_LayerStack)
                 {
                     layer->OnUpdate(deltaTime);
                 }
+                if (m_ResourceManager->HasActiveScene())
+                    m_ResourceManager->GetActiveScene()->UpdateTLAS(
+                        cmd, frameIndex);
                 UpdateGlobalUBO(frameIndex);
 
                 if (m_RenderPath)
@@ -372,7 +378,22 @@ void Application::UpdateGlobalUBO(uint32_t frameIndex)
             : -1;
     float lightCount =
         (float)m_ResourceManager->GetLightManager().GetLightCount();
-    ubo.envData = glm::vec4((float)skyboxIdx, lightCount, 0.0f, 0.0f);
+    ubo.envData = glm::vec4((float)skyboxIdx, lightCount, -1.0f, 0.0f);
+    std::shared_ptr<const ResourceManager::EnvironmentMap> environment =
+        skyboxIdx >= 0 ? m_ResourceManager->GetEnvironmentMap(skyboxIdx)
+                       : nullptr;
+    for (uint32_t i = 0; i < 9; ++i)
+    {
+        const float* rgb =
+            environment ? environment->irradiance.coefficients[i] : nullptr;
+        ubo.envIrradianceSH[i] =
+            rgb ? glm::vec4(rgb[0], rgb[1], rgb[2], 0.0f) : glm::vec4(0.0f);
+    }
+    if (environment)
+    {
+        ubo.envData.z = (float)environment->prefiltered.id;
+        ubo.envData.w = float(EnvironmentPrefilterLevels - 1);
+    }
 
     ubo.svgfAlpha =
         glm::vec4(0.01f, 0.1f, 0.0f,
@@ -382,10 +403,24 @@ void Application::UpdateGlobalUBO(uint32_t frameIndex)
         0.0f); // Tightened: PhiColor=4.0, PhiNormal=128.0, PhiDepth=0.02
     ubo.gpuClearColor = m_FrameContext.ClearColor;
 
+    // Clusters span the camera's depth range; the projection is reversed-Z,
+    // so P[2][2] = n / (f - n) and P[3][2] = n f / (f - n)
+    const float projZ = m_FrameContext.Projection[2][2];
+    const float projW = m_FrameContext.Projection[3][2];
+    ubo.clusterData = glm::vec4(0.0f, projW / (projZ + 1.0f),
+                                projZ > 0.0f ? projW / projZ : 1000.0f, 0.0f);
+
     if (m_ResourceManager->HasActiveScene())
     {
+        m_ResourceManager->UpdateTextureStreaming(
+            m_ResourceManager->GetActiveScene(), m_FrameContext.CamFrustum,
+            m_FrameContext.CameraPosition,
+            std::abs(m_FrameContext.Projection[1][1]),
+            m_FrameContext.ViewportSize.y, frameIndex);
         m_ResourceManager->SyncInstancesToGPU(
-            m_ResourceManager->GetActiveScene());
+            m_ResourceManager->GetActiveScene(), frameIndex);
+        ubo.clusterData.x = (float)m_ResourceManager->SyncPunctualLightsToGPU(
+            m_ResourceManager->GetActiveScene(), frameIndex);
         m_ResourceManager->UpdateSceneDescriptorSet(
             m_ResourceManager->GetActiveScene(), frameIndex);
     }
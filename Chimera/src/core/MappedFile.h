@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace Chimera
+{
+    // Read-only memory mapping of a whole file. The view stays valid for the
+    // lifetime of the object; moving transfers the mapping.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+        // Throws std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::span<const uint8_t> GetData() const
+    {
+        return {m_Data, m_Size};
+    }
+    bool IsOpen() const
+    {
+        return m_Data != nullptr;
+    }
+
+private:
+    void Close();
+
+private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+#ifdef _WIN32
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+};
+} // namespace Chimera
@@ -0,0 +1,105 @@
+// Build step run after all shaders are compiled: packs their SPIR-V and
+// reflection sidecars into the archive ShaderManager maps at startup.
+//
+// Usage: ChimeraShaderPack <shader_dir> <list_file> <output.pak>
+// The list file holds one shader per line, relative to shader_dir and
+// without ".spv", e.g. "postprocess/taa.comp".
+
+#include "Renderer/Backend/ShaderArchive.h"
+
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::vector<uint8_t> ReadBytes(const std::filesystem::path& path,
+                               bool required)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        if (required) throw std::runtime_error("cannot open " + path.string());
+        return {};
+    }
+    return {std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()};
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 4)
+    {
+        std::cerr << "usage: ChimeraShaderPack <shader_dir> <list_file> "
+                     "<output.pak>\n";
+        return 2;
+    }
+
+    try
+    {
+        const std::filesystem::path shaderDir = argv[1];
+        std::ifstream list(argv[2]);
+        if (!list.is_open())
+        {
+            throw std::runtime_error(std::string("cannot open ") + argv[2]);
+        }
+
+        std::vector<Chimera::ShaderArchiveInput> inputs;
+        for (std::string name; std::getline(list, name);)
+        {
+            if (!name.empty() && name.back() == '\r') name.pop_back();
+            if (name.empty()) continue;
+
+            const std::filesystem::path spirvPath = shaderDir / (name + ".spv");
+            const auto bytes = ReadBytes(spirvPath, true);
+            if (bytes.empty() || bytes.size() % sizeof(uint32_t) != 0)
+            {
+                throw std::runtime_error(spirvPath.string() +
+                                         " is not a SPIR-V binary");
+            }
+
+            Chimera::ShaderArchiveInput input;
+            input.name = name;
+            input.spirv.resize(bytes.size() / sizeof(uint32_t));
+            std::memcpy(input.spirv.data(), bytes.data(), bytes.size());
+            input.reflection =
+                ReadBytes(shaderDir / (name + ".spv.refl"), false);
+            inputs.push_back(std::move(input));
+        }
+
+        const size_t shaderCount = inputs.size();
+        const auto archive = Chimera::BuildShaderArchive(std::move(inputs));
+
+            // Write beside the target and rename so an interrupted build
+            // never leaves a truncated archive behind.
+        const std::filesystem::path output = argv[3];
+        std::filesystem::path temp = output;
+        temp += ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(archive.data()),
+                       static_cast<std::streamsize>(archive.size()));
+            if (!file)
+            {
+                throw std::runtime_error("cannot write " + temp.string());
+            }
+        }
+        std::filesystem::rename(temp, output);
+
+        std::cout << "ChimeraShaderPack: " << shaderCount << " shaders, "
+                  << archive.size() << " bytes -> " << output.string()
+                  << '\n';
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "ChimeraShaderPack: " << error.what() << '\n';
+        return 1;
+    }
+}
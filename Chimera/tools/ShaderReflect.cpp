@@ -0,0 +1,60 @@
+// Build step run after glslc: writes the reflection sidecar that Shader
+// loads instead of running spirv-reflect at startup.
+//
+// Usage: ChimeraShaderReflect <input.spv> <output.spv.refl>
+
+#include "Renderer/Backend/ShaderReflection.h"
+
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "usage: ChimeraShaderReflect <input.spv> <output.refl>\n";
+        return 2;
+    }
+
+    try
+    {
+        std::ifstream input(argv[1], std::ios::binary);
+        if (!input.is_open())
+        {
+            std::cerr << "ChimeraShaderReflect: cannot open " << argv[1]
+                      << '\n';
+            return 1;
+        }
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(input)),
+                                      std::istreambuf_iterator<char>());
+        std::vector<uint32_t> spirv(bytes.size() / sizeof(uint32_t));
+        std::copy(bytes.begin(),
+                  bytes.begin() + spirv.size() * sizeof(uint32_t),
+                  reinterpret_cast<char*>(spirv.data()));
+
+        const auto reflection = Chimera::ReflectSpirv(spirv);
+        const auto fileData =
+            Chimera::SerializeShaderReflection(reflection, spirv);
+
+        std::ofstream output(argv[2], std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(fileData.data()),
+                     static_cast<std::streamsize>(fileData.size()));
+        if (!output)
+        {
+            std::cerr << "ChimeraShaderReflect: cannot write " << argv[2]
+                      << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "ChimeraShaderReflect: " << argv[1] << ": "
+                  << error.what() << '\n';
+        return 1;
+    }
+}
@@ -6,6 +6,8 @@
 #include "Renderer/Backend/Renderer.h"
 #include "Utils/VulkanBarrier.h"
 #include "Renderer/Backend/VulkanContext.h"
+#include "Renderer/Backend/PipelineManager.h"
+#include "Renderer/Backend/ShaderManager.h"
 #include "Renderer/Benchmark/BenchmarkCsvWriter.h"
 #include "Renderer/Capture/ImageRegression.h"
 #include "Renderer/Graph/RenderGraph.h"
@@ -98,6 +100,33 @@ std::filesystem::path MakeFrameCapturePath()
            filename.str();
 }
 
+std::filesystem::path MakeRenderGraphProfilePath(const char* extension)
+{
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t timestamp = std::chrono::system_clock::to_time_t(now);
+    std::tm localTime{};
+    localtime_s(&localTime, &timestamp);
+
+    std::ostringstream filename;
+    filename << "render-graph-" << std::put_time(&localTime, "%Y%m%d-%H%M%S")
+             << extension;
+
+    return std::filesystem::current_path() / "profiling-results" /
+           filename.str();
+}
+
+bool WriteTextFile(const std::filesystem::path& path, const std::string& text)
+{
+    std::error_code directoryError;
+    std::filesystem::create_directories(path.parent_path(), directoryError);
+    if (directoryError) return false;
+
+    std::ofstream file(path, std::ios::out | std::ios::trunc);
+    file << text;
+    file.flush();
+    return file.good();
+}
+
 std::filesystem::path MakeRegressionBaselinePath()
 {
     return std::filesystem::current_path() / "frame-captures" /
@@ -741,6 +770,19 @@ void EditorLayer::DrawControlPanelContent(RenderPath* activePath)
             {
                 if (ImGui::BeginTabItem("Models"))
                 {
+                    bool mergeBLAS = Model::GetBLASGranularity() ==
+                                     BLASGranularity::PerModel;
+                    if (ImGui::Checkbox("Merge Meshes Into One BLAS",
+                                        &mergeBLAS))
+                    {
+                        Model::SetBLASGranularity(
+                            mergeBLAS ? BLASGranularity::PerModel
+                                      : BLASGranularity::PerMesh);
+                    }
+                    if (ImGui::IsItemHovered())
+                        ImGui::SetTooltip("Applies to models loaded after "
+                                          "the change");
+
                     ImGui::InputText("Search Models", m_AssetSearchFilter,
                                      IM_ARRAYSIZE(m_AssetSearchFilter));
                     std::string searchStr = m_AssetSearchFilter;
@@ -1408,7 +1450,47 @@ void EditorLayer::DrawControlPanelContent(RenderPath* activePath)
         if (ImGui::TreeNode("GPU Pass Breakdown"))
         {
             if (activePath)
+            {
                 activePath->GetRenderGraph().DrawPerformanceStatistics();
+
+                const auto& coldStart = activePath->GetColdStartStats();
+                ImGui::Text("Cold start: %.2f ms (%u pipelines, %.2f ms)",
+                            coldStart.firstFrameMS, coldStart.pipelineCount,
+                            coldStart.pipelineCreationMS);
+                ImGui::Text("Pipelines ready after: %.2f ms",
+                            coldStart.pipelinesReadyMS);
+
+                auto& pipelines = PipelineManager::Get();
+                bool asyncCompile = pipelines.IsAsyncCompilationEnabled();
+                if (ImGui::Checkbox("Background Pipeline Compilation",
+                                    &asyncCompile))
+                {
+                    pipelines.SetAsyncCompilation(asyncCompile);
+                }
+                if (pipelines.GetPendingCompileCount() > 0)
+                {
+                    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f),
+                                       "Compiling %u pipelines...",
+                                       pipelines.GetPendingCompileCount());
+                }
+
+                bool hotReload = ShaderManager::IsHotReloadEnabled();
+                if (ImGui::Checkbox("Shader Hot Reload", &hotReload))
+                {
+                    ShaderManager::SetHotReloadEnabled(hotReload);
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Recompile All"))
+                {
+                    ShaderManager::RecompileAll();
+                }
+                if (ShaderManager::GetPendingReloadCount() > 0)
+                {
+                    ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.2f, 1.0f),
+                                       "Recompiling %u shaders...",
+                                       ShaderManager::GetPendingReloadCount());
+                }
+            }
             ImGui::TreePop();
         }
 
@@ -1419,6 +1501,27 @@ void EditorLayer::DrawControlPanelContent(RenderPath* activePath)
             ImGui::SetClipboardText(
                 activePath->GetRenderGraph().ExportToMermaid().c_str());
         }
+
+        // 5. Export frame profile for offline trace viewers
+        static std::string profileStatus;
+        if (ImGui::Button("Export Frame Profile (JSON + Trace)", ImVec2(-1, 0)) &&
+            activePath)
+        {
+            const RenderGraph& graph = activePath->GetRenderGraph();
+            const auto jsonPath = MakeRenderGraphProfilePath(".json");
+            const auto tracePath = MakeRenderGraphProfilePath(".trace.json");
+
+            const bool success =
+                WriteTextFile(jsonPath, graph.ExportToJson()) &&
+                WriteTextFile(tracePath, graph.ExportToChromeTrace());
+            profileStatus = success ? "Saved to: " + tracePath.string()
+                                    : "Export failed: could not write " +
+                                          jsonPath.parent_path().string();
+        }
+        if (!profileStatus.empty())
+        {
+            ImGui::TextWrapped("%s", profileStatus.c_str());
+        }
     }
 
     if (activePath)
@@ -0,0 +1,155 @@
+#include "Renderer/Resources/AliasTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+    // Probability the table gives each index over all uniform numbers:
+    // entry i keeps itself for threshold / count and passes the rest to
+    // its alias.
+std::vector<double> ExactProbabilities(const Chimera::AliasTable& table)
+{
+    const size_t count = table.entries.size();
+    std::vector<double> probability(count, 0.0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& entry = table.entries[i];
+        const double keep = std::clamp((double)entry.threshold, 0.0, 1.0);
+        probability[i] += keep / count;
+        probability[entry.alias] += (1.0 - keep) / count;
+    }
+    return probability;
+}
+
+void TestExactProbabilities()
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> weight(0.0f, 100.0f);
+    std::vector<float> weights(1000);
+    double total = 0.0;
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        // Every tenth entry is empty and a few dominate
+        weights[i] = i % 10 == 0 ? 0.0f : weight(rng);
+        if (i % 97 == 1) weights[i] *= 1000.0f;
+        total += weights[i];
+    }
+    const Chimera::AliasTable table =
+        Chimera::BuildAliasTable(weights.data(), (uint32_t)weights.size());
+    Require(table.IsValid() && table.entries.size() == weights.size(),
+            "a table has one entry per weight");
+    const std::vector<double> probability = ExactProbabilities(table);
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        const double expected = weights[i] / total;
+        Require(std::abs(probability[i] - expected) < 1e-6,
+                "each index must be drawn in proportion to its weight");
+        Require(std::abs(table.Pmf((uint32_t)i) - expected) < 1e-6,
+                "the stored pmf must match the weight");
+    }
+}
+
+void TestSampleFrequencies()
+{
+    const std::vector<float> weights = {1.0f, 2.0f, 3.0f, 4.0f, 0.0f, 10.0f};
+    const Chimera::AliasTable table =
+        Chimera::BuildAliasTable(weights.data(), (uint32_t)weights.size());
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    const uint32_t samples = 1000000;
+    std::vector<uint32_t> histogram(weights.size(), 0);
+    for (uint32_t s = 0; s < samples; ++s)
+        ++histogram[table.Sample(uniform(rng))];
+
+    Require(histogram[4] == 0, "an empty entry must never be drawn");
+    // Pearson's chi-squared over the five live entries; 4 degrees of
+    // freedom exceed 23.5 with probability 1e-4
+    double chiSquared = 0.0;
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        if (weights[i] == 0.0f) continue;
+        const double expected = samples * weights[i] / 20.0;
+        const double difference = histogram[i] - expected;
+        chiSquared += difference * difference / expected;
+    }
+    Require(chiSquared < 23.5, "sample frequencies must follow the weights");
+}
+
+void TestEdgeCases()
+{
+    const float nan = std::nanf("");
+    const std::vector<float> weights = {-1.0f, nan, 0.0f, 5.0f};
+    const Chimera::AliasTable table =
+        Chimera::BuildAliasTable(weights.data(), (uint32_t)weights.size());
+    for (float u : {0.0f, 0.1f, 0.3f, 0.5f, 0.74f, 0.99f, 0.9999999f})
+        Require(table.Sample(u) == 3,
+                "negative, NaN and empty entries must never be drawn");
+    Require(table.Pmf(3) == 1.0f, "the only live entry must have pmf one");
+
+    const std::vector<float> empty = {0.0f, -2.0f};
+    Require(!Chimera::BuildAliasTable(empty.data(), 2).IsValid(),
+            "a table without weight must be empty");
+    Require(!Chimera::BuildAliasTable(nullptr, 0).IsValid(),
+            "a table without entries must be empty");
+
+    const float one = 3.0f;
+    const Chimera::AliasTable single = Chimera::BuildAliasTable(&one, 1);
+    Require(single.Sample(0.0f) == 0 && single.Sample(0.999f) == 0,
+            "a single entry is always drawn");
+}
+
+void TestPackedLayout()
+{
+    const std::vector<float> weights = {1.0f, 3.0f};
+    const Chimera::AliasTable table =
+        Chimera::BuildAliasTable(weights.data(), 2);
+    std::vector<float> packed = {-1.0f};
+    table.AppendTo(packed);
+    Require(packed.size() == 1 + table.GetPackedSize() &&
+                table.GetPackedSize() == 2 * Chimera::AliasEntryFloats,
+            "each entry packs into AliasEntryFloats floats after the rest");
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        const float* entry =
+            packed.data() + 1 + i * Chimera::AliasEntryFloats;
+        Require(entry[0] == table.entries[i].threshold &&
+                    std::bit_cast<uint32_t>(entry[1]) ==
+                        table.entries[i].alias &&
+                    entry[2] == table.entries[i].pmf,
+                "entries pack as threshold, alias bits and pmf");
+    }
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestExactProbabilities();
+        std::cout << "[PASS] exact probabilities\n";
+        TestSampleFrequencies();
+        std::cout << "[PASS] sample frequencies\n";
+        TestEdgeCases();
+        std::cout << "[PASS] edge cases\n";
+        TestPackedLayout();
+        std::cout << "[PASS] packed layout\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
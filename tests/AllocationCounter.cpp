@@ -0,0 +1,32 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<size_t> g_AllocationCount{0};
+}
+
+size_t AllocationCount()
+{
+    return g_AllocationCount.load();
+}
+
+void* operator new(size_t size)
+{
+    ++g_AllocationCount;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
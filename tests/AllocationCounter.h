@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+    // Number of global operator new calls so far. AllocationCounter.cpp
+    // replaces the global allocation functions; it is its own translation
+    // unit so the compiler never sees malloc and free behind new and delete
+    // and pairs them up as mismatched.
+size_t AllocationCount();
@@ -0,0 +1,280 @@
+#include "Renderer/Resources/BLASBatch.h"
+
+#include <array>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Chimera;
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+void TestPackAligned()
+{
+    const AlignedLayout empty = PackAligned({}, 256);
+    Require(empty.offsets.empty() && empty.size == 0,
+            "nothing packs into nothing");
+
+    const AlignedLayout layout = PackAligned({100, 256, 1, 300}, 256);
+    Require(layout.offsets == std::vector<uint64_t>({0, 256, 512, 768}),
+            "regions start on the alignment");
+    Require(layout.size == 768 + 300, "the buffer ends at the last region");
+
+    // Regions never overlap and stay aligned, whatever their sizes
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<uint64_t> size(1, 5000);
+    std::vector<uint64_t> sizes(200);
+    for (uint64_t& s : sizes) s = size(rng);
+    const AlignedLayout random = PackAligned(sizes, 128);
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        Require(random.offsets[i] % 128 == 0, "offsets are aligned");
+        const uint64_t end = random.offsets[i] + sizes[i];
+        Require(end <= random.size, "regions fit the buffer");
+        if (i + 1 < sizes.size())
+            Require(end <= random.offsets[i + 1], "regions do not overlap");
+    }
+}
+
+void TestPlanScratch()
+{
+    const ScratchPlan empty = PlanScratch({}, 128, 1000);
+    Require(empty.batches.empty() && empty.arenaSize == 0,
+            "no builds need no scratch");
+
+    // Everything fits: one build call, regions side by side
+    const ScratchPlan one = PlanScratch({100, 200, 50}, 128, 1000);
+    Require(one.batches.size() == 1 && one.batches[0].first == 0 &&
+                one.batches[0].count == 3,
+            "builds within the budget share one call");
+    Require(one.offsets == std::vector<uint64_t>({0, 128, 384}),
+            "concurrent builds get disjoint aligned scratch");
+    Require(one.arenaSize == 434, "the arena holds the whole run");
+
+    // Over the budget: runs restart at the arena's start
+    const ScratchPlan split = PlanScratch({600, 300, 200, 700, 50}, 128, 1000);
+    Require(split.batches.size() == 3, "runs split at the budget");
+    Require(split.batches[0].first == 0 && split.batches[0].count == 2 &&
+                split.batches[1].first == 2 && split.batches[1].count == 2 &&
+                split.batches[2].first == 4 && split.batches[2].count == 1,
+            "runs keep build order");
+    Require(split.offsets == std::vector<uint64_t>({0, 640, 0, 256, 0}),
+            "each run's scratch starts over");
+    Require(split.arenaSize == 956, "the arena holds the largest run");
+
+    // A build over the budget on its own still gets a run
+    const ScratchPlan large = PlanScratch({50, 5000, 50}, 128, 1000);
+    Require(large.batches.size() == 3 && large.batches[1].count == 1 &&
+                large.arenaSize == 5000,
+            "oversized builds run alone");
+
+    // Random sizes: every run fits its arena and builds are covered once
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint64_t> size(1, 700);
+    std::vector<uint64_t> sizes(300);
+    for (uint64_t& s : sizes) s = size(rng);
+    const ScratchPlan plan = PlanScratch(sizes, 256, 2048);
+    uint32_t next = 0;
+    for (const ScratchPlan::Batch& batch : plan.batches)
+    {
+        Require(batch.first == next && batch.count > 0,
+                "runs cover the builds in order");
+        for (uint32_t i = batch.first; i < batch.first + batch.count; ++i)
+        {
+            Require(plan.offsets[i] % 256 == 0, "scratch is aligned");
+            Require(plan.offsets[i] + sizes[i] <= plan.arenaSize,
+                    "scratch fits the arena");
+            Require(plan.offsets[i] + sizes[i] <= 2048,
+                    "runs stay within the budget");
+            if (i > batch.first)
+                Require(plan.offsets[i - 1] + sizes[i - 1] <= plan.offsets[i],
+                        "builds of a run do not share scratch");
+        }
+        next += batch.count;
+    }
+    Require(next == sizes.size(), "every build is planned");
+}
+
+    // Node of an imported scene: a local transform, the triangle counts of
+    // its meshes and its children. Flatten walks it as AssetImporter does,
+    // giving each mesh its node's model space transform.
+struct ImportedNode
+{
+    std::array<float, 16> local = Identity();
+    std::vector<uint32_t> meshTriangles;
+    std::vector<ImportedNode> children;
+
+    static std::array<float, 16> Identity()
+    {
+        return {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    }
+};
+
+std::array<float, 16> Translation(float x, float y, float z)
+{
+    std::array<float, 16> m = ImportedNode::Identity();
+    m[12] = x;
+    m[13] = y;
+    m[14] = z;
+    return m;
+}
+
+std::array<float, 16> Multiply(const std::array<float, 16>& a,
+                               const std::array<float, 16>& b)
+{
+    std::array<float, 16> m{};
+    for (int column = 0; column < 4; ++column)
+        for (int row = 0; row < 4; ++row)
+            for (int k = 0; k < 4; ++k)
+                m[column * 4 + row] += a[k * 4 + row] * b[column * 4 + k];
+    return m;
+}
+
+void Flatten(const ImportedNode& node, const std::array<float, 16>& parent,
+             std::vector<BLASMeshInfo>& meshes)
+{
+    const std::array<float, 16> world = Multiply(parent, node.local);
+    for (uint32_t triangles : node.meshTriangles)
+        meshes.push_back({triangles, world});
+    for (const ImportedNode& child : node.children)
+        Flatten(child, world, meshes);
+}
+
+std::vector<BLASMeshInfo> Flatten(const ImportedNode& root)
+{
+    std::vector<BLASMeshInfo> meshes;
+    Flatten(root, ImportedNode::Identity(), meshes);
+    return meshes;
+}
+
+    // Groups cover every mesh with triangles once, in order, and merge
+    // only meshes sharing a transform.
+void RequireValidGroups(const std::vector<BLASMeshInfo>& meshes,
+                        const std::vector<BLASGroup>& groups)
+{
+    std::vector<uint32_t> covered(meshes.size(), 0);
+    uint32_t end = 0;
+    for (const BLASGroup& group : groups)
+    {
+        Require(group.meshCount > 0 && group.firstMesh >= end,
+                "groups are non-empty and in mesh order");
+        for (uint32_t m = group.firstMesh;
+             m < group.firstMesh + group.meshCount; ++m)
+        {
+            Require(meshes[m].triangleCount > 0,
+                    "meshes without triangles get no geometry");
+            Require(meshes[m].transform ==
+                        meshes[group.firstMesh].transform,
+                    "a group shares one transform");
+            covered[m]++;
+        }
+        end = group.firstMesh + group.meshCount;
+    }
+    for (uint32_t m = 0; m < (uint32_t)meshes.size(); ++m)
+        Require(covered[m] == (meshes[m].triangleCount > 0 ? 1u : 0u),
+                "every mesh with triangles is in one group");
+}
+
+void TestGroupMeshes()
+{
+    // Sponza-style: every primitive under one node
+    ImportedNode sponza;
+    sponza.meshTriangles.assign(103, 500);
+    const std::vector<BLASMeshInfo> flat = Flatten(sponza);
+    const std::vector<BLASGroup> merged =
+        GroupMeshesForBLAS(flat, BLASGranularity::PerModel);
+    RequireValidGroups(flat, merged);
+    Require(merged.size() == 1 && merged[0].meshCount == 103,
+            "meshes under one node merge into one structure");
+    const std::vector<BLASGroup> perMesh =
+        GroupMeshesForBLAS(flat, BLASGranularity::PerMesh);
+    RequireValidGroups(flat, perMesh);
+    Require(perMesh.size() == 103, "per mesh granularity keeps one each");
+
+    // A hierarchy: identity children merge with the root's meshes, moved
+    // nodes start their own structure
+    ImportedNode root;
+    root.meshTriangles = {10, 20};
+    ImportedNode still;
+    still.meshTriangles = {30};
+    ImportedNode moved;
+    moved.local = Translation(5.0f, 0.0f, 0.0f);
+    moved.meshTriangles = {40, 50, 60};
+    ImportedNode nested;
+    nested.meshTriangles = {70};
+    moved.children.push_back(nested);
+    ImportedNode other;
+    other.local = Translation(0.0f, 2.0f, 0.0f);
+    other.meshTriangles = {80};
+    root.children = {still, moved, other};
+    const std::vector<BLASMeshInfo> tree = Flatten(root);
+    const std::vector<BLASGroup> treeGroups =
+        GroupMeshesForBLAS(tree, BLASGranularity::PerModel);
+    RequireValidGroups(tree, treeGroups);
+    Require(treeGroups.size() == 3 && treeGroups[0].meshCount == 3 &&
+                treeGroups[1].firstMesh == 3 &&
+                treeGroups[1].meshCount == 4 &&
+                treeGroups[2].firstMesh == 7,
+            "nodes sharing a transform merge, moved nodes split");
+
+    // Meshes without triangles are skipped and end a group
+    std::vector<BLASMeshInfo> gaps = Flatten(sponza);
+    gaps.resize(6);
+    gaps[0].triangleCount = 0;
+    gaps[3].triangleCount = 0;
+    const std::vector<BLASGroup> gapGroups =
+        GroupMeshesForBLAS(gaps, BLASGranularity::PerModel);
+    RequireValidGroups(gaps, gapGroups);
+    Require(gapGroups.size() == 2 && gapGroups[0].firstMesh == 1 &&
+                gapGroups[0].meshCount == 2 && gapGroups[1].firstMesh == 4,
+            "empty meshes split groups");
+
+    // Random hierarchies keep the invariants under both policies
+    std::mt19937 rng(23);
+    for (int scene = 0; scene < 50; ++scene)
+    {
+        ImportedNode random;
+        random.meshTriangles.assign(rng() % 4, 0);
+        for (uint32_t& triangles : random.meshTriangles)
+            triangles = rng() % 3 == 0 ? 0 : 1 + rng() % 100;
+        for (uint32_t c = rng() % 6; c > 0; --c)
+        {
+            ImportedNode child;
+            if (rng() % 2) child.local = Translation(float(rng() % 3), 0, 0);
+            child.meshTriangles.assign(1 + rng() % 5, 1 + rng() % 100);
+            random.children.push_back(child);
+        }
+        const std::vector<BLASMeshInfo> meshes = Flatten(random);
+        RequireValidGroups(
+            meshes, GroupMeshesForBLAS(meshes, BLASGranularity::PerModel));
+        RequireValidGroups(
+            meshes, GroupMeshesForBLAS(meshes, BLASGranularity::PerMesh));
+    }
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestPackAligned();
+        std::cout << "[PASS] aligned packing\n";
+        TestPlanScratch();
+        std::cout << "[PASS] scratch runs\n";
+        TestGroupMeshes();
+        std::cout << "[PASS] mesh grouping\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,73 @@
+#include "Renderer/Resources/BindlessCapacity.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+Chimera::BindlessLimits Uniform(uint32_t value)
+{
+    return {value, value, value, value, value, value};
+}
+
+void TestSmallestLimitWins()
+{
+    Chimera::BindlessLimits limits = Uniform(1u << 20);
+    limits.maxSetSampledImages = 5000;
+    Require(Chimera::ChooseBindlessTextureCapacity(limits, 1, 100, 1u << 16) ==
+                4900,
+            "the tightest limit minus the reservation must be used");
+
+    limits = Uniform(1u << 20);
+    limits.maxPerStageResources = 3000;
+    Require(Chimera::ChooseBindlessTextureCapacity(limits, 1, 0, 1u << 16) ==
+                3000,
+            "the per-stage resource limit must be honoured");
+}
+
+void TestPoolLimitIsSharedBetweenSets()
+{
+    Chimera::BindlessLimits limits = Uniform(1u << 20);
+    limits.maxDescriptorsInAllPools = 30000;
+    Require(Chimera::ChooseBindlessTextureCapacity(limits, 3, 0, 1u << 16) ==
+                10000,
+            "every set must fit in the pool limit");
+}
+
+void TestCeilingAndFloor()
+{
+    Require(Chimera::ChooseBindlessTextureCapacity(Uniform(1u << 20), 3, 256,
+                                                   1u << 16) == 1u << 16,
+            "huge limits must be capped by the ceiling");
+    Require(Chimera::ChooseBindlessTextureCapacity(Uniform(200), 1, 256,
+                                                   1u << 16) == 100,
+            "limits below the reservation must be split");
+    Require(Chimera::ChooseBindlessTextureCapacity(Uniform(0), 0, 256, 0) == 1,
+            "the capacity must never be zero");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestSmallestLimitWins();
+        std::cout << "[PASS] smallest limit wins\n";
+        TestPoolLimitIsSharedBetweenSets();
+        std::cout << "[PASS] pool limit is shared between sets\n";
+        TestCeilingAndFloor();
+        std::cout << "[PASS] ceiling and floor\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
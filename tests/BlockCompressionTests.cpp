@@ -0,0 +1,318 @@
+#include "Renderer/Resources/BlockCompression.h"
+#include "Renderer/Resources/MipChain.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+    // Smooth gradients with some higher-frequency detail, like a typical
+    // albedo texture.
+std::vector<uint8_t> MakeTestImage(uint32_t width, uint32_t height)
+{
+    std::vector<uint8_t> pixels((size_t)width * height * 4);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            uint8_t* texel = pixels.data() + ((size_t)y * width + x) * 4;
+            const float u = float(x) / width;
+            const float v = float(y) / height;
+            const float detail = 0.5f + 0.5f * std::sin(x * 0.7f) *
+                                            std::cos(y * 0.45f);
+            texel[0] = uint8_t(255.0f * u);
+            texel[1] = uint8_t(255.0f * (0.3f + 0.6f * v * detail));
+            texel[2] = uint8_t(255.0f * (1.0f - u) * v);
+            texel[3] = uint8_t(128.0f + 127.0f * detail);
+        }
+    }
+    return pixels;
+}
+
+double Psnr(double meanSquaredError)
+{
+    if (meanSquaredError <= 0.0) return 99.0;
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+    // PSNR of the channels in [0, channels) after an encode/decode round trip.
+template <typename Encode, typename Decode>
+double RoundTripPsnr(const std::vector<uint8_t>& pixels, uint32_t width,
+                     uint32_t height, int channels, Encode encode,
+                     Decode decode)
+{
+    double error = 0.0;
+    uint64_t samples = 0;
+    for (uint32_t by = 0; by < height; by += 4)
+    {
+        for (uint32_t bx = 0; bx < width; bx += 4)
+        {
+            uint8_t block[64], encoded[16], decoded[64];
+            for (uint32_t y = 0; y < 4; ++y)
+                std::memcpy(block + y * 16,
+                            pixels.data() +
+                                ((size_t)(by + y) * width + bx) * 4,
+                            16);
+            encode(block, encoded);
+            decode(encoded, decoded);
+            for (int i = 0; i < 16; ++i)
+            {
+                for (int c = 0; c < channels; ++c)
+                {
+                    const double d = double(block[i * 4 + c]) -
+                                     double(decoded[i * 4 + c]);
+                    error += d * d;
+                    ++samples;
+                }
+            }
+        }
+    }
+    return Psnr(error / double(samples));
+}
+
+void TestSolidBlocksRoundTrip()
+{
+    uint8_t block[64], encoded[16], decoded[64];
+    for (int value : {0, 1, 77, 128, 200, 254, 255})
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            block[i * 4 + 0] = uint8_t(value);
+            block[i * 4 + 1] = uint8_t(255 - value);
+            block[i * 4 + 2] = uint8_t(value / 2);
+            block[i * 4 + 3] = uint8_t(255 - value / 3);
+        }
+
+            // Mode 6 shares one p-bit across an endpoint's channels, so
+            // channels of mixed parity can be off by one.
+        Chimera::EncodeBC7Block(block, encoded);
+        Chimera::DecodeBC7Block(encoded, decoded);
+        for (int i = 0; i < 64; ++i)
+        {
+            Require(std::abs(int(block[i]) - int(decoded[i])) <= 1,
+                    "a solid BC7 block must round-trip within one step");
+        }
+        for (int i = 0; i < 16; ++i)
+            block[i * 4 + 1] = block[i * 4 + 2] = block[i * 4 + 3] =
+                block[i * 4];
+        Chimera::EncodeBC7Block(block, encoded);
+        Chimera::DecodeBC7Block(encoded, decoded);
+        Require(std::memcmp(block, decoded, 64) == 0,
+                "a solid grey BC7 block must round-trip exactly");
+
+        Chimera::EncodeBC4Block(block, encoded);
+        Chimera::DecodeBC4Block(encoded, decoded);
+        Require(decoded[0] == value && decoded[1] == value &&
+                    decoded[3] == 255,
+                "a solid BC4 block must round-trip exactly with RRR1");
+
+        for (int i = 0; i < 16; ++i) block[i * 4 + 1] = uint8_t(255 - value);
+        Chimera::EncodeBC5Block(block, encoded);
+        Chimera::DecodeBC5Block(encoded, decoded);
+        Require(decoded[0] == value && decoded[1] == 255 - value,
+                "a solid BC5 block must round-trip exactly");
+    }
+}
+
+void TestGradientQuality()
+{
+    const uint32_t size = 128;
+    const std::vector<uint8_t> pixels = MakeTestImage(size, size);
+
+    const double bc7 = RoundTripPsnr(pixels, size, size, 4,
+                                     Chimera::EncodeBC7Block,
+                                     Chimera::DecodeBC7Block);
+    const double bc5 = RoundTripPsnr(pixels, size, size, 2,
+                                     Chimera::EncodeBC5Block,
+                                     Chimera::DecodeBC5Block);
+    const double bc4 = RoundTripPsnr(pixels, size, size, 1,
+                                     Chimera::EncodeBC4Block,
+                                     Chimera::DecodeBC4Block);
+    std::cout << "  BC7 " << bc7 << " dB, BC5 " << bc5 << " dB, BC4 " << bc4
+              << " dB\n";
+    Require(bc7 > 38.0, "BC7 quality regressed");
+    Require(bc5 > 38.0, "BC5 quality regressed");
+    Require(bc4 > 40.0, "BC4 quality regressed");
+}
+
+void TestAnchorIndexIsValid()
+{
+        // A block whose first texel is at the far endpoint forces the
+        // encoder to swap endpoints.
+    uint8_t block[64], encoded[16], decoded[64];
+    for (int i = 0; i < 16; ++i)
+    {
+        const uint8_t v = uint8_t(255 - i * 17);
+        block[i * 4 + 0] = block[i * 4 + 1] = block[i * 4 + 2] = v;
+        block[i * 4 + 3] = 255;
+    }
+    Chimera::EncodeBC7Block(block, encoded);
+    Chimera::DecodeBC7Block(encoded, decoded);
+    for (int i = 0; i < 16; ++i)
+    {
+        Require(std::abs(int(decoded[i * 4]) - int(block[i * 4])) <= 4,
+                "a descending ramp must survive the anchor swap");
+    }
+}
+
+void TestBC6HRoundTrip()
+{
+    float block[64], decoded[64];
+    uint8_t encoded[16];
+    for (int i = 0; i < 16; ++i)
+    {
+            // Spans two orders of magnitude, as sky texels around the sun do.
+        const float v = 0.05f * std::pow(1.35f, float(i));
+        block[i * 4 + 0] = v;
+        block[i * 4 + 1] = v * 0.8f;
+        block[i * 4 + 2] = v * 0.6f;
+        block[i * 4 + 3] = 1.0f;
+    }
+    Chimera::EncodeBC6HBlock(block, encoded);
+    Chimera::DecodeBC6HBlock(encoded, decoded);
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            const float expected = block[i * 4 + c];
+            const float relative =
+                std::abs(decoded[i * 4 + c] - expected) / expected;
+            Require(relative < 0.25f, "BC6H error must stay within 25%");
+        }
+    }
+
+    for (int i = 0; i < 64; ++i) block[i] = (i % 4 == 3) ? 1.0f : 3.0f;
+    block[0] = -1.0f;
+    block[5] = NAN;
+    Chimera::EncodeBC6HBlock(block, encoded);
+    Chimera::DecodeBC6HBlock(encoded, decoded);
+    Require(decoded[0] >= 0.0f && std::isfinite(decoded[5]),
+            "negative and NaN inputs must decode to finite values");
+    Require(std::abs(decoded[4 * 4] - 3.0f) < 0.1f,
+            "flat BC6H texels must stay close to their value");
+
+    // Partial edge blocks must land in the right texels
+    const uint32_t width = 6, height = 5;
+    std::vector<float> level((size_t)width * height * 4, 1.0f);
+    for (uint32_t i = 0; i < width * height; ++i)
+        level[i * 4] = 0.5f + float(i % width);
+    const std::vector<uint8_t> blocks =
+        Chimera::CompressMipChainRGBA32F(level.data(), width, height, 1);
+    const std::vector<float> restored =
+        Chimera::DecompressLevelBC6H(blocks.data(), width, height);
+    Require(restored.size() == level.size(), "a level decodes to its size");
+    for (size_t i = 0; i < level.size(); i += 4)
+    {
+        Require(std::abs(restored[i] - level[i]) / level[i] < 0.25f,
+                "decoded levels must keep each texel in place");
+    }
+
+    const float halfInputs[5] = {1.0f, 0.5f, -2.0f, NAN, 1e6f};
+    const std::vector<uint16_t> halves =
+        Chimera::ConvertToHalfUnsigned(halfInputs, 5);
+    Require(halves == std::vector<uint16_t>{0x3C00, 0x3800, 0, 0, 0x7BFF},
+            "half conversion must clamp to the unsigned BC6H range");
+}
+
+void TestChainLayoutAndFormatChoice()
+{
+    const uint32_t width = 37, height = 9;
+    Require(Chimera::GetCompressedLevelSize(Chimera::BlockFormat::BC7, width,
+                                            height) == 10 * 3 * 16,
+            "partial blocks must round up");
+    Require(Chimera::GetCompressedLevelSize(Chimera::BlockFormat::BC4, 1,
+                                            1) == 8,
+            "a 1x1 level still needs one block");
+
+    const std::vector<uint8_t> pixels = MakeTestImage(width, height);
+    const uint32_t levels = Chimera::GetMipLevelCount(width, height);
+    const std::vector<uint8_t> chain = Chimera::BuildMipChainRGBA8(
+        pixels.data(), width, height, Chimera::MipFilter::Linear);
+    const std::vector<uint8_t> blocks = Chimera::CompressMipChainRGBA8(
+        Chimera::BlockFormat::BC5, chain.data(), width, height, levels);
+    Require(blocks.size() == Chimera::GetCompressedChainSize(
+                                 Chimera::BlockFormat::BC5, width, height,
+                                 levels),
+            "compressed chains must be tightly packed");
+
+    bool threw = false;
+    try
+    {
+        Chimera::CompressMipChainRGBA8(Chimera::BlockFormat::BC6H,
+                                       chain.data(), width, height, levels);
+    }
+    catch (const std::invalid_argument&)
+    {
+        threw = true;
+    }
+    Require(threw, "BC6H must reject 8-bit input");
+
+    std::vector<uint8_t> grey(16 * 4, 90);
+    for (int i = 0; i < 16; ++i) grey[i * 4 + 3] = 255;
+    Require(Chimera::ChooseBlockFormat(grey.data(), 16, false, false) ==
+                Chimera::BlockFormat::BC4,
+            "opaque greyscale linear textures must use BC4");
+    Require(Chimera::ChooseBlockFormat(grey.data(), 16, true, false) ==
+                Chimera::BlockFormat::BC7,
+            "sRGB textures must use BC7");
+    Require(Chimera::ChooseBlockFormat(grey.data(), 16, false, true) ==
+                Chimera::BlockFormat::BC5,
+            "normal maps must use BC5");
+    grey[6] = 91;
+    Require(Chimera::ChooseBlockFormat(grey.data(), 16, false, false) ==
+                Chimera::BlockFormat::BC7,
+            "coloured linear textures must use BC7");
+}
+
+void TestThroughput()
+{
+    const uint32_t size = 512;
+    const std::vector<uint8_t> pixels = MakeTestImage(size, size);
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<uint8_t> blocks = Chimera::CompressMipChainRGBA8(
+        Chimera::BlockFormat::BC7, pixels.data(), size, size, 1);
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    const double megapixels = double(size) * size / 1.0e6;
+    std::cout << "  BC7 " << megapixels / seconds << " Mpixel/s\n";
+    Require(blocks.size() == (size_t)size * size, "BC7 is one byte per texel");
+        // Loose bound: unoptimised builds on slow CI machines must pass.
+    Require(seconds < 5.0, "BC7 encoding is far too slow");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestSolidBlocksRoundTrip();
+        std::cout << "[PASS] solid blocks round-trip\n";
+        TestGradientQuality();
+        std::cout << "[PASS] gradient quality\n";
+        TestAnchorIndexIsValid();
+        std::cout << "[PASS] anchor index is valid\n";
+        TestBC6HRoundTrip();
+        std::cout << "[PASS] BC6H round trip\n";
+        TestChainLayoutAndFormatChoice();
+        std::cout << "[PASS] chain layout and format choice\n";
+        TestThroughput();
+        std::cout << "[PASS] throughput\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
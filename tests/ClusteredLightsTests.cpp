@@ -0,0 +1,227 @@
+#include "Renderer/Resources/ClusteredLights.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Chimera;
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+bool Near(float a, float b, float tolerance)
+{
+    return std::abs(a - b) <= tolerance * std::max(1.0f, std::abs(b));
+}
+
+    // 60 degree vertical field of view at 16:9, as the editor camera opens.
+ClusterGrid MakeGrid()
+{
+    ClusterGrid grid;
+    grid.scaleY = 1.0f / std::tan(0.5f * 1.0471976f);
+    grid.scaleX = grid.scaleY * 9.0f / 16.0f;
+    return grid;
+}
+
+std::vector<ClusterLight> RandomLights(const ClusterGrid& grid,
+                                       uint32_t count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<ClusterLight> lights(count);
+    for (ClusterLight& light : lights)
+    {
+        // Spread through the frustum and a little around it, out to 200
+        const float depth = -5.0f + 205.0f * unit(rng);
+        const float spread = std::max(depth, 1.0f) * 1.2f;
+        light.position[0] =
+            (2.0f * unit(rng) - 1.0f) * spread / grid.scaleX;
+        light.position[1] =
+            (2.0f * unit(rng) - 1.0f) * spread / grid.scaleY;
+        light.position[2] = depth;
+        light.radius = PunctualLightRange(0.05f + 2.0f * unit(rng)) * 0.5f;
+    }
+    return lights;
+}
+
+void TestSlices()
+{
+    const ClusterGrid grid = MakeGrid();
+    Require(grid.Slice(0.0f) == 0 && grid.Slice(grid.nearPlane) == 0,
+            "depths up to the near plane fall in the first slice");
+    Require(grid.Slice(grid.farPlane * 2.0f) == grid.z - 1,
+            "depths past the far plane clamp to the last slice");
+    Require(Near(grid.SliceDepth(0), grid.nearPlane, 1e-5f) &&
+                Near(grid.SliceDepth(grid.z), grid.farPlane, 1e-4f),
+            "slices span the near to the far plane");
+    for (uint32_t k = 0; k < grid.z; ++k)
+    {
+        const float start = grid.SliceDepth(k);
+        const float end = grid.SliceDepth(k + 1);
+        Require(end / start > 1.0f &&
+                    Near(end / start, grid.SliceDepth(1) / grid.nearPlane,
+                         1e-3f),
+                "slices grow exponentially");
+        Require(grid.Slice(std::sqrt(start * end)) == k,
+                "a depth inside slice k maps back to it");
+    }
+}
+
+void TestBounds()
+{
+    const ClusterGrid grid = MakeGrid();
+    float min[3], max[3];
+    grid.Bounds(0, 0, 3, min, max);
+    Require(Near(min[2], grid.SliceDepth(3), 1e-5f) &&
+                Near(max[2], grid.SliceDepth(4), 1e-5f),
+            "a froxel spans its slice's depths");
+    // The top left tile reaches the left and top frustum planes at the
+    // slice's far depth
+    Require(Near(min[0], -max[2] / grid.scaleX, 1e-5f) &&
+                Near(max[1], max[2] / grid.scaleY, 1e-5f),
+            "the top left froxel touches the left and top planes");
+
+    // A point projected to the centre of a froxel lands inside it; boxes
+    // around neighbouring froxels overlap it, but no others
+    const uint32_t i = 5, j = 2, k = 10;
+    const float depth = std::sqrt(grid.SliceDepth(k) * grid.SliceDepth(k + 1));
+    const float ndcX = 2.0f * (float(i) + 0.5f) / float(grid.x) - 1.0f;
+    const float row = (float(j) + 0.5f) / float(grid.y);
+    ClusterLight light;
+    light.position[0] = ndcX * depth / grid.scaleX;
+    light.position[1] = (1.0f - 2.0f * row) * depth / grid.scaleY;
+    light.position[2] = depth;
+    light.radius = 1e-3f;
+
+    grid.Bounds(i, j, k, min, max);
+    for (int axis = 0; axis < 3; ++axis)
+        Require(light.position[axis] >= min[axis] &&
+                    light.position[axis] <= max[axis],
+                "the projected point lies in its froxel's box");
+    const ClusterLightLists lists = AssignLights(grid, {light});
+    Require(lists.counts[grid.Index(i, j, k)] == 1,
+            "a small light is listed in its froxel");
+    for (uint32_t c = 0; c < grid.Count(); ++c)
+    {
+        const uint32_t ci = c % grid.x, cj = c / grid.x % grid.y;
+        const uint32_t ck = c / (grid.x * grid.y);
+        const bool adjacent = (ci + 1 >= i && ci <= i + 1) &&
+                              (cj + 1 >= j && cj <= j + 1) &&
+                              (ck + 1 >= k && ck <= k + 1);
+        Require(adjacent || lists.counts[c] == 0,
+                "a small light is listed only around its froxel");
+    }
+}
+
+void TestMatchesBruteForce()
+{
+    const ClusterGrid grid = MakeGrid();
+    for (uint32_t count : {1u, 16u, 256u})
+    {
+        const std::vector<ClusterLight> lights =
+            RandomLights(grid, count, 17 + count);
+        const ClusterLightLists fast = AssignLights(grid, lights);
+        const ClusterLightLists reference =
+            AssignLightsBruteForce(grid, lights);
+        Require(fast == reference,
+                "bounded assignment matches testing every cluster for " +
+                    std::to_string(count) + " lights");
+    }
+
+    // Lights behind the camera, past the far plane or without reach are
+    // in no cluster
+    std::vector<ClusterLight> outside(3);
+    outside[0].position[2] = -10.0f;
+    outside[0].radius = 5.0f;
+    outside[1].position[2] = grid.farPlane + 10.0f;
+    outside[1].radius = 5.0f;
+    outside[2].position[2] = 10.0f;
+    const ClusterLightLists none = AssignLights(grid, outside);
+    for (uint32_t count : none.counts)
+        Require(count == 0, "lights outside the view are culled");
+    Require(none == AssignLightsBruteForce(grid, outside),
+            "culled lights match the brute force lists");
+}
+
+void TestOverflow()
+{
+    ClusterGrid grid = MakeGrid();
+    grid.maxLightsPerCluster = 4;
+    std::vector<ClusterLight> lights(10);
+    for (ClusterLight& light : lights)
+    {
+        light.position[2] = 1.0f;
+        light.radius = 2.0f * grid.farPlane;
+    }
+    const ClusterLightLists lists = AssignLights(grid, lights);
+    Require(lists == AssignLightsBruteForce(grid, lights),
+            "full clusters match the brute force lists");
+    for (uint32_t c = 0; c < grid.Count(); ++c)
+    {
+        Require(lists.counts[c] == 4, "full clusters stop at the limit");
+        for (uint32_t n = 0; n < 4; ++n)
+            Require(lists.indices[c * 4 + n] == n,
+                    "full clusters keep the lowest light indices");
+    }
+}
+
+void TestScaling()
+{
+    const ClusterGrid grid = MakeGrid();
+    for (uint32_t count : {16u, 256u, 4096u})
+    {
+        const std::vector<ClusterLight> lights =
+            RandomLights(grid, count, 3 * count);
+        const auto start = std::chrono::steady_clock::now();
+        const ClusterLightLists lists = AssignLights(grid, lights);
+        const auto end = std::chrono::steady_clock::now();
+
+        uint64_t listed = 0, longest = 0;
+        for (uint32_t n : lists.counts)
+        {
+            Require(n <= grid.maxLightsPerCluster,
+                    "counts stay within the cluster limit");
+            listed += n;
+            longest = std::max<uint64_t>(longest, n);
+        }
+        Require(count < 256 || listed > 0, "visible lights are listed");
+        std::cout << "  " << count << " lights: "
+                  << std::chrono::duration<double, std::milli>(end - start)
+                         .count()
+                  << " ms, " << double(listed) / grid.Count()
+                  << " lights per cluster on average, " << longest
+                  << " at most\n";
+    }
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestSlices();
+        std::cout << "[PASS] exponential depth slices\n";
+        TestBounds();
+        std::cout << "[PASS] froxel bounds\n";
+        TestMatchesBruteForce();
+        std::cout << "[PASS] bounded assignment matches brute force\n";
+        TestOverflow();
+        std::cout << "[PASS] cluster overflow\n";
+        TestScaling();
+        std::cout << "[PASS] scaling with light count\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
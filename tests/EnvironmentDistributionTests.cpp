@@ -0,0 +1,197 @@
+#include "Core/Log.h"
+#include "Core/TaskSystem.h"
+#include "Renderer/Resources/EnvironmentDistribution.h"
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+constexpr double Pi = 3.14159265358979323846;
+
+    // Dim sky with a few bright texels, one of them a small "sun".
+std::vector<float> MakeSky(uint32_t width, uint32_t height)
+{
+    std::vector<float> rgba((size_t)width * height * 4);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            float* texel = rgba.data() + ((size_t)y * width + x) * 4;
+            const float sky = 0.1f + 0.05f * float(x % 3);
+            texel[0] = sky;
+            texel[1] = sky * 1.2f;
+            texel[2] = sky * 1.5f;
+            texel[3] = 1.0f;
+        }
+    }
+    float* sun = rgba.data() + ((size_t)(height / 4) * width + width / 3) * 4;
+    sun[0] = sun[1] = sun[2] = 500.0f;
+    float* black = rgba.data() + ((size_t)(height / 2) * width + 1) * 4;
+    black[0] = black[1] = black[2] = 0.0f;
+    return rgba;
+}
+
+    // Expected probability of each texel: luminance times the sine of its
+    // polar angle, normalised.
+std::vector<double> ExpectedProbabilities(const std::vector<float>& rgba,
+                                          uint32_t width, uint32_t height)
+{
+    std::vector<double> weights((size_t)width * height);
+    double total = 0.0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const double sinTheta = std::sin(Pi * (y + 0.5) / height);
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const float* texel = rgba.data() + ((size_t)y * width + x) * 4;
+            const double luminance = 0.2126 * texel[0] + 0.7152 * texel[1] +
+                                     0.0722 * texel[2];
+            weights[(size_t)y * width + x] = luminance * sinTheta;
+            total += luminance * sinTheta;
+        }
+    }
+    for (double& weight : weights) weight /= total;
+    return weights;
+}
+
+void TestPdfMatchesLuminance()
+{
+    const uint32_t width = 16, height = 8;
+    const std::vector<float> rgba = MakeSky(width, height);
+    const auto distribution =
+        Chimera::BuildEnvironmentDistribution(rgba.data(), width, height);
+    const std::vector<double> expected =
+        ExpectedProbabilities(rgba, width, height);
+
+    double integral = 0.0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const float pdf = distribution.PdfUV((x + 0.5f) / width,
+                                                 (y + 0.5f) / height);
+            const double probability = pdf / double(width * height);
+            const double want = expected[(size_t)y * width + x];
+            Require(std::abs(probability - want) <= 1e-5 + want * 1e-4,
+                    "texel probability must follow luminance times sine");
+            integral += probability;
+        }
+    }
+    Require(std::abs(integral - 1.0) < 1e-4, "the pdf must integrate to one");
+}
+
+void TestSamplesFollowDistribution()
+{
+    const uint32_t width = 16, height = 8;
+    const std::vector<float> rgba = MakeSky(width, height);
+    const auto distribution =
+        Chimera::BuildEnvironmentDistribution(rgba.data(), width, height);
+    const std::vector<double> expected =
+        ExpectedProbabilities(rgba, width, height);
+
+    // A stratified grid of sample pairs, so the histogram converges fast
+    const uint32_t strata = 512;
+    std::vector<double> histogram((size_t)width * height, 0.0);
+    for (uint32_t j = 0; j < strata; ++j)
+    {
+        for (uint32_t i = 0; i < strata; ++i)
+        {
+            float u = 0.0f, v = 0.0f;
+            const float pdf = distribution.SampleUV(
+                (j + 0.5f) / strata, (i + 0.5f) / strata, u, v);
+            const uint32_t x = std::min(uint32_t(u * width), width - 1);
+            const uint32_t y = std::min(uint32_t(v * height), height - 1);
+            Require(pdf > 0.0f, "samples must land where there is light");
+            Require(std::abs(pdf - distribution.PdfUV(u, v)) <= pdf * 1e-5f,
+                    "the returned pdf must match PdfUV at the sample");
+            histogram[(size_t)y * width + x] += 1.0 / (strata * strata);
+        }
+    }
+    for (size_t i = 0; i < histogram.size(); ++i)
+    {
+        Require(std::abs(histogram[i] - expected[i]) < 0.003,
+                "sample frequencies must match texel probabilities");
+    }
+    const uint32_t blackTexel = (height / 2) * width + 1;
+    Require(histogram[blackTexel] == 0.0,
+            "black texels must never be sampled");
+}
+
+void TestBlackMapFallsBackToUniform()
+{
+    const uint32_t width = 8, height = 4;
+    std::vector<float> rgba((size_t)width * height * 4, 0.0f);
+    rgba[5] = -3.0f; // Negative texels carry no light
+    rgba[9] = NAN;
+    const auto distribution =
+        Chimera::BuildEnvironmentDistribution(rgba.data(), width, height);
+    Require(distribution.IsValid(), "a black map must still be sampleable");
+
+    // Uniform over the sphere: each texel weighted by solid angle alone
+    double sineSum = 0.0;
+    for (uint32_t y = 0; y < height; ++y)
+        sineSum += std::sin(Pi * (y + 0.5) / height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const double sinTheta = std::sin(Pi * (y + 0.5) / height);
+        const double want = sinTheta / sineSum * height;
+        const float pdf = distribution.PdfUV(0.3f, (y + 0.5f) / height);
+        Require(std::abs(pdf - want) < 1e-4, "fallback must be uniform");
+    }
+}
+
+void TestParallelBuildMatchesSerial()
+{
+    const uint32_t width = 64, height = 200; // Several partial task chunks
+    const std::vector<float> rgba = MakeSky(width, height);
+    const auto serial =
+        Chimera::BuildEnvironmentDistribution(rgba.data(), width, height);
+    Chimera::TaskSystem tasks(3);
+    const auto parallel = Chimera::BuildEnvironmentDistribution(
+        rgba.data(), width, height, &tasks);
+    tasks.Shutdown();
+    Require(serial.marginalCdf == parallel.marginalCdf &&
+                serial.conditionalCdf == parallel.conditionalCdf,
+            "building on the task system must not change the result");
+
+    std::vector<float> packed = {42.0f};
+    serial.AppendTo(packed);
+    Require(packed.size() == 1 + serial.GetPackedSize() &&
+                packed[1] == float(width) && packed[2] == float(height) &&
+                packed[3] == serial.marginalCdf[0] &&
+                packed[3 + height] == serial.conditionalCdf[0] &&
+                packed.back() == serial.conditionalCdf.back(),
+            "the packed layout must be width, height, marginal, rows");
+}
+} // namespace
+
+int main()
+{
+    Chimera::Log::Init(); // TaskSystem logs its workers
+    try
+    {
+        TestPdfMatchesLuminance();
+        std::cout << "[PASS] pdf matches luminance\n";
+        TestSamplesFollowDistribution();
+        std::cout << "[PASS] samples follow distribution\n";
+        TestBlackMapFallsBackToUniform();
+        std::cout << "[PASS] black map falls back to uniform\n";
+        TestParallelBuildMatchesSerial();
+        std::cout << "[PASS] parallel build matches serial\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
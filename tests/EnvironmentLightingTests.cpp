@@ -0,0 +1,244 @@
+#include "Core/Log.h"
+#include "Core/TaskSystem.h"
+#include "Renderer/Resources/EnvironmentLighting.h"
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+constexpr double Pi = 3.14159265358979323846;
+
+struct Vec3
+{
+    float x, y, z;
+};
+
+    // Direction of a texel centre, matching SampleEquirectangular.
+Vec3 TexelDirection(uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    const double phi = ((x + 0.5) / width - 0.5) * 2.0 * Pi;
+    const double lat = (0.5 - (y + 0.5) / height) * Pi;
+    return {float(std::cos(lat) * std::cos(phi)), float(std::sin(lat)),
+            float(std::cos(lat) * std::sin(phi))};
+}
+
+    // Equirectangular map whose radiance is radiance(direction).
+std::vector<float> MakeMap(uint32_t width, uint32_t height,
+                           const std::function<Vec3(const Vec3&)>& radiance)
+{
+    std::vector<float> rgba((size_t)width * height * 4);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const Vec3 value = radiance(TexelDirection(x, y, width, height));
+            float* texel = rgba.data() + ((size_t)y * width + x) * 4;
+            texel[0] = value.x;
+            texel[1] = value.y;
+            texel[2] = value.z;
+            texel[3] = 1.0f;
+        }
+    }
+    return rgba;
+}
+
+    // Normals spread over the sphere, poles included.
+std::vector<Vec3> TestNormals()
+{
+    std::vector<Vec3> normals = {{0, 1, 0}, {0, -1, 0}, {1, 0, 0},
+                                 {0, 0, -1}};
+    for (int i = 0; i < 16; ++i)
+    {
+        const double z = 1.0 - (i + 0.5) / 8.0;
+        const double r = std::sqrt(1.0 - z * z);
+        const double phi = i * 2.399963;
+        normals.push_back(
+            {float(r * std::cos(phi)), float(r * std::sin(phi)), float(z)});
+    }
+    return normals;
+}
+
+    // Projects radiance and checks the SH against the analytic reflected
+    // radiance at every test normal.
+void CheckIrradiance(const std::function<Vec3(const Vec3&)>& radiance,
+                     const std::function<Vec3(const Vec3&)>& expected,
+                     const std::string& message)
+{
+    // An odd width also runs the scalar tail after the SIMD loop
+    const uint32_t width = 255, height = 128;
+    const std::vector<float> rgba = MakeMap(width, height, radiance);
+    const Chimera::IrradianceSH sh =
+        Chimera::ProjectIrradianceSH(rgba.data(), width, height);
+    for (const Vec3& n : TestNormals())
+    {
+        float rgb[3];
+        Chimera::EvaluateIrradianceSH(sh, n.x, n.y, n.z, rgb);
+        const Vec3 want = expected(n);
+        Require(std::abs(rgb[0] - want.x) < 2e-3f &&
+                    std::abs(rgb[1] - want.y) < 2e-3f &&
+                    std::abs(rgb[2] - want.z) < 2e-3f,
+                message);
+    }
+}
+
+void TestConstantRadiance()
+{
+    CheckIrradiance([](const Vec3&) { return Vec3{1.0f, 2.0f, 0.5f}; },
+                    [](const Vec3&) { return Vec3{1.0f, 2.0f, 0.5f}; },
+                    "a uniform sky must reflect its own radiance");
+}
+
+void TestLinearRadiance()
+{
+    // The clamped cosine scales band 1 by 2/3
+    CheckIrradiance(
+        [](const Vec3& d) { return Vec3{1 + d.y, 1 + d.x, 2 + d.z}; },
+        [](const Vec3& n)
+        {
+            return Vec3{1 + n.y * 2 / 3.0f, 1 + n.x * 2 / 3.0f,
+                        2 + n.z * 2 / 3.0f};
+        },
+        "linear radiance must keep two thirds of band 1");
+}
+
+void TestQuadraticRadiance()
+{
+    // y^2 is 1/3 in band 0 plus (y^2 - 1/3) in band 2, which the clamped
+    // cosine scales by 1/4
+    CheckIrradiance(
+        [](const Vec3& d)
+        { return Vec3{d.y * d.y, 1 + d.x * d.z, 1 + d.x * d.x - d.z * d.z}; },
+        [](const Vec3& n)
+        {
+            return Vec3{1 / 3.0f + (n.y * n.y - 1 / 3.0f) / 4,
+                        1 + n.x * n.z / 4, 1 + (n.x * n.x - n.z * n.z) / 4};
+        },
+        "quadratic radiance must keep a quarter of band 2");
+}
+
+void TestNegativeTexelsCarryNoLight()
+{
+    const uint32_t width = 64, height = 32;
+    std::vector<float> rgba((size_t)width * height * 4, -5.0f);
+    rgba[4] = NAN;
+    const Chimera::IrradianceSH sh =
+        Chimera::ProjectIrradianceSH(rgba.data(), width, height);
+    for (const auto& band : sh.coefficients)
+        Require(band[0] == 0.0f && band[1] == 0.0f && band[2] == 0.0f,
+                "negative and NaN texels must project to nothing");
+}
+
+    // Solid angle weighted mean of one level's red channel.
+double MeanRadiance(const float* rgba, uint32_t width, uint32_t height)
+{
+    double sum = 0.0, weight = 0.0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const double w = std::cos((0.5 - (y + 0.5) / height) * Pi);
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            sum += rgba[((size_t)y * width + x) * 4] * w;
+            weight += w;
+        }
+    }
+    return sum / weight;
+}
+
+void TestPrefilterChain()
+{
+    // A 2048 wide source is read from its 512 wide mip
+    const uint32_t width = 2048, height = 1024;
+    const std::vector<float> rgba = MakeMap(
+        width, height, [](const Vec3&) { return Vec3{3.0f, 3.0f, 3.0f}; });
+    Chimera::TaskSystem tasks(3);
+    const auto prefiltered =
+        Chimera::PrefilterEnvironmentGGX(rgba.data(), width, height, &tasks);
+    tasks.Shutdown();
+    Require(prefiltered.width == Chimera::EnvironmentPrefilterWidth &&
+                prefiltered.height == Chimera::EnvironmentPrefilterWidth / 2 &&
+                prefiltered.levelCount ==
+                    Chimera::EnvironmentPrefilterLevels,
+            "the chain must start at the prefilter width");
+    for (float value : prefiltered.texels)
+        Require(std::abs(value - 3.0f) < 1e-3f || value == 1.0f,
+                "a uniform sky must stay uniform at every roughness");
+}
+
+void TestPrefilterSpreadsHighlights()
+{
+    // A bright band around the equator on a dark sky
+    const uint32_t width = 256, height = 128;
+    const std::vector<float> rgba = MakeMap(
+        width, height,
+        [](const Vec3& d)
+        {
+            const float v = std::abs(d.y) < 0.3f ? 10.0f : 0.1f;
+            return Vec3{v, v, v};
+        });
+    const auto serial =
+        Chimera::PrefilterEnvironmentGGX(rgba.data(), width, height);
+    Chimera::TaskSystem tasks(2);
+    const auto parallel = Chimera::PrefilterEnvironmentGGX(
+        rgba.data(), width, height, &tasks);
+    tasks.Shutdown();
+    Require(serial.texels == parallel.texels,
+            "building on the task system must not change the result");
+    Require(std::equal(rgba.begin(), rgba.end(), serial.texels.begin()),
+            "level 0 is the mirror lobe, the source itself");
+
+    const double sourceMean = MeanRadiance(rgba.data(), width, height);
+    const float* level = serial.texels.data();
+    float previousPeak = 1e30f;
+    for (uint32_t i = 0; i < serial.levelCount; ++i)
+    {
+        const uint32_t w = width >> i, h = height >> i;
+        const double mean = MeanRadiance(level, w, h);
+        // Too few rows to measure the mean on the smallest levels
+        if (h >= 8)
+            Require(std::abs(mean - sourceMean) < sourceMean * 0.05,
+                    "prefiltering must roughly conserve energy");
+        const float peak = level[((size_t)(h / 2) * w) * 4];
+        Require(peak <= previousPeak * 1.01f,
+                "rougher levels must spread the highlight");
+        previousPeak = peak;
+        level += (size_t)w * h * 4;
+    }
+    Require(previousPeak < 5.0f, "the roughest level must blur the band");
+}
+} // namespace
+
+int main()
+{
+    Chimera::Log::Init(); // TaskSystem logs its workers
+    try
+    {
+        TestConstantRadiance();
+        std::cout << "[PASS] constant radiance\n";
+        TestLinearRadiance();
+        std::cout << "[PASS] linear radiance\n";
+        TestQuadraticRadiance();
+        std::cout << "[PASS] quadratic radiance\n";
+        TestNegativeTexelsCarryNoLight();
+        std::cout << "[PASS] negative texels carry no light\n";
+        TestPrefilterChain();
+        std::cout << "[PASS] prefilter chain\n";
+        TestPrefilterSpreadsHighlights();
+        std::cout << "[PASS] prefilter spreads highlights\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
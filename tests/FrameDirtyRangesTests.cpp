@@ -0,0 +1,104 @@
+#include "Renderer/Resources/FrameDirtyRanges.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+using Range = Chimera::FrameDirtyRanges::Range;
+
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+void TestCleanFramesHaveNothingPending()
+{
+    Chimera::FrameDirtyRanges ranges(3);
+    std::vector<Range> out{{1, 1}};
+    for (uint32_t frame = 0; frame < 3; ++frame)
+    {
+        Require(!ranges.HasPending(frame), "new frames must be clean");
+        ranges.Take(frame, out);
+        Require(out.empty(), "a clean frame must yield no ranges");
+    }
+}
+
+void TestMarkReachesEveryFrameOnce()
+{
+    Chimera::FrameDirtyRanges ranges(3);
+    ranges.Mark(10, 4);
+    std::vector<Range> out;
+    for (uint32_t frame = 0; frame < 3; ++frame)
+    {
+        Require(ranges.HasPending(frame), "every frame must see the mark");
+        ranges.Take(frame, out);
+        Require(out == std::vector<Range>{{10, 4}},
+                "each frame must rewrite the marked range");
+        Require(!ranges.HasPending(frame), "Take must clear the frame");
+    }
+}
+
+void TestRangesAreSortedAndMerged()
+{
+    Chimera::FrameDirtyRanges ranges(1);
+    ranges.Mark(20, 5);
+    ranges.Mark(0, 2);
+    ranges.Mark(2, 3);  // Adjacent to [0, 2)
+    ranges.Mark(22, 1); // Inside [20, 25)
+    ranges.Mark(24, 4); // Overlaps the end of [20, 25)
+    ranges.Mark(40, 0); // Empty marks are ignored
+    std::vector<Range> out;
+    ranges.Take(0, out);
+    Require(out == std::vector<Range>{{0, 5}, {20, 8}},
+            "ranges must be sorted and merged");
+}
+
+void TestMarkAllSupersedesRanges()
+{
+    Chimera::FrameDirtyRanges ranges(2);
+    ranges.Mark(3, 1);
+    ranges.MarkAll(100);
+    ranges.Mark(7, 2); // Already covered by the full rewrite
+    std::vector<Range> out;
+    ranges.Take(0, out);
+    Require(out == std::vector<Range>{{0, 100}},
+            "a full rewrite must replace the finer ranges");
+
+        // Frame 0 is clean again while frame 1 still owes the full rewrite.
+    ranges.Mark(5, 1);
+    ranges.Take(0, out);
+    Require(out == std::vector<Range>{{5, 1}},
+            "marks after Take must be tracked again");
+    ranges.Take(1, out);
+    Require(out == std::vector<Range>{{0, 100}},
+            "other frames must keep their full rewrite");
+
+    ranges.MarkAll(0);
+    ranges.Take(0, out);
+    Require(out.empty(), "rewriting zero elements must yield no ranges");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestCleanFramesHaveNothingPending();
+        std::cout << "[PASS] clean frames have nothing pending\n";
+        TestMarkReachesEveryFrameOnce();
+        std::cout << "[PASS] marks reach every frame once\n";
+        TestRangesAreSortedAndMerged();
+        std::cout << "[PASS] ranges are sorted and merged\n";
+        TestMarkAllSupersedesRanges();
+        std::cout << "[PASS] full rewrite supersedes ranges\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,332 @@
+#include "Renderer/Resources/LightTree.h"
+
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+    // A small quad's two triangles per cell of a grid of ceiling lights
+    // at height y facing down, each cell its own instance.
+std::vector<Chimera::LightTreePrimitive> MakeGrid(uint32_t side, float y,
+                                                  float offset = 0.0f)
+{
+    std::vector<Chimera::LightTreePrimitive> primitives;
+    for (uint32_t i = 0; i < side; ++i)
+    {
+        for (uint32_t j = 0; j < side; ++j)
+        {
+            const float x = i * 4.0f + offset, z = j * 4.0f;
+            const float a[3] = {x, y, z}, b[3] = {x + 1, y, z},
+                        c[3] = {x + 1, y, z + 1}, d[3] = {x, y, z + 1};
+            Chimera::LightTreePrimitive first, second;
+            first.bounds = Chimera::TriangleLightBounds(a, c, b, 2.0f);
+            second.bounds = Chimera::TriangleLightBounds(a, d, c, 2.0f);
+            first.instance = second.instance = i * side + j;
+            first.triangle = 0;
+            second.triangle = 1;
+            primitives.push_back(first);
+            primitives.push_back(second);
+        }
+    }
+    return primitives;
+}
+
+    // A unit square at the origin facing +y that only emits within 30
+    // degrees of its normal.
+Chimera::LightBounds Spotlight()
+{
+    Chimera::LightBounds beam;
+    beam.max[0] = beam.max[2] = 1.0f;
+    beam.axis[1] = 1.0f;
+    beam.axis[2] = 0.0f;
+    beam.cosThetaE = std::cos(3.14159265f / 6.0f);
+    beam.power = 1.0f;
+    return beam;
+}
+
+bool Contains(const Chimera::LightBounds& outer,
+              const Chimera::LightBounds& inner)
+{
+    for (int i = 0; i < 3; ++i)
+        if (inner.min[i] < outer.min[i] || inner.max[i] > outer.max[i])
+            return false;
+    return true;
+}
+
+    // Probability Sample gives each primitive, found by walking every
+    // branch with the importance split Sample uses.
+void LeafProbabilities(const Chimera::LightTree& tree, uint32_t node,
+                       double probability, const float p[3],
+                       const float n[3], std::vector<double>& out)
+{
+    const auto& current = tree.nodes[node];
+    if (current.leaf)
+    {
+        out[current.index] += probability;
+        return;
+    }
+    const double i0 =
+        Chimera::LightImportance(tree.nodes[node + 1].bounds, p, n);
+    const double i1 =
+        Chimera::LightImportance(tree.nodes[current.index].bounds, p, n);
+    if (i0 + i1 <= 0.0) return;
+    LeafProbabilities(tree, node + 1, probability * i0 / (i0 + i1), p, n, out);
+    LeafProbabilities(tree, current.index, probability * i1 / (i0 + i1), p,
+                      n, out);
+}
+
+void TestConstruction()
+{
+    const auto primitives = MakeGrid(8, 5.0f);
+    const Chimera::LightTree tree = Chimera::BuildLightTree(primitives);
+    Require(tree.nodes.size() == 2 * primitives.size() - 1,
+            "a tree with one primitive per leaf has 2n - 1 nodes");
+
+    std::vector<int> seen(primitives.size(), 0);
+    float totalPower = 0.0f;
+    for (const auto& primitive : primitives)
+        totalPower += primitive.bounds.power;
+    Require(std::abs(tree.nodes[0].bounds.power - totalPower) <
+                totalPower * 1e-5f,
+            "the root carries every primitive's power");
+    for (size_t i = 0; i < tree.nodes.size(); ++i)
+    {
+        const auto& node = tree.nodes[i];
+        if (node.leaf)
+        {
+            ++seen[node.index];
+            continue;
+        }
+        Require(node.index > i + 1 && node.index < tree.nodes.size(),
+                "the second child follows the first child's subtree");
+        const auto& first = tree.nodes[i + 1].bounds;
+        const auto& second = tree.nodes[node.index].bounds;
+        Require(Contains(node.bounds, first) && Contains(node.bounds, second),
+                "a node must bound its children");
+        Require(std::abs(node.bounds.power - first.power - second.power) <
+                    node.bounds.power * 1e-5f,
+                "a node's power is its children's");
+        // Every light faces straight down, so no cone should widen
+        Require(node.bounds.cosThetaO > 0.9999f,
+                "parallel emitters must keep a tight orientation cone");
+    }
+    for (int count : seen)
+        Require(count == 1, "every primitive must be in exactly one leaf");
+}
+
+void TestOrientationCone()
+{
+    // Normals along +x and +y merge into a cone of half angle 45 degrees
+    // around their bisector; a mirrored normal changes nothing
+    const float o[3] = {0, 0, 0}, x[3] = {1, 0, 0}, y[3] = {0, 1, 0},
+                z[3] = {0, 0, 1};
+    const auto facingX = Chimera::TriangleLightBounds(o, y, z, 1.0f);
+    const auto facingY = Chimera::TriangleLightBounds(o, z, x, 1.0f);
+    const auto facingMinusY = Chimera::TriangleLightBounds(o, x, z, 1.0f);
+    const auto merged = Chimera::Union(facingX, facingY);
+    Require(std::abs(merged.cosThetaO - std::sqrt(0.5f)) < 1e-5f,
+            "the cone must just cover both normals");
+    Require(std::abs(merged.axis[0] - std::sqrt(0.5f)) < 1e-5f &&
+                std::abs(merged.axis[1] - std::sqrt(0.5f)) < 1e-5f,
+            "the cone axis must bisect the normals");
+    const auto mirrored = Chimera::Union(facingX, facingMinusY);
+    Require(std::abs(mirrored.cosThetaO - merged.cosThetaO) < 1e-5f,
+            "two sided emitters must merge with either normal");
+}
+
+void TestImportance()
+{
+    const float a[3] = {0, 0, 0}, b[3] = {1, 0, 0}, c[3] = {0, 0, 1};
+    const auto light = Chimera::TriangleLightBounds(a, b, c, 1.0f);
+    const float none[3] = {0, 0, 0};
+    const float up[3] = {0, 1, 0};
+
+    const float near[3] = {0.3f, 10.0f, 0.3f}, far[3] = {0.3f, 20.0f, 0.3f};
+    const float nearImportance = Chimera::LightImportance(light, near, none);
+    const float farImportance = Chimera::LightImportance(light, far, none);
+    Require(nearImportance > 0.0f &&
+                std::abs(nearImportance / farImportance - 4.0f) < 0.05f,
+            "importance must fall off with the square of distance");
+
+    const float below[3] = {0.3f, -10.0f, 0.3f};
+    Require(std::abs(Chimera::LightImportance(light, below, none) -
+                     nearImportance) < nearImportance * 1e-4f,
+            "emitters light both sides");
+
+    // Far out in its own plane the light is seen edge on
+    const float edgeOn[3] = {1000.0f, 0.0f, 0.3f};
+    const float facing[3] = {0.3f, 1000.0f, 0.3f};
+    Require(Chimera::LightImportance(light, edgeOn, none) <
+                Chimera::LightImportance(light, facing, none) * 1e-2f,
+            "a light seen edge on must matter little");
+
+    // An emitter beaming within 30 degrees of its normal misses p at 60
+    const Chimera::LightBounds beam = Spotlight();
+    const float offAxis[3] = {0.5f + 10.0f * std::sqrt(3.0f), 10.0f, 0.5f};
+    const float onAxis[3] = {0.5f, 10.0f, 0.5f};
+    Require(Chimera::LightImportance(beam, offAxis, none) == 0.0f &&
+                Chimera::LightImportance(beam, onAxis, none) > 0.0f,
+            "a light must not reach points outside its emission cone");
+
+    // A receiver facing along the light's plane sees it edge on
+    const float side[3] = {0.3f, 1000.0f, 0.3f};
+    const float sideways[3] = {1, 0, 0};
+    Require(Chimera::LightImportance(light, side, sideways) <
+                Chimera::LightImportance(light, side, up) * 1e-2f,
+            "the receiver's normal must weigh the importance");
+
+    const float inside[3] = {0.2f, 0.0f, 0.2f};
+    const float importance = Chimera::LightImportance(light, inside, none);
+    Require(importance > 0.0f && std::isfinite(importance),
+            "points inside the bounds must stay finite");
+}
+
+void TestSampling()
+{
+    const auto primitives = MakeGrid(6, 5.0f);
+    const Chimera::LightTree tree = Chimera::BuildLightTree(primitives);
+    const float p[3] = {0.5f, 0.0f, 0.5f}, n[3] = {0, 1, 0};
+
+    std::vector<double> probability(primitives.size(), 0.0);
+    LeafProbabilities(tree, 0, 1.0, p, n, probability);
+    double total = 0.0;
+    for (double value : probability) total += value;
+    Require(std::abs(total - 1.0) < 1e-5, "leaf probabilities must sum to 1");
+    // The two triangles right above p against the far corner's
+    Require(probability[0] + probability[1] >
+                10.0 * (probability[primitives.size() - 1] +
+                        probability[primitives.size() - 2]),
+            "nearby lights must be chosen far more often");
+
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    const uint32_t samples = 200000;
+    std::vector<uint32_t> histogram(primitives.size(), 0);
+    for (uint32_t s = 0; s < samples; ++s)
+    {
+        uint32_t primitive = 0;
+        float pmf = 0.0f;
+        Require(tree.Sample(p, n, uniform(rng), primitive, pmf),
+                "a lit point must always find a light");
+        Require(std::abs(pmf - probability[primitive]) <
+                    1e-4f * (float)probability[primitive] + 1e-7f,
+                "Sample must return the probability it chose with");
+        ++histogram[primitive];
+    }
+    for (size_t i = 0; i < primitives.size(); ++i)
+    {
+        const double expected = samples * probability[i];
+        Require(std::abs(histogram[i] - expected) <
+                    5.0 * std::sqrt(expected) + 2.0,
+                "sample frequencies must follow the probabilities");
+    }
+
+    Chimera::LightTreePrimitive beam;
+    beam.bounds = Spotlight();
+    const Chimera::LightTree single = Chimera::BuildLightTree({beam});
+    const float edgeOn[3] = {1000.0f, 0.0f, 0.5f}, none[3] = {0, 0, 0};
+    uint32_t primitive = 0;
+    float pmf = 0.0f;
+    Require(!single.Sample(edgeOn, none, 0.5f, primitive, pmf),
+            "a lone leaf that cannot light p must not be chosen");
+}
+
+void TestRefit()
+{
+    auto primitives = MakeGrid(5, 5.0f);
+    Chimera::LightTree tree = Chimera::BuildLightTree(primitives);
+    const Chimera::LightTree original = tree;
+
+    // Move every light sideways, as moving their instances would
+    const auto moved = MakeGrid(5, 5.0f, 100.0f);
+    for (size_t i = 0; i < primitives.size(); ++i)
+        primitives[i].bounds = moved[i].bounds;
+    tree.Refit(primitives);
+
+    Require(tree.nodes.size() == original.nodes.size(),
+            "refitting must keep the node count");
+    for (size_t i = 0; i < tree.nodes.size(); ++i)
+    {
+        const auto& node = tree.nodes[i];
+        Require(node.leaf == original.nodes[i].leaf &&
+                    node.index == original.nodes[i].index,
+                "refitting must keep the topology");
+        if (node.leaf)
+            Require(Contains(node.bounds, primitives[node.index].bounds),
+                    "leaves must take their primitive's new bounds");
+        else
+            Require(Contains(node.bounds, tree.nodes[i + 1].bounds) &&
+                        Contains(node.bounds, tree.nodes[node.index].bounds),
+                    "refitted nodes must bound their children");
+    }
+    Require(tree.nodes[0].bounds.min[0] >= 100.0f,
+            "the root must follow the lights");
+}
+
+void TestPackedLayout()
+{
+    const auto primitives = MakeGrid(2, 1.0f);
+    const Chimera::LightTree tree = Chimera::BuildLightTree(primitives);
+    std::vector<float> packed;
+    tree.AppendTo(primitives, packed);
+    Require(packed.size() == tree.GetPackedSize() &&
+                tree.GetPackedSize() ==
+                    tree.nodes.size() * Chimera::LightTreeNodeFloats,
+            "each node packs into LightTreeNodeFloats floats");
+    for (size_t i = 0; i < tree.nodes.size(); ++i)
+    {
+        const auto& node = tree.nodes[i];
+        const float* out = packed.data() + i * Chimera::LightTreeNodeFloats;
+        Require(out[3] == node.bounds.power &&
+                    out[7] == node.bounds.cosThetaO &&
+                    out[11] == node.bounds.cosThetaE,
+                "power and cone angles pack beside the vectors");
+        Require(std::bit_cast<uint32_t>(out[14]) == (node.leaf ? 1u : 0u),
+                "the leaf flag packs as uint bits");
+        const uint32_t first = std::bit_cast<uint32_t>(out[12]);
+        if (node.leaf)
+            Require(first == primitives[node.index].instance &&
+                        std::bit_cast<uint32_t>(out[13]) ==
+                            primitives[node.index].triangle,
+                    "leaves pack their instance and triangle");
+        else
+            Require(first == node.index,
+                    "interior nodes pack their second child");
+    }
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestConstruction();
+        std::cout << "[PASS] construction\n";
+        TestOrientationCone();
+        std::cout << "[PASS] orientation cone\n";
+        TestImportance();
+        std::cout << "[PASS] importance\n";
+        TestSampling();
+        std::cout << "[PASS] sampling\n";
+        TestRefit();
+        std::cout << "[PASS] refit\n";
+        TestPackedLayout();
+        std::cout << "[PASS] packed layout\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
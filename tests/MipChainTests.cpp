@@ -0,0 +1,136 @@
+#include "Renderer/Resources/MipChain.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+bool Near(int actual, int expected, int tolerance = 1)
+{
+    return std::abs(actual - expected) <= tolerance;
+}
+
+void TestLevelCounts()
+{
+    Require(Chimera::GetMipLevelCount(1, 1) == 1, "1x1 has one level");
+    Require(Chimera::GetMipLevelCount(4096, 4096) == 13,
+            "4096^2 has 13 levels");
+    Require(Chimera::GetMipLevelCount(5, 3) == 3, "5x3 halves to 2x1, 1x1");
+    Require(Chimera::GetMipLevelCount(1, 1024) == 11,
+            "the longer side decides the level count");
+    Require(Chimera::GetMipChainTexelCount(4, 2, 3) == 8 + 2 + 1,
+            "texel counts must follow the clamped halving");
+}
+
+void TestLinearBoxFilter()
+{
+        // 4x2 so level 1 is 2x1: the left and right 2x2 blocks.
+    const std::vector<uint8_t> pixels = {
+        0,   0,   0,   0,   100, 100, 100, 100, 10, 20, 30, 40, 10, 20, 30, 40,
+        200, 200, 200, 200, 100, 100, 100, 100, 10, 20, 30, 40, 10, 20, 30, 40};
+    const auto chain = Chimera::BuildMipChainRGBA8(
+        pixels.data(), 4, 2, Chimera::MipFilter::Linear);
+    Require(chain.size() == (8 + 2 + 1) * 4, "the chain must hold 3 levels");
+    Require(std::equal(pixels.begin(), pixels.end(), chain.begin()),
+            "level 0 must be the source");
+
+    const uint8_t* level1 = chain.data() + 8 * 4;
+    Require(level1[0] == 100 && level1[3] == 100,
+            "the left block must average to 100");
+    Require(level1[4] == 10 && level1[5] == 20 && level1[6] == 30 &&
+                level1[7] == 40,
+            "a uniform block must keep its value");
+    const uint8_t* level2 = chain.data() + 10 * 4;
+    Require(level2[0] == 55, "level 2 must average level 1");
+}
+
+void TestSrgbAveragesInLinearLight()
+{
+        // Black and white checker: half the light, which is sRGB 188, not
+        // the 128 a naive average of the encoded values gives.
+    const std::vector<uint8_t> pixels = {0,   0,   0,   255, 255, 255, 255, 255,
+                                         255, 255, 255, 255, 0,   0,   0,   255};
+    const auto srgb = Chimera::BuildMipChainRGBA8(pixels.data(), 2, 2,
+                                                  Chimera::MipFilter::Srgb);
+    const uint8_t* texel = srgb.data() + 4 * 4;
+    Require(Near(texel[0], 188) && Near(texel[1], 188) && Near(texel[2], 188),
+            "sRGB texels must be averaged in linear light");
+    Require(texel[3] == 255, "alpha must be averaged linearly");
+
+    const auto linear = Chimera::BuildMipChainRGBA8(pixels.data(), 2, 2,
+                                                    Chimera::MipFilter::Linear);
+    Require(Near(linear[4 * 4], 128), "linear texels must average directly");
+}
+
+void TestNormalMapsAreRenormalised()
+{
+        // +X and +Y average to a vector of length 0.707 which must be
+        // renormalised to (0.707, 0.707, 0).
+    const std::vector<uint8_t> pixels = {255, 128, 128, 255, 128, 255, 128, 255,
+                                         255, 128, 128, 255, 128, 255, 128, 255};
+    const auto chain = Chimera::BuildMipChainRGBA8(
+        pixels.data(), 2, 2, Chimera::MipFilter::NormalMap);
+    const uint8_t* texel = chain.data() + 4 * 4;
+    const int expected = (int)std::lround((0.7071f * 0.5f + 0.5f) * 255.0f);
+    Require(Near(texel[0], expected) && Near(texel[1], expected),
+            "the averaged normal must be unit length");
+    Require(Near(texel[2], 128), "z must stay at zero");
+
+        // Opposite normals cancel; the result falls back to +Z.
+    const std::vector<uint8_t> opposite = {255, 128, 128, 255, 0, 128, 128, 255};
+    const auto flat = Chimera::BuildMipChainRGBA8(
+        opposite.data(), 2, 1, Chimera::MipFilter::NormalMap);
+    Require(Near(flat[8 + 0], 128) && flat[8 + 2] == 255,
+            "cancelled normals must fall back to +Z");
+}
+
+void TestFloatChainMatchesReference()
+{
+    std::vector<float> pixels(8 * 8 * 4);
+    for (size_t i = 0; i < pixels.size(); ++i) pixels[i] = (float)(i % 37);
+    const auto chain = Chimera::BuildMipChainRGBA32F(pixels.data(), 8, 8);
+    Require(chain.size() == (64 + 16 + 4 + 1) * 4,
+            "the chain must hold 4 levels");
+
+        // Reference: level 3 of a box-filter chain on a power of two is the
+        // mean of level 0.
+    double sum[4] = {};
+    for (size_t i = 0; i < pixels.size(); ++i) sum[i % 4] += pixels[i];
+    const float* last = chain.data() + (64 + 16 + 4) * 4;
+    for (int c = 0; c < 4; ++c)
+        Require(std::abs(last[c] - sum[c] / 64.0) < 1e-4,
+                "the 1x1 level must be the mean of the image");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestLevelCounts();
+        std::cout << "[PASS] level counts\n";
+        TestLinearBoxFilter();
+        std::cout << "[PASS] linear box filter\n";
+        TestSrgbAveragesInLinearLight();
+        std::cout << "[PASS] sRGB averages in linear light\n";
+        TestNormalMapsAreRenormalised();
+        std::cout << "[PASS] normal maps are renormalised\n";
+        TestFloatChainMatchesReference();
+        std::cout << "[PASS] float chain matches reference\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,121 @@
+#include "Renderer/Backend/PipelineCacheFile.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+Chimera::PipelineCacheDeviceInfo MakeDevice()
+{
+    Chimera::PipelineCacheDeviceInfo device;
+    device.vendorID = 0x10DE;
+    device.deviceID = 0x2684;
+    device.driverVersion = 0x8A4E0000;
+    for (uint8_t i = 0; i < device.pipelineCacheUUID.size(); ++i)
+    {
+        device.pipelineCacheUUID[i] = static_cast<uint8_t>(i * 7 + 1);
+    }
+    return device;
+}
+
+const std::vector<uint8_t> Payload = {0x10, 0x20, 0x30, 0x40, 0x50, 0x60};
+
+void TestRoundTripReturnsDriverPayload()
+{
+    const auto device = MakeDevice();
+    const auto file = Chimera::SerializePipelineCache(device, Payload);
+
+    std::vector<uint8_t> payload;
+    Require(Chimera::DeserializePipelineCache(file, device, payload) ==
+                Chimera::PipelineCacheLoadStatus::Loaded,
+            "cache written for a device must load on the same device");
+    Require(payload == Payload, "loaded payload must match the saved data");
+}
+
+void TestMissingFileIsReported()
+{
+    std::vector<uint8_t> payload{1, 2, 3};
+    Require(Chimera::DeserializePipelineCache({}, MakeDevice(), payload) ==
+                Chimera::PipelineCacheLoadStatus::Missing,
+            "empty file data must be reported as a missing cache");
+    Require(payload.empty(), "rejected cache must not return a payload");
+}
+
+void TestDeviceIdentityMismatchIsRejected()
+{
+    const auto device = MakeDevice();
+    const auto file = Chimera::SerializePipelineCache(device, Payload);
+    std::vector<uint8_t> payload;
+
+    auto otherUUID = device;
+    otherUUID.pipelineCacheUUID[3] ^= 0xFF;
+    Require(Chimera::DeserializePipelineCache(file, otherUUID, payload) ==
+                Chimera::PipelineCacheLoadStatus::DeviceMismatch,
+            "different pipeline cache UUID must be rejected");
+
+    auto otherDevice = device;
+    otherDevice.deviceID += 1;
+    Require(Chimera::DeserializePipelineCache(file, otherDevice, payload) ==
+                Chimera::PipelineCacheLoadStatus::DeviceMismatch,
+            "different device ID must be rejected");
+
+    auto otherDriver = device;
+    otherDriver.driverVersion += 1;
+    Require(Chimera::DeserializePipelineCache(file, otherDriver, payload) ==
+                Chimera::PipelineCacheLoadStatus::DriverMismatch,
+            "different driver version must be rejected");
+    Require(payload.empty(), "rejected cache must not return a payload");
+}
+
+void TestTruncatedOrCorruptedFileIsRejected()
+{
+    const auto device = MakeDevice();
+    auto file = Chimera::SerializePipelineCache(device, Payload);
+    std::vector<uint8_t> payload;
+
+    auto truncated = file;
+    truncated.pop_back();
+    Require(Chimera::DeserializePipelineCache(truncated, device, payload) ==
+                Chimera::PipelineCacheLoadStatus::Corrupt,
+            "truncated payload must be rejected");
+
+    auto headerOnly = file;
+    headerOnly.resize(8);
+    Require(Chimera::DeserializePipelineCache(headerOnly, device, payload) ==
+                Chimera::PipelineCacheLoadStatus::Corrupt,
+            "truncated header must be rejected");
+
+    file.back() ^= 0x01;
+    Require(Chimera::DeserializePipelineCache(file, device, payload) ==
+                Chimera::PipelineCacheLoadStatus::Corrupt,
+            "flipped payload bit must fail the checksum");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestRoundTripReturnsDriverPayload();
+        std::cout << "[PASS] pipeline cache round-trips its driver payload\n";
+        TestMissingFileIsReported();
+        std::cout << "[PASS] missing pipeline cache is reported\n";
+        TestDeviceIdentityMismatchIsRejected();
+        std::cout << "[PASS] device and driver mismatches are rejected\n";
+        TestTruncatedOrCorruptedFileIsRejected();
+        std::cout << "[PASS] truncated and corrupted caches are rejected\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,337 @@
+#include "AllocationCounter.h"
+#include "Renderer/Backend/PipelineKey.h"
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+struct FakePipeline
+{
+    uint32_t id = 0;
+};
+
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+Chimera::GraphicsPipelineDescription MakeGraphicsDesc(uint32_t variant)
+{
+    Chimera::GraphicsPipelineDescription desc;
+    desc.name = "Forward";
+    desc.vertex_shader = "forward.vert";
+    desc.fragment_shader = "forward.frag";
+    desc.specializationConstants = {variant};
+    return desc;
+}
+
+Chimera::RaytracingPipelineDescription MakeRaytracingDesc(uint32_t variant)
+{
+    Chimera::RaytracingPipelineDescription desc;
+    desc.raygen_shader = "raygen.rgen";
+    desc.miss_shaders = {"miss.rmiss", "shadow.rmiss"};
+    desc.hit_shaders = {{"closesthit.rchit", "", ""}};
+    desc.specializationConstants = {variant};
+    return desc;
+}
+
+Chimera::ComputePipelineDescription::Kernel MakeKernel(uint32_t variant)
+{
+    return {"SVGF", "svgf_atrous.comp", {variant}};
+}
+
+const std::vector<VkFormat> HDRTarget = {VK_FORMAT_R16G16B16A16_SFLOAT};
+const std::vector<VkFormat> LDRTarget = {VK_FORMAT_B8G8R8A8_UNORM};
+
+void TestEqualDescriptionsProduceEqualKeys()
+{
+    Chimera::ShaderIDTable ids;
+    const auto a = Chimera::MakeGraphicsPipelineKey(
+        ids, HDRTarget, VK_FORMAT_D32_SFLOAT, MakeGraphicsDesc(1));
+    const auto b = Chimera::MakeGraphicsPipelineKey(
+        ids, HDRTarget, VK_FORMAT_D32_SFLOAT, MakeGraphicsDesc(1));
+    Require(a == b, "identical descriptions must build identical keys");
+    Require(Chimera::HashPipelineKey(a) == Chimera::HashPipelineKey(b),
+            "identical keys must hash identically");
+    Require(ids.GetCount() == 2, "each shader name must get one ID");
+}
+
+void TestKeyCapturesPipelineState()
+{
+    Chimera::ShaderIDTable ids;
+    const auto base = Chimera::MakeGraphicsPipelineKey(
+        ids, HDRTarget, VK_FORMAT_D32_SFLOAT, MakeGraphicsDesc(1));
+
+    Require(base != Chimera::MakeGraphicsPipelineKey(
+                        ids, LDRTarget, VK_FORMAT_D32_SFLOAT,
+                        MakeGraphicsDesc(1)),
+            "color format must be part of the key");
+    Require(base != Chimera::MakeGraphicsPipelineKey(
+                        ids, HDRTarget, VK_FORMAT_UNDEFINED,
+                        MakeGraphicsDesc(1)),
+            "depth format must be part of the key");
+    Require(base != Chimera::MakeGraphicsPipelineKey(
+                        ids, HDRTarget, VK_FORMAT_D32_SFLOAT,
+                        MakeGraphicsDesc(2)),
+            "specialization constants must be part of the key");
+
+    auto noDepthWrite = MakeGraphicsDesc(1);
+    noDepthWrite.depth_write = false;
+    Require(base != Chimera::MakeGraphicsPipelineKey(
+                        ids, HDRTarget, VK_FORMAT_D32_SFLOAT, noDepthWrite),
+            "depth write state must be part of the key");
+
+    auto swapped = MakeGraphicsDesc(1);
+    std::swap(swapped.vertex_shader, swapped.fragment_shader);
+    Require(base != Chimera::MakeGraphicsPipelineKey(
+                        ids, HDRTarget, VK_FORMAT_D32_SFLOAT, swapped),
+            "shader stage order must be part of the key");
+}
+
+void TestRaytracingGroupLayoutIsPartOfKey()
+{
+    Chimera::ShaderIDTable ids;
+    auto twoMiss = MakeRaytracingDesc(0);
+    twoMiss.hit_shaders.clear();
+    twoMiss.miss_shaders = {"miss.rmiss", "closesthit.rchit"};
+
+    auto oneHit = MakeRaytracingDesc(0);
+    oneHit.miss_shaders = {"miss.rmiss"};
+
+    Require(Chimera::MakeRaytracingPipelineKey(ids, twoMiss) !=
+                Chimera::MakeRaytracingPipelineKey(ids, oneHit),
+            "moving a shader between miss and hit groups must change the key");
+
+    const auto compute = Chimera::MakeComputePipelineKey(ids, MakeKernel(0));
+    auto graphics = MakeGraphicsDesc(0);
+    graphics.vertex_shader = "svgf_atrous.comp";
+    graphics.fragment_shader.clear();
+    Require(compute != Chimera::MakeGraphicsPipelineKey(
+                           ids, {}, VK_FORMAT_UNDEFINED, graphics),
+            "pipeline kind must be part of the key");
+}
+
+void TestOversizedDescriptionThrows()
+{
+    Chimera::ShaderIDTable ids;
+    auto desc = MakeGraphicsDesc(0);
+    desc.specializationConstants.assign(
+        Chimera::PipelineKey::MaxSpecializationConstants + 1, 0);
+
+    bool threw = false;
+    try
+    {
+        Chimera::MakeGraphicsPipelineKey(ids, HDRTarget, VK_FORMAT_D32_SFLOAT,
+                                         desc);
+    }
+    catch (const std::runtime_error&)
+    {
+        threw = true;
+    }
+    Require(threw, "descriptions that do not fit the key must throw");
+}
+
+void TestTableGrowsAndFindsEveryKey()
+{
+    Chimera::ShaderIDTable ids;
+    Chimera::PipelineKeyTable<FakePipeline> table;
+    std::vector<Chimera::PipelineKey> keys;
+
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        keys.push_back(Chimera::MakeGraphicsPipelineKey(
+            ids, HDRTarget, VK_FORMAT_D32_SFLOAT, MakeGraphicsDesc(i)));
+        table.Insert(keys.back(),
+                     std::make_unique<FakePipeline>(FakePipeline{i}));
+    }
+
+    Require(table.Size() == keys.size(), "every distinct key must be stored");
+    Require(table.Capacity() >= table.Size() * 2,
+            "table must keep its load factor at or below one half");
+
+    for (uint32_t i = 0; i < keys.size(); ++i)
+    {
+        const FakePipeline* pipeline = table.Find(keys[i]);
+        Require(pipeline && pipeline->id == i,
+                "every stored key must be found after growing");
+    }
+
+    Require(!table.Find(Chimera::MakeComputePipelineKey(ids, MakeKernel(0))),
+            "unknown keys must not be found");
+
+    table.Insert(keys[7], std::make_unique<FakePipeline>(FakePipeline{99}));
+    Require(table.Size() == keys.size() && table.Find(keys[7])->id == 99,
+            "inserting an existing key must replace its value");
+
+    table.Clear();
+    Require(table.Size() == 0 && !table.Find(keys[0]),
+            "cleared table must be empty");
+}
+
+void TestTakeKeepsProbeRunsIntact()
+{
+    Chimera::ShaderIDTable ids;
+    Chimera::PipelineKeyTable<FakePipeline> table;
+    std::vector<Chimera::PipelineKey> keys;
+    for (uint32_t i = 0; i < 500; ++i)
+    {
+        keys.push_back(Chimera::MakeComputePipelineKey(ids, MakeKernel(i)));
+        table.Insert(keys.back(),
+                     std::make_unique<FakePipeline>(FakePipeline{i}));
+    }
+
+    // Remove every third key, then the rest must still be reachable even
+    // when they were displaced past a removed slot.
+    for (uint32_t i = 0; i < keys.size(); i += 3)
+    {
+        auto taken = table.Take(keys[i]);
+        Require(taken && taken->id == i, "Take must return the stored value");
+    }
+    Require(!table.Take(keys[0]), "a removed key must not be taken twice");
+
+    for (uint32_t i = 0; i < keys.size(); ++i)
+    {
+        const FakePipeline* pipeline = table.Find(keys[i]);
+        Require((i % 3 == 0) ? !pipeline : (pipeline && pipeline->id == i),
+                "removal must not hide other keys");
+    }
+
+    const auto odd = table.TakeIf([](const Chimera::PipelineKey& key)
+                                  { return key.specializationConstants[0] & 1; });
+    for (const auto& [key, pipeline] : odd)
+    {
+        Require(pipeline && (pipeline->id & 1) && !table.Find(key),
+                "TakeIf must remove exactly the matching keys");
+    }
+    Require(table.Size() + odd.size() + (keys.size() + 2) / 3 == keys.size(),
+            "size must track removals");
+}
+
+void TestLookupIsAllocationFree()
+{
+    constexpr uint32_t VariantsPerKind = 64;
+    constexpr uint32_t Iterations = 2000;
+
+    Chimera::ShaderIDTable ids;
+    Chimera::PipelineKeyTable<FakePipeline> table;
+    std::unordered_map<std::string, FakePipeline> stringTable;
+    std::vector<Chimera::PipelineKey> keys;
+    std::vector<std::string> stringKeys;
+
+    for (uint32_t i = 0; i < VariantsPerKind; ++i)
+    {
+        keys.push_back(Chimera::MakeGraphicsPipelineKey(
+            ids, HDRTarget, VK_FORMAT_D32_SFLOAT, MakeGraphicsDesc(i)));
+        stringKeys.push_back("Forward_forward.vert_forward.frag_" +
+                             std::to_string(i));
+        keys.push_back(
+            Chimera::MakeRaytracingPipelineKey(ids, MakeRaytracingDesc(i)));
+        stringKeys.push_back("raygen.rgen_miss.rmiss_shadow.rmiss_"
+                             "closesthit.rchit_" +
+                             std::to_string(i));
+        keys.push_back(Chimera::MakeComputePipelineKey(ids, MakeKernel(i)));
+        stringKeys.push_back("svgf_atrous.comp_" + std::to_string(i));
+    }
+    for (uint32_t i = 0; i < keys.size(); ++i)
+    {
+        table.Insert(keys[i], std::make_unique<FakePipeline>(FakePipeline{i}));
+        stringTable.emplace(stringKeys[i], FakePipeline{i});
+    }
+
+    // Hot path: the render graph rebuilds descriptions every frame, so a
+    // lookup is key construction plus Find for names that already have IDs.
+    const auto graphicsDesc = MakeGraphicsDesc(5);
+    const auto raytracingDesc = MakeRaytracingDesc(5);
+    const auto kernel = MakeKernel(5);
+
+    using Clock = std::chrono::steady_clock;
+    uint64_t found = 0;
+    const size_t allocationsBefore = AllocationCount();
+    const auto keyStart = Clock::now();
+    for (uint32_t it = 0; it < Iterations; ++it)
+    {
+        for (const auto& key : keys)
+        {
+            found += table.Find(key) ? 1 : 0;
+        }
+        found += table.Find(Chimera::MakeGraphicsPipelineKey(
+                     ids, HDRTarget, VK_FORMAT_D32_SFLOAT, graphicsDesc))
+                     ? 1
+                     : 0;
+        found += table.Find(Chimera::MakeRaytracingPipelineKey(
+                     ids, raytracingDesc))
+                     ? 1
+                     : 0;
+        found += table.Find(Chimera::MakeComputePipelineKey(ids, kernel))
+                     ? 1
+                     : 0;
+    }
+    const auto keyEnd = Clock::now();
+    const size_t lookupAllocations = AllocationCount() - allocationsBefore;
+
+    Require(found == uint64_t(Iterations) * (keys.size() + 3),
+            "every lookup in the benchmark must hit");
+    Require(lookupAllocations == 0,
+            "pipeline key lookups must not allocate (saw " +
+                std::to_string(lookupAllocations) + ")");
+
+    // Baseline: the previous string-keyed cache rebuilt its key every lookup.
+    uint64_t stringFound = 0;
+    const auto stringStart = Clock::now();
+    for (uint32_t it = 0; it < Iterations; ++it)
+    {
+        for (uint32_t i = 0; i < stringKeys.size(); ++i)
+        {
+            const std::string key = stringKeys[i].substr(0);
+            stringFound += stringTable.count(key);
+        }
+    }
+    const auto stringEnd = Clock::now();
+    Require(stringFound == uint64_t(Iterations) * stringKeys.size(),
+            "string baseline must hit every key");
+
+    const double lookups = double(Iterations) * double(keys.size() + 3);
+    const double keyNS =
+        std::chrono::duration<double, std::nano>(keyEnd - keyStart).count() /
+        lookups;
+    const double stringNS =
+        std::chrono::duration<double, std::nano>(stringEnd - stringStart)
+            .count() /
+        (double(Iterations) * double(stringKeys.size()));
+    std::cout << "       structural key: " << keyNS
+              << " ns/lookup, string key: " << stringNS << " ns/lookup\n";
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestEqualDescriptionsProduceEqualKeys();
+        std::cout << "[PASS] equal descriptions build equal keys\n";
+        TestKeyCapturesPipelineState();
+        std::cout << "[PASS] formats, state and constants change the key\n";
+        TestRaytracingGroupLayoutIsPartOfKey();
+        std::cout << "[PASS] shader group layout and kind change the key\n";
+        TestOversizedDescriptionThrows();
+        std::cout << "[PASS] oversized descriptions are rejected\n";
+        TestTableGrowsAndFindsEveryKey();
+        std::cout << "[PASS] open-addressing table grows and finds keys\n";
+        TestTakeKeepsProbeRunsIntact();
+        std::cout << "[PASS] removal keeps probe runs intact\n";
+        TestLookupIsAllocationFree();
+        std::cout << "[PASS] lookups across all pipeline kinds do not "
+                     "allocate\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
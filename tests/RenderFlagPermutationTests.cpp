@@ -0,0 +1,171 @@
+#include "Renderer/Backend/PipelineKey.h"
+#include "Renderer/Backend/RenderFlagPermutation.h"
+
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Mirrors the bit values of RenderFlags_* in ShaderCommon.h.
+constexpr uint32_t LightBit = 1u << 0;
+constexpr uint32_t ShadowBit = 1u << 1;
+constexpr uint32_t AOBit = 1u << 2;
+constexpr uint32_t GIBit = 1u << 4;
+constexpr uint32_t TAABit = 1u << 5;
+constexpr uint32_t IBLBit = 1u << 10;
+
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+    // CPU model of GetRenderFlags() in shaders/common/render_flags.glsl.
+uint32_t ResolveShaderFlags(const std::vector<uint32_t>& constants,
+                            uint32_t firstConstantID, uint32_t runtimeFlags)
+{
+    const uint32_t mask = constants[firstConstantID];
+    const uint32_t value = constants[firstConstantID + 1];
+    return (runtimeFlags & ~mask) | (value & mask);
+}
+
+Chimera::GraphicsPipelineDescription MakeForwardDesc()
+{
+    Chimera::GraphicsPipelineDescription desc;
+    desc.name = "Forward";
+    desc.vertex_shader = "forward.vert";
+    desc.fragment_shader = "forward.frag";
+    return desc;
+}
+
+void TestVariantIndexRoundTrip()
+{
+    const Chimera::RenderFlagPermutation permutation(LightBit | ShadowBit |
+                                                     IBLBit);
+    Require(permutation.GetVariantCount() == 8,
+            "three flags must give eight variants");
+
+    std::set<uint32_t> seen;
+    for (uint32_t index = 0; index < permutation.GetVariantCount(); ++index)
+    {
+        const uint32_t flags = permutation.GetVariantFlags(index);
+        Require((flags & ~permutation.GetStaticFlags()) == 0,
+                "variant flags must stay inside the mask");
+        Require(permutation.GetVariantIndex(flags) == index,
+                "variant index must round trip");
+        seen.insert(flags);
+    }
+    Require(seen.size() == 8, "every variant must have distinct flags");
+
+    Require(permutation.GetVariantIndex(LightBit | TAABit | AOBit) ==
+                permutation.GetVariantIndex(LightBit),
+            "flags outside the mask must not change the variant");
+}
+
+void TestVariantCountIsBounded()
+{
+    const uint32_t tooMany = LightBit | ShadowBit | AOBit | GIBit | IBLBit;
+    bool threw = false;
+    try
+    {
+        Chimera::RenderFlagPermutation permutation(tooMany);
+    }
+    catch (const std::invalid_argument&)
+    {
+        threw = true;
+    }
+    Require(threw, "more than MaxStaticFlags flags must be rejected");
+
+    const Chimera::RenderFlagPermutation empty(0);
+    Require(empty.GetVariantCount() == 1,
+            "an empty mask must have a single variant");
+}
+
+void TestConstantsResolveFlags()
+{
+    const uint32_t firstConstantID = 3;
+    const Chimera::RenderFlagPermutation permutation(LightBit | ShadowBit,
+                                                     firstConstantID);
+
+    std::vector<uint32_t> constants = {7, 8};
+    permutation.Apply(LightBit | TAABit, constants);
+    Require(constants.size() == firstConstantID + 2,
+            "constants must grow to hold mask and value");
+    Require(constants[0] == 7 && constants[1] == 8 && constants[2] == 0,
+            "unrelated constants must be preserved");
+
+        // Baked flags win over the runtime word; the rest pass through.
+    const uint32_t runtime = ShadowBit | GIBit;
+    Require(ResolveShaderFlags(constants, firstConstantID, runtime) ==
+                (LightBit | GIBit),
+            "baked flags must override runtime flags");
+
+    permutation.ApplyDynamic(constants);
+    Require(ResolveShaderFlags(constants, firstConstantID, runtime) ==
+                runtime,
+            "the dynamic variant must use runtime flags unchanged");
+}
+
+void TestVariantsHaveDistinctPipelineKeys()
+{
+    const Chimera::RenderFlagPermutation permutation(LightBit | ShadowBit |
+                                                     IBLBit);
+    const auto desc = MakeForwardDesc();
+    const std::vector<VkFormat> colorFormats = {
+        VK_FORMAT_R16G16B16A16_SFLOAT};
+
+    Chimera::ShaderIDTable shaderIDs;
+    std::vector<Chimera::PipelineKey> keys;
+    for (uint32_t index = 0; index < permutation.GetVariantCount(); ++index)
+    {
+        const auto variant =
+            permutation.Select(desc, permutation.GetVariantFlags(index));
+        keys.push_back(Chimera::MakeGraphicsPipelineKey(
+            shaderIDs, colorFormats, VK_FORMAT_D32_SFLOAT, variant));
+    }
+    keys.push_back(Chimera::MakeGraphicsPipelineKey(
+        shaderIDs, colorFormats, VK_FORMAT_D32_SFLOAT,
+        permutation.SelectDynamic(desc)));
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        for (size_t j = i + 1; j < keys.size(); ++j)
+        {
+            Require(keys[i] != keys[j],
+                    "each variant must map to its own pipeline");
+        }
+    }
+
+        // Toggling a flag outside the mask must reuse the same pipeline.
+    Require(Chimera::MakeGraphicsPipelineKey(
+                shaderIDs, colorFormats, VK_FORMAT_D32_SFLOAT,
+                permutation.Select(desc, LightBit)) ==
+                Chimera::MakeGraphicsPipelineKey(
+                    shaderIDs, colorFormats, VK_FORMAT_D32_SFLOAT,
+                    permutation.Select(desc, LightBit | TAABit | GIBit)),
+            "unbaked flags must not create new variants");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestVariantIndexRoundTrip();
+        std::cout << "[PASS] variant index round trip\n";
+        TestVariantCountIsBounded();
+        std::cout << "[PASS] variant count is bounded\n";
+        TestConstantsResolveFlags();
+        std::cout << "[PASS] specialization constants resolve flags\n";
+        TestVariantsHaveDistinctPipelineKeys();
+        std::cout << "[PASS] variants map to distinct pipeline keys\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -7,12 +7,14 @@
 #include "Renderer/Passes/RTShadowPass.h"
 #include "Renderer/Passes/TAAPass.h"
 #include "Renderer/Passes/SVGFPass.h"
+#include "Utils/VulkanBarrier.h"
 
 #include <array>
 #include <exception>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace
 {
@@ -881,6 +883,104 @@ void TestDuplicateHistoryProducersAreRejected()
             "Compile accepted multiple producers for one history resource");
 }
 
+void TestCompileOnlyProfileReportsLifetimesAndBarriers()
+{
+    Chimera::RenderGraph graph(1280, 720);
+
+    AddWriter(graph, "WriterA");
+    AddReader(graph, "ReaderA");
+    AddReader(graph, "ReaderB");
+
+    graph.AddPassRaw<EmptyPassData>(
+        "HistoryWriter",
+        [](EmptyPassData&, Chimera::RenderGraph::PassBuilder& builder)
+        {
+            builder.Write("HistorySource")
+                .Format(VK_FORMAT_R16G16B16A16_SFLOAT)
+                .SaveAsHistory("ProfileHistory");
+        },
+        [](const EmptyPassData&, Chimera::RenderGraphRegistry&,
+           VkCommandBuffer) {});
+
+    graph.Compile();
+
+    const Chimera::RenderGraphProfile profile = graph.BuildProfile();
+
+    Require(!profile.hasTimings,
+            "compile-only graph must not report GPU timings");
+    Require(profile.passes.size() == 4, "profile must contain every pass");
+
+    for (const auto& pass : profile.passes)
+    {
+        Require(pass.gpuDurationMS == 0.0f && pass.cpuDurationMS == 0.0f,
+                "compile-only pass timings must be zeroed");
+    }
+
+    Require(profile.passes[0].layer == 0 && profile.passes[3].layer == 0,
+            "independent writers must share layer 0");
+    Require(profile.passes[1].layer == 1 && profile.passes[2].layer == 1,
+            "readers must be reported in layer 1");
+
+    Require(profile.passes[0].barrierCount == 1,
+            "first write must transition from UNDEFINED");
+    Require(profile.passes[1].barrierCount == 1,
+            "first read must transition the attachment to shader read");
+    Require(profile.passes[2].barrierCount == 0,
+            "second read in the same state must not add a barrier");
+    Require(profile.barrierCount == 3,
+            "total barrier count must sum the per-pass counts");
+    Require(profile.historyCopyCount == 1,
+            "history producer must be reported as one history copy");
+
+    Require(profile.resources.size() == 2,
+            "profile must contain every declared resource");
+
+    const auto& shared = profile.resources[0];
+    Require(shared.name == "SharedImage" && shared.firstPass == 0 &&
+                shared.lastPass == 2,
+            "lifetime must span from the writer to the last reader");
+    Require(shared.sizeBytes == 1280ull * 720ull * 4ull,
+            "RGBA8 size must be width * height * 4 bytes");
+
+    const auto& history = profile.resources[1];
+    Require(history.sizeBytes == 1280ull * 720ull * 8ull,
+            "RGBA16F size must be width * height * 8 bytes");
+    // ReSTIR reservoirs and packed integer targets count toward memory too
+    Require(Chimera::VulkanUtils::GetFormatTexelSize(
+                VK_FORMAT_R32G32B32A32_UINT) == 16 &&
+                Chimera::VulkanUtils::GetFormatTexelSize(
+                    VK_FORMAT_R32G32_UINT) == 8,
+            "integer graph formats must have a texel size");
+    // Execution runs layer 0 (WriterA, HistoryWriter) before the readers,
+    // so SharedImage is still live while HistoryWriter runs
+    Require(profile.executionOrder ==
+                std::vector<uint32_t>({0u, 3u, 1u, 2u}),
+            "execution order must walk the layers");
+    Require(profile.passes[3].position == 1 &&
+                profile.passes[1].position == 2,
+            "pass positions must follow the execution order");
+    Require(profile.peakMemoryBytes == shared.sizeBytes + history.sizeBytes,
+            "peak memory must be the largest live set in execution order");
+
+    const std::string json = graph.ExportToJson();
+    Require(json.find("\"name\": \"ReaderB\"") != std::string::npos,
+            "JSON export must contain pass names");
+    Require(json.find("VK_FORMAT_R16G16B16A16_SFLOAT") != std::string::npos,
+            "JSON export must contain resource formats");
+    Require(json.find("\"historyCopyCount\": 1") != std::string::npos,
+            "JSON export must contain the history copy count");
+    Require(json.find("\"peakMemoryBytes\": " +
+                      std::to_string(profile.peakMemoryBytes)) !=
+                std::string::npos,
+            "JSON export must contain the peak live memory");
+
+    const std::string trace = graph.ExportToChromeTrace();
+    Require(trace.find("\"traceEvents\"") != std::string::npos,
+            "Chrome trace must contain a traceEvents array");
+    Require(trace.find("Live Graph Memory") != std::string::npos,
+            "Chrome trace must contain the live memory counter");
+}
+
 void TestPhysicalImageUsageContract()
 {
     using Chimera::ResourceUsage;
@@ -1113,6 +1213,9 @@ int main()
         TestPhysicalImageUsageContract();
         std::cout << "[PASS] physical image usage contract is enforced\n";
 
+        TestCompileOnlyProfileReportsLifetimesAndBarriers();
+        std::cout << "[PASS] compile-only profile reports lifetimes and barriers\n";
+
         TestNamedDescriptorResolutionIgnoresRequestOrder();
         std::cout << "[PASS] named descriptor resolution ignores request order\n";
 
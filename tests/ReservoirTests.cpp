@@ -0,0 +1,196 @@
+#include "Renderer/Resources/Reservoir.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+    // A discrete domain standing in for points on lights: f is what a
+    // pixel integrates, the source pdf is what candidates are drawn from
+    // and the target is an approximation of f, as p-hat is in restir.glsl.
+struct Domain
+{
+    std::vector<float> f = {0.5f, 4.0f, 0.0f, 2.0f, 8.0f, 1.0f, 0.25f, 3.0f};
+    std::vector<float> source = {0.3f, 0.05f, 0.1f, 0.2f,
+                                 0.05f, 0.1f, 0.1f, 0.1f};
+
+    float Target(uint32_t x) const
+    {
+        // Close to f but not proportional to it, and zero where f is
+        return f[x] > 0.0f ? std::sqrt(f[x]) + 0.5f : 0.0f;
+    }
+    double Integral() const
+    {
+        double sum = 0.0;
+        for (float value : f) sum += value;
+        return sum;
+    }
+};
+
+uint32_t DrawSource(const Domain& domain, float random)
+{
+    float cumulative = 0.0f;
+    for (uint32_t x = 0; x < domain.source.size(); ++x)
+    {
+        cumulative += domain.source[x];
+        if (random < cumulative) return x;
+    }
+    return (uint32_t)domain.source.size() - 1;
+}
+
+    // A pixel's initial reservoir from count candidates.
+Chimera::Reservoir Initial(const Domain& domain, uint32_t count,
+                           std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    Chimera::Reservoir reservoir;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t x = DrawSource(domain, uniform(rng));
+        reservoir.Update(x, domain.Target(x) / domain.source[x], 1.0f,
+                         uniform(rng));
+    }
+    reservoir.Finalize(domain.Target(reservoir.sample));
+    return reservoir;
+}
+
+double Estimate(const Domain& domain, const Chimera::Reservoir& reservoir)
+{
+    return reservoir.IsValid() ? domain.f[reservoir.sample] * reservoir.W
+                               : 0.0;
+}
+
+void TestInitialIsUnbiased()
+{
+    const Domain domain;
+    std::mt19937 rng(3);
+    const uint32_t trials = 400000;
+    for (uint32_t count : {1u, 4u, 32u})
+    {
+        double sum = 0.0;
+        for (uint32_t t = 0; t < trials; ++t)
+            sum += Estimate(domain, Initial(domain, count, rng));
+        const double mean = sum / trials;
+        Require(std::abs(mean - domain.Integral()) < 0.01 * domain.Integral(),
+                "f(y) W must average to the integral for " +
+                    std::to_string(count) + " candidates");
+    }
+}
+
+void TestSelectionFollowsWeights()
+{
+    // Three candidates weighing 1, 2 and 5 are kept an eighth, a quarter
+    // and five eighths of the time
+    const float weights[3] = {1.0f, 2.0f, 5.0f};
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    const uint32_t trials = 200000;
+    uint32_t histogram[3] = {0, 0, 0};
+    for (uint32_t t = 0; t < trials; ++t)
+    {
+        Chimera::Reservoir reservoir;
+        for (uint32_t i = 0; i < 3; ++i)
+            reservoir.Update(i, weights[i], 1.0f, uniform(rng));
+        ++histogram[reservoir.sample];
+    }
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        const double expected = weights[i] / 8.0;
+        Require(std::abs(histogram[i] / double(trials) - expected) < 0.005,
+                "candidates must be kept in proportion to their weight");
+    }
+}
+
+void TestMergeIsUnbiased()
+{
+    // Temporal and spatial reuse merge reservoirs built for the same
+    // target; the history is clamped to a multiple of the new candidates
+    // as restir_di.rgen does
+    const Domain domain;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    const uint32_t trials = 200000;
+    double sum = 0.0, sumSquared = 0.0, initialSquared = 0.0;
+    for (uint32_t t = 0; t < trials; ++t)
+    {
+        const Chimera::Reservoir current = Initial(domain, 4, rng);
+        Chimera::Reservoir history = Initial(domain, 64, rng);
+        history.ClampM(20.0f * current.M);
+
+        Chimera::Reservoir merged;
+        merged.Merge(current, domain.Target(current.sample), uniform(rng));
+        merged.Merge(history, domain.Target(history.sample), uniform(rng));
+        merged.Finalize(domain.Target(merged.sample));
+        Require(merged.M == current.M + history.M,
+                "a merge must add up the candidates of both reservoirs");
+
+        const double estimate = Estimate(domain, merged);
+        sum += estimate;
+        sumSquared += estimate * estimate;
+        const double initial = Estimate(domain, current);
+        initialSquared += initial * initial;
+    }
+    const double mean = sum / trials;
+    Require(std::abs(mean - domain.Integral()) < 0.01 * domain.Integral(),
+            "merged reservoirs must stay unbiased");
+    const double integralSquared = domain.Integral() * domain.Integral();
+    Require(sumSquared / trials - integralSquared <
+                0.5 * (initialSquared / trials - integralSquared),
+            "reuse must at least halve the variance of four candidates");
+}
+
+void TestEdgeCases()
+{
+    Chimera::Reservoir reservoir;
+    reservoir.Update(1, 0.0f, 1.0f, 0.0f);
+    reservoir.Update(2, std::nanf(""), 1.0f, 0.0f);
+    reservoir.Update(3, -1.0f, 1.0f, 0.0f);
+    reservoir.Finalize(1.0f);
+    Require(!reservoir.IsValid() && reservoir.M == 3.0f,
+            "candidates without weight count but are never kept");
+
+    reservoir.Update(4, 2.0f, 1.0f, 0.999f);
+    Require(reservoir.sample == 4, "the first live candidate is always kept");
+    reservoir.Finalize(0.0f);
+    Require(!reservoir.IsValid(),
+            "a sample without target density has no weight");
+    reservoir.Finalize(0.5f);
+    Require(std::abs(reservoir.W - 1.0f) < 1e-6f,
+            "W is the weight sum over M times the target density");
+
+    reservoir.ClampM(2.0f);
+    reservoir.Finalize(0.5f);
+    Require(reservoir.M == 2.0f && std::abs(reservoir.W - 1.0f) < 1e-6f,
+            "clamping M must keep W");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestInitialIsUnbiased();
+        std::cout << "[PASS] initial candidates are unbiased\n";
+        TestSelectionFollowsWeights();
+        std::cout << "[PASS] selection follows weights\n";
+        TestMergeIsUnbiased();
+        std::cout << "[PASS] merged reservoirs are unbiased\n";
+        TestEdgeCases();
+        std::cout << "[PASS] edge cases\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -1,4 +1,5 @@
 #include "Renderer/Backend/ShaderCommon.h"
+#include "Renderer/Resources/ClusteredLights.h"
 
 #include <cmath>
 #include <cstddef>
@@ -32,7 +33,9 @@ static_assert(offsetof(UniformBufferObject, envData) == 640);
 static_assert(offsetof(UniformBufferObject, svgfAlpha) == 656);
 static_assert(offsetof(UniformBufferObject, svgfPhi) == 672);
 static_assert(offsetof(UniformBufferObject, gpuClearColor) == 688);
-static_assert(sizeof(UniformBufferObject) == 704);
+static_assert(offsetof(UniformBufferObject, envIrradianceSH) == 704);
+static_assert(offsetof(UniformBufferObject, clusterData) == 848);
+static_assert(sizeof(UniformBufferObject) == 864);
 
 static_assert(offsetof(GpuMaterial, roughness) == 12);
 static_assert(offsetof(GpuMaterial, colour) == 16);
@@ -63,6 +66,13 @@ static_assert(offsetof(GpuInstance, vertexAddress) == 240);
 static_assert(offsetof(GpuInstance, indexAddress) == 248);
 static_assert(offsetof(GpuInstance, prevTransform) == 256);
 static_assert(sizeof(GpuInstance) == 320);
+static_assert(offsetof(GpuPunctualLight, colorIntensity) == 16);
+static_assert(offsetof(GpuPunctualLight, directionType) == 32);
+static_assert(offsetof(GpuPunctualLight, spotCos) == 48);
+static_assert(ClusterGrid{}.x == CLUSTER_GRID_X &&
+              ClusterGrid{}.y == CLUSTER_GRID_Y &&
+              ClusterGrid{}.z == CLUSTER_GRID_Z &&
+              ClusterGrid{}.maxLightsPerCluster == CLUSTER_MAX_LIGHTS);
 static_assert(static_cast<uint32_t>(DisplayMode::TAAHistory) == 12);
 static_assert(RenderFlags_TAAHighQualityBit == (1u << 12));
 static_assert(RenderFlags_ManualOutputSrgbBit == (1u << 13));
@@ -0,0 +1,217 @@
+#include "Renderer/Backend/ShaderArchive.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace fs = std::filesystem;
+
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+template <typename F>
+bool Throws(F&& func)
+{
+    try
+    {
+        func();
+    }
+    catch (const std::runtime_error&)
+    {
+        return true;
+    }
+    return false;
+}
+
+    // The archive never parses SPIR-V, so numbered words are enough.
+Chimera::ShaderArchiveInput MakeInput(const std::string& name, uint32_t seed,
+                                      size_t words)
+{
+    Chimera::ShaderArchiveInput input;
+    input.name = name;
+    input.spirv.push_back(0x07230203);
+    for (size_t i = 1; i < words; ++i)
+    {
+        input.spirv.push_back(seed * 1000 + (uint32_t)i);
+    }
+    input.reflection.assign(name.size() % 7 + 1, (uint8_t)seed);
+    return input;
+}
+
+std::vector<Chimera::ShaderArchiveInput> MakeInputs()
+{
+    return {MakeInput("postprocess/taa.comp", 1, 64),
+            MakeInput("forward/forward.vert", 2, 33),
+            MakeInput("forward/forward.frag", 3, 17),
+            MakeInput("raytracing/raygen.rgen", 4, 128)};
+}
+
+void TestLookup()
+{
+    const auto inputs = MakeInputs();
+    const auto archive =
+        Chimera::ShaderArchive::FromMemory(Chimera::BuildShaderArchive(inputs));
+
+    Require(archive->GetEntries().size() == inputs.size(),
+            "every input must be indexed");
+    for (size_t i = 1; i < archive->GetEntries().size(); ++i)
+    {
+        Require(archive->GetEntries()[i - 1].name <
+                    archive->GetEntries()[i].name,
+                "the index must be sorted by name");
+    }
+
+    for (const auto& input : inputs)
+    {
+        const auto* entry = archive->Find(input.name);
+        Require(entry != nullptr, "missing entry for " + input.name);
+        Require(entry->name == input.name, "entry name mismatch");
+        Require(std::vector<uint32_t>(entry->spirv.begin(),
+                                      entry->spirv.end()) == input.spirv,
+                "bytecode mismatch for " + input.name);
+        Require(std::vector<uint8_t>(entry->reflection.begin(),
+                                     entry->reflection.end()) ==
+                    input.reflection,
+                "reflection mismatch for " + input.name);
+        Require(reinterpret_cast<uintptr_t>(entry->spirv.data()) % 4 == 0,
+                "bytecode must be 4-byte aligned");
+    }
+
+    Require(archive->Find("forward/forward") == nullptr,
+            "a prefix must not match");
+    Require(archive->Find("zzz.comp") == nullptr, "unknown names miss");
+    Require(archive->Find("") == nullptr, "an empty name misses");
+}
+
+void TestRejectsBadArchives()
+{
+    auto inputs = MakeInputs();
+    inputs.push_back(MakeInput("forward/forward.vert", 9, 4));
+    Require(Throws([&] { Chimera::BuildShaderArchive(inputs); }),
+            "duplicate names must be rejected");
+
+    const auto data = Chimera::BuildShaderArchive(MakeInputs());
+    Require(Throws([&] { Chimera::ShaderArchive::FromMemory({}); }),
+            "empty data must be rejected");
+
+    auto truncated = data;
+    truncated.pop_back();
+    Require(Throws([&]
+                   { Chimera::ShaderArchive::FromMemory(truncated); }),
+            "a truncated archive must be rejected");
+
+    auto badMagic = data;
+    badMagic[0] ^= 0xFF;
+    Require(Throws([&] { Chimera::ShaderArchive::FromMemory(badMagic); }),
+            "a wrong magic number must be rejected");
+
+        // Point the first entry's bytecode past the end of the file.
+    auto badOffset = data;
+    const uint32_t outOfRange = (uint32_t)data.size();
+    std::memcpy(badOffset.data() + 16 + 8, &outOfRange, sizeof(outOfRange));
+    Require(Throws([&] { Chimera::ShaderArchive::FromMemory(badOffset); }),
+            "out-of-range offsets must be rejected");
+}
+
+    // Startup comparison for a shader set the size of Chimera/shaders: the
+    // old per-file path (exists, absolute, open, read) against mapping one
+    // archive and looking every shader up in its index.
+void TestMappedArchiveStartup()
+{
+    const fs::path root =
+        fs::temp_directory_path() / "ChimeraShaderArchiveTests";
+    fs::remove_all(root);
+    fs::create_directories(root);
+
+    std::vector<Chimera::ShaderArchiveInput> inputs;
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        inputs.push_back(MakeInput("pass" + std::to_string(i) + ".comp", i,
+                                   2048 + i * 16));
+        std::ofstream file(root / (inputs.back().name + ".spv"),
+                           std::ios::binary);
+        file.write(reinterpret_cast<const char*>(inputs.back().spirv.data()),
+                   inputs.back().spirv.size() * sizeof(uint32_t));
+    }
+    {
+        const auto data = Chimera::BuildShaderArchive(inputs);
+        std::ofstream file(root / Chimera::ShaderArchiveFileName,
+                           std::ios::binary);
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    size_t looseWords = 0;
+    for (const auto& input : inputs)
+    {
+        fs::path path = root / (input.name + ".spv");
+        Require(fs::exists(path), "loose shader missing");
+        path = fs::absolute(path);
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+        std::vector<uint32_t> spirv((size_t)file.tellg() / 4);
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(spirv.data()), spirv.size() * 4);
+        looseWords += spirv.size();
+    }
+    const auto looseTime = Clock::now() - start;
+
+    start = Clock::now();
+    size_t archiveWords = 0;
+    {
+        const auto archive = Chimera::ShaderArchive::Open(
+            root / Chimera::ShaderArchiveFileName);
+        for (const auto& input : inputs)
+        {
+            const auto* entry = archive->Find(input.name);
+            Require(entry != nullptr, "mapped archive is missing a shader");
+            archiveWords += entry->spirv.size();
+        }
+        const auto archiveTime = Clock::now() - start;
+
+        Require(looseWords == archiveWords,
+                "archive and loose files must hold the same bytecode");
+        const auto* last = archive->Find(inputs.back().name);
+        Require(std::equal(last->spirv.begin(), last->spirv.end(),
+                           inputs.back().spirv.begin()),
+                "mapped bytecode must match the input");
+
+        const auto ms = [](Clock::duration d)
+        { return std::chrono::duration<double, std::milli>(d).count(); };
+        std::cout << "  " << inputs.size() << " shaders: loose files "
+                  << ms(looseTime) << " ms, mapped archive "
+                  << ms(archiveTime) << " ms\n";
+    }
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestLookup();
+        std::cout << "[PASS] archive index lookup\n";
+        TestRejectsBadArchives();
+        std::cout << "[PASS] malformed archives are rejected\n";
+        TestMappedArchiveStartup();
+        std::cout << "[PASS] mapped archive matches loose shaders\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
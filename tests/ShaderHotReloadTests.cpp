@@ -0,0 +1,214 @@
+#include "Renderer/Backend/ShaderHotReload.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace fs = std::filesystem;
+
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+void WriteFile(const fs::path& path, const std::string& contents)
+{
+    fs::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+    // Mirrors Chimera/shaders: stage files include common/common.glsl by a
+    // relative path, and common.glsl and taa.comp pull ShaderCommon.h from
+    // the backend include directory.
+struct ShaderTree
+{
+    fs::path root;
+    fs::path shaders;
+    fs::path backend;
+
+    ShaderTree()
+    {
+        root = fs::temp_directory_path() / "ChimeraShaderHotReloadTests";
+        fs::remove_all(root);
+        shaders = root / "shaders";
+        backend = root / "backend";
+
+        WriteFile(backend / "ShaderCommon.h", "#define MAX_LIGHTS 16\n");
+        WriteFile(shaders / "common" / "common.glsl",
+                  "#include \"ShaderCommon.h\"\nvec3 Shade();\n");
+        WriteFile(shaders / "common" / "pbr.glsl", "float D_GGX();\n");
+        WriteFile(shaders / "postprocess" / "svgf" / "atrous.comp",
+                  "#version 460\n#include \"../../common/common.glsl\"\n");
+        WriteFile(shaders / "postprocess" / "taa.comp",
+                  "#version 460\n#include \"ShaderCommon.h\"\n");
+        WriteFile(shaders / "forward" / "forward.frag",
+                  "#version 460\n"
+                  "#include \"../common/common.glsl\"\n"
+                  "#include \"../common/pbr.glsl\"\n");
+        WriteFile(shaders / "postprocess" / "linearize_depth.frag",
+                  "#version 460\n// #include \"../common/pbr.glsl\"\n");
+    }
+
+    ~ShaderTree()
+    {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+
+    Chimera::ShaderDependencyGraph Scan() const
+    {
+        Chimera::ShaderDependencyGraph graph;
+        graph.SetIncludeDirectories({backend, shaders / "common", shaders});
+        graph.ScanDirectory(shaders);
+        return graph;
+    }
+};
+
+std::vector<std::string> FileNames(const std::vector<fs::path>& paths)
+{
+    std::vector<std::string> names;
+    for (const auto& path : paths)
+    {
+        names.push_back(path.filename().string());
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+void TestParseIncludesSkipsComments()
+{
+    const auto includes = Chimera::ParseShaderIncludes(
+        "#version 460\n"
+        "#include \"a.glsl\"\n"
+        "  #  include <b.glsl>\n"
+        "// #include \"commented.glsl\"\n"
+        "/* #include \"block.glsl\"\n"
+        "   #include \"block2.glsl\" */\n"
+        "#define INCLUDE_ME 1\n"
+        "#include \"c.glsl\" // trailing\n");
+
+    Require(includes == std::vector<std::string>{"a.glsl", "b.glsl", "c.glsl"},
+            "only live #include directives must be reported");
+}
+
+void TestHeaderChangeRebuildsOnlyDependents()
+{
+    ShaderTree tree;
+    const auto graph = tree.Scan();
+
+    Require(FileNames(graph.GetShaderFiles()) ==
+                std::vector<std::string>{"atrous.comp", "forward.frag",
+                                         "linearize_depth.frag", "taa.comp"},
+            "scan must find every stage file");
+
+    Require(FileNames(graph.GetAffectedShaders(
+                {tree.backend / "ShaderCommon.h"})) ==
+                std::vector<std::string>{"atrous.comp", "forward.frag",
+                                         "taa.comp"},
+            "ShaderCommon.h must rebuild direct and transitive includers");
+
+    Require(FileNames(graph.GetAffectedShaders(
+                {tree.shaders / "common" / "common.glsl"})) ==
+                std::vector<std::string>{"atrous.comp", "forward.frag"},
+            "common.glsl must not rebuild shaders that skip it");
+
+    Require(FileNames(graph.GetAffectedShaders(
+                {tree.shaders / "common" / "pbr.glsl"})) ==
+                std::vector<std::string>{"forward.frag"},
+            "a commented-out include must not create a dependency");
+
+    Require(FileNames(graph.GetAffectedShaders(
+                {tree.shaders / "postprocess" / "svgf" / "atrous.comp"})) ==
+                std::vector<std::string>{"atrous.comp"},
+            "editing a stage file must rebuild only that file");
+}
+
+void TestRescanUpdatesEdges()
+{
+    ShaderTree tree;
+    auto graph = tree.Scan();
+
+    const fs::path taa = tree.shaders / "postprocess" / "taa.comp";
+    WriteFile(taa, "#version 460\n#include \"../common/pbr.glsl\"\n");
+    graph.ScanFile(taa);
+
+    Require(FileNames(graph.GetAffectedShaders(
+                {tree.backend / "ShaderCommon.h"})) ==
+                std::vector<std::string>{"atrous.comp", "forward.frag"},
+            "a removed include must stop propagating changes");
+    Require(FileNames(graph.GetAffectedShaders(
+                {tree.shaders / "common" / "pbr.glsl"})) ==
+                std::vector<std::string>{"forward.frag", "taa.comp"},
+            "an added include must start propagating changes");
+}
+
+void TestIncludeCycleTerminates()
+{
+    ShaderTree tree;
+    WriteFile(tree.shaders / "common" / "a.glsl", "#include \"b.glsl\"\n");
+    WriteFile(tree.shaders / "common" / "b.glsl", "#include \"a.glsl\"\n");
+    WriteFile(tree.shaders / "cycle.frag", "#include \"common/a.glsl\"\n");
+
+    const auto graph = tree.Scan();
+    Require(FileNames(graph.GetAffectedShaders(
+                {tree.shaders / "common" / "b.glsl"})) ==
+                std::vector<std::string>{"cycle.frag"},
+            "include cycles must not loop forever");
+}
+
+void TestWatcherReportsModifiedFiles()
+{
+    ShaderTree tree;
+    const auto graph = tree.Scan();
+
+    Chimera::ShaderFileWatcher watcher;
+    for (const auto& file : graph.GetFiles())
+    {
+        watcher.Watch(file);
+    }
+    Require(watcher.Poll().empty(), "unchanged files must not be reported");
+
+    const fs::path header = tree.backend / "ShaderCommon.h";
+    fs::last_write_time(header,
+                        fs::last_write_time(header) + std::chrono::seconds(2));
+    const auto changed = watcher.Poll();
+    Require(FileNames(changed) == std::vector<std::string>{"ShaderCommon.h"},
+            "a touched header must be reported once");
+    Require(watcher.Poll().empty(), "a change must not be reported twice");
+
+    fs::remove(tree.shaders / "common" / "pbr.glsl");
+    Require(FileNames(watcher.Poll()) == std::vector<std::string>{"pbr.glsl"},
+            "a deleted file must be reported");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestParseIncludesSkipsComments();
+        std::cout << "[PASS] include parser skips comments\n";
+        TestHeaderChangeRebuildsOnlyDependents();
+        std::cout << "[PASS] header changes rebuild only dependent shaders\n";
+        TestRescanUpdatesEdges();
+        std::cout << "[PASS] rescanning a file updates its include edges\n";
+        TestIncludeCycleTerminates();
+        std::cout << "[PASS] include cycles terminate\n";
+        TestWatcherReportsModifiedFiles();
+        std::cout << "[PASS] watcher reports modified and deleted files\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,187 @@
+#include "Renderer/Backend/ShaderReflection.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+namespace fs = std::filesystem;
+using Chimera::ShaderReflectionLoadStatus;
+
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+std::vector<uint8_t> ReadBytes(const fs::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()};
+}
+
+std::vector<uint32_t> ReadSpirv(const fs::path& path)
+{
+    const auto bytes = ReadBytes(path);
+    std::vector<uint32_t> spirv(bytes.size() / sizeof(uint32_t));
+    std::copy(bytes.begin(), bytes.begin() + spirv.size() * sizeof(uint32_t),
+              reinterpret_cast<uint8_t*>(spirv.data()));
+    return spirv;
+}
+
+    // Serialization never parses the bytecode, so arbitrary words stand in
+    // for a module here.
+const std::vector<uint32_t> FakeSpirv = {0x07230203, 0x00010600, 1, 2, 3};
+
+Chimera::ShaderReflectionData MakeReflection()
+{
+    Chimera::ShaderReflectionData reflection;
+    reflection.bindings = {
+        {"u_Camera", 0, 0, 6, 1},        // uniform buffer
+        {"u_Textures", 1, 0, 1, 4096},   // combined image sampler array
+        {"u_Output", 2, 3, 3, 1},        // storage image
+    };
+    reflection.pushConstantOffset = 0;
+    reflection.pushConstantSize = 128;
+    reflection.pushConstantStages = 0x10 | 0x20;
+    return reflection;
+}
+
+void TestRoundTrip()
+{
+    const auto reflection = MakeReflection();
+    const auto fileData =
+        Chimera::SerializeShaderReflection(reflection, FakeSpirv);
+
+    Chimera::ShaderReflectionData loaded;
+    Require(Chimera::DeserializeShaderReflection(fileData, FakeSpirv,
+                                                 loaded) ==
+                ShaderReflectionLoadStatus::Loaded,
+            "a fresh sidecar must load");
+    Require(loaded == reflection, "a loaded sidecar must match its source");
+}
+
+void TestChangedBytecodeIsStale()
+{
+    const auto fileData =
+        Chimera::SerializeShaderReflection(MakeReflection(), FakeSpirv);
+
+    auto rebuilt = FakeSpirv;
+    rebuilt.back() ^= 1;
+    Chimera::ShaderReflectionData loaded;
+    Require(Chimera::DeserializeShaderReflection(fileData, rebuilt, loaded) ==
+                ShaderReflectionLoadStatus::Stale,
+            "a sidecar for other bytecode must be stale");
+    Require(loaded.bindings.empty(), "a rejected sidecar must not fill out");
+}
+
+void TestDamagedSidecarIsCorrupt()
+{
+    const auto fileData =
+        Chimera::SerializeShaderReflection(MakeReflection(), FakeSpirv);
+    Chimera::ShaderReflectionData loaded;
+
+    Require(Chimera::DeserializeShaderReflection({}, FakeSpirv, loaded) ==
+                ShaderReflectionLoadStatus::Missing,
+            "an empty sidecar must count as missing");
+
+    for (size_t size : {size_t(7), size_t(32), fileData.size() - 1})
+    {
+        const std::vector<uint8_t> truncated(fileData.begin(),
+                                             fileData.begin() + size);
+        Require(Chimera::DeserializeShaderReflection(truncated, FakeSpirv,
+                                                     loaded) ==
+                    ShaderReflectionLoadStatus::Corrupt,
+                "a truncated sidecar must be corrupt");
+    }
+
+    auto padded = fileData;
+    padded.push_back(0);
+    Require(Chimera::DeserializeShaderReflection(padded, FakeSpirv, loaded) ==
+                ShaderReflectionLoadStatus::Corrupt,
+            "trailing bytes must be rejected");
+
+    auto badMagic = fileData;
+    badMagic[0] ^= 0xFF;
+    Require(Chimera::DeserializeShaderReflection(badMagic, FakeSpirv,
+                                                 loaded) ==
+                ShaderReflectionLoadStatus::Corrupt,
+            "a wrong magic number must be rejected");
+}
+
+    // Startup cost over every shader the build produced: runtime reflection
+    // versus loading the sidecar written by ChimeraShaderReflect.
+void TestCompiledShaderSidecars()
+{
+    const fs::path dir = CHIMERA_SHADER_BINARY_DIR;
+    Require(fs::is_directory(dir), "compiled shader directory is missing: " +
+                                       dir.string());
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration reflectTime{};
+    Clock::duration loadTime{};
+    size_t shaderCount = 0;
+
+    for (const auto& entry : fs::recursive_directory_iterator(dir))
+    {
+        if (entry.path().extension() != ".spv") continue;
+
+        fs::path sidecarPath = entry.path();
+        sidecarPath += ".refl";
+        const auto spirv = ReadSpirv(entry.path());
+
+        auto start = Clock::now();
+        const auto reflected = Chimera::ReflectSpirv(spirv);
+        reflectTime += Clock::now() - start;
+
+        start = Clock::now();
+        const auto fileData = ReadBytes(sidecarPath);
+        Chimera::ShaderReflectionData loaded;
+        const auto status =
+            Chimera::DeserializeShaderReflection(fileData, spirv, loaded);
+        loadTime += Clock::now() - start;
+
+        Require(status == ShaderReflectionLoadStatus::Loaded,
+                entry.path().string() + ": sidecar is " +
+                    Chimera::ShaderReflectionLoadStatusToString(status));
+        Require(loaded == reflected,
+                entry.path().string() + ": sidecar differs from runtime "
+                                        "reflection");
+        ++shaderCount;
+    }
+    Require(shaderCount > 0, "no compiled shaders found in " + dir.string());
+
+    const auto ms = [](Clock::duration d)
+    { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << "  " << shaderCount << " shaders: spirv-reflect "
+              << ms(reflectTime) << " ms, sidecar load " << ms(loadTime)
+              << " ms\n";
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestRoundTrip();
+        std::cout << "[PASS] reflection sidecar round trip\n";
+        TestChangedBytecodeIsStale();
+        std::cout << "[PASS] sidecar for changed bytecode is stale\n";
+        TestDamagedSidecarIsCorrupt();
+        std::cout << "[PASS] damaged sidecars are rejected\n";
+        TestCompiledShaderSidecars();
+        std::cout << "[PASS] build sidecars match runtime reflection\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
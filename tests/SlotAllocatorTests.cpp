@@ -0,0 +1,112 @@
+#include "Renderer/Resources/SlotAllocator.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+void TestIndicesAreDenseAndVersioned()
+{
+    Chimera::SlotAllocator slots(3);
+    const auto a = slots.Allocate();
+    const auto b = slots.Allocate();
+    Require(a.index == 0 && b.index == 1, "indices must be handed out densely");
+    Require(a.generation != 0 && b.generation != 0,
+            "generation 0 is reserved for unversioned handles");
+    Require(slots.IsCurrent(a.index, a.generation), "a live slot is current");
+    Require(slots.IsCurrent(a.index, 0),
+            "unversioned handles resolve to the live occupant");
+    Require(slots.GetAliveCount() == 2, "both slots must be alive");
+}
+
+void TestReuseWaitsForFramesInFlight()
+{
+    Chimera::SlotAllocator slots(3);
+    const auto a = slots.Allocate();
+    slots.Allocate();
+    Require(slots.Free(a.index), "freeing a live slot must succeed");
+    Require(!slots.Free(a.index), "double frees must be rejected");
+    Require(!slots.IsCurrent(a.index, a.generation),
+            "a freed slot must not be current");
+    Require(!slots.IsCurrent(a.index, 0),
+            "unversioned handles to a freed slot must not resolve");
+
+    slots.AdvanceFrame();
+    slots.AdvanceFrame();
+    Require(slots.Allocate().index == 2,
+            "a slot must not be reused while frames may still bind it");
+
+    slots.AdvanceFrame();
+    const auto reused = slots.Allocate();
+    Require(reused.index == a.index,
+            "the slot must be reused once the frames in flight retired");
+    Require(reused.generation != a.generation,
+            "reuse must bump the generation");
+    Require(!slots.IsCurrent(a.index, a.generation),
+            "stale handles must not alias the new occupant");
+    Require(slots.IsCurrent(reused.index, reused.generation),
+            "the new handle must be current");
+}
+
+void TestLowestFreeIndexFirst()
+{
+    Chimera::SlotAllocator slots(0);
+    for (int i = 0; i < 8; ++i) slots.Allocate();
+    slots.Free(6);
+    slots.Free(2);
+    slots.Free(4);
+    Require(slots.Allocate().index == 2, "the lowest free index comes first");
+    Require(slots.Allocate().index == 4, "then the next lowest");
+    Require(slots.Allocate().index == 6, "then the last freed");
+    Require(slots.Allocate().index == 8, "then the array grows");
+}
+
+void TestChurnStaysBounded()
+{
+    Chimera::SlotAllocator slots(3);
+    uint32_t live[16];
+    for (auto& index : live) index = slots.Allocate().index;
+    for (int frame = 0; frame < 1000; ++frame)
+    {
+            // Replace a quarter of the resources every frame, like models
+            // streaming in and out.
+        for (int i = 0; i < 4; ++i)
+        {
+            uint32_t& index = live[(frame * 4 + i) % 16];
+            slots.Free(index);
+            index = slots.Allocate().index;
+        }
+        slots.AdvanceFrame();
+    }
+    Require(slots.GetAliveCount() == 16, "the live count must be stable");
+    Require(slots.GetSlotCount() <= 16 + 4 * 3,
+            "slot indices must stay bounded under churn");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestIndicesAreDenseAndVersioned();
+        std::cout << "[PASS] indices are dense and versioned\n";
+        TestReuseWaitsForFramesInFlight();
+        std::cout << "[PASS] reuse waits for frames in flight\n";
+        TestLowestFreeIndexFirst();
+        std::cout << "[PASS] lowest free index first\n";
+        TestChurnStaysBounded();
+        std::cout << "[PASS] churn stays bounded\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,197 @@
+#include "Renderer/Backend/StagingRing.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+void TestAllocationsAreAlignedAndDisjoint()
+{
+    Chimera::StagingRing ring(1024);
+    const auto a = ring.Allocate(10, 16);
+    const auto b = ring.Allocate(10, 16);
+    const auto c = ring.Allocate(3, 4);
+    Require(a && b && c, "small allocations must fit in an empty ring");
+    Require(*a == 0, "the first allocation must start at offset 0");
+    Require(*b == 16, "alignment must skip to the next 16-byte boundary");
+    Require(*c == 28, "4-byte alignment must follow the previous block");
+    Require(ring.GetUsed() == 31, "padding must count as used");
+}
+
+void TestFullRingRejectsUntilRetired()
+{
+    Chimera::StagingRing ring(256);
+    Require(ring.Allocate(200).has_value(), "first block must fit");
+    ring.Close(1);
+    Require(!ring.Allocate(100).has_value(),
+            "a block larger than the free space must be rejected");
+
+    ring.Retire(0);
+    Require(!ring.Allocate(100).has_value(),
+            "retiring an older token must not free a newer range");
+
+    ring.Retire(1);
+    Require(ring.GetUsed() == 0, "retiring the token must free its range");
+    Require(ring.Allocate(100).has_value(),
+            "space must be reusable once retired");
+}
+
+void TestWraparoundSkipsTail()
+{
+    Chimera::StagingRing ring(256);
+    Require(ring.Allocate(160) == 0u, "first block starts at 0");
+    ring.Close(1);
+    Require(ring.Allocate(64) == 160u, "second block follows the first");
+    ring.Close(2);
+    ring.Retire(1);
+
+        // 32 bytes remain before the end; a 64-byte block must restart at
+        // 0 rather than straddle the end.
+    const auto wrapped = ring.Allocate(64);
+    Require(wrapped == 0u, "a block must not straddle the end of the ring");
+    Require(ring.GetUsed() == 64 + 32 + 64,
+            "the skipped tail must stay used until retired");
+
+    ring.Close(3);
+    ring.Retire(3);
+    Require(ring.GetUsed() == 0, "every range must be free after retiring");
+}
+
+void TestWrappedBlockWaitsForOverlappingRange()
+{
+    Chimera::StagingRing ring(256);
+    ring.Allocate(64); // [0, 64)
+    ring.Close(1);
+    ring.Allocate(160); // [64, 224)
+    ring.Close(2);
+
+        // Only 32 bytes at the end and range 1 still occupies the start.
+    Require(!ring.Allocate(48).has_value(),
+            "a wrapped block must not overwrite a live range");
+    ring.Retire(1);
+    Require(ring.Allocate(48) == 0u,
+            "the wrapped block must fit once the start is retired");
+}
+
+void TestDrainedRingRestartsAtZero()
+{
+    Chimera::StagingRing ring(64);
+    Require(ring.Allocate(10) == 0u, "first block starts at 0");
+    ring.Close(1);
+    ring.Retire(1);
+
+        // The head sits at 10, so neither side of it holds 60 bytes; an
+        // empty ring must still take the block from offset 0.
+    Require(ring.Allocate(60) == 0u,
+            "a drained ring must fit any block up to its capacity");
+    Require(ring.GetUsed() == 60, "only the new block must count as used");
+    ring.Close(2);
+    ring.Retire(2);
+    Require(ring.Allocate(64) == 0u,
+            "a drained ring must fit a block of the full capacity");
+}
+
+void TestOversizedAndEmptyRequests()
+{
+    Chimera::StagingRing ring(128);
+    Require(!ring.Allocate(129).has_value(),
+            "blocks larger than the ring must never fit");
+    Require(!ring.Allocate(0).has_value(), "empty blocks are rejected");
+    Require(ring.Allocate(128) == 0u, "a block may use the whole ring");
+    Require(ring.HasOpenAllocations(),
+            "allocations must stay open until closed");
+    ring.Close(5);
+    Require(!ring.HasOpenAllocations(), "Close must tag open allocations");
+    Require(ring.GetOldestToken() == 5u, "the closed token must be tracked");
+
+    bool threw = false;
+    try
+    {
+        ring.Allocate(0);
+        ring.Close(4);
+    }
+    catch (const std::invalid_argument&)
+    {
+        threw = true;
+    }
+    Require(!threw, "closing with no open allocations must be a no-op");
+
+    ring.Retire(5);
+    ring.Allocate(8);
+    threw = false;
+    try
+    {
+        ring.Close(6);
+        ring.Allocate(8);
+        ring.Close(4);
+    }
+    catch (const std::invalid_argument&)
+    {
+        threw = true;
+    }
+    Require(threw, "tokens must not decrease");
+}
+
+void TestManyCyclesStayBounded()
+{
+    Chimera::StagingRing ring(4096);
+    uint64_t token = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        const uint64_t size = 1 + (i * 37) % 700;
+        auto offset = ring.Allocate(size, 16);
+        if (!offset)
+        {
+                // Simulate the GPU catching up with everything but the
+                // newest batch.
+            ring.Retire(token > 0 ? token - 1 : 0);
+            offset = ring.Allocate(size, 16);
+            if (!offset)
+            {
+                ring.Retire(token);
+                offset = ring.Allocate(size, 16);
+            }
+        }
+        Require(offset.has_value(), "allocation must succeed after retiring");
+        Require(*offset % 16 == 0, "offsets must stay aligned");
+        Require(*offset + size <= ring.GetCapacity(),
+                "blocks must stay inside the ring");
+        Require(ring.GetUsed() <= ring.GetCapacity(),
+                "used bytes must never exceed the capacity");
+        if (i % 3 == 2) ring.Close(++token);
+    }
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestAllocationsAreAlignedAndDisjoint();
+        std::cout << "[PASS] allocations are aligned and disjoint\n";
+        TestFullRingRejectsUntilRetired();
+        std::cout << "[PASS] full ring rejects until retired\n";
+        TestWraparoundSkipsTail();
+        std::cout << "[PASS] wraparound skips the tail\n";
+        TestWrappedBlockWaitsForOverlappingRange();
+        std::cout << "[PASS] wrapped block waits for overlapping range\n";
+        TestDrainedRingRestartsAtZero();
+        std::cout << "[PASS] drained ring restarts at zero\n";
+        TestOversizedAndEmptyRequests();
+        std::cout << "[PASS] oversized and empty requests\n";
+        TestManyCyclesStayBounded();
+        std::cout << "[PASS] many cycles stay bounded\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
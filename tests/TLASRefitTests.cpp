@@ -0,0 +1,77 @@
+#include "Renderer/Resources/TLASRefit.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace Chimera;
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+void TestCapacity()
+{
+    Require(TLASCapacity(0) == 64 && TLASCapacity(64) == 64,
+            "small scenes get the minimum capacity");
+    Require(TLASCapacity(65) == 128 && TLASCapacity(1000) == 1024,
+            "capacity rounds up to a power of two");
+    for (uint32_t count : {1u, 100u, 4097u, 1u << 20, 0xFFFFFFFFu})
+        Require(TLASCapacity(count) >= count, "capacity holds the count");
+}
+
+void TestUpdatesBetweenBuilds()
+{
+    TLASRefitPolicy policy(3);
+    Require(policy.Next(10, 1) == TLASBuildMode::Build,
+            "the first build is a full build");
+    for (uint32_t n = 1; n <= 3; ++n)
+    {
+        Require(policy.Next(10, 1) == TLASBuildMode::Update,
+                "moved instances are refit");
+        Require(policy.GetUpdatesSinceBuild() == n, "updates are counted");
+    }
+    Require(policy.Next(10, 1) == TLASBuildMode::Build,
+            "the structure is rebuilt after rebuildInterval updates");
+    Require(policy.GetUpdatesSinceBuild() == 0 &&
+                policy.Next(10, 1) == TLASBuildMode::Update,
+            "a rebuild starts the count again");
+}
+
+void TestChangesForceBuilds()
+{
+    TLASRefitPolicy policy;
+    policy.Next(10, 1);
+    Require(policy.Next(11, 1) == TLASBuildMode::Build,
+            "a new instance count needs a build");
+    Require(policy.Next(11, 2) == TLASBuildMode::Build,
+            "a new instance layout needs a build");
+    Require(policy.Next(11, 2) == TLASBuildMode::Update,
+            "an unchanged layout is refit");
+    policy.Reset();
+    Require(policy.Next(11, 2) == TLASBuildMode::Build,
+            "a recreated structure needs a build");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestCapacity();
+        std::cout << "[PASS] TLAS capacity\n";
+        TestUpdatesBetweenBuilds();
+        std::cout << "[PASS] periodic rebuilds between refits\n";
+        TestChangesForceBuilds();
+        std::cout << "[PASS] changes force full builds\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,158 @@
+#include "Core/Log.h"
+#include "Core/TaskSystem.h"
+#include "Renderer/Resources/TextureAlpha.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Chimera;
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+std::vector<uint8_t> MakeImage(uint32_t width, uint32_t height,
+                               uint8_t alpha)
+{
+    std::vector<uint8_t> rgba((size_t)width * height * 4, 200);
+    for (size_t i = 3; i < rgba.size(); i += 4) rgba[i] = alpha;
+    return rgba;
+}
+
+    // Foliage-style cut-out: a disc of opaque texels on transparent ones,
+    // with a one texel ring of partial alpha where it was filtered.
+std::vector<uint8_t> MakeCutout(uint32_t size)
+{
+    std::vector<uint8_t> rgba = MakeImage(size, size, 0);
+    const float radius = size * 0.4f;
+    for (uint32_t y = 0; y < size; ++y)
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            const float d = std::hypot(x - size * 0.5f, y - size * 0.5f);
+            const float coverage = std::clamp(radius - d + 0.5f, 0.0f, 1.0f);
+            rgba[((size_t)y * size + x) * 4 + 3] =
+                (uint8_t)std::lround(coverage * 255.0f);
+        }
+    return rgba;
+}
+
+AlphaMode Classify(const std::vector<uint8_t>& rgba,
+                   TaskSystem* tasks = nullptr)
+{
+    return ClassifyAlpha(rgba.data(), rgba.size() / 4, tasks);
+}
+
+void TestClasses()
+{
+    Require(Classify(MakeImage(8, 8, 255)) == AlphaMode::Opaque,
+            "full alpha is opaque");
+    Require(Classify(MakeImage(8, 8, 255 - AlphaTolerance)) ==
+                AlphaMode::Opaque,
+            "alpha within the tolerance of full is opaque");
+    Require(Classify(MakeImage(8, 8, 0)) == AlphaMode::Masked,
+            "fully transparent texels are a mask");
+    Require(Classify(MakeCutout(256)) == AlphaMode::Masked,
+            "a cut-out with filtered edges is masked");
+    Require(Classify(MakeImage(8, 8, 128)) == AlphaMode::Blended,
+            "uniform partial alpha is blended");
+
+    // A gradient from transparent to opaque blends
+    std::vector<uint8_t> gradient = MakeImage(256, 4, 0);
+    for (size_t i = 0; i < gradient.size() / 4; ++i)
+        gradient[i * 4 + 3] = (uint8_t)(i % 256);
+    Require(Classify(gradient) == AlphaMode::Blended,
+            "an alpha gradient is blended");
+
+    // One punched texel demotes an opaque texture to masked
+    std::vector<uint8_t> punched = MakeImage(64, 64, 255);
+    punched[1000 * 4 + 3] = 0;
+    Require(Classify(punched) == AlphaMode::Masked,
+            "a single transparent texel is enough to mask");
+    Require(ClassifyAlpha(nullptr, 0) == AlphaMode::Opaque,
+            "no texels are opaque");
+}
+
+void TestCoverageMerges()
+{
+    const std::vector<uint8_t> cutout = MakeCutout(100);
+    const uint64_t texels = cutout.size() / 4;
+    AlphaCoverage whole;
+    whole.Add(cutout.data(), texels);
+    AlphaCoverage parts;
+    for (uint64_t first = 0; first < texels; first += 777)
+    {
+        AlphaCoverage part;
+        part.Add(cutout.data() + first * 4,
+                 std::min<uint64_t>(777, texels - first));
+        parts.Merge(part);
+    }
+    Require(parts.opaque == whole.opaque &&
+                parts.transparent == whole.transparent &&
+                parts.partial == whole.partial,
+            "chunk counts merge into the whole image's");
+    Require(whole.opaque + whole.transparent + whole.partial == texels,
+            "every texel is counted once");
+}
+
+void TestParallelMatchesSerial()
+{
+    TaskSystem tasks(4);
+    std::mt19937 rng(3);
+    for (int image = 0; image < 6; ++image)
+    {
+        // Large enough to split into chunks, with a class set by a few
+        // texels far from the start
+        std::vector<uint8_t> rgba = MakeImage(1024, 1024 + image, 255);
+        const size_t texels = rgba.size() / 4;
+        if (image % 3 == 1) rgba[(texels - 1 - rng() % 5000) * 4 + 3] = 0;
+        if (image % 3 == 2)
+            for (size_t i = texels / 2; i < texels; ++i)
+                rgba[i * 4 + 3] = (uint8_t)(64 + rng() % 128);
+        Require(Classify(rgba, &tasks) == Classify(rgba),
+                "chunked classification matches a serial scan");
+    }
+
+    std::vector<uint8_t> large = MakeCutout(4096);
+    const auto start = std::chrono::steady_clock::now();
+    const AlphaMode serial = Classify(large);
+    const auto middle = std::chrono::steady_clock::now();
+    const AlphaMode parallel = Classify(large, &tasks);
+    const auto end = std::chrono::steady_clock::now();
+    Require(serial == AlphaMode::Masked && parallel == serial,
+            "a large cut-out is masked either way");
+    using Ms = std::chrono::duration<double, std::milli>;
+    std::cout << "  4096x4096: " << Ms(middle - start).count()
+              << " ms serial, " << Ms(end - middle).count()
+              << " ms on 4 workers\n";
+}
+} // namespace
+
+int main()
+{
+    Chimera::Log::Init();
+
+    try
+    {
+        TestClasses();
+        std::cout << "[PASS] alpha classes\n";
+        TestCoverageMerges();
+        std::cout << "[PASS] coverage merging\n";
+        TestParallelMatchesSerial();
+        std::cout << "[PASS] parallel classification\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,165 @@
+#include "Renderer/Resources/TextureCacheFile.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+constexpr uint64_t SourceHash = 0x0123456789abcdefull;
+
+Chimera::TextureCacheEntry MakeEntry()
+{
+    Chimera::TextureCacheEntry entry;
+    entry.format = Chimera::BlockFormat::BC7;
+    entry.srgb = true;
+    entry.width = 20;
+    entry.height = 8;
+    entry.levelCount = 5; // 20x8, 10x4, 5x2, 2x1, 1x1
+    entry.alphaMode = Chimera::AlphaMode::Blended;
+    entry.data.resize(Chimera::GetCompressedChainSize(
+        entry.format, entry.width, entry.height, entry.levelCount));
+    for (size_t i = 0; i < entry.data.size(); ++i)
+        entry.data[i] = static_cast<uint8_t>(i * 13 + 7);
+    return entry;
+}
+
+void TestRoundTripReturnsLevels()
+{
+    const auto entry = MakeEntry();
+    Require(entry.data.size() == (10 + 3 + 2 + 1 + 1) * 16,
+            "test chain must cover every level's blocks");
+    const auto file = Chimera::SerializeTextureCache(entry, SourceHash);
+
+    Chimera::TextureCacheEntry loaded;
+    Require(Chimera::DeserializeTextureCache(file, SourceHash, loaded) ==
+                Chimera::TextureCacheLoadStatus::Loaded,
+            "a cache file must load for its own source");
+    Require(loaded.format == entry.format && loaded.srgb == entry.srgb &&
+                loaded.width == entry.width &&
+                loaded.height == entry.height &&
+                loaded.levelCount == entry.levelCount &&
+                loaded.alphaMode == entry.alphaMode,
+            "loaded metadata must match the saved entry");
+    Require(loaded.data == entry.data, "loaded levels must match");
+}
+
+void TestMissingAndStaleFiles()
+{
+    Chimera::TextureCacheEntry loaded;
+    Require(Chimera::DeserializeTextureCache({}, SourceHash, loaded) ==
+                Chimera::TextureCacheLoadStatus::Missing,
+            "empty file data must be reported as missing");
+
+    const auto file = Chimera::SerializeTextureCache(MakeEntry(), SourceHash);
+    Require(Chimera::DeserializeTextureCache(file, SourceHash + 1, loaded) ==
+                Chimera::TextureCacheLoadStatus::Stale,
+            "a file for other source bytes must be stale");
+    Require(loaded.data.empty(), "rejected files must not return data");
+
+    auto otherVersion = file;
+    otherVersion[12] ^= 0xFF; // formatVersion follows the identifier
+    Require(Chimera::DeserializeTextureCache(otherVersion, SourceHash,
+                                             loaded) ==
+                Chimera::TextureCacheLoadStatus::Stale,
+            "a file from another encoder version must be stale");
+}
+
+void TestDamagedFilesAreCorrupt()
+{
+    const auto file = Chimera::SerializeTextureCache(MakeEntry(), SourceHash);
+    Chimera::TextureCacheEntry loaded;
+
+    auto truncated = file;
+    truncated.resize(truncated.size() - 1);
+    Require(Chimera::DeserializeTextureCache(truncated, SourceHash, loaded) ==
+                Chimera::TextureCacheLoadStatus::Corrupt,
+            "a truncated file must be corrupt");
+
+    auto flipped = file;
+    flipped.back() ^= 0x01;
+    Require(Chimera::DeserializeTextureCache(flipped, SourceHash, loaded) ==
+                Chimera::TextureCacheLoadStatus::Corrupt,
+            "a payload bit flip must be caught by the checksum");
+
+    auto badIndex = file;
+    badIndex[64 + 16] ^= 0x01; // Level 1 byteOffset
+    Require(Chimera::DeserializeTextureCache(badIndex, SourceHash, loaded) ==
+                Chimera::TextureCacheLoadStatus::Corrupt,
+            "a level index that disagrees with the header must be corrupt");
+
+    auto badAlpha = file;
+    badAlpha[36] = 7; // alphaMode follows levelCount
+    Require(Chimera::DeserializeTextureCache(badAlpha, SourceHash, loaded) ==
+                Chimera::TextureCacheLoadStatus::Corrupt,
+            "an unknown alpha mode must be corrupt");
+
+    auto notOurs = file;
+    notOurs[1] = 'K';
+    Require(Chimera::DeserializeTextureCache(notOurs, SourceHash, loaded) ==
+                Chimera::TextureCacheLoadStatus::Corrupt,
+            "files with another identifier must be corrupt");
+}
+
+void TestSerializeRejectsMismatchedData()
+{
+    auto entry = MakeEntry();
+    entry.data.pop_back();
+    bool threw = false;
+    try
+    {
+        Chimera::SerializeTextureCache(entry, SourceHash);
+    }
+    catch (const std::invalid_argument&)
+    {
+        threw = true;
+    }
+    Require(threw, "data that does not fill the levels must be rejected");
+}
+
+void TestHashAndFileNames()
+{
+    const std::vector<uint8_t> a = {1, 2, 3, 4};
+    const std::vector<uint8_t> b = {1, 2, 3, 5};
+    Require(Chimera::HashTextureSource(a.data(), a.size()) !=
+                Chimera::HashTextureSource(b.data(), b.size()),
+            "different sources must hash differently");
+    const uint64_t seeded = Chimera::HashTextureSource(
+        b.data(), b.size(), Chimera::HashTextureSource(a.data(), a.size()));
+    Require(seeded != Chimera::HashTextureSource(b.data(), b.size()),
+            "the seed must feed into the hash");
+
+    Require(Chimera::MakeTextureCacheFileName(0xabcull, "normal") ==
+                "0000000000000abc_normal.chtex",
+            "file names must be the zero-padded hash and variant");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestRoundTripReturnsLevels();
+        std::cout << "[PASS] round trip returns levels\n";
+        TestMissingAndStaleFiles();
+        std::cout << "[PASS] missing and stale files\n";
+        TestDamagedFilesAreCorrupt();
+        std::cout << "[PASS] damaged files are corrupt\n";
+        TestSerializeRejectsMismatchedData();
+        std::cout << "[PASS] serialize rejects mismatched data\n";
+        TestHashAndFileNames();
+        std::cout << "[PASS] hash and file names\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,275 @@
+#include "Renderer/Resources/TextureResidency.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void Require(bool condition, const std::string& message)
+{
+    if (!condition) throw std::runtime_error(message);
+}
+
+    // Five levels sized like a square RGBA8 chain: 256, 64, 16, 4 and 1
+    // bytes. Levels 3 and 4 are the tail.
+std::vector<uint64_t> MakeLevels()
+{
+    return {256, 64, 16, 4, 1};
+}
+constexpr uint32_t TailMip = 3;
+constexpr uint64_t TailBytes = 5;
+
+std::vector<Chimera::TextureResidency::Change> Update(
+    Chimera::TextureResidency& residency, uint64_t frame)
+{
+    std::vector<Chimera::TextureResidency::Change> changes;
+    residency.Update(frame, changes);
+    return changes;
+}
+
+void TestDesiredMip()
+{
+    Require(Chimera::ComputeDesiredMip(1024, 11, 2048.0f) == 0,
+            "magnified textures need the full chain");
+    Require(Chimera::ComputeDesiredMip(1024, 11, 1024.0f) == 0,
+            "one texel per pixel needs mip 0");
+    Require(Chimera::ComputeDesiredMip(1024, 11, 300.0f) == 1,
+            "partial ratios round towards the finer mip");
+    Require(Chimera::ComputeDesiredMip(1024, 11, 64.0f) == 4,
+            "a 64 pixel footprint needs the 64 texel mip");
+    Require(Chimera::ComputeDesiredMip(1024, 11, 0.0f) == 10,
+            "sub-pixel footprints need only the last mip");
+    Require(Chimera::ComputeDesiredMip(1024, 1, 1.0f) == 0,
+            "single-level textures always use mip 0");
+}
+
+void TestTailIsResidentAtLoad()
+{
+    Chimera::TextureResidency residency;
+    residency.Add(7, MakeLevels(), TailMip);
+    Require(residency.GetResidentMip(7) == TailMip,
+            "textures start with only their tail resident");
+    Require(residency.GetResidentBytes() == TailBytes,
+            "only tail bytes count at load");
+    Require(Update(residency, 1).empty(),
+            "unrequested textures must not stream in");
+
+    residency.Remove(7);
+    Require(residency.GetResidentBytes() == 0 && !residency.Contains(7),
+            "removing a texture returns its bytes");
+}
+
+void TestRequestsPromoteWithinBudget()
+{
+    Chimera::TextureResidency residency;
+    residency.SetBudget(1000);
+    residency.Add(1, MakeLevels(), TailMip);
+    residency.Request(1, 2, 1);
+    residency.Request(1, 0, 1); // Finest request in a frame wins
+    residency.Request(1, 1, 1);
+    const auto changes = Update(residency, 1);
+    Require(changes.size() == 1 && changes[0].id == 1 &&
+                changes[0].residentMip == 0,
+            "a request must promote to the finest mip asked for");
+    Require(residency.GetResidentBytes() == 341,
+            "promoted levels must be counted");
+    Require(Update(residency, 2).empty(),
+            "resident textures stay put once requests stop");
+}
+
+void TestBudgetPicksCoarserLevel()
+{
+    Chimera::TextureResidency residency;
+    residency.SetBudget(100);
+    residency.Add(1, MakeLevels(), TailMip);
+    residency.Request(1, 0, 1);
+    const auto changes = Update(residency, 1);
+    Require(changes.size() == 1 && changes[0].residentMip == 1,
+            "a level that cannot fit must settle for the finest that does");
+    Require(residency.GetResidentBytes() <= 100, "budget must hold");
+}
+
+void TestLeastRecentlyUsedIsEvicted()
+{
+    Chimera::TextureResidency residency;
+    residency.SetBudget(440);
+    for (uint32_t id = 1; id <= 3; ++id)
+        residency.Add(id, MakeLevels(), TailMip);
+
+    // Textures 1 and 2 stream in fully, 1 used last at frame 1
+    residency.Request(1, 1, 1);
+    residency.Request(2, 1, 1);
+    Update(residency, 1);
+    residency.Request(2, 1, 2);
+    Update(residency, 2);
+    Require(residency.GetResidentMip(1) == 1 &&
+                residency.GetResidentMip(2) == 1,
+            "both textures fit the budget");
+
+    // Texture 3 wants mip 0 (336 more bytes), which needs both of texture
+    // 1's streamed levels; only texture 1 is older than it
+    residency.Request(2, 1, 3);
+    residency.Request(3, 0, 3);
+    const auto changes = Update(residency, 3);
+    Require(residency.GetResidentMip(3) == 0,
+            "the requested texture must reach its mip");
+    Require(residency.GetResidentMip(1) == TailMip,
+            "the least recently used texture must be evicted");
+    Require(residency.GetResidentMip(2) == 1,
+            "textures used this frame must keep their mips");
+    Require(changes.size() == 2 && changes[0].id == 1 && changes[1].id == 3,
+            "changes must list evictions and promotions by id");
+    Require(residency.GetResidentBytes() <= 440, "budget must hold");
+}
+
+void TestVisibleTexturesDoNotThrash()
+{
+    Chimera::TextureResidency residency;
+    residency.SetBudget(300);
+    residency.Add(1, MakeLevels(), TailMip);
+    residency.Add(2, MakeLevels(), TailMip);
+    for (uint64_t frame = 1; frame <= 4; ++frame)
+    {
+        residency.Request(1, 0, frame);
+        residency.Request(2, 0, frame);
+        const auto changes = Update(residency, frame);
+        if (frame > 1)
+            Require(changes.empty(),
+                    "two visible textures must not trade levels");
+    }
+    Require(residency.GetResidentMip(1) == 1 &&
+                residency.GetResidentMip(2) == 1,
+            "neither visible texture may take levels from the other");
+}
+
+void TestOverResidentTexturesGiveWay()
+{
+    Chimera::TextureResidency residency;
+    residency.SetBudget(370);
+    residency.Add(1, MakeLevels(), TailMip);
+    residency.Add(2, MakeLevels(), TailMip);
+    residency.Request(1, 0, 1);
+    Update(residency, 1);
+
+    // Both visible, but texture 1 now only needs mip 2
+    residency.Request(1, 2, 2);
+    residency.Request(2, 0, 2);
+    Update(residency, 2);
+    Require(residency.GetResidentMip(2) == 0,
+            "levels held beyond a request must make room");
+    Require(residency.GetResidentMip(1) == 2,
+            "an over-resident texture keeps what it still needs");
+}
+
+void TestLargestShortfallFirstAndUploadLimit()
+{
+    Chimera::TextureResidency residency;
+    residency.SetUploadBytesPerUpdate(50);
+    residency.Add(1, MakeLevels(), TailMip);
+    residency.Add(2, MakeLevels(), TailMip);
+    residency.Request(1, 2, 1);
+    residency.Request(2, 0, 1);
+    auto changes = Update(residency, 1);
+    Require(changes.size() == 1 && changes[0].id == 2,
+            "the largest shortfall streams first, even past the limit");
+
+    residency.Request(1, 2, 2);
+    residency.Request(2, 0, 2);
+    changes = Update(residency, 2);
+    Require(changes.size() == 1 && changes[0].id == 1 &&
+                changes[0].residentMip == 2,
+            "the rest streams in on later updates");
+}
+
+void TestLoweredBudgetEvicts()
+{
+    Chimera::TextureResidency residency;
+    residency.Add(1, MakeLevels(), TailMip);
+    residency.Request(1, 0, 1);
+    Update(residency, 1);
+    residency.SetBudget(50);
+    residency.Request(1, 0, 2);
+    const auto changes = Update(residency, 2);
+    Require(changes.size() == 1 && changes[0].residentMip == 2,
+            "a lowered budget must evict down to what fits");
+    Require(residency.GetResidentBytes() <= 50, "budget must hold");
+
+    residency.SetBudget(1);
+    Update(residency, 3);
+    Require(residency.GetResidentMip(1) == TailMip &&
+                residency.GetResidentBytes() == TailBytes,
+            "the tail is never evicted, even over budget");
+}
+
+void TestSourceDataTrimmed()
+{
+    Chimera::TextureResidency residency;
+    residency.SetBudget(1000);
+    residency.SetSourceBudget(700);
+    for (uint32_t id = 1; id <= 4; ++id)
+    {
+        residency.Add(id, MakeLevels(), TailMip);
+        residency.SetSourceData(id, 341, id != 4); // 4 cannot be reloaded
+    }
+    Require(residency.GetSourceBytes() == 4 * 341,
+            "every copy must be counted");
+
+    residency.Request(1, 0, 1);
+    residency.Request(2, TailMip, 1);
+    Update(residency, 1);
+    residency.Request(1, 0, 2);
+    Update(residency, 2);
+    std::vector<uint32_t> dropped;
+    residency.TrimSourceData(2, dropped);
+    Require(dropped == std::vector<uint32_t>({3, 2}),
+            "copies must be dropped least recently requested first");
+    Require(residency.GetSourceBytes() == 2 * 341,
+            "trimming must stop once the copies fit");
+
+    residency.SetSourceBudget(0);
+    dropped.clear();
+    residency.TrimSourceData(3, dropped);
+    Require(dropped.empty(),
+            "streamed-in and unreloadable textures must keep their copies");
+
+    residency.SetSourceData(2, 341, true);
+    residency.Remove(1);
+    Require(residency.GetSourceBytes() == 2 * 341,
+            "reloads and removals must update the count");
+}
+} // namespace
+
+int main()
+{
+    try
+    {
+        TestDesiredMip();
+        std::cout << "[PASS] desired mip\n";
+        TestTailIsResidentAtLoad();
+        std::cout << "[PASS] tail is resident at load\n";
+        TestRequestsPromoteWithinBudget();
+        std::cout << "[PASS] requests promote within budget\n";
+        TestBudgetPicksCoarserLevel();
+        std::cout << "[PASS] budget picks coarser level\n";
+        TestLeastRecentlyUsedIsEvicted();
+        std::cout << "[PASS] least recently used is evicted\n";
+        TestVisibleTexturesDoNotThrash();
+        std::cout << "[PASS] visible textures do not thrash\n";
+        TestOverResidentTexturesGiveWay();
+        std::cout << "[PASS] over-resident textures give way\n";
+        TestLargestShortfallFirstAndUploadLimit();
+        std::cout << "[PASS] largest shortfall first and upload limit\n";
+        TestLoweredBudgetEvicts();
+        std::cout << "[PASS] lowered budget evicts\n";
+        TestSourceDataTrimmed();
+        std::cout << "[PASS] source data trimmed\n";
+        return 0;
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << "[FAIL] " << error.what() << '\n';
+        return 1;
+    }
+}